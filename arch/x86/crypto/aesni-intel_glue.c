@@ -33,6 +33,8 @@
 #include <crypto/xts.h>
 #include <asm/cpu_device_id.h>
 #include <asm/i387.h>
+#include <asm/xcr.h>
+#include <asm/xsave.h>
 #include <asm/crypto/aes.h>
 #include <crypto/ablk_helper.h>
 #include <crypto/scatterwalk.h>
@@ -53,8 +55,11 @@
  */
 struct aesni_rfc4106_gcm_ctx {
 	u8 hash_subkey[16];
+	/* H^1..H^8 and their Karatsuba halves for the AVX2 code */
+	u8 hash_keys[16 * 16];
 	struct crypto_aes_ctx aes_key_expanded;
 	u8 nonce[4];
+	bool hash_keys_set;
 	struct cryptd_aead *cryptd_tfm;
 };
 
@@ -150,6 +155,30 @@ asmlinkage void aesni_gcm_dec(void *ctx, u8 *out,
 			u8 *hash_subkey, const u8 *aad, unsigned long aad_len,
 			u8 *auth_tag, unsigned long auth_tag_len);
 
+#ifdef CONFIG_AS_AVX2
+/*
+ * AVX2 GCM building blocks.  The hash value and counter block are kept in
+ * GCM byte order; hash_keys is the table written by aesni_gcm_precomp_avx2().
+ * The bulk functions take a number of 128 byte chunks and hash the
+ * ciphertext while encrypting the next eight counter blocks.
+ */
+asmlinkage void aesni_gcm_precomp_avx2(u8 *hash_keys, const u8 *hash_subkey);
+asmlinkage void aesni_gcm_ghash_avx2(u8 *hash, const u8 *hash_keys,
+				     const u8 *in, unsigned int blocks);
+asmlinkage void aesni_gcm_enc8_avx2(struct crypto_aes_ctx *ctx, u8 *out,
+				    const u8 *in, unsigned int chunks,
+				    u8 *ctr, u8 *hash, const u8 *hash_keys);
+asmlinkage void aesni_gcm_dec8_avx2(struct crypto_aes_ctx *ctx, u8 *out,
+				    const u8 *in, unsigned int chunks,
+				    u8 *ctr, u8 *hash, const u8 *hash_keys);
+
+static bool aesni_gcm_use_avx2;
+
+/* Packets below this are hashed in a single GHASH call from a bounce buffer */
+#define AESNI_GCM_AVX2_SMALL	256
+#define AESNI_GCM_AVX2_CHUNK	(8 * AES_BLOCK_SIZE)
+#endif
+
 static inline struct
 aesni_rfc4106_gcm_ctx *aesni_rfc4106_gcm_ctx_get(struct crypto_aead *tfm)
 {
@@ -793,6 +822,15 @@ static int rfc4106_set_key(struct crypto_aead *parent, const u8 *key,
 		goto exit;
 	}
 	ret = rfc4106_set_hash_subkey(ctx->hash_subkey, key, key_len);
+	ctx->hash_keys_set = false;
+#ifdef CONFIG_AS_AVX2
+	if (!ret && aesni_gcm_use_avx2 && irq_fpu_usable()) {
+		kernel_fpu_begin();
+		aesni_gcm_precomp_avx2(ctx->hash_keys, ctx->hash_subkey);
+		kernel_fpu_end();
+		ctx->hash_keys_set = true;
+	}
+#endif
 	memcpy(child_ctx, ctx, sizeof(*ctx));
 exit:
 	kfree(new_key_mem);
@@ -862,6 +900,126 @@ static int rfc4106_decrypt(struct aead_request *req)
 	}
 }
 
+#ifdef CONFIG_AS_AVX2
+/*
+ * GCM on a linear buffer with the AVX2 functions, called with the FPU held.
+ * rfc4106 associated data is 8 or 12 bytes, so it is always a single block.
+ * Small packets are assembled with the associated data and the length block
+ * in one buffer and hashed in one pass; larger ones go through the
+ * stitched 8-block loop, and the remaining blocks through the CTR code.
+ */
+static void aesni_gcm_avx2_crypt(struct aesni_rfc4106_gcm_ctx *ctx, bool enc,
+				 u8 *out, const u8 *in, unsigned long len,
+				 u8 *iv, const u8 *aad, unsigned long aad_len,
+				 u8 *auth_tag, unsigned long auth_tag_len)
+{
+	struct crypto_aes_ctx *aes_ctx = &ctx->aes_key_expanded;
+	u8 buf[AESNI_GCM_AVX2_SMALL + 2 * AES_BLOCK_SIZE];
+	u8 ctr[AES_BLOCK_SIZE], hash[AES_BLOCK_SIZE], ks[AES_BLOCK_SIZE];
+	unsigned long total = len, nbytes, tail, i;
+	__be64 *lens;
+	u8 *p;
+
+	memset(hash, 0, sizeof(hash));
+	memcpy(ctr, iv, AES_BLOCK_SIZE);
+	crypto_inc(ctr, AES_BLOCK_SIZE);
+
+	memset(buf, 0, AES_BLOCK_SIZE);
+	memcpy(buf, aad, aad_len);
+	p = buf + AES_BLOCK_SIZE;
+
+	if (len >= AESNI_GCM_AVX2_SMALL) {
+		aesni_gcm_ghash_avx2(hash, ctx->hash_keys, buf, 1);
+		p = buf;
+
+		nbytes = len / AESNI_GCM_AVX2_CHUNK;
+		if (enc)
+			aesni_gcm_enc8_avx2(aes_ctx, out, in, nbytes, ctr,
+					    hash, ctx->hash_keys);
+		else
+			aesni_gcm_dec8_avx2(aes_ctx, out, in, nbytes, ctr,
+					    hash, ctx->hash_keys);
+		nbytes *= AESNI_GCM_AVX2_CHUNK;
+		in += nbytes;
+		out += nbytes;
+		len -= nbytes;
+
+		nbytes = len & AES_BLOCK_MASK;
+		if (!enc)
+			aesni_gcm_ghash_avx2(hash, ctx->hash_keys, in,
+					     nbytes / AES_BLOCK_SIZE);
+		aesni_ctr_enc(aes_ctx, out, in, nbytes, ctr);
+		if (enc)
+			aesni_gcm_ghash_avx2(hash, ctx->hash_keys, out,
+					     nbytes / AES_BLOCK_SIZE);
+		in += nbytes;
+		out += nbytes;
+		len -= nbytes;
+	}
+
+	/* what is left is copied to buf, behind the AAD for small packets */
+	nbytes = len & AES_BLOCK_MASK;
+	tail = len - nbytes;
+	if (!enc)
+		memcpy(p, in, len);
+	aesni_ctr_enc(aes_ctx, out, in, nbytes, ctr);
+	if (tail) {
+		aesni_enc(aes_ctx, ks, ctr);
+		for (i = 0; i < tail; i++)
+			out[nbytes + i] = in[nbytes + i] ^ ks[i];
+	}
+	if (enc)
+		memcpy(p, out, len);
+	p += len;
+	tail = -len & (AES_BLOCK_SIZE - 1);
+	memset(p, 0, tail);
+	p += tail;
+
+	lens = (__be64 *)p;
+	lens[0] = cpu_to_be64((u64)aad_len * 8);
+	lens[1] = cpu_to_be64((u64)total * 8);
+	p += AES_BLOCK_SIZE;
+	aesni_gcm_ghash_avx2(hash, ctx->hash_keys, buf,
+			     (p - buf) / AES_BLOCK_SIZE);
+
+	aesni_enc(aes_ctx, ks, iv);
+	crypto_xor(ks, hash, AES_BLOCK_SIZE);
+	memcpy(auth_tag, ks, auth_tag_len);
+}
+#endif
+
+static void aesni_rfc4106_gcm_enc(struct aesni_rfc4106_gcm_ctx *ctx, u8 *out,
+				  const u8 *in, unsigned long len, u8 *iv,
+				  const u8 *aad, unsigned long aad_len,
+				  u8 *auth_tag, unsigned long auth_tag_len)
+{
+#ifdef CONFIG_AS_AVX2
+	if (ctx->hash_keys_set) {
+		aesni_gcm_avx2_crypt(ctx, true, out, in, len, iv, aad,
+				     aad_len, auth_tag, auth_tag_len);
+		return;
+	}
+#endif
+	aesni_gcm_enc(&ctx->aes_key_expanded, out, in, len, iv,
+		      ctx->hash_subkey, aad, aad_len, auth_tag, auth_tag_len);
+}
+
+static void aesni_rfc4106_gcm_dec(struct aesni_rfc4106_gcm_ctx *ctx, u8 *out,
+				  const u8 *in, unsigned long len, u8 *iv,
+				  const u8 *aad, unsigned long aad_len,
+				  u8 *auth_tag, unsigned long auth_tag_len)
+{
+#ifdef CONFIG_AS_AVX2
+	if (ctx->hash_keys_set) {
+		aesni_gcm_avx2_crypt(ctx, false, out, in, len, iv, aad,
+				     aad_len, auth_tag, auth_tag_len);
+		return;
+	}
+#endif
+	aesni_gcm_dec(&ctx->aes_key_expanded, out, in, len, iv,
+		      ctx->hash_subkey, aad, aad_len, auth_tag, auth_tag_len);
+}
+
 static int __driver_rfc4106_encrypt(struct aead_request *req)
 {
 	u8 one_entry_in_sg = 0;
@@ -869,7 +1027,6 @@ static int __driver_rfc4106_encrypt(struct aead_request *req)
 	__be32 counter = cpu_to_be32(1);
 	struct crypto_aead *tfm = crypto_aead_reqtfm(req);
 	struct aesni_rfc4106_gcm_ctx *ctx = aesni_rfc4106_gcm_ctx_get(tfm);
-	void *aes_ctx = &(ctx->aes_key_expanded);
 	unsigned long auth_tag_len = crypto_aead_authsize(tfm);
 	u8 iv_tab[16+AESNI_ALIGN];
 	u8* iv = (u8 *) PTR_ALIGN((u8 *)iv_tab, AESNI_ALIGN);
@@ -915,8 +1072,8 @@ static int __driver_rfc4106_encrypt(struct aead_request *req)
 		dst = src;
 	}
 
-	aesni_gcm_enc(aes_ctx, dst, src, (unsigned long)req->cryptlen, iv,
-		ctx->hash_subkey, assoc, (unsigned long)req->assoclen, dst
+	aesni_rfc4106_gcm_enc(ctx, dst, src, (unsigned long)req->cryptlen, iv,
+		assoc, (unsigned long)req->assoclen, dst
 		+ ((unsigned long)req->cryptlen), auth_tag_len);
 
 	/* The authTag (aka the Integrity Check Value) needs to be written
@@ -947,7 +1104,6 @@ static int __driver_rfc4106_decrypt(struct aead_request *req)
 	int retval = 0;
 	struct crypto_aead *tfm = crypto_aead_reqtfm(req);
 	struct aesni_rfc4106_gcm_ctx *ctx = aesni_rfc4106_gcm_ctx_get(tfm);
-	void *aes_ctx = &(ctx->aes_key_expanded);
 	unsigned long auth_tag_len = crypto_aead_authsize(tfm);
 	u8 iv_and_authTag[32+AESNI_ALIGN];
 	u8 *iv = (u8 *) PTR_ALIGN((u8 *)iv_and_authTag, AESNI_ALIGN);
@@ -996,8 +1152,8 @@ static int __driver_rfc4106_decrypt(struct aead_request *req)
 		dst = src;
 	}
 
-	aesni_gcm_dec(aes_ctx, dst, src, tempCipherLen, iv,
-		ctx->hash_subkey, assoc, (unsigned long)req->assoclen,
+	aesni_rfc4106_gcm_dec(ctx, dst, src, tempCipherLen, iv,
+		assoc, (unsigned long)req->assoclen,
 		authTag, auth_tag_len);
 
 	/* Compare generated tag with passed in tag. */
@@ -1019,6 +1175,56 @@ static int __driver_rfc4106_decrypt(struct aead_request *req)
 	}
 	return retval;
 }
+
+#define RFC4106_BATCH	16
+
+/*
+ * Run a batch of requests inside a single FPU section and call their
+ * completions once it has been left.  Without the FPU, every request goes
+ * through cryptd like a single one would.
+ */
+static void rfc4106_crypt_batch(struct aead_request **reqs, unsigned int nreq,
+				int (*crypt)(struct aead_request *req),
+				int (*queue)(struct aead_request *req))
+{
+	int err[RFC4106_BATCH];
+	unsigned int i, n;
+
+	while (nreq) {
+		n = min_t(unsigned int, nreq, RFC4106_BATCH);
+
+		if (irq_fpu_usable()) {
+			kernel_fpu_begin();
+			for (i = 0; i < n; i++)
+				err[i] = crypt(reqs[i]);
+			kernel_fpu_end();
+		} else {
+			for (i = 0; i < n; i++)
+				err[i] = queue(reqs[i]);
+		}
+
+		for (i = 0; i < n; i++)
+			if (!aead_request_pending(reqs[i], err[i]))
+				aead_request_complete(reqs[i], err[i]);
+
+		reqs += n;
+		nreq -= n;
+	}
+}
+
+static void rfc4106_encrypt_batch(struct aead_request **reqs,
+				  unsigned int nreq)
+{
+	rfc4106_crypt_batch(reqs, nreq, __driver_rfc4106_encrypt,
+			    rfc4106_encrypt);
+}
+
+static void rfc4106_decrypt_batch(struct aead_request **reqs,
+				  unsigned int nreq)
+{
+	rfc4106_crypt_batch(reqs, nreq, __driver_rfc4106_decrypt,
+			    rfc4106_decrypt);
+}
 #endif
 
 static struct crypto_alg aesni_algs[] = { {
@@ -1223,6 +1429,8 @@ static struct crypto_alg aesni_algs[] = { {
 			.setauthsize	= rfc4106_set_authsize,
 			.encrypt	= rfc4106_encrypt,
 			.decrypt	= rfc4106_decrypt,
+			.encrypt_batch	= rfc4106_encrypt_batch,
+			.decrypt_batch	= rfc4106_decrypt_batch,
 			.geniv		= "seqiv",
 			.ivsize		= 8,
 			.maxauthsize	= 16,
@@ -1358,6 +1566,16 @@ static int __init aesni_init(void)
 	if (err)
 		return err;
 
+#if defined(CONFIG_X86_64) && defined(CONFIG_AS_AVX2)
+	if (cpu_has_avx2 && cpu_has_avx && cpu_has_osxsave &&
+	    cpu_has_pclmulqdq) {
+		u64 xcr0 = xgetbv(XCR_XFEATURE_ENABLED_MASK);
+
+		aesni_gcm_use_avx2 = (xcr0 & (XSTATE_SSE | XSTATE_YMM)) ==
+				     (XSTATE_SSE | XSTATE_YMM);
+	}
+#endif
+
 	return crypto_register_algs(aesni_algs, ARRAY_SIZE(aesni_algs));
 }
 
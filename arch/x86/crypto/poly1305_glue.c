@@ -0,0 +1,219 @@
+/*
+ * Poly1305 authenticator algorithm, RFC7539, SIMD glue code
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <crypto/algapi.h>
+#include <crypto/internal/hash.h>
+#include <crypto/poly1305.h>
+#include <linux/crypto.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <asm/i387.h>
+#include <asm/xcr.h>
+#include <asm/xsave.h>
+
+/*
+ * Below this many bytes, the generic code is done before the FPU state
+ * would have been saved and restored.
+ */
+#define POLY1305_SIMD_MIN	(POLY1305_BLOCK_SIZE * 18)
+
+struct poly1305_simd_desc_ctx {
+	struct poly1305_desc_ctx base;
+	/* derived key r^2 has been set */
+	bool uset;
+#ifdef CONFIG_AS_AVX2
+	/* derived keys r^3 and r^4 have been set */
+	bool wset;
+#endif
+	/* derived keys r^2, r^3 and r^4, in this order */
+	u32 u[3][5];
+};
+
+asmlinkage void poly1305_2block_sse2(u32 *h, const u8 *src, const u32 *r,
+				     unsigned int blocks, const u32 *u);
+#ifdef CONFIG_AS_AVX2
+asmlinkage void poly1305_4block_avx2(u32 *h, const u8 *src, const u32 *r,
+				     unsigned int blocks, const u32 *u);
+static bool poly1305_use_avx2;
+#endif
+
+static int poly1305_simd_init(struct shash_desc *desc)
+{
+	struct poly1305_simd_desc_ctx *sctx = shash_desc_ctx(desc);
+
+	sctx->uset = false;
+#ifdef CONFIG_AS_AVX2
+	sctx->wset = false;
+#endif
+
+	return crypto_poly1305_init(desc);
+}
+
+/* a = a * b mod 2^130 - 5, both in 26-bit limbs */
+static void poly1305_simd_mult(u32 *a, const u32 *b)
+{
+	u32 s1 = b[1] * 5, s2 = b[2] * 5, s3 = b[3] * 5, s4 = b[4] * 5;
+	u64 d0, d1, d2, d3, d4;
+
+	d0 = (u64)a[0] * b[0] + (u64)a[1] * s4 + (u64)a[2] * s3 +
+	     (u64)a[3] * s2 + (u64)a[4] * s1;
+	d1 = (u64)a[0] * b[1] + (u64)a[1] * b[0] + (u64)a[2] * s4 +
+	     (u64)a[3] * s3 + (u64)a[4] * s2;
+	d2 = (u64)a[0] * b[2] + (u64)a[1] * b[1] + (u64)a[2] * b[0] +
+	     (u64)a[3] * s4 + (u64)a[4] * s3;
+	d3 = (u64)a[0] * b[3] + (u64)a[1] * b[2] + (u64)a[2] * b[1] +
+	     (u64)a[3] * b[0] + (u64)a[4] * s4;
+	d4 = (u64)a[0] * b[4] + (u64)a[1] * b[3] + (u64)a[2] * b[2] +
+	     (u64)a[3] * b[1] + (u64)a[4] * b[0];
+
+	d1 += d0 >> 26;
+	d2 += d1 >> 26;
+	d3 += d2 >> 26;
+	d4 += d3 >> 26;
+	a[0] = (d0 & 0x3ffffff) + (u32)(d4 >> 26) * 5;
+	a[1] = (d1 & 0x3ffffff) + (a[0] >> 26);
+	a[0] &= 0x3ffffff;
+	a[2] = d2 & 0x3ffffff;
+	a[3] = d3 & 0x3ffffff;
+	a[4] = d4 & 0x3ffffff;
+}
+
+static unsigned int poly1305_simd_blocks(struct poly1305_desc_ctx *dctx,
+					 const u8 *src, unsigned int srclen)
+{
+	struct poly1305_simd_desc_ctx *sctx;
+	unsigned int blocks, datalen;
+
+	BUILD_BUG_ON(offsetof(struct poly1305_simd_desc_ctx, base));
+	sctx = container_of(dctx, struct poly1305_simd_desc_ctx, base);
+
+	if (unlikely(!dctx->sset)) {
+		datalen = crypto_poly1305_setdesckey(dctx, src, srclen);
+		src += srclen - datalen;
+		srclen = datalen;
+	}
+
+	if (srclen >= POLY1305_BLOCK_SIZE * 2 && unlikely(!sctx->uset)) {
+		memcpy(sctx->u[0], dctx->r, sizeof(sctx->u[0]));
+		poly1305_simd_mult(sctx->u[0], dctx->r);
+		sctx->uset = true;
+	}
+
+#ifdef CONFIG_AS_AVX2
+	if (poly1305_use_avx2 && srclen >= POLY1305_BLOCK_SIZE * 4) {
+		if (unlikely(!sctx->wset)) {
+			memcpy(sctx->u[1], sctx->u[0], sizeof(sctx->u[1]));
+			poly1305_simd_mult(sctx->u[1], dctx->r);
+			memcpy(sctx->u[2], sctx->u[1], sizeof(sctx->u[2]));
+			poly1305_simd_mult(sctx->u[2], dctx->r);
+			sctx->wset = true;
+		}
+		blocks = srclen / (POLY1305_BLOCK_SIZE * 4);
+		poly1305_4block_avx2(dctx->h, src, dctx->r, blocks,
+				     sctx->u[0]);
+		src += POLY1305_BLOCK_SIZE * 4 * blocks;
+		srclen -= POLY1305_BLOCK_SIZE * 4 * blocks;
+	}
+#endif
+	if (likely(srclen >= POLY1305_BLOCK_SIZE * 2)) {
+		blocks = srclen / (POLY1305_BLOCK_SIZE * 2);
+		poly1305_2block_sse2(dctx->h, src, dctx->r, blocks,
+				     sctx->u[0]);
+		src += POLY1305_BLOCK_SIZE * 2 * blocks;
+		srclen -= POLY1305_BLOCK_SIZE * 2 * blocks;
+	}
+	if (srclen >= POLY1305_BLOCK_SIZE)
+		srclen = crypto_poly1305_blocks(dctx, src, srclen);
+
+	return srclen;
+}
+
+static int poly1305_simd_update(struct shash_desc *desc,
+				const u8 *src, unsigned int srclen)
+{
+	struct poly1305_desc_ctx *dctx = shash_desc_ctx(desc);
+	unsigned int bytes;
+
+	if (srclen < POLY1305_SIMD_MIN || !irq_fpu_usable())
+		return crypto_poly1305_update(desc, src, srclen);
+
+	kernel_fpu_begin();
+
+	if (unlikely(dctx->buflen)) {
+		bytes = min(srclen, POLY1305_BLOCK_SIZE - dctx->buflen);
+		memcpy(dctx->buf + dctx->buflen, src, bytes);
+		src += bytes;
+		srclen -= bytes;
+		dctx->buflen += bytes;
+
+		if (dctx->buflen == POLY1305_BLOCK_SIZE) {
+			poly1305_simd_blocks(dctx, dctx->buf,
+					     POLY1305_BLOCK_SIZE);
+			dctx->buflen = 0;
+		}
+	}
+
+	if (likely(srclen >= POLY1305_BLOCK_SIZE)) {
+		bytes = poly1305_simd_blocks(dctx, src, srclen);
+		src += srclen - bytes;
+		srclen = bytes;
+	}
+
+	kernel_fpu_end();
+
+	if (unlikely(srclen)) {
+		dctx->buflen = srclen;
+		memcpy(dctx->buf, src, srclen);
+	}
+
+	return 0;
+}
+
+static struct shash_alg alg = {
+	.digestsize	= POLY1305_DIGEST_SIZE,
+	.init		= poly1305_simd_init,
+	.update		= poly1305_simd_update,
+	.final		= crypto_poly1305_final,
+	.descsize	= sizeof(struct poly1305_simd_desc_ctx),
+	.base		= {
+		.cra_name		= "poly1305",
+		.cra_driver_name	= "poly1305-simd",
+		.cra_priority		= 300,
+		.cra_flags		= CRYPTO_ALG_TYPE_SHASH,
+		.cra_alignmask		= sizeof(u32) - 1,
+		.cra_blocksize		= POLY1305_BLOCK_SIZE,
+		.cra_module		= THIS_MODULE,
+	},
+};
+
+static int __init poly1305_simd_mod_init(void)
+{
+#ifdef CONFIG_AS_AVX2
+	if (cpu_has_avx2 && cpu_has_avx && cpu_has_osxsave) {
+		u64 xcr0 = xgetbv(XCR_XFEATURE_ENABLED_MASK);
+
+		poly1305_use_avx2 = (xcr0 & (XSTATE_SSE | XSTATE_YMM)) ==
+				    (XSTATE_SSE | XSTATE_YMM);
+	}
+#endif
+	return crypto_register_shash(&alg);
+}
+
+static void __exit poly1305_simd_mod_exit(void)
+{
+	crypto_unregister_shash(&alg);
+}
+
+module_init(poly1305_simd_mod_init);
+module_exit(poly1305_simd_mod_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Poly1305 authenticator, SIMD accelerated");
+MODULE_ALIAS("poly1305");
+MODULE_ALIAS("poly1305-simd");
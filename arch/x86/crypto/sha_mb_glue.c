@@ -0,0 +1,645 @@
+/*
+ * Cryptographic API.
+ *
+ * Glue code for the multi-buffer SHA-1 and SHA-256 implementations using
+ * AVX2 instructions.
+ *
+ * A single SHA-1 or SHA-256 stream cannot keep the vector units busy, every
+ * round depends on the previous one.  Independent streams can: the AVX2
+ * code hashes eight messages at once, one per 32-bit lane.  The asynchronous
+ * hash interface lets us collect requests from many users (typically IPsec
+ * or dm-crypt style callers that keep several requests in flight) into a
+ * per-cpu set of lanes and push them through the vector code together.
+ *
+ * Requests are queued on the cpu that submitted them and processed by a
+ * work item bound to that cpu.  The lanes are run as soon as all eight
+ * are busy.  When the queue runs dry with only some lanes busy, a delayed
+ * work item runs them anyway after SHA_MB_FLUSH_US, so a lone request
+ * never waits longer than that for company.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ */
+
+#define pr_fmt(fmt)	KBUILD_MODNAME ": " fmt
+
+#include <crypto/internal/hash.h>
+#include <crypto/crypto_wq.h>
+#include <crypto/scatterwalk.h>
+#include <crypto/sha.h>
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/scatterlist.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/types.h>
+#include <linux/workqueue.h>
+#include <asm/byteorder.h>
+#include <asm/i387.h>
+#include <asm/xcr.h>
+#include <asm/xsave.h>
+
+#define SHA_MB_LANES		8
+#define SHA_MB_BLOCK_SIZE	64
+#define SHA_MB_MAX_WORDS	8
+
+/* Longest a partially filled set of lanes waits for more requests */
+#define SHA_MB_FLUSH_US		1000
+
+/*
+ * Upper bound on the blocks hashed per lane between kernel_fpu_begin() and
+ * kernel_fpu_end(), which keeps the time spent with preemption disabled
+ * in the tens of microseconds.
+ */
+#define SHA_MB_MAX_BLKS		64
+
+#define SHA_MB_QUEUE_LEN	256
+
+/* Layout shared with sha1-mb-avx2-asm_64.S and sha256-mb-avx2-asm_64.S */
+struct sha_mb_args {
+	u32 digest[SHA_MB_MAX_WORDS][SHA_MB_LANES];
+	const u8 *data_ptr[SHA_MB_LANES];
+};
+
+typedef void (sha_mb_x8_fn)(struct sha_mb_args *args, u64 num_blks);
+
+asmlinkage void sha1_x8_avx2(struct sha_mb_args *args, u64 num_blks);
+asmlinkage void sha256_x8_avx2(struct sha_mb_args *args, u64 num_blks);
+
+struct sha_mb_req_ctx {
+	u32 digest[SHA_MB_MAX_WORDS];
+	u64 count;			/* bytes hashed or buffered so far */
+	u8 buf[2 * SHA_MB_BLOCK_SIZE];	/* partial block, or final padding */
+
+	/* input of the update/final/finup in progress */
+	struct scatterlist *sg;
+	unsigned int offset;		/* into sg */
+	unsigned int nbytes;		/* left in the request */
+	bool final;
+	bool padded;
+	u8 *result;
+
+	/* job currently loaded into a lane */
+	const u8 *data;
+	unsigned int blocks;
+};
+
+struct sha_mb_cpu {
+	struct sha_mb_alg *alg;
+	int cpu_id;
+
+	spinlock_t lock;		/* protects queue */
+	struct crypto_queue queue;
+
+	struct mutex mutex;		/* protects the lanes */
+	struct sha_mb_args args;
+	struct ahash_request *lane[SHA_MB_LANES];
+	unsigned int active;
+
+	struct work_struct work;
+	struct delayed_work flush;
+};
+
+struct sha_mb_alg {
+	unsigned int words;
+	const u32 *iv;
+	sha_mb_x8_fn *x8;
+	struct sha_mb_cpu __percpu *cpu;
+	struct ahash_alg ahash;
+};
+
+static struct sha_mb_alg *sha_mb_alg(struct ahash_request *req)
+{
+	struct crypto_ahash *tfm = crypto_ahash_reqtfm(req);
+
+	return container_of(__crypto_ahash_alg(crypto_ahash_tfm(tfm)->__crt_alg),
+			    struct sha_mb_alg, ahash);
+}
+
+static void sha_mb_complete(struct ahash_request *req, int err)
+{
+	local_bh_disable();
+	req->base.complete(&req->base, err);
+	local_bh_enable();
+}
+
+static bool sha_mb_set_job(struct sha_mb_req_ctx *rctx, const u8 *data,
+			   unsigned int blocks)
+{
+	rctx->data = data;
+	rctx->blocks = blocks;
+	return true;
+}
+
+static void sha_mb_advance(struct sha_mb_req_ctx *rctx, unsigned int n)
+{
+	rctx->offset += n;
+	rctx->nbytes -= n;
+	rctx->count += n;
+}
+
+/*
+ * Find the next run of whole blocks to hash for a request.  Full blocks are
+ * hashed straight from the scatterlist, the rest goes through rctx->buf.
+ * x86_64 has no highmem, so sg_virt() is good for any page.
+ */
+static bool sha_mb_next_job(struct sha_mb_req_ctx *rctx)
+{
+	unsigned int partial, avail, n;
+	__be64 bits;
+	const u8 *p;
+
+	while (rctx->nbytes) {
+		if (rctx->offset == rctx->sg->length) {
+			rctx->sg = sg_next(rctx->sg);
+			rctx->offset = 0;
+			continue;
+		}
+
+		p = sg_virt(rctx->sg) + rctx->offset;
+		avail = min(rctx->sg->length - rctx->offset, rctx->nbytes);
+		partial = rctx->count % SHA_MB_BLOCK_SIZE;
+
+		if (partial || avail < SHA_MB_BLOCK_SIZE) {
+			n = min(SHA_MB_BLOCK_SIZE - partial, avail);
+			memcpy(rctx->buf + partial, p, n);
+			sha_mb_advance(rctx, n);
+			if (rctx->count % SHA_MB_BLOCK_SIZE == 0)
+				return sha_mb_set_job(rctx, rctx->buf, 1);
+			continue;
+		}
+
+		n = avail / SHA_MB_BLOCK_SIZE;
+		sha_mb_advance(rctx, n * SHA_MB_BLOCK_SIZE);
+		return sha_mb_set_job(rctx, p, n);
+	}
+
+	if (!rctx->final || rctx->padded)
+		return false;
+
+	partial = rctx->count % SHA_MB_BLOCK_SIZE;
+	bits = cpu_to_be64(rctx->count << 3);
+	rctx->buf[partial++] = 0x80;
+	n = partial > SHA_MB_BLOCK_SIZE - sizeof(bits) ? 2 : 1;
+	memset(rctx->buf + partial, 0,
+	       n * SHA_MB_BLOCK_SIZE - sizeof(bits) - partial);
+	memcpy(rctx->buf + n * SHA_MB_BLOCK_SIZE - sizeof(bits), &bits,
+	       sizeof(bits));
+	rctx->padded = true;
+
+	return sha_mb_set_job(rctx, rctx->buf, n);
+}
+
+static void sha_mb_finish(struct sha_mb_alg *alg, struct ahash_request *req)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	__be32 *dst = (__be32 *)rctx->result;
+	unsigned int i;
+
+	if (rctx->final) {
+		for (i = 0; i < alg->words; i++)
+			dst[i] = cpu_to_be32(rctx->digest[i]);
+	}
+
+	sha_mb_complete(req, 0);
+}
+
+/* Hash the lanes until at least one of them runs out of work. */
+static void sha_mb_run(struct sha_mb_cpu *cpu)
+{
+	struct sha_mb_alg *alg = cpu->alg;
+	struct sha_mb_args *args = &cpu->args;
+	struct sha_mb_req_ctx *rctx;
+	struct ahash_request *req;
+	unsigned int blocks = SHA_MB_MAX_BLKS;
+	const u8 *idle = NULL;
+	int l, i;
+
+	for (l = 0; l < SHA_MB_LANES; l++) {
+		if (!cpu->lane[l])
+			continue;
+		rctx = ahash_request_ctx(cpu->lane[l]);
+		blocks = min(blocks, rctx->blocks);
+		idle = rctx->data;
+	}
+
+	/* idle lanes hash someone else's data and the result is dropped */
+	for (l = 0; l < SHA_MB_LANES; l++) {
+		if (!cpu->lane[l])
+			args->data_ptr[l] = idle;
+	}
+
+	kernel_fpu_begin();
+	alg->x8(args, blocks);
+	kernel_fpu_end();
+
+	for (l = 0; l < SHA_MB_LANES; l++) {
+		req = cpu->lane[l];
+		if (!req)
+			continue;
+
+		rctx = ahash_request_ctx(req);
+		rctx->blocks -= blocks;
+		rctx->data = args->data_ptr[l];
+		if (rctx->blocks)
+			continue;
+
+		if (sha_mb_next_job(rctx)) {
+			args->data_ptr[l] = rctx->data;
+			continue;
+		}
+
+		for (i = 0; i < alg->words; i++)
+			rctx->digest[i] = args->digest[i][l];
+		cpu->lane[l] = NULL;
+		cpu->active--;
+		sha_mb_finish(alg, req);
+	}
+}
+
+static void sha_mb_submit(struct sha_mb_cpu *cpu, struct ahash_request *req)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	struct sha_mb_args *args = &cpu->args;
+	int l, i;
+
+	if (!sha_mb_next_job(rctx)) {
+		sha_mb_finish(cpu->alg, req);
+		return;
+	}
+
+	for (l = 0; cpu->lane[l]; l++)
+		;
+
+	for (i = 0; i < cpu->alg->words; i++)
+		args->digest[i][l] = rctx->digest[i];
+	args->data_ptr[l] = rctx->data;
+	cpu->lane[l] = req;
+
+	if (++cpu->active == SHA_MB_LANES)
+		sha_mb_run(cpu);
+}
+
+static void sha_mb_worker(struct work_struct *work)
+{
+	struct sha_mb_cpu *cpu = container_of(work, struct sha_mb_cpu, work);
+	struct crypto_async_request *req, *backlog;
+
+	mutex_lock(&cpu->mutex);
+
+	for (;;) {
+		spin_lock_bh(&cpu->lock);
+		backlog = crypto_get_backlog(&cpu->queue);
+		req = crypto_dequeue_request(&cpu->queue);
+		spin_unlock_bh(&cpu->lock);
+
+		if (!req)
+			break;
+
+		if (backlog) {
+			local_bh_disable();
+			backlog->complete(backlog, -EINPROGRESS);
+			local_bh_enable();
+		}
+
+		sha_mb_submit(cpu, ahash_request_cast(req));
+	}
+
+	/*
+	 * An already pending flush is left alone rather than pushed back, so
+	 * it happens SHA_MB_FLUSH_US after the lanes were first left partially
+	 * filled, not after the latest request.
+	 */
+	if (cpu->active)
+		queue_delayed_work_on(cpu->cpu_id, kcrypto_wq,
+				      &cpu->flush,
+				      usecs_to_jiffies(SHA_MB_FLUSH_US));
+
+	mutex_unlock(&cpu->mutex);
+}
+
+static void sha_mb_flusher(struct work_struct *work)
+{
+	struct sha_mb_cpu *cpu = container_of(to_delayed_work(work),
+					      struct sha_mb_cpu, flush);
+
+	mutex_lock(&cpu->mutex);
+	while (cpu->active)
+		sha_mb_run(cpu);
+	mutex_unlock(&cpu->mutex);
+}
+
+static int sha_mb_enqueue(struct ahash_request *req)
+{
+	struct sha_mb_alg *alg = sha_mb_alg(req);
+	struct sha_mb_cpu *cpu;
+	int cpu_id, err;
+
+	cpu_id = get_cpu();
+	cpu = per_cpu_ptr(alg->cpu, cpu_id);
+
+	spin_lock_bh(&cpu->lock);
+	err = crypto_enqueue_request(&cpu->queue, &req->base);
+	spin_unlock_bh(&cpu->lock);
+
+	queue_work_on(cpu_id, kcrypto_wq, &cpu->work);
+	put_cpu();
+
+	return err;
+}
+
+static void sha_mb_prepare(struct ahash_request *req, bool final)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+
+	rctx->sg = req->src;
+	rctx->offset = 0;
+	rctx->nbytes = req->nbytes;
+	rctx->final = final;
+	rctx->padded = false;
+	rctx->result = req->result;
+}
+
+static int sha_mb_init(struct ahash_request *req)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	struct sha_mb_alg *alg = sha_mb_alg(req);
+
+	memcpy(rctx->digest, alg->iv, alg->words * sizeof(u32));
+	rctx->count = 0;
+
+	return 0;
+}
+
+static int sha_mb_update(struct ahash_request *req)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	unsigned int partial = rctx->count % SHA_MB_BLOCK_SIZE;
+
+	/* nothing to hash yet, don't bother the worker */
+	if (partial + req->nbytes < SHA_MB_BLOCK_SIZE) {
+		scatterwalk_map_and_copy(rctx->buf + partial, req->src, 0,
+					 req->nbytes, 0);
+		rctx->count += req->nbytes;
+		return 0;
+	}
+
+	sha_mb_prepare(req, false);
+	return sha_mb_enqueue(req);
+}
+
+static int sha_mb_final(struct ahash_request *req)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+
+	sha_mb_prepare(req, true);
+	rctx->nbytes = 0;
+	return sha_mb_enqueue(req);
+}
+
+static int sha_mb_finup(struct ahash_request *req)
+{
+	sha_mb_prepare(req, true);
+	return sha_mb_enqueue(req);
+}
+
+static int sha_mb_digest(struct ahash_request *req)
+{
+	sha_mb_init(req);
+	return sha_mb_finup(req);
+}
+
+/*
+ * The exported state is struct sha1_state or struct sha256_state, so it can
+ * be imported into any other implementation of the same algorithm.
+ */
+static int sha1_mb_export(struct ahash_request *req, void *out)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	struct sha1_state *sctx = out;
+
+	sctx->count = rctx->count;
+	memcpy(sctx->state, rctx->digest, sizeof(sctx->state));
+	memcpy(sctx->buffer, rctx->buf, sizeof(sctx->buffer));
+
+	return 0;
+}
+
+static int sha1_mb_import(struct ahash_request *req, const void *in)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	const struct sha1_state *sctx = in;
+
+	rctx->count = sctx->count;
+	memcpy(rctx->digest, sctx->state, sizeof(sctx->state));
+	memcpy(rctx->buf, sctx->buffer, sizeof(sctx->buffer));
+
+	return 0;
+}
+
+static int sha256_mb_export(struct ahash_request *req, void *out)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	struct sha256_state *sctx = out;
+
+	sctx->count = rctx->count;
+	memcpy(sctx->state, rctx->digest, sizeof(sctx->state));
+	memcpy(sctx->buf, rctx->buf, sizeof(sctx->buf));
+
+	return 0;
+}
+
+static int sha256_mb_import(struct ahash_request *req, const void *in)
+{
+	struct sha_mb_req_ctx *rctx = ahash_request_ctx(req);
+	const struct sha256_state *sctx = in;
+
+	rctx->count = sctx->count;
+	memcpy(rctx->digest, sctx->state, sizeof(sctx->state));
+	memcpy(rctx->buf, sctx->buf, sizeof(sctx->buf));
+
+	return 0;
+}
+
+static int sha_mb_cra_init(struct crypto_tfm *tfm)
+{
+	crypto_ahash_set_reqsize(__crypto_ahash_cast(tfm),
+				 sizeof(struct sha_mb_req_ctx));
+	return 0;
+}
+
+static const u32 sha1_mb_iv[SHA1_DIGEST_SIZE / 4] = {
+	SHA1_H0, SHA1_H1, SHA1_H2, SHA1_H3, SHA1_H4,
+};
+
+static const u32 sha256_mb_iv[SHA256_DIGEST_SIZE / 4] = {
+	SHA256_H0, SHA256_H1, SHA256_H2, SHA256_H3,
+	SHA256_H4, SHA256_H5, SHA256_H6, SHA256_H7,
+};
+
+/*
+ * The priority is below the single-buffer implementations: multi-buffer
+ * hashing only pays off for callers that keep many requests in flight, and
+ * costs a lone synchronous user up to SHA_MB_FLUSH_US per request.  Such
+ * callers ask for the driver by name.
+ */
+static struct sha_mb_alg sha_mb_algs[] = { {
+	.words		= SHA1_DIGEST_SIZE / 4,
+	.iv		= sha1_mb_iv,
+	.x8		= sha1_x8_avx2,
+	.ahash = {
+		.init		= sha_mb_init,
+		.update		= sha_mb_update,
+		.final		= sha_mb_final,
+		.finup		= sha_mb_finup,
+		.digest		= sha_mb_digest,
+		.export		= sha1_mb_export,
+		.import		= sha1_mb_import,
+		.halg = {
+			.digestsize	= SHA1_DIGEST_SIZE,
+			.statesize	= sizeof(struct sha1_state),
+			.base = {
+				.cra_name	 = "sha1",
+				.cra_driver_name = "sha1-mb",
+				.cra_priority	 = 50,
+				.cra_flags	 = CRYPTO_ALG_TYPE_AHASH |
+						   CRYPTO_ALG_ASYNC,
+				.cra_blocksize	 = SHA1_BLOCK_SIZE,
+				.cra_init	 = sha_mb_cra_init,
+				.cra_module	 = THIS_MODULE,
+			}
+		}
+	}
+}, {
+	.words		= SHA256_DIGEST_SIZE / 4,
+	.iv		= sha256_mb_iv,
+	.x8		= sha256_x8_avx2,
+	.ahash = {
+		.init		= sha_mb_init,
+		.update		= sha_mb_update,
+		.final		= sha_mb_final,
+		.finup		= sha_mb_finup,
+		.digest		= sha_mb_digest,
+		.export		= sha256_mb_export,
+		.import		= sha256_mb_import,
+		.halg = {
+			.digestsize	= SHA256_DIGEST_SIZE,
+			.statesize	= sizeof(struct sha256_state),
+			.base = {
+				.cra_name	 = "sha256",
+				.cra_driver_name = "sha256-mb",
+				.cra_priority	 = 50,
+				.cra_flags	 = CRYPTO_ALG_TYPE_AHASH |
+						   CRYPTO_ALG_ASYNC,
+				.cra_blocksize	 = SHA256_BLOCK_SIZE,
+				.cra_init	 = sha_mb_cra_init,
+				.cra_module	 = THIS_MODULE,
+			}
+		}
+	}
+} };
+
+static bool __init sha_mb_usable(void)
+{
+	u64 xcr0;
+
+	if (!cpu_has_avx || !cpu_has_osxsave ||
+	    !boot_cpu_has(X86_FEATURE_AVX2))
+		return false;
+
+	xcr0 = xgetbv(XCR_XFEATURE_ENABLED_MASK);
+	if ((xcr0 & (XSTATE_SSE | XSTATE_YMM)) != (XSTATE_SSE | XSTATE_YMM)) {
+		pr_info("AVX2 detected but unusable.\n");
+		return false;
+	}
+
+	return true;
+}
+
+static void sha_mb_free_alg(struct sha_mb_alg *alg)
+{
+	struct sha_mb_cpu *cpu;
+	int i;
+
+	for_each_possible_cpu(i) {
+		cpu = per_cpu_ptr(alg->cpu, i);
+		cancel_work_sync(&cpu->work);
+		flush_delayed_work(&cpu->flush);
+	}
+	free_percpu(alg->cpu);
+}
+
+static int __init sha_mb_init_alg(struct sha_mb_alg *alg)
+{
+	struct sha_mb_cpu *cpu;
+	int i, err;
+
+	alg->cpu = alloc_percpu(struct sha_mb_cpu);
+	if (!alg->cpu)
+		return -ENOMEM;
+
+	for_each_possible_cpu(i) {
+		cpu = per_cpu_ptr(alg->cpu, i);
+		cpu->alg = alg;
+		cpu->cpu_id = i;
+		spin_lock_init(&cpu->lock);
+		crypto_init_queue(&cpu->queue, SHA_MB_QUEUE_LEN);
+		mutex_init(&cpu->mutex);
+		INIT_WORK(&cpu->work, sha_mb_worker);
+		INIT_DELAYED_WORK(&cpu->flush, sha_mb_flusher);
+	}
+
+	err = crypto_register_ahash(&alg->ahash);
+	if (err)
+		free_percpu(alg->cpu);
+
+	return err;
+}
+
+static int __init sha_mb_mod_init(void)
+{
+	int i, err;
+
+	if (!sha_mb_usable()) {
+		pr_info("AVX2 not available.\n");
+		return -ENODEV;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sha_mb_algs); i++) {
+		err = sha_mb_init_alg(&sha_mb_algs[i]);
+		if (err)
+			goto err_unregister;
+	}
+
+	return 0;
+
+err_unregister:
+	while (--i >= 0) {
+		crypto_unregister_ahash(&sha_mb_algs[i].ahash);
+		sha_mb_free_alg(&sha_mb_algs[i]);
+	}
+	return err;
+}
+
+static void __exit sha_mb_mod_fini(void)
+{
+	int i;
+
+	for (i = ARRAY_SIZE(sha_mb_algs) - 1; i >= 0; i--) {
+		crypto_unregister_ahash(&sha_mb_algs[i].ahash);
+		sha_mb_free_alg(&sha_mb_algs[i]);
+	}
+}
+
+module_init(sha_mb_mod_init);
+module_exit(sha_mb_mod_fini);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("SHA1 and SHA256 Secure Hash Algorithms, multi-buffer AVX2 accelerated");
+
+MODULE_ALIAS("sha1");
+MODULE_ALIAS("sha256");
@@ -90,6 +90,43 @@ static int no_givcrypt(struct aead_givcrypt_request *req)
 	return -ENOSYS;
 }
 
+static void aead_encrypt_batch(struct aead_request **reqs, unsigned int nreq)
+{
+	unsigned int i;
+	int err;
+
+	for (i = 0; i < nreq; i++) {
+		err = crypto_aead_encrypt(reqs[i]);
+		if (!aead_request_pending(reqs[i], err))
+			aead_request_complete(reqs[i], err);
+	}
+}
+
+static void aead_decrypt_batch(struct aead_request **reqs, unsigned int nreq)
+{
+	unsigned int i;
+	int err;
+
+	for (i = 0; i < nreq; i++) {
+		err = crypto_aead_decrypt(reqs[i]);
+		if (!aead_request_pending(reqs[i], err))
+			aead_request_complete(reqs[i], err);
+	}
+}
+
+static void aead_givencrypt_batch(struct aead_givcrypt_request **reqs,
+				  unsigned int nreq)
+{
+	unsigned int i;
+	int err;
+
+	for (i = 0; i < nreq; i++) {
+		err = crypto_aead_givencrypt(reqs[i]);
+		if (!aead_request_pending(&reqs[i]->areq, err))
+			aead_givcrypt_complete(reqs[i], err);
+	}
+}
+
 static int crypto_init_aead_ops(struct crypto_tfm *tfm, u32 type, u32 mask)
 {
 	struct aead_alg *alg = &tfm->__crt_alg->cra_aead;
@@ -104,6 +141,9 @@ static int crypto_init_aead_ops(struct crypto_tfm *tfm, u32 type, u32 mask)
 	crt->decrypt = alg->decrypt;
 	crt->givencrypt = alg->givencrypt ?: no_givcrypt;
 	crt->givdecrypt = alg->givdecrypt ?: no_givcrypt;
+	crt->encrypt_batch = alg->encrypt_batch ?: aead_encrypt_batch;
+	crt->decrypt_batch = alg->decrypt_batch ?: aead_decrypt_batch;
+	crt->givencrypt_batch = alg->givencrypt_batch ?: aead_givencrypt_batch;
 	crt->base = __crypto_aead_cast(tfm);
 	crt->ivsize = alg->ivsize;
 	crt->authsize = alg->maxauthsize;
@@ -185,9 +225,12 @@ static int crypto_init_nivaead_ops(struct crypto_tfm *tfm, u32 type, u32 mask)
 	crt->setkey = setkey;
 	crt->encrypt = alg->encrypt;
 	crt->decrypt = alg->decrypt;
+	crt->encrypt_batch = alg->encrypt_batch ?: aead_encrypt_batch;
+	crt->decrypt_batch = alg->decrypt_batch ?: aead_decrypt_batch;
 	if (!alg->ivsize) {
 		crt->givencrypt = aead_null_givencrypt;
 		crt->givdecrypt = aead_null_givdecrypt;
+		crt->givencrypt_batch = aead_givencrypt_batch;
 	}
 	crt->base = __crypto_aead_cast(tfm);
 	crt->ivsize = alg->ivsize;
@@ -351,6 +394,8 @@ struct crypto_instance *aead_geniv_alloc(struct crypto_template *tmpl,
 	inst->alg.cra_aead.setauthsize = alg->cra_aead.setauthsize;
 	inst->alg.cra_aead.encrypt = alg->cra_aead.encrypt;
 	inst->alg.cra_aead.decrypt = alg->cra_aead.decrypt;
+	inst->alg.cra_aead.encrypt_batch = alg->cra_aead.encrypt_batch;
+	inst->alg.cra_aead.decrypt_batch = alg->cra_aead.decrypt_batch;
 
 out:
 	return inst;
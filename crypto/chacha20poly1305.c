@@ -0,0 +1,492 @@
+/*
+ * ChaCha20-Poly1305 AEAD, RFC7539
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <crypto/internal/aead.h>
+#include <crypto/internal/hash.h>
+#include <crypto/internal/skcipher.h>
+#include <crypto/scatterwalk.h>
+#include <crypto/chacha20.h>
+#include <crypto/poly1305.h>
+#include <linux/err.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+
+#include "internal.h"
+
+#define CHACHAPOLY_IV_SIZE	12
+
+struct chachapoly_instance_ctx {
+	struct crypto_skcipher_spawn chacha;
+	struct crypto_shash_spawn poly;
+	unsigned int saltlen;
+};
+
+struct chachapoly_ctx {
+	struct crypto_ablkcipher *chacha;
+	struct crypto_shash *poly;
+	/* key bytes we use for the ChaCha20 IV */
+	unsigned int saltlen;
+	u8 salt[];
+};
+
+struct chachapoly_req_ctx {
+	/* the key we generate for Poly1305 using Chacha20 */
+	u8 key[POLY1305_KEY_SIZE];
+	/* calculated Poly1305 tag */
+	u8 tag[POLY1305_DIGEST_SIZE];
+	/* tag read from the source on decryption */
+	u8 otag[POLY1305_DIGEST_SIZE];
+	/* full ChaCha20 IV: le32 block counter followed by the nonce */
+	u8 iv[CHACHA20_IV_SIZE];
+	/* little endian AD and ciphertext length for the Poly1305 tail */
+	__le64 lens[2];
+	struct scatterlist sg[1];
+	union {
+		struct ablkcipher_request ablkreq;
+		struct shash_desc desc;
+	} u;
+};
+
+static inline struct chachapoly_req_ctx *chachapoly_reqctx(
+	struct aead_request *req)
+{
+	unsigned long align = crypto_aead_alignmask(crypto_aead_reqtfm(req));
+
+	return (void *)PTR_ALIGN((u8 *)aead_request_ctx(req), align + 1);
+}
+
+static void chachapoly_iv(struct aead_request *req, u32 icb)
+{
+	struct chachapoly_ctx *ctx = crypto_aead_ctx(crypto_aead_reqtfm(req));
+	struct chachapoly_req_ctx *rctx = chachapoly_reqctx(req);
+	__le32 leicb = cpu_to_le32(icb);
+
+	memcpy(rctx->iv, &leicb, sizeof(leicb));
+	memcpy(rctx->iv + sizeof(leicb), ctx->salt, ctx->saltlen);
+	memcpy(rctx->iv + sizeof(leicb) + ctx->saltlen, req->iv,
+	       CHACHA20_IV_SIZE - sizeof(leicb) - ctx->saltlen);
+}
+
+static int chachapoly_crypt(struct aead_request *req, struct scatterlist *dst,
+			    struct scatterlist *src, unsigned int len, u32 icb)
+{
+	struct chachapoly_ctx *ctx = crypto_aead_ctx(crypto_aead_reqtfm(req));
+	struct chachapoly_req_ctx *rctx = chachapoly_reqctx(req);
+	struct ablkcipher_request *ablkreq = &rctx->u.ablkreq;
+
+	chachapoly_iv(req, icb);
+
+	ablkcipher_request_set_tfm(ablkreq, ctx->chacha);
+	ablkcipher_request_set_callback(ablkreq, req->base.flags &
+					CRYPTO_TFM_REQ_MAY_SLEEP, NULL, NULL);
+	ablkcipher_request_set_crypt(ablkreq, src, dst, len, rctx->iv);
+
+	return crypto_ablkcipher_encrypt(ablkreq);
+}
+
+static int chachapoly_hash_sg(struct shash_desc *desc, struct scatterlist *sg,
+			      unsigned int len)
+{
+	struct scatter_walk walk;
+	u8 *data_src;
+	unsigned int n;
+	int err = 0;
+
+	if (!len)
+		return 0;
+
+	scatterwalk_start(&walk, sg);
+
+	while (len) {
+		n = scatterwalk_clamp(&walk, len);
+		if (!n) {
+			scatterwalk_start(&walk, sg_next(walk.sg));
+			n = scatterwalk_clamp(&walk, len);
+		}
+		data_src = scatterwalk_map(&walk);
+
+		err = crypto_shash_update(desc, data_src, n);
+		len -= n;
+
+		scatterwalk_unmap(data_src);
+		scatterwalk_advance(&walk, n);
+		scatterwalk_done(&walk, 0, len);
+		if (err)
+			break;
+	}
+
+	return err;
+}
+
+static int chachapoly_hash_pad(struct shash_desc *desc, unsigned int len)
+{
+	static const u8 zeroes[POLY1305_BLOCK_SIZE];
+	unsigned int padlen = -len % POLY1305_BLOCK_SIZE;
+
+	if (!padlen)
+		return 0;
+	return crypto_shash_update(desc, zeroes, padlen);
+}
+
+/*
+ * Calculate the Poly1305 tag over the associated data and the ciphertext
+ * in @crypt, keyed with the one-time key generated by chachapoly_genkey().
+ */
+static int chachapoly_hash(struct aead_request *req, struct scatterlist *crypt,
+			   unsigned int cryptlen)
+{
+	struct chachapoly_ctx *ctx = crypto_aead_ctx(crypto_aead_reqtfm(req));
+	struct chachapoly_req_ctx *rctx = chachapoly_reqctx(req);
+	struct shash_desc *desc = &rctx->u.desc;
+	int err;
+
+	desc->tfm = ctx->poly;
+	desc->flags = req->base.flags & CRYPTO_TFM_REQ_MAY_SLEEP;
+
+	err = crypto_shash_init(desc);
+	if (err)
+		return err;
+
+	/* the generic Poly1305 takes its key as the first 32 bytes of data */
+	err = crypto_shash_update(desc, rctx->key, sizeof(rctx->key));
+	if (err)
+		return err;
+
+	err = chachapoly_hash_sg(desc, req->assoc, req->assoclen);
+	if (err)
+		return err;
+	err = chachapoly_hash_pad(desc, req->assoclen);
+	if (err)
+		return err;
+
+	err = chachapoly_hash_sg(desc, crypt, cryptlen);
+	if (err)
+		return err;
+	err = chachapoly_hash_pad(desc, cryptlen);
+	if (err)
+		return err;
+
+	rctx->lens[0] = cpu_to_le64(req->assoclen);
+	rctx->lens[1] = cpu_to_le64(cryptlen);
+	err = crypto_shash_update(desc, (u8 *)rctx->lens, sizeof(rctx->lens));
+	if (err)
+		return err;
+
+	return crypto_shash_final(desc, rctx->tag);
+}
+
+/* The Poly1305 key is the first half of the ChaCha20 block with counter 0 */
+static int chachapoly_genkey(struct aead_request *req)
+{
+	struct chachapoly_req_ctx *rctx = chachapoly_reqctx(req);
+
+	memset(rctx->key, 0, sizeof(rctx->key));
+	sg_init_one(rctx->sg, rctx->key, sizeof(rctx->key));
+
+	return chachapoly_crypt(req, rctx->sg, rctx->sg, sizeof(rctx->key), 0);
+}
+
+static int chachapoly_encrypt(struct aead_request *req)
+{
+	struct chachapoly_req_ctx *rctx = chachapoly_reqctx(req);
+	int err;
+
+	err = chachapoly_genkey(req);
+	if (err)
+		return err;
+
+	err = chachapoly_crypt(req, req->dst, req->src, req->cryptlen, 1);
+	if (err)
+		return err;
+
+	err = chachapoly_hash(req, req->dst, req->cryptlen);
+	if (err)
+		return err;
+
+	scatterwalk_map_and_copy(rctx->tag, req->dst, req->cryptlen,
+				 sizeof(rctx->tag), 1);
+	return 0;
+}
+
+static int chachapoly_decrypt(struct aead_request *req)
+{
+	struct chachapoly_req_ctx *rctx = chachapoly_reqctx(req);
+	unsigned int cryptlen = req->cryptlen;
+	int err;
+
+	if (cryptlen < POLY1305_DIGEST_SIZE)
+		return -EINVAL;
+	cryptlen -= POLY1305_DIGEST_SIZE;
+
+	err = chachapoly_genkey(req);
+	if (err)
+		return err;
+
+	/* authenticate the ciphertext before decrypting anything */
+	err = chachapoly_hash(req, req->src, cryptlen);
+	if (err)
+		return err;
+
+	scatterwalk_map_and_copy(rctx->otag, req->src, cryptlen,
+				 sizeof(rctx->otag), 0);
+	if (crypto_memneq(rctx->tag, rctx->otag, sizeof(rctx->tag)))
+		return -EBADMSG;
+
+	return chachapoly_crypt(req, req->dst, req->src, cryptlen, 1);
+}
+
+static int chachapoly_setkey(struct crypto_aead *aead, const u8 *key,
+			     unsigned int keylen)
+{
+	struct chachapoly_ctx *ctx = crypto_aead_ctx(aead);
+	int err;
+
+	if (keylen != ctx->saltlen + CHACHA20_KEY_SIZE)
+		return -EINVAL;
+
+	keylen -= ctx->saltlen;
+	memcpy(ctx->salt, key + keylen, ctx->saltlen);
+
+	crypto_ablkcipher_clear_flags(ctx->chacha, CRYPTO_TFM_REQ_MASK);
+	crypto_ablkcipher_set_flags(ctx->chacha, crypto_aead_get_flags(aead) &
+						 CRYPTO_TFM_REQ_MASK);
+
+	err = crypto_ablkcipher_setkey(ctx->chacha, key, keylen);
+	crypto_aead_set_flags(aead, crypto_ablkcipher_get_flags(ctx->chacha) &
+				    CRYPTO_TFM_RES_MASK);
+	return err;
+}
+
+static int chachapoly_setauthsize(struct crypto_aead *tfm,
+				  unsigned int authsize)
+{
+	if (authsize != POLY1305_DIGEST_SIZE)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int chachapoly_init(struct crypto_tfm *tfm)
+{
+	struct crypto_instance *inst = (void *)tfm->__crt_alg;
+	struct chachapoly_instance_ctx *ictx = crypto_instance_ctx(inst);
+	struct chachapoly_ctx *ctx = crypto_tfm_ctx(tfm);
+	struct crypto_ablkcipher *chacha;
+	struct crypto_shash *poly;
+	unsigned long align;
+
+	poly = crypto_spawn_shash(&ictx->poly);
+	if (IS_ERR(poly))
+		return PTR_ERR(poly);
+
+	chacha = crypto_spawn_skcipher(&ictx->chacha);
+	if (IS_ERR(chacha)) {
+		crypto_free_shash(poly);
+		return PTR_ERR(chacha);
+	}
+
+	ctx->chacha = chacha;
+	ctx->poly = poly;
+	ctx->saltlen = ictx->saltlen;
+
+	align = crypto_tfm_alg_alignmask(tfm);
+	align &= ~(crypto_tfm_ctx_alignment() - 1);
+	tfm->crt_aead.reqsize = align +
+		offsetof(struct chachapoly_req_ctx, u) +
+		max(offsetof(struct ablkcipher_request, __ctx) +
+		    crypto_ablkcipher_reqsize(chacha),
+		    offsetof(struct shash_desc, __ctx) +
+		    crypto_shash_descsize(poly));
+
+	return 0;
+}
+
+static void chachapoly_exit(struct crypto_tfm *tfm)
+{
+	struct chachapoly_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	crypto_free_ablkcipher(ctx->chacha);
+	crypto_free_shash(ctx->poly);
+}
+
+static struct crypto_instance *chachapoly_alloc(struct rtattr **tb,
+						const char *name,
+						unsigned int ivsize)
+{
+	struct crypto_attr_type *algt;
+	struct crypto_instance *inst;
+	struct crypto_alg *chacha;
+	struct crypto_alg *poly;
+	struct shash_alg *poly_shash;
+	struct chachapoly_instance_ctx *ctx;
+	const char *chacha_name;
+	int err;
+
+	if (ivsize > CHACHAPOLY_IV_SIZE)
+		return ERR_PTR(-EINVAL);
+
+	algt = crypto_get_attr_type(tb);
+	if (IS_ERR(algt))
+		return ERR_CAST(algt);
+
+	if ((algt->type ^ CRYPTO_ALG_TYPE_AEAD) & algt->mask)
+		return ERR_PTR(-EINVAL);
+
+	chacha_name = crypto_attr_alg_name(tb[1]);
+	if (IS_ERR(chacha_name))
+		return ERR_CAST(chacha_name);
+
+	poly_shash = shash_attr_alg(tb[2], 0, 0);
+	if (IS_ERR(poly_shash))
+		return ERR_CAST(poly_shash);
+	poly = &poly_shash->base;
+
+	err = -EINVAL;
+	if (poly_shash->digestsize != POLY1305_DIGEST_SIZE)
+		goto out_put_poly;
+
+	inst = kzalloc(sizeof(*inst) + sizeof(*ctx), GFP_KERNEL);
+	err = -ENOMEM;
+	if (!inst)
+		goto out_put_poly;
+
+	ctx = crypto_instance_ctx(inst);
+	ctx->saltlen = CHACHAPOLY_IV_SIZE - ivsize;
+	err = crypto_init_shash_spawn(&ctx->poly, poly_shash, inst);
+	if (err)
+		goto err_free_inst;
+
+	/*
+	 * The ChaCha20 step is issued synchronously, twice per request, in
+	 * between the Poly1305 updates, so only take synchronous ciphers.
+	 */
+	crypto_set_skcipher_spawn(&ctx->chacha, inst);
+	err = crypto_grab_skcipher(&ctx->chacha, chacha_name, 0,
+				   CRYPTO_ALG_ASYNC);
+	if (err)
+		goto err_drop_poly;
+
+	chacha = crypto_skcipher_spawn_alg(&ctx->chacha);
+
+	err = -EINVAL;
+	/* Need 16-byte IV size, including Initial Block Counter value */
+	if (chacha->cra_ablkcipher.ivsize != CHACHA20_IV_SIZE)
+		goto out_drop_chacha;
+	/* Not a stream cipher? */
+	if (chacha->cra_blocksize != 1)
+		goto out_drop_chacha;
+
+	err = -ENAMETOOLONG;
+	if (snprintf(inst->alg.cra_name, CRYPTO_MAX_ALG_NAME,
+		     "%s(%s,%s)", name, chacha->cra_name,
+		     poly->cra_name) >= CRYPTO_MAX_ALG_NAME)
+		goto out_drop_chacha;
+	if (snprintf(inst->alg.cra_driver_name, CRYPTO_MAX_ALG_NAME,
+		     "%s(%s,%s)", name, chacha->cra_driver_name,
+		     poly->cra_driver_name) >= CRYPTO_MAX_ALG_NAME)
+		goto out_drop_chacha;
+
+	inst->alg.cra_flags = CRYPTO_ALG_TYPE_AEAD;
+	inst->alg.cra_priority = (chacha->cra_priority +
+				  poly->cra_priority) / 2;
+	inst->alg.cra_blocksize = 1;
+	inst->alg.cra_alignmask = chacha->cra_alignmask | poly->cra_alignmask |
+				  (__alignof__(u32) - 1);
+	inst->alg.cra_type = ctx->saltlen ? &crypto_nivaead_type :
+					    &crypto_aead_type;
+	inst->alg.cra_aead.ivsize = ivsize;
+	inst->alg.cra_aead.maxauthsize = POLY1305_DIGEST_SIZE;
+	inst->alg.cra_ctxsize = sizeof(struct chachapoly_ctx) + ctx->saltlen;
+	inst->alg.cra_init = chachapoly_init;
+	inst->alg.cra_exit = chachapoly_exit;
+	inst->alg.cra_aead.setkey = chachapoly_setkey;
+	inst->alg.cra_aead.setauthsize = chachapoly_setauthsize;
+	inst->alg.cra_aead.encrypt = chachapoly_encrypt;
+	inst->alg.cra_aead.decrypt = chachapoly_decrypt;
+	if (ctx->saltlen)
+		inst->alg.cra_aead.geniv = "seqiv";
+
+out:
+	crypto_mod_put(poly);
+	return inst;
+
+out_drop_chacha:
+	crypto_drop_skcipher(&ctx->chacha);
+err_drop_poly:
+	crypto_drop_shash(&ctx->poly);
+err_free_inst:
+	kfree(inst);
+out_put_poly:
+	inst = ERR_PTR(err);
+	goto out;
+}
+
+static struct crypto_instance *rfc7539_alloc(struct rtattr **tb)
+{
+	return chachapoly_alloc(tb, "rfc7539", 12);
+}
+
+static struct crypto_instance *rfc7539esp_alloc(struct rtattr **tb)
+{
+	return chachapoly_alloc(tb, "rfc7539esp", 8);
+}
+
+static void chachapoly_free(struct crypto_instance *inst)
+{
+	struct chachapoly_instance_ctx *ctx = crypto_instance_ctx(inst);
+
+	crypto_drop_skcipher(&ctx->chacha);
+	crypto_drop_shash(&ctx->poly);
+	kfree(inst);
+}
+
+static struct crypto_template rfc7539_tmpl = {
+	.name = "rfc7539",
+	.alloc = rfc7539_alloc,
+	.free = chachapoly_free,
+	.module = THIS_MODULE,
+};
+
+static struct crypto_template rfc7539esp_tmpl = {
+	.name = "rfc7539esp",
+	.alloc = rfc7539esp_alloc,
+	.free = chachapoly_free,
+	.module = THIS_MODULE,
+};
+
+static int __init chacha20poly1305_module_init(void)
+{
+	int err;
+
+	err = crypto_register_template(&rfc7539_tmpl);
+	if (err)
+		return err;
+
+	err = crypto_register_template(&rfc7539esp_tmpl);
+	if (err)
+		crypto_unregister_template(&rfc7539_tmpl);
+
+	return err;
+}
+
+static void __exit chacha20poly1305_module_exit(void)
+{
+	crypto_unregister_template(&rfc7539esp_tmpl);
+	crypto_unregister_template(&rfc7539_tmpl);
+}
+
+module_init(chacha20poly1305_module_init);
+module_exit(chacha20poly1305_module_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("ChaCha20-Poly1305 AEAD");
+MODULE_ALIAS("rfc7539");
+MODULE_ALIAS("rfc7539esp");
@@ -140,7 +140,12 @@ static int seqiv_givencrypt(struct skcipher_givcrypt_request *req)
 	return err;
 }
 
-static int seqiv_aead_givencrypt(struct aead_givcrypt_request *req)
+/*
+ * Set up the subrequest of @req on the underlying AEAD and generate the IV.
+ * If the IV buffer of @req is misaligned, a bounce buffer is allocated and
+ * the subrequest completes through seqiv_aead_complete().
+ */
+static int seqiv_aead_prepare(struct aead_givcrypt_request *req)
 {
 	struct crypto_aead *geniv = aead_givcrypt_reqtfm(req);
 	struct seqiv_ctx *ctx = crypto_aead_ctx(geniv);
@@ -150,7 +155,6 @@ static int seqiv_aead_givencrypt(struct aead_givcrypt_request *req)
 	void *data;
 	u8 *info;
 	unsigned int ivsize;
-	int err;
 
 	aead_request_set_tfm(subreq, aead_geniv_base(geniv));
 
@@ -180,8 +184,20 @@ static int seqiv_aead_givencrypt(struct aead_givcrypt_request *req)
 	seqiv_geniv(ctx, info, req->seq, ivsize);
 	memcpy(req->giv, info, ivsize);
 
+	return 0;
+}
+
+static int seqiv_aead_givencrypt(struct aead_givcrypt_request *req)
+{
+	struct aead_request *subreq = aead_givcrypt_reqctx(req);
+	int err;
+
+	err = seqiv_aead_prepare(req);
+	if (err)
+		return err;
+
 	err = crypto_aead_encrypt(subreq);
-	if (unlikely(info != areq->iv))
+	if (unlikely(subreq->iv != req->areq.iv))
 		seqiv_aead_complete2(req, err);
 	return err;
 }
@@ -209,9 +225,8 @@ unlock:
 	return seqiv_givencrypt(req);
 }
 
-static int seqiv_aead_givencrypt_first(struct aead_givcrypt_request *req)
+static int seqiv_aead_setup_salt(struct crypto_aead *geniv)
 {
-	struct crypto_aead *geniv = aead_givcrypt_reqtfm(req);
 	struct seqiv_ctx *ctx = crypto_aead_ctx(geniv);
 	int err = 0;
 
@@ -226,12 +241,63 @@ static int seqiv_aead_givencrypt_first(struct aead_givcrypt_request *req)
 unlock:
 	spin_unlock_bh(&ctx->lock);
 
+	return err;
+}
+
+static int seqiv_aead_givencrypt_first(struct aead_givcrypt_request *req)
+{
+	int err;
+
+	err = seqiv_aead_setup_salt(aead_givcrypt_reqtfm(req));
 	if (err)
 		return err;
 
 	return seqiv_aead_givencrypt(req);
 }
 
+/*
+ * Generate the IVs for the whole batch and pass the subrequests on to the
+ * underlying AEAD as one batch, in chunks of SEQIV_BATCH.  Completions of
+ * the subrequests go straight to the caller's completion functions, except
+ * for bounced IVs which go through seqiv_aead_complete().
+ */
+#define SEQIV_BATCH	16
+
+static void seqiv_aead_givencrypt_batch(struct aead_givcrypt_request **reqs,
+					unsigned int nreq)
+{
+	struct crypto_aead *geniv = aead_givcrypt_reqtfm(reqs[0]);
+	struct aead_request *subreqs[SEQIV_BATCH];
+	unsigned int i, n;
+	int err;
+
+	if (unlikely(crypto_aead_crt(geniv)->givencrypt ==
+		     seqiv_aead_givencrypt_first)) {
+		err = seqiv_aead_setup_salt(geniv);
+		if (err) {
+			for (i = 0; i < nreq; i++)
+				aead_givcrypt_complete(reqs[i], err);
+			return;
+		}
+	}
+
+	for (i = 0, n = 0; i < nreq; i++) {
+		err = seqiv_aead_prepare(reqs[i]);
+		if (err) {
+			aead_givcrypt_complete(reqs[i], err);
+			continue;
+		}
+
+		subreqs[n++] = aead_givcrypt_reqctx(reqs[i]);
+		if (n == SEQIV_BATCH) {
+			crypto_aead_encrypt_batch(subreqs, n);
+			n = 0;
+		}
+	}
+
+	crypto_aead_encrypt_batch(subreqs, n);
+}
+
 static int seqiv_init(struct crypto_tfm *tfm)
 {
 	struct crypto_ablkcipher *geniv = __crypto_ablkcipher_cast(tfm);
@@ -288,6 +354,7 @@ static struct crypto_instance *seqiv_aead_alloc(struct rtattr **tb)
 		goto out;
 
 	inst->alg.cra_aead.givencrypt = seqiv_aead_givencrypt_first;
+	inst->alg.cra_aead.givencrypt_batch = seqiv_aead_givencrypt_batch;
 
 	inst->alg.cra_init = seqiv_aead_init;
 	inst->alg.cra_exit = aead_geniv_exit;
@@ -22,17 +22,23 @@
  *
  */
 
+#include <crypto/compress.h>
 #include <crypto/hash.h>
+#include <linux/cpu.h>
 #include <linux/err.h>
 #include <linux/init.h>
 #include <linux/gfp.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
+#include <linux/random.h>
 #include <linux/scatterlist.h>
 #include <linux/string.h>
 #include <linux/moduleparam.h>
 #include <linux/jiffies.h>
 #include <linux/timex.h>
 #include <linux/interrupt.h>
+#include <linux/vmalloc.h>
 #include "tcrypt.h"
 #include "internal.h"
 
@@ -926,6 +932,656 @@ out:
 	crypto_free_ablkcipher(tfm);
 }
 
+/*
+ * Packet rate of AEAD requests submitted through crypto_aead_encrypt_batch(),
+ * one request per call versus TCRYPT_AEAD_BATCH requests per call.
+ */
+#define TCRYPT_AEAD_BATCH	16
+
+static u32 aead_packet_sizes[] = { 64, 128, 256, 512, 1024, 1420, 1500, 0 };
+
+struct tcrypt_batch_result {
+	struct completion completion;
+	atomic_t pending;
+	int err;
+};
+
+static void tcrypt_batch_complete(struct crypto_async_request *req, int err)
+{
+	struct tcrypt_batch_result *res = req->data;
+
+	if (err == -EINPROGRESS)
+		return;
+
+	if (err)
+		res->err = err;
+	if (atomic_dec_and_test(&res->pending))
+		complete(&res->completion);
+}
+
+static int do_aead_batch_op(struct aead_request **reqs, unsigned int nreq,
+			    struct tcrypt_batch_result *res)
+{
+	int ret;
+
+	atomic_set(&res->pending, nreq);
+	res->err = 0;
+
+	crypto_aead_encrypt_batch(reqs, nreq);
+
+	ret = wait_for_completion_interruptible(&res->completion);
+	if (!ret)
+		ret = res->err;
+	reinit_completion(&res->completion);
+
+	return ret;
+}
+
+static int test_aead_batch_jiffies(struct aead_request **reqs,
+				   unsigned int nreq,
+				   struct tcrypt_batch_result *res,
+				   int blen, int sec)
+{
+	unsigned long start, end;
+	unsigned int bcount;
+	int ret;
+
+	for (start = jiffies, end = start + sec * HZ, bcount = 0;
+	     time_before(jiffies, end); bcount += nreq) {
+		ret = do_aead_batch_op(reqs, nreq, res);
+		if (ret)
+			return ret;
+	}
+
+	pr_cont("%8u opers/sec, %10lu bytes/sec\n",
+		bcount / sec, ((long)bcount * blen) / sec);
+	return 0;
+}
+
+static int test_aead_batch_cycles(struct aead_request **reqs,
+				  unsigned int nreq,
+				  struct tcrypt_batch_result *res, int blen)
+{
+	unsigned long cycles = 0;
+	int ret = 0;
+	int i;
+
+	/* Warm-up run. */
+	for (i = 0; i < 4; i++) {
+		ret = do_aead_batch_op(reqs, nreq, res);
+		if (ret)
+			goto out;
+	}
+
+	/* The real thing. */
+	for (i = 0; i < 8; i++) {
+		cycles_t start, end;
+
+		start = get_cycles();
+		ret = do_aead_batch_op(reqs, nreq, res);
+		end = get_cycles();
+
+		if (ret)
+			goto out;
+
+		cycles += end - start;
+	}
+
+out:
+	if (ret == 0)
+		pr_cont("1 operation in %lu cycles (%d bytes)\n",
+			(cycles + 4 * nreq) / (8 * nreq), blen);
+
+	return ret;
+}
+
+static void test_aead_batch_speed(const char *algo, unsigned int sec,
+				  unsigned int klen, unsigned int assoclen)
+{
+	struct aead_request *reqs[TCRYPT_AEAD_BATCH] = { NULL };
+	struct scatterlist sg[TCRYPT_AEAD_BATCH];
+	struct scatterlist asg[TCRYPT_AEAD_BATCH];
+	char *buf[TCRYPT_AEAD_BATCH] = { NULL };
+	struct tcrypt_batch_result res;
+	struct crypto_aead *tfm;
+	unsigned int authsize = 16;
+	unsigned int i, j, nreq;
+	char iv[32];
+	u32 *b_size;
+	int ret;
+
+	pr_info("\ntesting packet rate of %s encryption\n", algo);
+
+	init_completion(&res.completion);
+
+	tfm = crypto_alloc_aead(algo, 0, 0);
+	if (IS_ERR(tfm)) {
+		pr_err("failed to load transform for %s: %ld\n", algo,
+		       PTR_ERR(tfm));
+		return;
+	}
+
+	memset(tvmem[0], 0xff, PAGE_SIZE);
+	ret = crypto_aead_setkey(tfm, tvmem[0], klen);
+	if (!ret)
+		ret = crypto_aead_setauthsize(tfm, authsize);
+	if (ret) {
+		pr_err("setkey() failed flags=%x\n",
+		       crypto_aead_get_flags(tfm));
+		goto out;
+	}
+
+	memset(iv, 0xff, sizeof(iv));
+
+	/* payload at the start of a page, associated data at its end */
+	for (i = 0; i < TCRYPT_AEAD_BATCH; i++) {
+		buf[i] = (void *)__get_free_page(GFP_KERNEL);
+		reqs[i] = aead_request_alloc(tfm, GFP_KERNEL);
+		if (!buf[i] || !reqs[i]) {
+			pr_err("tcrypt: aead: Failed to allocate request for %s\n",
+			       algo);
+			goto out_free;
+		}
+		memset(buf[i], 0xff, PAGE_SIZE);
+		sg_init_one(&asg[i], buf[i] + PAGE_SIZE - assoclen, assoclen);
+		aead_request_set_assoc(reqs[i], &asg[i], assoclen);
+		aead_request_set_callback(reqs[i], CRYPTO_TFM_REQ_MAY_BACKLOG,
+					  tcrypt_batch_complete, &res);
+	}
+
+	j = 0;
+	for (nreq = 1; nreq <= TCRYPT_AEAD_BATCH; nreq *= TCRYPT_AEAD_BATCH) {
+		for (b_size = aead_packet_sizes; *b_size; b_size++, j++) {
+			pr_info("test %u (%u byte packets, %u per call): ",
+				j, *b_size, nreq);
+
+			for (i = 0; i < nreq; i++) {
+				sg_init_one(&sg[i], buf[i], *b_size + authsize);
+				aead_request_set_crypt(reqs[i], &sg[i], &sg[i],
+						       *b_size, iv);
+			}
+
+			if (sec)
+				ret = test_aead_batch_jiffies(reqs, nreq, &res,
+							      *b_size, sec);
+			else
+				ret = test_aead_batch_cycles(reqs, nreq, &res,
+							     *b_size);
+
+			if (ret) {
+				pr_err("encryption failed ret=%d\n", ret);
+				goto out_free;
+			}
+		}
+	}
+
+out_free:
+	for (i = 0; i < TCRYPT_AEAD_BATCH; i++) {
+		if (reqs[i])
+			aead_request_free(reqs[i]);
+		if (buf[i])
+			free_page((unsigned long)buf[i]);
+	}
+out:
+	crypto_free_aead(tfm);
+}
+
+/*
+ * Compression speed.  Every page of a corpus is compressed and decompressed
+ * on its own, the way zram and zswap use the compressors, and the totals
+ * give MB/s and the compression ratio.  Each direction runs for sec seconds
+ * (one if unset), first on the calling CPU and then with one thread on every
+ * online CPU.
+ */
+#define TCRYPT_COMP_PAGES	64
+
+enum {
+	TCRYPT_CORPUS_ZERO,
+	TCRYPT_CORPUS_TEXT,
+	TCRYPT_CORPUS_RANDOM,
+	TCRYPT_CORPUS_PAGES,
+	TCRYPT_CORPUS_MAX,
+};
+
+static const char * const tcrypt_corpus_names[TCRYPT_CORPUS_MAX] = {
+	[TCRYPT_CORPUS_ZERO]	= "zero",
+	[TCRYPT_CORPUS_TEXT]	= "text",
+	[TCRYPT_CORPUS_RANDOM]	= "random",
+	[TCRYPT_CORPUS_PAGES]	= "pages",
+};
+
+static char *corpus;
+
+static const char * const tcrypt_words[] = {
+	"the", "of", "and", "to", "in", "a", "is", "that", "for", "it",
+	"as", "was", "with", "be", "by", "on", "not", "this", "are", "or",
+	"from", "at", "which", "but", "have", "an", "they", "one", "all",
+	"can", "there", "been", "if", "more", "when", "will", "would", "so",
+	"no", "page", "memory", "kernel", "data", "system", "process",
+	"compression", "buffer", "device", "request", "function", "value",
+};
+
+/* English-like text: skewed word frequencies, sentences and lines */
+static void tcrypt_fill_text(u8 *buf, unsigned int len)
+{
+	unsigned int n = ARRAY_SIZE(tcrypt_words);
+	unsigned int pos = 0, col = 0;
+
+	while (pos < len) {
+		u32 r = prandom_u32();
+		const char *w = tcrypt_words[(r & 0xffff) % n *
+					     ((r >> 16) % n) / n];
+		unsigned int wlen = strlen(w);
+
+		if (pos + wlen + 2 > len)
+			break;
+		memcpy(buf + pos, w, wlen);
+		pos += wlen;
+		col += wlen + 1;
+
+		if (!(r % 13))
+			buf[pos++] = '.';
+		if (col > 72) {
+			buf[pos++] = '\n';
+			col = 0;
+		} else {
+			buf[pos++] = ' ';
+		}
+	}
+	memset(buf + pos, ' ', len - pos);
+}
+
+/*
+ * Real page samples: the previous contents of freshly allocated pages, which
+ * were recently used for page cache, anonymous memory or slab.
+ */
+static int tcrypt_fill_pages(u8 *buf, unsigned int npages)
+{
+	struct page **pages;
+	unsigned int i;
+	int ret = 0;
+
+	pages = kcalloc(npages, sizeof(*pages), GFP_KERNEL);
+	if (!pages)
+		return -ENOMEM;
+
+	for (i = 0; i < npages; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i]) {
+			ret = -ENOMEM;
+			break;
+		}
+		memcpy(buf + i * PAGE_SIZE, page_address(pages[i]), PAGE_SIZE);
+	}
+
+	while (i--)
+		__free_page(pages[i]);
+	kfree(pages);
+	return ret;
+}
+
+static int tcrypt_fill_corpus(u8 *buf, unsigned int npages, int type)
+{
+	unsigned int len = npages * PAGE_SIZE;
+
+	switch (type) {
+	case TCRYPT_CORPUS_ZERO:
+		memset(buf, 0, len);
+		break;
+	case TCRYPT_CORPUS_TEXT:
+		tcrypt_fill_text(buf, len);
+		break;
+	case TCRYPT_CORPUS_RANDOM:
+		prandom_bytes(buf, len);
+		break;
+	case TCRYPT_CORPUS_PAGES:
+		return tcrypt_fill_pages(buf, npages);
+	}
+
+	return 0;
+}
+
+struct tcrypt_comp_thread {
+	const char *algo;
+	bool pcomp;
+	const u8 *src;
+	u8 *dst;
+	u8 *out;
+	unsigned int dlen[TCRYPT_COMP_PAGES];
+	unsigned int sec;
+
+	u64 in_bytes;
+	u64 out_bytes;
+	u64 comp_ns;
+	u64 decomp_bytes;
+	u64 decomp_ns;
+	int err;
+
+	struct completion done;
+};
+
+/* zlib only has the partial compression interface, run it in one go */
+static int tcrypt_pcomp_compress(struct crypto_pcomp *tfm, const u8 *src,
+				 unsigned int slen, u8 *dst,
+				 unsigned int *dlen)
+{
+	struct comp_request req;
+	int ret;
+
+	ret = crypto_compress_init(tfm);
+	if (ret)
+		return ret;
+
+	req.next_in = src;
+	req.avail_in = slen;
+	req.next_out = dst;
+	req.avail_out = *dlen;
+
+	ret = crypto_compress_final(tfm, &req);
+	if (ret < 0)
+		return ret;
+
+	*dlen = ret;
+	return 0;
+}
+
+static int tcrypt_pcomp_decompress(struct crypto_pcomp *tfm, const u8 *src,
+				   unsigned int slen, u8 *dst,
+				   unsigned int *dlen)
+{
+	struct comp_request req;
+	int ret;
+
+	ret = crypto_decompress_init(tfm);
+	if (ret)
+		return ret;
+
+	req.next_in = src;
+	req.avail_in = slen;
+	req.next_out = dst;
+	req.avail_out = *dlen;
+
+	ret = crypto_decompress_final(tfm, &req);
+	if (ret < 0)
+		return ret;
+
+	*dlen = ret;
+	return 0;
+}
+
+static int tcrypt_comp_page(struct tcrypt_comp_thread *t, void *tfm,
+			    unsigned int i)
+{
+	unsigned int dlen = 2 * PAGE_SIZE;
+	const u8 *src = t->src + i * PAGE_SIZE;
+	u8 *dst = t->dst + i * 2 * PAGE_SIZE;
+	int ret;
+
+	if (t->pcomp)
+		ret = tcrypt_pcomp_compress(tfm, src, PAGE_SIZE, dst, &dlen);
+	else
+		ret = crypto_comp_compress(tfm, src, PAGE_SIZE, dst, &dlen);
+
+	t->dlen[i] = dlen;
+	return ret;
+}
+
+static int tcrypt_decomp_page(struct tcrypt_comp_thread *t, void *tfm,
+			      unsigned int i)
+{
+	unsigned int dlen = PAGE_SIZE;
+	const u8 *src = t->dst + i * 2 * PAGE_SIZE;
+	int ret;
+
+	if (t->pcomp)
+		ret = tcrypt_pcomp_decompress(tfm, src, t->dlen[i], t->out,
+					      &dlen);
+	else
+		ret = crypto_comp_decompress(tfm, src, t->dlen[i], t->out,
+					     &dlen);
+
+	if (!ret && dlen != PAGE_SIZE)
+		ret = -EINVAL;
+	return ret;
+}
+
+static int tcrypt_comp_run(struct tcrypt_comp_thread *t, void *tfm)
+{
+	unsigned int i;
+	ktime_t start, end;
+	int ret;
+
+	/* one pass to fill dst and check the round trip */
+	for (i = 0; i < TCRYPT_COMP_PAGES; i++) {
+		ret = tcrypt_comp_page(t, tfm, i);
+		if (!ret)
+			ret = tcrypt_decomp_page(t, tfm, i);
+		if (ret)
+			return ret;
+		if (memcmp(t->out, t->src + i * PAGE_SIZE, PAGE_SIZE))
+			return -EINVAL;
+	}
+
+	start = ktime_get();
+	end = ktime_add_ns(start, (u64)t->sec * NSEC_PER_SEC);
+	do {
+		for (i = 0; i < TCRYPT_COMP_PAGES; i++) {
+			ret = tcrypt_comp_page(t, tfm, i);
+			if (ret)
+				return ret;
+			t->out_bytes += t->dlen[i];
+		}
+		t->in_bytes += TCRYPT_COMP_PAGES * PAGE_SIZE;
+		cond_resched();
+	} while (ktime_to_ns(ktime_sub(end, ktime_get())) > 0);
+	t->comp_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	start = ktime_get();
+	end = ktime_add_ns(start, (u64)t->sec * NSEC_PER_SEC);
+	do {
+		for (i = 0; i < TCRYPT_COMP_PAGES; i++) {
+			ret = tcrypt_decomp_page(t, tfm, i);
+			if (ret)
+				return ret;
+		}
+		t->decomp_bytes += TCRYPT_COMP_PAGES * PAGE_SIZE;
+		cond_resched();
+	} while (ktime_to_ns(ktime_sub(end, ktime_get())) > 0);
+	t->decomp_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	return 0;
+}
+
+static int tcrypt_comp_thread_fn(void *data)
+{
+	struct tcrypt_comp_thread *t = data;
+	void *tfm;
+
+	if (t->pcomp) {
+		struct crypto_pcomp *pcomp;
+
+		pcomp = crypto_alloc_pcomp(t->algo, 0, 0);
+		if (IS_ERR(pcomp)) {
+			t->err = PTR_ERR(pcomp);
+			goto out;
+		}
+
+		t->err = crypto_compress_setup(pcomp, NULL, 0);
+		if (!t->err)
+			t->err = crypto_decompress_setup(pcomp, NULL, 0);
+		if (!t->err)
+			t->err = tcrypt_comp_run(t, pcomp);
+		crypto_free_pcomp(pcomp);
+	} else {
+		tfm = crypto_alloc_comp(t->algo, 0, 0);
+		if (IS_ERR(tfm)) {
+			t->err = PTR_ERR(tfm);
+			goto out;
+		}
+
+		t->err = tcrypt_comp_run(t, tfm);
+		crypto_free_comp(tfm);
+	}
+
+out:
+	complete(&t->done);
+	return 0;
+}
+
+static void tcrypt_comp_thread_free(struct tcrypt_comp_thread *t)
+{
+	if (!t)
+		return;
+	vfree(t->dst);
+	kfree(t->out);
+	kfree(t);
+}
+
+static struct tcrypt_comp_thread *tcrypt_comp_thread_alloc(
+	const char *algo, bool pcomp, const u8 *src, unsigned int sec)
+{
+	struct tcrypt_comp_thread *t;
+
+	t = kzalloc(sizeof(*t), GFP_KERNEL);
+	if (!t)
+		return NULL;
+
+	t->algo = algo;
+	t->pcomp = pcomp;
+	t->src = src;
+	t->sec = sec ?: 1;
+	init_completion(&t->done);
+
+	t->dst = vmalloc(TCRYPT_COMP_PAGES * 2 * PAGE_SIZE);
+	t->out = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!t->dst || !t->out) {
+		tcrypt_comp_thread_free(t);
+		return NULL;
+	}
+
+	return t;
+}
+
+static void tcrypt_comp_report(const char *algo, const char *name,
+			       unsigned int nthreads, u64 in, u64 out,
+			       u64 comp_ns, u64 decomp_bytes, u64 decomp_ns)
+{
+	u64 ratio = out ? div64_u64(in * 100, out) : 0;
+
+	pr_info("%-6s %-6s %3u thread(s): compress %6llu MB/s, "
+		"decompress %6llu MB/s, ratio %llu.%02llu\n",
+		algo, name, nthreads,
+		comp_ns ? div64_u64(in * 1000, comp_ns) : 0,
+		decomp_ns ? div64_u64(decomp_bytes * 1000, decomp_ns) : 0,
+		div64_u64(ratio, 100), ratio % 100);
+}
+
+/*
+ * Rates of the parallel run are summed over the threads, each of which
+ * ran for the same time.
+ */
+static int test_comp_speed_corpus(const char *algo, bool pcomp,
+				  const u8 *src, const char *name,
+				  unsigned int sec)
+{
+	struct tcrypt_comp_thread **threads;
+	struct tcrypt_comp_thread *t;
+	u64 in = 0, out = 0, decomp = 0, comp_ns = 0, decomp_ns = 0;
+	unsigned int cpu, n = 0;
+	int ret = 0;
+
+	t = tcrypt_comp_thread_alloc(algo, pcomp, src, sec);
+	if (!t)
+		return -ENOMEM;
+	tcrypt_comp_thread_fn(t);
+	ret = t->err;
+	if (!ret)
+		tcrypt_comp_report(algo, name, 1, t->in_bytes, t->out_bytes,
+				   t->comp_ns, t->decomp_bytes, t->decomp_ns);
+	tcrypt_comp_thread_free(t);
+	if (ret)
+		return ret;
+
+	threads = kcalloc(nr_cpu_ids, sizeof(*threads), GFP_KERNEL);
+	if (!threads)
+		return -ENOMEM;
+
+	get_online_cpus();
+	for_each_online_cpu(cpu) {
+		struct task_struct *task;
+
+		t = tcrypt_comp_thread_alloc(algo, pcomp, src, sec);
+		if (!t) {
+			ret = -ENOMEM;
+			break;
+		}
+
+		task = kthread_create_on_node(tcrypt_comp_thread_fn, t,
+					      cpu_to_node(cpu), "tcrypt/%u",
+					      cpu);
+		if (IS_ERR(task)) {
+			tcrypt_comp_thread_free(t);
+			ret = PTR_ERR(task);
+			break;
+		}
+		kthread_bind(task, cpu);
+		threads[n++] = t;
+		wake_up_process(task);
+	}
+	put_online_cpus();
+
+	for (cpu = 0; cpu < n; cpu++) {
+		t = threads[cpu];
+		wait_for_completion(&t->done);
+		if (t->err)
+			ret = t->err;
+		in += t->in_bytes;
+		out += t->out_bytes;
+		decomp += t->decomp_bytes;
+		comp_ns = max(comp_ns, t->comp_ns);
+		decomp_ns = max(decomp_ns, t->decomp_ns);
+		tcrypt_comp_thread_free(t);
+	}
+	kfree(threads);
+
+	if (!ret)
+		tcrypt_comp_report(algo, name, n, in, out, comp_ns, decomp,
+				   decomp_ns);
+	return ret;
+}
+
+static void test_comp_speed(const char *algo, bool pcomp, unsigned int sec)
+{
+	unsigned int i;
+	u8 *src;
+	int ret;
+
+	pr_info("\ntesting speed of %s compression, %u pages of %lu bytes\n",
+		algo, TCRYPT_COMP_PAGES, PAGE_SIZE);
+
+	src = vmalloc(TCRYPT_COMP_PAGES * PAGE_SIZE);
+	if (!src)
+		return;
+
+	for (i = 0; i < TCRYPT_CORPUS_MAX; i++) {
+		if (corpus && strcmp(corpus, tcrypt_corpus_names[i]))
+			continue;
+
+		ret = tcrypt_fill_corpus(src, TCRYPT_COMP_PAGES, i);
+		if (!ret)
+			ret = test_comp_speed_corpus(algo, pcomp, src,
+						     tcrypt_corpus_names[i],
+						     sec);
+		if (ret) {
+			pr_err("%s on %s corpus failed: %d\n", algo,
+			       tcrypt_corpus_names[i], ret);
+			break;
+		}
+	}
+
+	vfree(src);
+}
+
 static void test_available(void)
 {
 	char **name = check;
@@ -1178,6 +1834,22 @@ static int do_test(int m)
 		ret += tcrypt_test("crct10dif");
 		break;
 
+	case 48:
+		ret += tcrypt_test("chacha20");
+		break;
+
+	case 49:
+		ret += tcrypt_test("poly1305");
+		break;
+
+	case 50:
+		ret += tcrypt_test("rfc7539(chacha20,poly1305)");
+		break;
+
+	case 51:
+		ret += tcrypt_test("rfc7539esp(chacha20,poly1305)");
+		break;
+
 	case 100:
 		ret += tcrypt_test("hmac(md5)");
 		break;
@@ -1427,6 +2099,11 @@ static int do_test(int m)
 				  speed_template_32_64);
 		break;
 
+	case 211:
+		test_cipher_speed("chacha20", ENCRYPT, sec, NULL, 0,
+				  speed_template_32);
+		break;
+
 	case 300:
 		/* fall through */
 
@@ -1510,6 +2187,10 @@ static int do_test(int m)
 		test_hash_speed("crct10dif", sec, generic_hash_speed_template);
 		if (mode > 300 && mode < 400) break;
 
+	case 321:
+		test_hash_speed("poly1305", sec, poly1305_speed_template);
+		if (mode > 300 && mode < 400) break;
+
 	case 399:
 		break;
 
@@ -1795,6 +2476,38 @@ static int do_test(int m)
 				   speed_template_8_32);
 		break;
 
+	case 600:
+		test_aead_batch_speed("rfc4106(gcm(aes))", sec, 20, 8);
+		test_aead_batch_speed("rfc7539esp(chacha20,poly1305)", sec,
+				      36, 8);
+		break;
+
+	case 700:
+		/* fall through */
+
+	case 701:
+		test_comp_speed("lzo", false, sec);
+		if (mode > 700 && mode < 800) break;
+
+	case 702:
+		test_comp_speed("lz4", false, sec);
+		if (mode > 700 && mode < 800) break;
+
+	case 703:
+		test_comp_speed("lz4hc", false, sec);
+		if (mode > 700 && mode < 800) break;
+
+	case 704:
+		test_comp_speed("deflate", false, sec);
+		if (mode > 700 && mode < 800) break;
+
+	case 705:
+		test_comp_speed("zlib", true, sec);
+		if (mode > 700 && mode < 800) break;
+
+	case 799:
+		break;
+
 	case 1000:
 		test_available();
 		break;
@@ -1863,6 +2576,9 @@ module_param(mode, int, 0);
 module_param(sec, uint, 0);
 MODULE_PARM_DESC(sec, "Length in seconds of speed tests "
 		      "(defaults to zero which uses CPU cycles instead)");
+module_param(corpus, charp, 0);
+MODULE_PARM_DESC(corpus, "Only run compression speed tests on this corpus "
+			 "(zero, text, random or pages)");
 
 MODULE_LICENSE("GPL");
 MODULE_DESCRIPTION("Quick & dirty crypto testing module");
@@ -1089,6 +1089,177 @@ static struct hash_testvec ghash_tv_template[] =
 	},
 };
 
+/*
+ * Poly1305 test vectors from RFC7539 A.3. and 2.5.2.  The one-time key is
+ * passed as the first 32 bytes of the data.
+ */
+#define POLY1305_TEST_VECTORS 3
+static struct hash_testvec poly1305_tv_template[] = {
+	{ /* RFC7539 A.3. Test Vector #1 */
+		.plaintext = "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.psize	= 96,
+		.digest	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00",
+	}, { /* RFC7539 2.5.2. Test Vector */
+		.plaintext = "\x85\xd6\xbe\x78\x57\x55\x6d\x33"
+			  "\x7f\x44\x52\xfe\x42\xd5\x06\xa8"
+			  "\x01\x03\x80\x8a\xfb\x0d\xb2\xfd"
+			  "\x4a\xbf\xf6\xaf\x41\x49\xf5\x1b"
+			  "\x43\x72\x79\x70\x74\x6f\x67\x72"
+			  "\x61\x70\x68\x69\x63\x20\x46\x6f"
+			  "\x72\x75\x6d\x20\x52\x65\x73\x65"
+			  "\x61\x72\x63\x68\x20\x47\x72\x6f"
+			  "\x75\x70",
+		.psize	= 66,
+		.digest	= "\xa8\x06\x1d\xc1\x30\x51\x36\xc6"
+			  "\xc2\x2b\x8b\xaf\x0c\x01\x27\xa9",
+	}, { /* Long enough for the SIMD paths, with a partial block */
+		.plaintext = "\x31\x3e\x4b\x58\x65\x72\x7f\x8c"
+			  "\x99\xa6\xb3\xc0\xcd\xda\xe7\xf4"
+			  "\x01\x0e\x1b\x28\x35\x42\x4f\x5c"
+			  "\x69\x76\x83\x90\x9d\xaa\xb7\xc4"
+			  "\x05\x10\x1b\x26\x31\x3c\x47\x52"
+			  "\x5d\x68\x73\x7e\x89\x94\x9f\xaa"
+			  "\xb5\xc0\xcb\xd6\xe1\xec\xf7\x02"
+			  "\x0d\x18\x23\x2e\x39\x44\x4f\x5a"
+			  "\x65\x70\x7b\x86\x91\x9c\xa7\xb2"
+			  "\xbd\xc8\xd3\xde\xe9\xf4\xff\x0a"
+			  "\x15\x20\x2b\x36\x41\x4c\x57\x62"
+			  "\x6d\x78\x83\x8e\x99\xa4\xaf\xba"
+			  "\xc5\xd0\xdb\xe6\xf1\xfc\x07\x12"
+			  "\x1d\x28\x33\x3e\x49\x54\x5f\x6a"
+			  "\x75\x80\x8b\x96\xa1\xac\xb7\xc2"
+			  "\xcd\xd8\xe3\xee\xf9\x04\x0f\x1a"
+			  "\x25\x30\x3b\x46\x51\x5c\x67\x72"
+			  "\x7d\x88\x93\x9e\xa9\xb4\xbf\xca"
+			  "\xd5\xe0\xeb\xf6\x01\x0c\x17\x22"
+			  "\x2d\x38\x43\x4e\x59\x64\x6f\x7a"
+			  "\x85\x90\x9b\xa6\xb1\xbc\xc7\xd2"
+			  "\xdd\xe8\xf3\xfe\x09\x14\x1f\x2a"
+			  "\x35\x40\x4b\x56\x61\x6c\x77\x82"
+			  "\x8d\x98\xa3\xae\xb9\xc4\xcf\xda"
+			  "\xe5\xf0\xfb\x06\x11\x1c\x27\x32"
+			  "\x3d\x48\x53\x5e\x69\x74\x7f\x8a"
+			  "\x95\xa0\xab\xb6\xc1\xcc\xd7\xe2"
+			  "\xed\xf8\x03\x0e\x19\x24\x2f\x3a"
+			  "\x45\x50\x5b\x66\x71\x7c\x87\x92"
+			  "\x9d\xa8\xb3\xbe\xc9\xd4\xdf\xea"
+			  "\xf5\x00\x0b\x16\x21\x2c\x37\x42"
+			  "\x4d\x58\x63\x6e\x79\x84\x8f\x9a"
+			  "\xa5\xb0\xbb\xc6\xd1\xdc\xe7\xf2"
+			  "\xfd\x08\x13\x1e\x29\x34\x3f\x4a"
+			  "\x55\x60\x6b\x76\x81\x8c\x97\xa2"
+			  "\xad\xb8\xc3\xce\xd9\xe4\xef\xfa"
+			  "\x05\x10\x1b\x26\x31\x3c\x47\x52"
+			  "\x5d\x68\x73\x7e\x89\x94\x9f\xaa"
+			  "\xb5\xc0\xcb\xd6\xe1\xec\xf7\x02"
+			  "\x0d\x18\x23\x2e\x39\x44\x4f\x5a"
+			  "\x65\x70\x7b\x86\x91\x9c\xa7\xb2"
+			  "\xbd\xc8\xd3\xde\xe9\xf4\xff\x0a"
+			  "\x15\x20\x2b\x36\x41\x4c\x57\x62"
+			  "\x6d\x78\x83\x8e\x99\xa4\xaf\xba"
+			  "\xc5\xd0\xdb\xe6\xf1\xfc\x07\x12"
+			  "\x1d\x28\x33\x3e\x49\x54\x5f\x6a"
+			  "\x75\x80\x8b\x96\xa1\xac\xb7\xc2"
+			  "\xcd\xd8\xe3\xee\xf9\x04\x0f\x1a"
+			  "\x25\x30\x3b\x46\x51\x5c\x67\x72"
+			  "\x7d\x88\x93\x9e\xa9\xb4\xbf\xca"
+			  "\xd5\xe0\xeb\xf6\x01\x0c\x17\x22"
+			  "\x2d\x38\x43\x4e\x59\x64\x6f\x7a"
+			  "\x85\x90\x9b\xa6\xb1\xbc\xc7\xd2"
+			  "\xdd\xe8\xf3\xfe\x09\x14\x1f\x2a"
+			  "\x35\x40\x4b\x56\x61\x6c\x77\x82"
+			  "\x8d\x98\xa3\xae\xb9\xc4\xcf\xda"
+			  "\xe5\xf0\xfb\x06\x11\x1c\x27\x32"
+			  "\x3d\x48\x53\x5e\x69\x74\x7f\x8a"
+			  "\x95\xa0\xab\xb6\xc1\xcc\xd7\xe2"
+			  "\xed\xf8\x03\x0e\x19\x24\x2f\x3a"
+			  "\x45\x50\x5b\x66\x71\x7c\x87\x92"
+			  "\x9d\xa8\xb3\xbe\xc9\xd4\xdf\xea"
+			  "\xf5\x00\x0b\x16\x21\x2c\x37\x42"
+			  "\x4d\x58\x63\x6e\x79\x84\x8f\x9a"
+			  "\xa5\xb0\xbb\xc6\xd1\xdc\xe7\xf2"
+			  "\xfd\x08\x13\x1e\x29\x34\x3f\x4a"
+			  "\x55\x60\x6b\x76\x81\x8c\x97\xa2"
+			  "\xad\xb8\xc3\xce\xd9\xe4\xef\xfa"
+			  "\x05\x10\x1b\x26\x31\x3c\x47\x52"
+			  "\x5d\x68\x73\x7e\x89\x94\x9f\xaa"
+			  "\xb5\xc0\xcb\xd6\xe1\xec\xf7\x02"
+			  "\x0d\x18\x23\x2e\x39\x44\x4f\x5a"
+			  "\x65\x70\x7b\x86\x91\x9c\xa7\xb2"
+			  "\xbd\xc8\xd3\xde\xe9\xf4\xff\x0a"
+			  "\x15\x20\x2b\x36\x41\x4c\x57\x62"
+			  "\x6d\x78\x83\x8e\x99\xa4\xaf\xba"
+			  "\xc5\xd0\xdb\xe6\xf1\xfc\x07\x12"
+			  "\x1d\x28\x33\x3e\x49\x54\x5f\x6a"
+			  "\x75\x80\x8b\x96\xa1\xac\xb7\xc2"
+			  "\xcd\xd8\xe3\xee\xf9\x04\x0f\x1a"
+			  "\x25\x30\x3b\x46\x51\x5c\x67\x72"
+			  "\x7d\x88\x93\x9e\xa9\xb4\xbf\xca"
+			  "\xd5\xe0\xeb\xf6\x01\x0c\x17\x22"
+			  "\x2d\x38\x43\x4e\x59\x64\x6f\x7a"
+			  "\x85\x90\x9b\xa6\xb1\xbc\xc7\xd2"
+			  "\xdd\xe8\xf3\xfe\x09\x14\x1f\x2a"
+			  "\x35\x40\x4b\x56\x61\x6c\x77\x82"
+			  "\x8d\x98\xa3\xae\xb9\xc4\xcf\xda"
+			  "\xe5\xf0\xfb\x06\x11\x1c\x27\x32"
+			  "\x3d\x48\x53\x5e\x69\x74\x7f\x8a"
+			  "\x95\xa0\xab\xb6\xc1\xcc\xd7\xe2"
+			  "\xed\xf8\x03\x0e\x19\x24\x2f\x3a"
+			  "\x45\x50\x5b\x66\x71\x7c\x87\x92"
+			  "\x9d\xa8\xb3\xbe\xc9\xd4\xdf\xea"
+			  "\xf5\x00\x0b\x16\x21\x2c\x37\x42"
+			  "\x4d\x58\x63\x6e\x79\x84\x8f\x9a"
+			  "\xa5\xb0\xbb\xc6\xd1\xdc\xe7\xf2"
+			  "\xfd\x08\x13\x1e\x29\x34\x3f\x4a"
+			  "\x55\x60\x6b\x76\x81\x8c\x97\xa2"
+			  "\xad\xb8\xc3\xce\xd9\xe4\xef\xfa"
+			  "\x05\x10\x1b\x26\x31\x3c\x47\x52"
+			  "\x5d\x68\x73\x7e\x89\x94\x9f\xaa"
+			  "\xb5\xc0\xcb\xd6\xe1\xec\xf7\x02"
+			  "\x0d\x18\x23\x2e\x39\x44\x4f\x5a"
+			  "\x65\x70\x7b\x86\x91\x9c\xa7\xb2"
+			  "\xbd\xc8\xd3\xde\xe9\xf4\xff\x0a"
+			  "\x15\x20\x2b\x36\x41\x4c\x57\x62"
+			  "\x6d\x78\x83\x8e\x99\xa4\xaf\xba"
+			  "\xc5\xd0\xdb\xe6\xf1\xfc\x07\x12"
+			  "\x1d\x28\x33\x3e\x49\x54\x5f\x6a"
+			  "\x75\x80\x8b\x96\xa1\xac\xb7\xc2"
+			  "\xcd\xd8\xe3\xee\xf9\x04\x0f\x1a"
+			  "\x25\x30\x3b\x46\x51\x5c\x67\x72"
+			  "\x7d\x88\x93\x9e\xa9\xb4\xbf\xca"
+			  "\xd5\xe0\xeb\xf6\x01\x0c\x17\x22"
+			  "\x2d\x38\x43\x4e\x59\x64\x6f\x7a"
+			  "\x85\x90\x9b\xa6\xb1\xbc\xc7\xd2"
+			  "\xdd\xe8\xf3\xfe\x09\x14\x1f\x2a"
+			  "\x35\x40\x4b\x56\x61\x6c\x77\x82"
+			  "\x8d\x98\xa3\xae\xb9\xc4\xcf\xda"
+			  "\xe5\xf0\xfb\x06\x11\x1c\x27\x32"
+			  "\x3d\x48\x53\x5e\x69\x74\x7f\x8a"
+			  "\x95\xa0\xab\xb6\xc1\xcc\xd7\xe2"
+			  "\xed\xf8\x03\x0e\x19\x24\x2f\x3a"
+			  "\x45\x50\x5b\x66\x71\x7c\x87\x92"
+			  "\x9d\xa8\xb3\xbe\xc9\xd4\xdf\xea"
+			  "\xf5\x00\x0b\x16\x21\x2c\x37\x42"
+			  "\x4d\x58\x63\x6e\x79\x84\x8f\x9a"
+			  "\xa5\xb0\xbb\xc6\xd1\xdc\xe7\xf2",
+		.psize	= 1032,
+		.digest	= "\x40\xec\x52\x5b\x6a\xe3\xa6\x78"
+			  "\xe6\xc0\xd9\x8e\xce\x7a\x8a\x2b",
+	},
+};
+
 /*
  * HMAC-MD5 test vectors from RFC2202
  * (These need to be fixed to not use strlen).
@@ -12836,8 +13007,8 @@ static struct cipher_testvec cast6_xts_dec_tv_template[] = {
 #define AES_CTR_3686_DEC_TEST_VECTORS 6
 #define AES_GCM_ENC_TEST_VECTORS 9
 #define AES_GCM_DEC_TEST_VECTORS 8
-#define AES_GCM_4106_ENC_TEST_VECTORS 7
-#define AES_GCM_4106_DEC_TEST_VECTORS 7
+#define AES_GCM_4106_ENC_TEST_VECTORS 8
+#define AES_GCM_4106_DEC_TEST_VECTORS 8
 #define AES_GCM_4543_ENC_TEST_VECTORS 1
 #define AES_GCM_4543_DEC_TEST_VECTORS 2
 #define AES_CCM_ENC_TEST_VECTORS 7
@@ -18174,6 +18345,94 @@ static struct aead_testvec aes_gcm_rfc4106_enc_tv_template[] = {
 			  "\x37\x08\x1C\xCF\xBA\x5D\x71\x46"
 			  "\x80\x72\xB0\x4C\x82\x0D\x60\x3C",
 		.rlen	= 208,
+	}, {
+		.key	= "\x00\x01\x02\x03\x04\x05\x06\x07"
+			  "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+			  "\xca\xfe\xba\xbe",
+		.klen	= 20,
+		.iv	= "\x01\x23\x45\x67\x89\xab\xcd\xef",
+		.input	= "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30\x37\x3e\x45\x4c"
+			  "\x53\x5a\x61\x68\x6f\x76\x7d\x84"
+			  "\x8b\x92\x99\xa0\xa7\xae\xb5\xbc"
+			  "\xc3\xca\xd1\xd8\xdf\xe6\xed\xf4"
+			  "\xfb\x02\x09\x10\x17\x1e\x25\x2c"
+			  "\x33\x3a\x41\x48\x4f\x56\x5d\x64"
+			  "\x6b\x72\x79\x80\x87\x8e\x95\x9c"
+			  "\xa3\xaa\xb1\xb8\xbf\xc6\xcd\xd4"
+			  "\xdb\xe2\xe9\xf0\xf7\xfe\x05\x0c"
+			  "\x13\x1a\x21\x28\x2f\x36\x3d\x44"
+			  "\x4b\x52\x59\x60\x67\x6e\x75\x7c"
+			  "\x83\x8a\x91\x98\x9f\xa6\xad\xb4"
+			  "\xbb\xc2\xc9\xd0\xd7\xde\xe5\xec"
+			  "\xf3\xfa\x01\x08\x0f\x16\x1d\x24"
+			  "\x2b\x32\x39\x40\x47\x4e\x55\x5c"
+			  "\x63\x6a\x71\x78\x7f\x86\x8d\x94"
+			  "\x9b\xa2\xa9\xb0\xb7\xbe\xc5\xcc"
+			  "\xd3\xda\xe1\xe8\xef\xf6\xfd\x04"
+			  "\x0b\x12\x19\x20\x27\x2e\x35\x3c"
+			  "\x43\x4a\x51\x58\x5f\x66\x6d\x74"
+			  "\x7b\x82\x89\x90\x97\x9e\xa5\xac"
+			  "\xb3\xba\xc1\xc8\xcf\xd6\xdd\xe4"
+			  "\xeb\xf2\xf9\x00\x07\x0e\x15\x1c"
+			  "\x23\x2a\x31\x38\x3f\x46\x4d\x54"
+			  "\x5b\x62\x69\x70\x77\x7e\x85\x8c"
+			  "\x93\x9a\xa1\xa8\xaf\xb6\xbd\xc4"
+			  "\xcb\xd2\xd9\xe0\xe7\xee\xf5\xfc"
+			  "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30",
+		.ilen	= 300,
+		.assoc	= "\x10\x11\x12\x13\x14\x15\x16\x17",
+		.alen	= 8,
+		.result	= "\xC0\xC6\xD1\xF4\xA6\x52\xA5\x8E"
+			  "\x21\xB4\x08\x1F\x11\x26\xAF\x28"
+			  "\xB4\xE4\x89\x12\x48\x1C\xA5\xA5"
+			  "\xE5\xB9\x6E\x90\x03\x9E\xD1\xD6"
+			  "\xDE\xBD\xA8\xCB\x84\x3D\xC3\x98"
+			  "\xDF\x07\xBE\x0E\xB5\x05\x2C\x0F"
+			  "\xC6\xB1\xCA\x87\x0D\xF5\x40\xAC"
+			  "\x73\xAB\x79\x01\x81\x2D\x89\xA9"
+			  "\x06\x7B\x97\x79\xDB\x5F\xC0\x0A"
+			  "\xDC\xCD\xAA\x5B\xEB\x29\x92\x45"
+			  "\x04\xC6\x35\xD0\xC5\x6F\x5A\xDD"
+			  "\x7C\x93\xD6\x14\xD7\xEF\x8D\xC9"
+			  "\xEC\xFD\x06\x8A\x5B\xCE\xC1\xD3"
+			  "\x02\x78\xA7\x9E\x13\xAC\xF9\x41"
+			  "\x26\x95\xF7\x6D\xE4\x30\x86\xF1"
+			  "\xBF\xB5\x14\xCE\x0B\x06\x0D\x7A"
+			  "\x16\x3C\x88\x27\xD6\xA6\x9C\xC3"
+			  "\x4E\x13\xB4\xA9\xDB\x52\x13\x2D"
+			  "\x77\x96\xEE\x42\xDF\x43\x41\xAE"
+			  "\x99\x98\x7A\xDD\xAF\x06\xBC\xC0"
+			  "\x5A\xC9\x13\xC9\xD2\x67\xB6\x52"
+			  "\x96\xC8\xAD\x1D\x74\x67\x70\x0E"
+			  "\x24\x75\xD2\x4A\xCF\x13\x96\x24"
+			  "\xB5\x7F\x64\xD6\x19\xC8\xDA\x33"
+			  "\xCF\x4A\x31\x47\x06\x8D\x2A\xC5"
+			  "\xB4\x4A\xBB\xD5\xE0\x14\xCB\xDC"
+			  "\x18\x5F\x03\x37\x02\x3C\xF2\x47"
+			  "\x0C\x89\x0E\xC2\xBC\xAA\x09\x81"
+			  "\xE7\x08\x3F\x0E\xA9\x24\x5B\xE7"
+			  "\x5D\x33\x9F\x5E\x0F\xB2\x29\xEC"
+			  "\x2D\x20\xE1\xC1\x1D\xDF\x4D\x1B"
+			  "\xC1\xF3\xDC\x6F\x32\xBD\x83\x78"
+			  "\x4A\x5F\xEE\x99\xAA\x85\x55\xD9"
+			  "\x7A\x5A\xA7\xDE\x22\x8F\xF4\xBE"
+			  "\x47\x7F\x1F\x6D\x99\x25\x85\xE4"
+			  "\x58\xA8\xC4\xB4\x34\x41\x1B\xCE"
+			  "\xEE\x43\xF1\xC5\x1E\xC5\xA0\xB2"
+			  "\x1F\xE0\xC3\xBD\xF4\x6E\x33\x94"
+			  "\x2F\xA9\x60\xD3\xF1\xFA\xD5\x3B"
+			  "\x1E\xBB\xD0\xE0",
+		.rlen	= 316,
 	}
 };
 
@@ -18350,6 +18609,94 @@ static struct aead_testvec aes_gcm_rfc4106_dec_tv_template[] = {
                           "\xff\xff\xff\xff\xff\xff\xff\xff",
                 .rlen   = 192,
 
+	}, {
+		.key	= "\x00\x01\x02\x03\x04\x05\x06\x07"
+			  "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+			  "\xca\xfe\xba\xbe",
+		.klen	= 20,
+		.iv	= "\x01\x23\x45\x67\x89\xab\xcd\xef",
+		.input	= "\xC0\xC6\xD1\xF4\xA6\x52\xA5\x8E"
+			  "\x21\xB4\x08\x1F\x11\x26\xAF\x28"
+			  "\xB4\xE4\x89\x12\x48\x1C\xA5\xA5"
+			  "\xE5\xB9\x6E\x90\x03\x9E\xD1\xD6"
+			  "\xDE\xBD\xA8\xCB\x84\x3D\xC3\x98"
+			  "\xDF\x07\xBE\x0E\xB5\x05\x2C\x0F"
+			  "\xC6\xB1\xCA\x87\x0D\xF5\x40\xAC"
+			  "\x73\xAB\x79\x01\x81\x2D\x89\xA9"
+			  "\x06\x7B\x97\x79\xDB\x5F\xC0\x0A"
+			  "\xDC\xCD\xAA\x5B\xEB\x29\x92\x45"
+			  "\x04\xC6\x35\xD0\xC5\x6F\x5A\xDD"
+			  "\x7C\x93\xD6\x14\xD7\xEF\x8D\xC9"
+			  "\xEC\xFD\x06\x8A\x5B\xCE\xC1\xD3"
+			  "\x02\x78\xA7\x9E\x13\xAC\xF9\x41"
+			  "\x26\x95\xF7\x6D\xE4\x30\x86\xF1"
+			  "\xBF\xB5\x14\xCE\x0B\x06\x0D\x7A"
+			  "\x16\x3C\x88\x27\xD6\xA6\x9C\xC3"
+			  "\x4E\x13\xB4\xA9\xDB\x52\x13\x2D"
+			  "\x77\x96\xEE\x42\xDF\x43\x41\xAE"
+			  "\x99\x98\x7A\xDD\xAF\x06\xBC\xC0"
+			  "\x5A\xC9\x13\xC9\xD2\x67\xB6\x52"
+			  "\x96\xC8\xAD\x1D\x74\x67\x70\x0E"
+			  "\x24\x75\xD2\x4A\xCF\x13\x96\x24"
+			  "\xB5\x7F\x64\xD6\x19\xC8\xDA\x33"
+			  "\xCF\x4A\x31\x47\x06\x8D\x2A\xC5"
+			  "\xB4\x4A\xBB\xD5\xE0\x14\xCB\xDC"
+			  "\x18\x5F\x03\x37\x02\x3C\xF2\x47"
+			  "\x0C\x89\x0E\xC2\xBC\xAA\x09\x81"
+			  "\xE7\x08\x3F\x0E\xA9\x24\x5B\xE7"
+			  "\x5D\x33\x9F\x5E\x0F\xB2\x29\xEC"
+			  "\x2D\x20\xE1\xC1\x1D\xDF\x4D\x1B"
+			  "\xC1\xF3\xDC\x6F\x32\xBD\x83\x78"
+			  "\x4A\x5F\xEE\x99\xAA\x85\x55\xD9"
+			  "\x7A\x5A\xA7\xDE\x22\x8F\xF4\xBE"
+			  "\x47\x7F\x1F\x6D\x99\x25\x85\xE4"
+			  "\x58\xA8\xC4\xB4\x34\x41\x1B\xCE"
+			  "\xEE\x43\xF1\xC5\x1E\xC5\xA0\xB2"
+			  "\x1F\xE0\xC3\xBD\xF4\x6E\x33\x94"
+			  "\x2F\xA9\x60\xD3\xF1\xFA\xD5\x3B"
+			  "\x1E\xBB\xD0\xE0",
+		.ilen	= 316,
+		.assoc	= "\x10\x11\x12\x13\x14\x15\x16\x17",
+		.alen	= 8,
+		.result	= "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30\x37\x3e\x45\x4c"
+			  "\x53\x5a\x61\x68\x6f\x76\x7d\x84"
+			  "\x8b\x92\x99\xa0\xa7\xae\xb5\xbc"
+			  "\xc3\xca\xd1\xd8\xdf\xe6\xed\xf4"
+			  "\xfb\x02\x09\x10\x17\x1e\x25\x2c"
+			  "\x33\x3a\x41\x48\x4f\x56\x5d\x64"
+			  "\x6b\x72\x79\x80\x87\x8e\x95\x9c"
+			  "\xa3\xaa\xb1\xb8\xbf\xc6\xcd\xd4"
+			  "\xdb\xe2\xe9\xf0\xf7\xfe\x05\x0c"
+			  "\x13\x1a\x21\x28\x2f\x36\x3d\x44"
+			  "\x4b\x52\x59\x60\x67\x6e\x75\x7c"
+			  "\x83\x8a\x91\x98\x9f\xa6\xad\xb4"
+			  "\xbb\xc2\xc9\xd0\xd7\xde\xe5\xec"
+			  "\xf3\xfa\x01\x08\x0f\x16\x1d\x24"
+			  "\x2b\x32\x39\x40\x47\x4e\x55\x5c"
+			  "\x63\x6a\x71\x78\x7f\x86\x8d\x94"
+			  "\x9b\xa2\xa9\xb0\xb7\xbe\xc5\xcc"
+			  "\xd3\xda\xe1\xe8\xef\xf6\xfd\x04"
+			  "\x0b\x12\x19\x20\x27\x2e\x35\x3c"
+			  "\x43\x4a\x51\x58\x5f\x66\x6d\x74"
+			  "\x7b\x82\x89\x90\x97\x9e\xa5\xac"
+			  "\xb3\xba\xc1\xc8\xcf\xd6\xdd\xe4"
+			  "\xeb\xf2\xf9\x00\x07\x0e\x15\x1c"
+			  "\x23\x2a\x31\x38\x3f\x46\x4d\x54"
+			  "\x5b\x62\x69\x70\x77\x7e\x85\x8c"
+			  "\x93\x9a\xa1\xa8\xaf\xb6\xbd\xc4"
+			  "\xcb\xd2\xd9\xe0\xe7\xee\xf5\xfc"
+			  "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30",
+		.rlen	= 300,
 	}
 };
 
@@ -19066,6 +19413,967 @@ static struct aead_testvec aes_ccm_rfc4309_dec_tv_template[] = {
 	},
 };
 
+/*
+ * ChaCha20-Poly1305 AEAD test vectors from RFC7539 2.8.2., plus a longer
+ * one.  The rfc7539esp vectors are the same with the first four IV bytes
+ * moved to the end of the key.
+ */
+#define RFC7539_ENC_TEST_VECTORS 2
+static struct aead_testvec rfc7539_enc_tv_template[] = {
+	{ /* RFC7539 2.8.2. Test Vector */
+		.key	= "\x80\x81\x82\x83\x84\x85\x86\x87"
+			  "\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+			  "\x90\x91\x92\x93\x94\x95\x96\x97"
+			  "\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f",
+		.klen	= 32,
+		.iv	= "\x07\x00\x00\x00\x40\x41\x42\x43"
+			  "\x44\x45\x46\x47",
+		.assoc	= "\x50\x51\x52\x53\xc0\xc1\xc2\xc3"
+			  "\xc4\xc5\xc6\xc7",
+		.alen	= 12,
+		.input	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.ilen	= 114,
+		.result	= "\xd3\x1a\x8d\x34\x64\x8e\x60\xdb"
+			  "\x7b\x86\xaf\xbc\x53\xef\x7e\xc2"
+			  "\xa4\xad\xed\x51\x29\x6e\x08\xfe"
+			  "\xa9\xe2\xb5\xa7\x36\xee\x62\xd6"
+			  "\x3d\xbe\xa4\x5e\x8c\xa9\x67\x12"
+			  "\x82\xfa\xfb\x69\xda\x92\x72\x8b"
+			  "\x1a\x71\xde\x0a\x9e\x06\x0b\x29"
+			  "\x05\xd6\xa5\xb6\x7e\xcd\x3b\x36"
+			  "\x92\xdd\xbd\x7f\x2d\x77\x8b\x8c"
+			  "\x98\x03\xae\xe3\x28\x09\x1b\x58"
+			  "\xfa\xb3\x24\xe4\xfa\xd6\x75\x94"
+			  "\x55\x85\x80\x8b\x48\x31\xd7\xbc"
+			  "\x3f\xf4\xde\xf0\x8e\x4b\x7a\x9d"
+			  "\xe5\x76\xd2\x65\x86\xce\xc6\x4b"
+			  "\x61\x16\x1a\xe1\x0b\x59\x4f\x09"
+			  "\xe2\x6a\x7e\x90\x2e\xcb\xd0\x60"
+			  "\x06\x91",
+		.rlen	= 130,
+	}, { /* Long enough for the SIMD paths */
+		.key	= "\x77\x7a\x7d\x80\x83\x86\x89\x8c"
+			  "\x8f\x92\x95\x98\x9b\x9e\xa1\xa4"
+			  "\xa7\xaa\xad\xb0\xb3\xb6\xb9\xbc"
+			  "\xbf\xc2\xc5\xc8\xcb\xce\xd1\xd4",
+		.klen	= 32,
+		.iv	= "\x01\x0a\x13\x1c\x25\x2e\x37\x40"
+			  "\x49\x52\x5b\x64",
+		.assoc	= "\x02\x13\x24\x35\x46\x57\x68\x79"
+			  "\x8a\x9b\xac\xbd\xce\xdf\xf0\x01"
+			  "\x12\x23\x34\x45",
+		.alen	= 20,
+		.input	= "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3",
+		.ilen	= 600,
+		.result	= "\xc1\xed\x76\xb9\x4f\xee\x8b\xc6"
+			  "\xfe\x25\xd5\xc3\xf5\xd6\xb0\xae"
+			  "\xa3\x1f\xaa\x44\x98\x25\x32\x75"
+			  "\xb9\x74\x8a\x7a\x36\x33\x52\xcc"
+			  "\x3b\x8c\xbe\x96\x06\x35\xab\xf3"
+			  "\x04\xee\x77\xa5\x2f\x3f\x4f\x95"
+			  "\xb4\xb7\x78\xc8\x44\x72\x88\xfe"
+			  "\x79\x20\x29\x61\x9a\xd4\x18\x60"
+			  "\xf3\x60\xec\x43\xd9\x67\xc3\x48"
+			  "\x2b\x8e\xc4\x9d\x23\x27\x72\xce"
+			  "\xcf\xb8\x83\xf3\x2d\x5b\x74\x9f"
+			  "\x02\x64\x36\x8f\x4c\x24\x3f\x42"
+			  "\xdf\xaa\xc9\x24\x4e\xf9\x2c\x0d"
+			  "\x6a\xef\x45\xa0\x1a\x84\xd7\x8d"
+			  "\x0c\x58\x91\x44\xab\x18\x22\xe1"
+			  "\xe4\xe8\x8e\x8e\x3c\x6c\x1f\x29"
+			  "\x1a\x0a\xe2\xa4\x2b\x1f\xed\x1c"
+			  "\x63\x67\x11\x14\x52\xfe\xc8\x8f"
+			  "\xd2\xa7\x26\x35\x74\xd2\xe3\x9c"
+			  "\x94\x7b\xf7\x8e\xfe\x35\xa9\x33"
+			  "\x66\x39\x76\xe4\xbe\x52\xab\x5c"
+			  "\x24\xea\x67\xd3\xbb\x9f\x52\xf9"
+			  "\x30\xf0\x43\x48\xed\xfb\xfd\x8f"
+			  "\xf5\xe7\x30\xc7\x72\x66\x79\x13"
+			  "\x86\x36\xf2\x78\x55\x3d\x5a\x10"
+			  "\x25\x12\xd7\x27\x97\xbf\xc7\xd3"
+			  "\x4f\x5f\xaf\x6d\x84\x23\x1a\x32"
+			  "\x9e\x43\xe7\xfe\xd2\x86\x2e\xee"
+			  "\x1d\x0d\x34\x43\x8b\x74\x67\x27"
+			  "\x8e\xde\xc1\x87\x9e\x56\x01\x87"
+			  "\x05\x9b\x62\xf7\x26\x46\x75\x40"
+			  "\x23\x09\x97\xce\x24\x89\xa0\xc6"
+			  "\x6e\x3c\x91\xc6\xc7\xf6\x56\xce"
+			  "\x7b\x34\x4e\xe0\x75\xa1\x99\x1a"
+			  "\x83\xb8\xc7\xb0\x17\xf4\x9d\xcd"
+			  "\xb8\xb2\xf1\x16\x64\x2b\x8c\xa4"
+			  "\x59\xec\x92\xd9\x11\x2b\xa3\x7f"
+			  "\x96\xe4\x11\x86\xff\xfb\xbc\x82"
+			  "\xfd\xde\x5c\xbc\x3b\x84\x41\x14"
+			  "\xf5\x1e\x96\x93\x69\x1a\x7f\x7b"
+			  "\x4f\x6b\x32\x97\x60\x3d\xbf\x2d"
+			  "\x8a\x4c\x1e\x39\xe8\xae\x16\xc2"
+			  "\xa7\x8f\x77\xe9\xa0\x42\x4b\x7b"
+			  "\xd9\x07\x12\xe1\xc7\x8e\x45\xa0"
+			  "\xda\x7c\x32\x8b\x7a\xa7\xc6\x55"
+			  "\x1c\xd9\x9f\x72\xc5\x78\x88\x4e"
+			  "\xe2\x15\x93\x68\x57\x63\xda\xf2"
+			  "\x80\x7b\x27\x88\xee\xfd\x3a\x2b"
+			  "\x31\xcb\xf7\x1d\x6c\xfd\x70\x0c"
+			  "\xf0\xed\x24\xb5\x0b\x63\xf1\xd2"
+			  "\xf9\xd9\x7c\xb3\x43\x5a\xdd\xf4"
+			  "\x65\xf4\xf9\x0f\x98\x08\x43\x4e"
+			  "\xb1\x8b\xc9\x70\x7c\xf4\x42\x29"
+			  "\xc3\x66\xe6\x38\x6a\xc6\xb4\xa4"
+			  "\xc4\x27\xb4\xed\xa6\x39\x7d\xd2"
+			  "\x0a\x7f\xbd\xd6\x4c\xf1\x70\x64"
+			  "\x0b\xc6\x55\xe4\x21\xd2\xc8\x8b"
+			  "\x56\x30\x5d\xf9\x91\x5c\xb3\x23"
+			  "\xdb\x33\x0c\x53\x37\xa2\x96\x74"
+			  "\x78\x99\xae\x6c\x50\x28\xba\x91"
+			  "\x50\x4a\x8d\xb0\x13\xab\x01\xec"
+			  "\x4a\x2b\xb1\xf1\x66\xa6\xf7\x09"
+			  "\xe8\x9d\x54\x23\x8c\xd7\x4c\x10"
+			  "\x7f\xe2\x38\x67\x01\x4c\x4a\xa2"
+			  "\x88\x6a\x51\x75\x07\xa3\x18\xa1"
+			  "\x35\xd5\xca\x40\x33\xa9\xbc\x6f"
+			  "\x8e\xc3\xec\xbe\x1c\xe9\xe0\xb4"
+			  "\x29\x32\x7d\xd0\xbf\x79\xfb\xd9"
+			  "\xb1\x8d\x1d\x24\x82\x3b\x8a\xf0"
+			  "\x3e\xe1\xc0\x25\x52\x1c\x35\xda"
+			  "\xbb\x38\x04\xee\x1b\x2a\x19\x4b"
+			  "\x9a\xe0\x4b\x40\xf5\x32\xfa\x05"
+			  "\x9a\xed\xfc\xa1\x37\x91\xeb\xa1"
+			  "\x8d\x45\x1a\x08\x4f\x80\x55\x86"
+			  "\x84\x48\xfe\x20\xee\x30\xa0\xb4"
+			  "\x4d\xf0\x6b\x2c\x7e\xd1\xf6\x5e"
+			  "\x1b\xe7\x0f\x99\x12\x0c\xff\x69",
+		.rlen	= 616,
+	},
+};
+
+#define RFC7539_DEC_TEST_VECTORS 3
+static struct aead_testvec rfc7539_dec_tv_template[] = {
+	{ /* RFC7539 2.8.2. Test Vector */
+		.key	= "\x80\x81\x82\x83\x84\x85\x86\x87"
+			  "\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+			  "\x90\x91\x92\x93\x94\x95\x96\x97"
+			  "\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f",
+		.klen	= 32,
+		.iv	= "\x07\x00\x00\x00\x40\x41\x42\x43"
+			  "\x44\x45\x46\x47",
+		.assoc	= "\x50\x51\x52\x53\xc0\xc1\xc2\xc3"
+			  "\xc4\xc5\xc6\xc7",
+		.alen	= 12,
+		.input	= "\xd3\x1a\x8d\x34\x64\x8e\x60\xdb"
+			  "\x7b\x86\xaf\xbc\x53\xef\x7e\xc2"
+			  "\xa4\xad\xed\x51\x29\x6e\x08\xfe"
+			  "\xa9\xe2\xb5\xa7\x36\xee\x62\xd6"
+			  "\x3d\xbe\xa4\x5e\x8c\xa9\x67\x12"
+			  "\x82\xfa\xfb\x69\xda\x92\x72\x8b"
+			  "\x1a\x71\xde\x0a\x9e\x06\x0b\x29"
+			  "\x05\xd6\xa5\xb6\x7e\xcd\x3b\x36"
+			  "\x92\xdd\xbd\x7f\x2d\x77\x8b\x8c"
+			  "\x98\x03\xae\xe3\x28\x09\x1b\x58"
+			  "\xfa\xb3\x24\xe4\xfa\xd6\x75\x94"
+			  "\x55\x85\x80\x8b\x48\x31\xd7\xbc"
+			  "\x3f\xf4\xde\xf0\x8e\x4b\x7a\x9d"
+			  "\xe5\x76\xd2\x65\x86\xce\xc6\x4b"
+			  "\x61\x16\x1a\xe1\x0b\x59\x4f\x09"
+			  "\xe2\x6a\x7e\x90\x2e\xcb\xd0\x60"
+			  "\x06\x91",
+		.ilen	= 130,
+		.result	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.rlen	= 114,
+	}, { /* Same, with a corrupted tag */
+		.key	= "\x80\x81\x82\x83\x84\x85\x86\x87"
+			  "\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+			  "\x90\x91\x92\x93\x94\x95\x96\x97"
+			  "\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f",
+		.klen	= 32,
+		.iv	= "\x07\x00\x00\x00\x40\x41\x42\x43"
+			  "\x44\x45\x46\x47",
+		.assoc	= "\x50\x51\x52\x53\xc0\xc1\xc2\xc3"
+			  "\xc4\xc5\xc6\xc7",
+		.alen	= 12,
+		.input	= "\xd3\x1a\x8d\x34\x64\x8e\x60\xdb"
+			  "\x7b\x86\xaf\xbc\x53\xef\x7e\xc2"
+			  "\xa4\xad\xed\x51\x29\x6e\x08\xfe"
+			  "\xa9\xe2\xb5\xa7\x36\xee\x62\xd6"
+			  "\x3d\xbe\xa4\x5e\x8c\xa9\x67\x12"
+			  "\x82\xfa\xfb\x69\xda\x92\x72\x8b"
+			  "\x1a\x71\xde\x0a\x9e\x06\x0b\x29"
+			  "\x05\xd6\xa5\xb6\x7e\xcd\x3b\x36"
+			  "\x92\xdd\xbd\x7f\x2d\x77\x8b\x8c"
+			  "\x98\x03\xae\xe3\x28\x09\x1b\x58"
+			  "\xfa\xb3\x24\xe4\xfa\xd6\x75\x94"
+			  "\x55\x85\x80\x8b\x48\x31\xd7\xbc"
+			  "\x3f\xf4\xde\xf0\x8e\x4b\x7a\x9d"
+			  "\xe5\x76\xd2\x65\x86\xce\xc6\x4b"
+			  "\x61\x16\x1a\xe1\x0b\x59\x4f\x09"
+			  "\xe2\x6a\x7e\x90\x2e\xcb\xd0\x60"
+			  "\x06\x90",
+		.ilen	= 130,
+		.result	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.rlen	= 114,
+		.novrfy	= 1,
+	}, { /* Long enough for the SIMD paths */
+		.key	= "\x77\x7a\x7d\x80\x83\x86\x89\x8c"
+			  "\x8f\x92\x95\x98\x9b\x9e\xa1\xa4"
+			  "\xa7\xaa\xad\xb0\xb3\xb6\xb9\xbc"
+			  "\xbf\xc2\xc5\xc8\xcb\xce\xd1\xd4",
+		.klen	= 32,
+		.iv	= "\x01\x0a\x13\x1c\x25\x2e\x37\x40"
+			  "\x49\x52\x5b\x64",
+		.assoc	= "\x02\x13\x24\x35\x46\x57\x68\x79"
+			  "\x8a\x9b\xac\xbd\xce\xdf\xf0\x01"
+			  "\x12\x23\x34\x45",
+		.alen	= 20,
+		.input	= "\xc1\xed\x76\xb9\x4f\xee\x8b\xc6"
+			  "\xfe\x25\xd5\xc3\xf5\xd6\xb0\xae"
+			  "\xa3\x1f\xaa\x44\x98\x25\x32\x75"
+			  "\xb9\x74\x8a\x7a\x36\x33\x52\xcc"
+			  "\x3b\x8c\xbe\x96\x06\x35\xab\xf3"
+			  "\x04\xee\x77\xa5\x2f\x3f\x4f\x95"
+			  "\xb4\xb7\x78\xc8\x44\x72\x88\xfe"
+			  "\x79\x20\x29\x61\x9a\xd4\x18\x60"
+			  "\xf3\x60\xec\x43\xd9\x67\xc3\x48"
+			  "\x2b\x8e\xc4\x9d\x23\x27\x72\xce"
+			  "\xcf\xb8\x83\xf3\x2d\x5b\x74\x9f"
+			  "\x02\x64\x36\x8f\x4c\x24\x3f\x42"
+			  "\xdf\xaa\xc9\x24\x4e\xf9\x2c\x0d"
+			  "\x6a\xef\x45\xa0\x1a\x84\xd7\x8d"
+			  "\x0c\x58\x91\x44\xab\x18\x22\xe1"
+			  "\xe4\xe8\x8e\x8e\x3c\x6c\x1f\x29"
+			  "\x1a\x0a\xe2\xa4\x2b\x1f\xed\x1c"
+			  "\x63\x67\x11\x14\x52\xfe\xc8\x8f"
+			  "\xd2\xa7\x26\x35\x74\xd2\xe3\x9c"
+			  "\x94\x7b\xf7\x8e\xfe\x35\xa9\x33"
+			  "\x66\x39\x76\xe4\xbe\x52\xab\x5c"
+			  "\x24\xea\x67\xd3\xbb\x9f\x52\xf9"
+			  "\x30\xf0\x43\x48\xed\xfb\xfd\x8f"
+			  "\xf5\xe7\x30\xc7\x72\x66\x79\x13"
+			  "\x86\x36\xf2\x78\x55\x3d\x5a\x10"
+			  "\x25\x12\xd7\x27\x97\xbf\xc7\xd3"
+			  "\x4f\x5f\xaf\x6d\x84\x23\x1a\x32"
+			  "\x9e\x43\xe7\xfe\xd2\x86\x2e\xee"
+			  "\x1d\x0d\x34\x43\x8b\x74\x67\x27"
+			  "\x8e\xde\xc1\x87\x9e\x56\x01\x87"
+			  "\x05\x9b\x62\xf7\x26\x46\x75\x40"
+			  "\x23\x09\x97\xce\x24\x89\xa0\xc6"
+			  "\x6e\x3c\x91\xc6\xc7\xf6\x56\xce"
+			  "\x7b\x34\x4e\xe0\x75\xa1\x99\x1a"
+			  "\x83\xb8\xc7\xb0\x17\xf4\x9d\xcd"
+			  "\xb8\xb2\xf1\x16\x64\x2b\x8c\xa4"
+			  "\x59\xec\x92\xd9\x11\x2b\xa3\x7f"
+			  "\x96\xe4\x11\x86\xff\xfb\xbc\x82"
+			  "\xfd\xde\x5c\xbc\x3b\x84\x41\x14"
+			  "\xf5\x1e\x96\x93\x69\x1a\x7f\x7b"
+			  "\x4f\x6b\x32\x97\x60\x3d\xbf\x2d"
+			  "\x8a\x4c\x1e\x39\xe8\xae\x16\xc2"
+			  "\xa7\x8f\x77\xe9\xa0\x42\x4b\x7b"
+			  "\xd9\x07\x12\xe1\xc7\x8e\x45\xa0"
+			  "\xda\x7c\x32\x8b\x7a\xa7\xc6\x55"
+			  "\x1c\xd9\x9f\x72\xc5\x78\x88\x4e"
+			  "\xe2\x15\x93\x68\x57\x63\xda\xf2"
+			  "\x80\x7b\x27\x88\xee\xfd\x3a\x2b"
+			  "\x31\xcb\xf7\x1d\x6c\xfd\x70\x0c"
+			  "\xf0\xed\x24\xb5\x0b\x63\xf1\xd2"
+			  "\xf9\xd9\x7c\xb3\x43\x5a\xdd\xf4"
+			  "\x65\xf4\xf9\x0f\x98\x08\x43\x4e"
+			  "\xb1\x8b\xc9\x70\x7c\xf4\x42\x29"
+			  "\xc3\x66\xe6\x38\x6a\xc6\xb4\xa4"
+			  "\xc4\x27\xb4\xed\xa6\x39\x7d\xd2"
+			  "\x0a\x7f\xbd\xd6\x4c\xf1\x70\x64"
+			  "\x0b\xc6\x55\xe4\x21\xd2\xc8\x8b"
+			  "\x56\x30\x5d\xf9\x91\x5c\xb3\x23"
+			  "\xdb\x33\x0c\x53\x37\xa2\x96\x74"
+			  "\x78\x99\xae\x6c\x50\x28\xba\x91"
+			  "\x50\x4a\x8d\xb0\x13\xab\x01\xec"
+			  "\x4a\x2b\xb1\xf1\x66\xa6\xf7\x09"
+			  "\xe8\x9d\x54\x23\x8c\xd7\x4c\x10"
+			  "\x7f\xe2\x38\x67\x01\x4c\x4a\xa2"
+			  "\x88\x6a\x51\x75\x07\xa3\x18\xa1"
+			  "\x35\xd5\xca\x40\x33\xa9\xbc\x6f"
+			  "\x8e\xc3\xec\xbe\x1c\xe9\xe0\xb4"
+			  "\x29\x32\x7d\xd0\xbf\x79\xfb\xd9"
+			  "\xb1\x8d\x1d\x24\x82\x3b\x8a\xf0"
+			  "\x3e\xe1\xc0\x25\x52\x1c\x35\xda"
+			  "\xbb\x38\x04\xee\x1b\x2a\x19\x4b"
+			  "\x9a\xe0\x4b\x40\xf5\x32\xfa\x05"
+			  "\x9a\xed\xfc\xa1\x37\x91\xeb\xa1"
+			  "\x8d\x45\x1a\x08\x4f\x80\x55\x86"
+			  "\x84\x48\xfe\x20\xee\x30\xa0\xb4"
+			  "\x4d\xf0\x6b\x2c\x7e\xd1\xf6\x5e"
+			  "\x1b\xe7\x0f\x99\x12\x0c\xff\x69",
+		.ilen	= 616,
+		.result	= "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3",
+		.rlen	= 600,
+	},
+};
+
+#define RFC7539ESP_ENC_TEST_VECTORS 2
+static struct aead_testvec rfc7539esp_enc_tv_template[] = {
+	{ /* RFC7539 2.8.2. Test Vector */
+		.key	= "\x80\x81\x82\x83\x84\x85\x86\x87"
+			  "\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+			  "\x90\x91\x92\x93\x94\x95\x96\x97"
+			  "\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f"
+			  "\x07\x00\x00\x00",
+		.klen	= 36,
+		.iv	= "\x40\x41\x42\x43\x44\x45\x46\x47",
+		.assoc	= "\x50\x51\x52\x53\xc0\xc1\xc2\xc3"
+			  "\xc4\xc5\xc6\xc7",
+		.alen	= 12,
+		.input	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.ilen	= 114,
+		.result	= "\xd3\x1a\x8d\x34\x64\x8e\x60\xdb"
+			  "\x7b\x86\xaf\xbc\x53\xef\x7e\xc2"
+			  "\xa4\xad\xed\x51\x29\x6e\x08\xfe"
+			  "\xa9\xe2\xb5\xa7\x36\xee\x62\xd6"
+			  "\x3d\xbe\xa4\x5e\x8c\xa9\x67\x12"
+			  "\x82\xfa\xfb\x69\xda\x92\x72\x8b"
+			  "\x1a\x71\xde\x0a\x9e\x06\x0b\x29"
+			  "\x05\xd6\xa5\xb6\x7e\xcd\x3b\x36"
+			  "\x92\xdd\xbd\x7f\x2d\x77\x8b\x8c"
+			  "\x98\x03\xae\xe3\x28\x09\x1b\x58"
+			  "\xfa\xb3\x24\xe4\xfa\xd6\x75\x94"
+			  "\x55\x85\x80\x8b\x48\x31\xd7\xbc"
+			  "\x3f\xf4\xde\xf0\x8e\x4b\x7a\x9d"
+			  "\xe5\x76\xd2\x65\x86\xce\xc6\x4b"
+			  "\x61\x16\x1a\xe1\x0b\x59\x4f\x09"
+			  "\xe2\x6a\x7e\x90\x2e\xcb\xd0\x60"
+			  "\x06\x91",
+		.rlen	= 130,
+	}, { /* Long enough for the SIMD paths */
+		.key	= "\x77\x7a\x7d\x80\x83\x86\x89\x8c"
+			  "\x8f\x92\x95\x98\x9b\x9e\xa1\xa4"
+			  "\xa7\xaa\xad\xb0\xb3\xb6\xb9\xbc"
+			  "\xbf\xc2\xc5\xc8\xcb\xce\xd1\xd4"
+			  "\x01\x0a\x13\x1c",
+		.klen	= 36,
+		.iv	= "\x25\x2e\x37\x40\x49\x52\x5b\x64",
+		.assoc	= "\x02\x13\x24\x35\x46\x57\x68\x79"
+			  "\x8a\x9b\xac\xbd\xce\xdf\xf0\x01"
+			  "\x12\x23\x34\x45",
+		.alen	= 20,
+		.input	= "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3",
+		.ilen	= 600,
+		.result	= "\xc1\xed\x76\xb9\x4f\xee\x8b\xc6"
+			  "\xfe\x25\xd5\xc3\xf5\xd6\xb0\xae"
+			  "\xa3\x1f\xaa\x44\x98\x25\x32\x75"
+			  "\xb9\x74\x8a\x7a\x36\x33\x52\xcc"
+			  "\x3b\x8c\xbe\x96\x06\x35\xab\xf3"
+			  "\x04\xee\x77\xa5\x2f\x3f\x4f\x95"
+			  "\xb4\xb7\x78\xc8\x44\x72\x88\xfe"
+			  "\x79\x20\x29\x61\x9a\xd4\x18\x60"
+			  "\xf3\x60\xec\x43\xd9\x67\xc3\x48"
+			  "\x2b\x8e\xc4\x9d\x23\x27\x72\xce"
+			  "\xcf\xb8\x83\xf3\x2d\x5b\x74\x9f"
+			  "\x02\x64\x36\x8f\x4c\x24\x3f\x42"
+			  "\xdf\xaa\xc9\x24\x4e\xf9\x2c\x0d"
+			  "\x6a\xef\x45\xa0\x1a\x84\xd7\x8d"
+			  "\x0c\x58\x91\x44\xab\x18\x22\xe1"
+			  "\xe4\xe8\x8e\x8e\x3c\x6c\x1f\x29"
+			  "\x1a\x0a\xe2\xa4\x2b\x1f\xed\x1c"
+			  "\x63\x67\x11\x14\x52\xfe\xc8\x8f"
+			  "\xd2\xa7\x26\x35\x74\xd2\xe3\x9c"
+			  "\x94\x7b\xf7\x8e\xfe\x35\xa9\x33"
+			  "\x66\x39\x76\xe4\xbe\x52\xab\x5c"
+			  "\x24\xea\x67\xd3\xbb\x9f\x52\xf9"
+			  "\x30\xf0\x43\x48\xed\xfb\xfd\x8f"
+			  "\xf5\xe7\x30\xc7\x72\x66\x79\x13"
+			  "\x86\x36\xf2\x78\x55\x3d\x5a\x10"
+			  "\x25\x12\xd7\x27\x97\xbf\xc7\xd3"
+			  "\x4f\x5f\xaf\x6d\x84\x23\x1a\x32"
+			  "\x9e\x43\xe7\xfe\xd2\x86\x2e\xee"
+			  "\x1d\x0d\x34\x43\x8b\x74\x67\x27"
+			  "\x8e\xde\xc1\x87\x9e\x56\x01\x87"
+			  "\x05\x9b\x62\xf7\x26\x46\x75\x40"
+			  "\x23\x09\x97\xce\x24\x89\xa0\xc6"
+			  "\x6e\x3c\x91\xc6\xc7\xf6\x56\xce"
+			  "\x7b\x34\x4e\xe0\x75\xa1\x99\x1a"
+			  "\x83\xb8\xc7\xb0\x17\xf4\x9d\xcd"
+			  "\xb8\xb2\xf1\x16\x64\x2b\x8c\xa4"
+			  "\x59\xec\x92\xd9\x11\x2b\xa3\x7f"
+			  "\x96\xe4\x11\x86\xff\xfb\xbc\x82"
+			  "\xfd\xde\x5c\xbc\x3b\x84\x41\x14"
+			  "\xf5\x1e\x96\x93\x69\x1a\x7f\x7b"
+			  "\x4f\x6b\x32\x97\x60\x3d\xbf\x2d"
+			  "\x8a\x4c\x1e\x39\xe8\xae\x16\xc2"
+			  "\xa7\x8f\x77\xe9\xa0\x42\x4b\x7b"
+			  "\xd9\x07\x12\xe1\xc7\x8e\x45\xa0"
+			  "\xda\x7c\x32\x8b\x7a\xa7\xc6\x55"
+			  "\x1c\xd9\x9f\x72\xc5\x78\x88\x4e"
+			  "\xe2\x15\x93\x68\x57\x63\xda\xf2"
+			  "\x80\x7b\x27\x88\xee\xfd\x3a\x2b"
+			  "\x31\xcb\xf7\x1d\x6c\xfd\x70\x0c"
+			  "\xf0\xed\x24\xb5\x0b\x63\xf1\xd2"
+			  "\xf9\xd9\x7c\xb3\x43\x5a\xdd\xf4"
+			  "\x65\xf4\xf9\x0f\x98\x08\x43\x4e"
+			  "\xb1\x8b\xc9\x70\x7c\xf4\x42\x29"
+			  "\xc3\x66\xe6\x38\x6a\xc6\xb4\xa4"
+			  "\xc4\x27\xb4\xed\xa6\x39\x7d\xd2"
+			  "\x0a\x7f\xbd\xd6\x4c\xf1\x70\x64"
+			  "\x0b\xc6\x55\xe4\x21\xd2\xc8\x8b"
+			  "\x56\x30\x5d\xf9\x91\x5c\xb3\x23"
+			  "\xdb\x33\x0c\x53\x37\xa2\x96\x74"
+			  "\x78\x99\xae\x6c\x50\x28\xba\x91"
+			  "\x50\x4a\x8d\xb0\x13\xab\x01\xec"
+			  "\x4a\x2b\xb1\xf1\x66\xa6\xf7\x09"
+			  "\xe8\x9d\x54\x23\x8c\xd7\x4c\x10"
+			  "\x7f\xe2\x38\x67\x01\x4c\x4a\xa2"
+			  "\x88\x6a\x51\x75\x07\xa3\x18\xa1"
+			  "\x35\xd5\xca\x40\x33\xa9\xbc\x6f"
+			  "\x8e\xc3\xec\xbe\x1c\xe9\xe0\xb4"
+			  "\x29\x32\x7d\xd0\xbf\x79\xfb\xd9"
+			  "\xb1\x8d\x1d\x24\x82\x3b\x8a\xf0"
+			  "\x3e\xe1\xc0\x25\x52\x1c\x35\xda"
+			  "\xbb\x38\x04\xee\x1b\x2a\x19\x4b"
+			  "\x9a\xe0\x4b\x40\xf5\x32\xfa\x05"
+			  "\x9a\xed\xfc\xa1\x37\x91\xeb\xa1"
+			  "\x8d\x45\x1a\x08\x4f\x80\x55\x86"
+			  "\x84\x48\xfe\x20\xee\x30\xa0\xb4"
+			  "\x4d\xf0\x6b\x2c\x7e\xd1\xf6\x5e"
+			  "\x1b\xe7\x0f\x99\x12\x0c\xff\x69",
+		.rlen	= 616,
+	},
+};
+
+#define RFC7539ESP_DEC_TEST_VECTORS 3
+static struct aead_testvec rfc7539esp_dec_tv_template[] = {
+	{ /* RFC7539 2.8.2. Test Vector */
+		.key	= "\x80\x81\x82\x83\x84\x85\x86\x87"
+			  "\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+			  "\x90\x91\x92\x93\x94\x95\x96\x97"
+			  "\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f"
+			  "\x07\x00\x00\x00",
+		.klen	= 36,
+		.iv	= "\x40\x41\x42\x43\x44\x45\x46\x47",
+		.assoc	= "\x50\x51\x52\x53\xc0\xc1\xc2\xc3"
+			  "\xc4\xc5\xc6\xc7",
+		.alen	= 12,
+		.input	= "\xd3\x1a\x8d\x34\x64\x8e\x60\xdb"
+			  "\x7b\x86\xaf\xbc\x53\xef\x7e\xc2"
+			  "\xa4\xad\xed\x51\x29\x6e\x08\xfe"
+			  "\xa9\xe2\xb5\xa7\x36\xee\x62\xd6"
+			  "\x3d\xbe\xa4\x5e\x8c\xa9\x67\x12"
+			  "\x82\xfa\xfb\x69\xda\x92\x72\x8b"
+			  "\x1a\x71\xde\x0a\x9e\x06\x0b\x29"
+			  "\x05\xd6\xa5\xb6\x7e\xcd\x3b\x36"
+			  "\x92\xdd\xbd\x7f\x2d\x77\x8b\x8c"
+			  "\x98\x03\xae\xe3\x28\x09\x1b\x58"
+			  "\xfa\xb3\x24\xe4\xfa\xd6\x75\x94"
+			  "\x55\x85\x80\x8b\x48\x31\xd7\xbc"
+			  "\x3f\xf4\xde\xf0\x8e\x4b\x7a\x9d"
+			  "\xe5\x76\xd2\x65\x86\xce\xc6\x4b"
+			  "\x61\x16\x1a\xe1\x0b\x59\x4f\x09"
+			  "\xe2\x6a\x7e\x90\x2e\xcb\xd0\x60"
+			  "\x06\x91",
+		.ilen	= 130,
+		.result	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.rlen	= 114,
+	}, { /* Same, with a corrupted tag */
+		.key	= "\x80\x81\x82\x83\x84\x85\x86\x87"
+			  "\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f"
+			  "\x90\x91\x92\x93\x94\x95\x96\x97"
+			  "\x98\x99\x9a\x9b\x9c\x9d\x9e\x9f"
+			  "\x07\x00\x00\x00",
+		.klen	= 36,
+		.iv	= "\x40\x41\x42\x43\x44\x45\x46\x47",
+		.assoc	= "\x50\x51\x52\x53\xc0\xc1\xc2\xc3"
+			  "\xc4\xc5\xc6\xc7",
+		.alen	= 12,
+		.input	= "\xd3\x1a\x8d\x34\x64\x8e\x60\xdb"
+			  "\x7b\x86\xaf\xbc\x53\xef\x7e\xc2"
+			  "\xa4\xad\xed\x51\x29\x6e\x08\xfe"
+			  "\xa9\xe2\xb5\xa7\x36\xee\x62\xd6"
+			  "\x3d\xbe\xa4\x5e\x8c\xa9\x67\x12"
+			  "\x82\xfa\xfb\x69\xda\x92\x72\x8b"
+			  "\x1a\x71\xde\x0a\x9e\x06\x0b\x29"
+			  "\x05\xd6\xa5\xb6\x7e\xcd\x3b\x36"
+			  "\x92\xdd\xbd\x7f\x2d\x77\x8b\x8c"
+			  "\x98\x03\xae\xe3\x28\x09\x1b\x58"
+			  "\xfa\xb3\x24\xe4\xfa\xd6\x75\x94"
+			  "\x55\x85\x80\x8b\x48\x31\xd7\xbc"
+			  "\x3f\xf4\xde\xf0\x8e\x4b\x7a\x9d"
+			  "\xe5\x76\xd2\x65\x86\xce\xc6\x4b"
+			  "\x61\x16\x1a\xe1\x0b\x59\x4f\x09"
+			  "\xe2\x6a\x7e\x90\x2e\xcb\xd0\x60"
+			  "\x06\x90",
+		.ilen	= 130,
+		.result	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.rlen	= 114,
+		.novrfy	= 1,
+	}, { /* Long enough for the SIMD paths */
+		.key	= "\x77\x7a\x7d\x80\x83\x86\x89\x8c"
+			  "\x8f\x92\x95\x98\x9b\x9e\xa1\xa4"
+			  "\xa7\xaa\xad\xb0\xb3\xb6\xb9\xbc"
+			  "\xbf\xc2\xc5\xc8\xcb\xce\xd1\xd4"
+			  "\x01\x0a\x13\x1c",
+		.klen	= 36,
+		.iv	= "\x25\x2e\x37\x40\x49\x52\x5b\x64",
+		.assoc	= "\x02\x13\x24\x35\x46\x57\x68\x79"
+			  "\x8a\x9b\xac\xbd\xce\xdf\xf0\x01"
+			  "\x12\x23\x34\x45",
+		.alen	= 20,
+		.input	= "\xc1\xed\x76\xb9\x4f\xee\x8b\xc6"
+			  "\xfe\x25\xd5\xc3\xf5\xd6\xb0\xae"
+			  "\xa3\x1f\xaa\x44\x98\x25\x32\x75"
+			  "\xb9\x74\x8a\x7a\x36\x33\x52\xcc"
+			  "\x3b\x8c\xbe\x96\x06\x35\xab\xf3"
+			  "\x04\xee\x77\xa5\x2f\x3f\x4f\x95"
+			  "\xb4\xb7\x78\xc8\x44\x72\x88\xfe"
+			  "\x79\x20\x29\x61\x9a\xd4\x18\x60"
+			  "\xf3\x60\xec\x43\xd9\x67\xc3\x48"
+			  "\x2b\x8e\xc4\x9d\x23\x27\x72\xce"
+			  "\xcf\xb8\x83\xf3\x2d\x5b\x74\x9f"
+			  "\x02\x64\x36\x8f\x4c\x24\x3f\x42"
+			  "\xdf\xaa\xc9\x24\x4e\xf9\x2c\x0d"
+			  "\x6a\xef\x45\xa0\x1a\x84\xd7\x8d"
+			  "\x0c\x58\x91\x44\xab\x18\x22\xe1"
+			  "\xe4\xe8\x8e\x8e\x3c\x6c\x1f\x29"
+			  "\x1a\x0a\xe2\xa4\x2b\x1f\xed\x1c"
+			  "\x63\x67\x11\x14\x52\xfe\xc8\x8f"
+			  "\xd2\xa7\x26\x35\x74\xd2\xe3\x9c"
+			  "\x94\x7b\xf7\x8e\xfe\x35\xa9\x33"
+			  "\x66\x39\x76\xe4\xbe\x52\xab\x5c"
+			  "\x24\xea\x67\xd3\xbb\x9f\x52\xf9"
+			  "\x30\xf0\x43\x48\xed\xfb\xfd\x8f"
+			  "\xf5\xe7\x30\xc7\x72\x66\x79\x13"
+			  "\x86\x36\xf2\x78\x55\x3d\x5a\x10"
+			  "\x25\x12\xd7\x27\x97\xbf\xc7\xd3"
+			  "\x4f\x5f\xaf\x6d\x84\x23\x1a\x32"
+			  "\x9e\x43\xe7\xfe\xd2\x86\x2e\xee"
+			  "\x1d\x0d\x34\x43\x8b\x74\x67\x27"
+			  "\x8e\xde\xc1\x87\x9e\x56\x01\x87"
+			  "\x05\x9b\x62\xf7\x26\x46\x75\x40"
+			  "\x23\x09\x97\xce\x24\x89\xa0\xc6"
+			  "\x6e\x3c\x91\xc6\xc7\xf6\x56\xce"
+			  "\x7b\x34\x4e\xe0\x75\xa1\x99\x1a"
+			  "\x83\xb8\xc7\xb0\x17\xf4\x9d\xcd"
+			  "\xb8\xb2\xf1\x16\x64\x2b\x8c\xa4"
+			  "\x59\xec\x92\xd9\x11\x2b\xa3\x7f"
+			  "\x96\xe4\x11\x86\xff\xfb\xbc\x82"
+			  "\xfd\xde\x5c\xbc\x3b\x84\x41\x14"
+			  "\xf5\x1e\x96\x93\x69\x1a\x7f\x7b"
+			  "\x4f\x6b\x32\x97\x60\x3d\xbf\x2d"
+			  "\x8a\x4c\x1e\x39\xe8\xae\x16\xc2"
+			  "\xa7\x8f\x77\xe9\xa0\x42\x4b\x7b"
+			  "\xd9\x07\x12\xe1\xc7\x8e\x45\xa0"
+			  "\xda\x7c\x32\x8b\x7a\xa7\xc6\x55"
+			  "\x1c\xd9\x9f\x72\xc5\x78\x88\x4e"
+			  "\xe2\x15\x93\x68\x57\x63\xda\xf2"
+			  "\x80\x7b\x27\x88\xee\xfd\x3a\x2b"
+			  "\x31\xcb\xf7\x1d\x6c\xfd\x70\x0c"
+			  "\xf0\xed\x24\xb5\x0b\x63\xf1\xd2"
+			  "\xf9\xd9\x7c\xb3\x43\x5a\xdd\xf4"
+			  "\x65\xf4\xf9\x0f\x98\x08\x43\x4e"
+			  "\xb1\x8b\xc9\x70\x7c\xf4\x42\x29"
+			  "\xc3\x66\xe6\x38\x6a\xc6\xb4\xa4"
+			  "\xc4\x27\xb4\xed\xa6\x39\x7d\xd2"
+			  "\x0a\x7f\xbd\xd6\x4c\xf1\x70\x64"
+			  "\x0b\xc6\x55\xe4\x21\xd2\xc8\x8b"
+			  "\x56\x30\x5d\xf9\x91\x5c\xb3\x23"
+			  "\xdb\x33\x0c\x53\x37\xa2\x96\x74"
+			  "\x78\x99\xae\x6c\x50\x28\xba\x91"
+			  "\x50\x4a\x8d\xb0\x13\xab\x01\xec"
+			  "\x4a\x2b\xb1\xf1\x66\xa6\xf7\x09"
+			  "\xe8\x9d\x54\x23\x8c\xd7\x4c\x10"
+			  "\x7f\xe2\x38\x67\x01\x4c\x4a\xa2"
+			  "\x88\x6a\x51\x75\x07\xa3\x18\xa1"
+			  "\x35\xd5\xca\x40\x33\xa9\xbc\x6f"
+			  "\x8e\xc3\xec\xbe\x1c\xe9\xe0\xb4"
+			  "\x29\x32\x7d\xd0\xbf\x79\xfb\xd9"
+			  "\xb1\x8d\x1d\x24\x82\x3b\x8a\xf0"
+			  "\x3e\xe1\xc0\x25\x52\x1c\x35\xda"
+			  "\xbb\x38\x04\xee\x1b\x2a\x19\x4b"
+			  "\x9a\xe0\x4b\x40\xf5\x32\xfa\x05"
+			  "\x9a\xed\xfc\xa1\x37\x91\xeb\xa1"
+			  "\x8d\x45\x1a\x08\x4f\x80\x55\x86"
+			  "\x84\x48\xfe\x20\xee\x30\xa0\xb4"
+			  "\x4d\xf0\x6b\x2c\x7e\xd1\xf6\x5e"
+			  "\x1b\xe7\x0f\x99\x12\x0c\xff\x69",
+		.ilen	= 616,
+		.result	= "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3"
+			  "\xc8\xcd\xd2\xd7\xdc\xe1\xe6\xeb"
+			  "\xf0\xf5\xfa\xff\x04\x09\x0e\x13"
+			  "\x18\x1d\x22\x27\x2c\x31\x36\x3b"
+			  "\x40\x45\x4a\x4f\x54\x59\x5e\x63"
+			  "\x68\x6d\x72\x77\x7c\x81\x86\x8b"
+			  "\x90\x95\x9a\x9f\xa4\xa9\xae\xb3"
+			  "\xb8\xbd\xc2\xc7\xcc\xd1\xd6\xdb"
+			  "\xe0\xe5\xea\xef\xf4\xf9\xfe\x03"
+			  "\x08\x0d\x12\x17\x1c\x21\x26\x2b"
+			  "\x30\x35\x3a\x3f\x44\x49\x4e\x53"
+			  "\x58\x5d\x62\x67\x6c\x71\x76\x7b"
+			  "\x80\x85\x8a\x8f\x94\x99\x9e\xa3"
+			  "\xa8\xad\xb2\xb7\xbc\xc1\xc6\xcb"
+			  "\xd0\xd5\xda\xdf\xe4\xe9\xee\xf3"
+			  "\xf8\xfd\x02\x07\x0c\x11\x16\x1b"
+			  "\x20\x25\x2a\x2f\x34\x39\x3e\x43"
+			  "\x48\x4d\x52\x57\x5c\x61\x66\x6b"
+			  "\x70\x75\x7a\x7f\x84\x89\x8e\x93"
+			  "\x98\x9d\xa2\xa7\xac\xb1\xb6\xbb"
+			  "\xc0\xc5\xca\xcf\xd4\xd9\xde\xe3"
+			  "\xe8\xed\xf2\xf7\xfc\x01\x06\x0b"
+			  "\x10\x15\x1a\x1f\x24\x29\x2e\x33"
+			  "\x38\x3d\x42\x47\x4c\x51\x56\x5b"
+			  "\x60\x65\x6a\x6f\x74\x79\x7e\x83"
+			  "\x88\x8d\x92\x97\x9c\xa1\xa6\xab"
+			  "\xb0\xb5\xba\xbf\xc4\xc9\xce\xd3"
+			  "\xd8\xdd\xe2\xe7\xec\xf1\xf6\xfb"
+			  "\x00\x05\x0a\x0f\x14\x19\x1e\x23"
+			  "\x28\x2d\x32\x37\x3c\x41\x46\x4b"
+			  "\x50\x55\x5a\x5f\x64\x69\x6e\x73"
+			  "\x78\x7d\x82\x87\x8c\x91\x96\x9b"
+			  "\xa0\xa5\xaa\xaf\xb4\xb9\xbe\xc3",
+		.rlen	= 600,
+	},
+};
+
 /*
  * ANSI X9.31 Continuous Pseudo-Random Number Generator (AES mode)
  * test vectors, taken from Appendix B.2.9 and B.2.10:
@@ -25905,6 +27213,287 @@ static struct cipher_testvec salsa20_stream_enc_tv_template[] = {
 	},
 };
 
+/*
+ * ChaCha20 test vectors from RFC7539 A.2. and 2.4.2.  The IV is the 32-bit
+ * little endian block counter followed by the 96-bit nonce.
+ */
+#define CHACHA20_ENC_TEST_VECTORS 3
+static struct cipher_testvec chacha20_enc_tv_template[] = {
+	{ /* RFC7539 A.2. Test Vector #1 */
+		.key	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.klen	= 32,
+		.iv	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.input	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.ilen	= 64,
+		.result	= "\x76\xb8\xe0\xad\xa0\xf1\x3d\x90"
+			  "\x40\x5d\x6a\xe5\x53\x86\xbd\x28"
+			  "\xbd\xd2\x19\xb8\xa0\x8d\xed\x1a"
+			  "\xa8\x36\xef\xcc\x8b\x77\x0d\xc7"
+			  "\xda\x41\x59\x7c\x51\x57\x48\x8d"
+			  "\x77\x24\xe0\x3f\xb8\xd8\x4a\x37"
+			  "\x6a\x43\xb8\xf4\x15\x18\xa1\x1c"
+			  "\xc3\x87\xb6\x69\xb2\xee\x65\x86",
+		.rlen	= 64,
+	}, { /* RFC7539 2.4.2. Test Vector */
+		.key	= "\x00\x01\x02\x03\x04\x05\x06\x07"
+			  "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"
+			  "\x10\x11\x12\x13\x14\x15\x16\x17"
+			  "\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f",
+		.klen	= 32,
+		.iv	= "\x01\x00\x00\x00\x00\x00\x00\x00"
+			  "\x00\x00\x00\x4a\x00\x00\x00\x00",
+		.input	= "\x4c\x61\x64\x69\x65\x73\x20\x61"
+			  "\x6e\x64\x20\x47\x65\x6e\x74\x6c"
+			  "\x65\x6d\x65\x6e\x20\x6f\x66\x20"
+			  "\x74\x68\x65\x20\x63\x6c\x61\x73"
+			  "\x73\x20\x6f\x66\x20\x27\x39\x39"
+			  "\x3a\x20\x49\x66\x20\x49\x20\x63"
+			  "\x6f\x75\x6c\x64\x20\x6f\x66\x66"
+			  "\x65\x72\x20\x79\x6f\x75\x20\x6f"
+			  "\x6e\x6c\x79\x20\x6f\x6e\x65\x20"
+			  "\x74\x69\x70\x20\x66\x6f\x72\x20"
+			  "\x74\x68\x65\x20\x66\x75\x74\x75"
+			  "\x72\x65\x2c\x20\x73\x75\x6e\x73"
+			  "\x63\x72\x65\x65\x6e\x20\x77\x6f"
+			  "\x75\x6c\x64\x20\x62\x65\x20\x69"
+			  "\x74\x2e",
+		.ilen	= 114,
+		.result	= "\x6e\x2e\x35\x9a\x25\x68\xf9\x80"
+			  "\x41\xba\x07\x28\xdd\x0d\x69\x81"
+			  "\xe9\x7e\x7a\xec\x1d\x43\x60\xc2"
+			  "\x0a\x27\xaf\xcc\xfd\x9f\xae\x0b"
+			  "\xf9\x1b\x65\xc5\x52\x47\x33\xab"
+			  "\x8f\x59\x3d\xab\xcd\x62\xb3\x57"
+			  "\x16\x39\xd6\x24\xe6\x51\x52\xab"
+			  "\x8f\x53\x0c\x35\x9f\x08\x61\xd8"
+			  "\x07\xca\x0d\xbf\x50\x0d\x6a\x61"
+			  "\x56\xa3\x8e\x08\x8a\x22\xb6\x5e"
+			  "\x52\xbc\x51\x4d\x16\xcc\xf8\x06"
+			  "\x81\x8c\xe9\x1a\xb7\x79\x37\x36"
+			  "\x5a\xf9\x0b\xbf\x74\xa3\x5b\xe6"
+			  "\xb4\x0b\x8e\xed\xf2\x78\x5e\x42"
+			  "\x87\x4d",
+		.rlen	= 114,
+	}, { /* Multiple of the SIMD block counts, plus a partial block */
+		.key	= "\x1c\x39\x56\x73\x90\xad\xca\xe7"
+			  "\x04\x21\x3e\x5b\x78\x95\xb2\xcf"
+			  "\xec\x09\x26\x43\x60\x7d\x9a\xb7"
+			  "\xd4\xf1\x0e\x2b\x48\x65\x82\x9f",
+		.klen	= 32,
+		.iv	= "\x2a\x00\x00\x00\x42\x47\x4c\x51"
+			  "\x56\x5b\x60\x65\x6a\x6f\x74\x79",
+		.input	= "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30\x37\x3e\x45\x4c"
+			  "\x53\x5a\x61\x68\x6f\x76\x7d\x84"
+			  "\x8b\x92\x99\xa0\xa7\xae\xb5\xbc"
+			  "\xc3\xca\xd1\xd8\xdf\xe6\xed\xf4"
+			  "\xfb\x02\x09\x10\x17\x1e\x25\x2c"
+			  "\x33\x3a\x41\x48\x4f\x56\x5d\x64"
+			  "\x6b\x72\x79\x80\x87\x8e\x95\x9c"
+			  "\xa3\xaa\xb1\xb8\xbf\xc6\xcd\xd4"
+			  "\xdb\xe2\xe9\xf0\xf7\xfe\x05\x0c"
+			  "\x13\x1a\x21\x28\x2f\x36\x3d\x44"
+			  "\x4b\x52\x59\x60\x67\x6e\x75\x7c"
+			  "\x83\x8a\x91\x98\x9f\xa6\xad\xb4"
+			  "\xbb\xc2\xc9\xd0\xd7\xde\xe5\xec"
+			  "\xf3\xfa\x01\x08\x0f\x16\x1d\x24"
+			  "\x2b\x32\x39\x40\x47\x4e\x55\x5c"
+			  "\x63\x6a\x71\x78\x7f\x86\x8d\x94"
+			  "\x9b\xa2\xa9\xb0\xb7\xbe\xc5\xcc"
+			  "\xd3\xda\xe1\xe8\xef\xf6\xfd\x04"
+			  "\x0b\x12\x19\x20\x27\x2e\x35\x3c"
+			  "\x43\x4a\x51\x58\x5f\x66\x6d\x74"
+			  "\x7b\x82\x89\x90\x97\x9e\xa5\xac"
+			  "\xb3\xba\xc1\xc8\xcf\xd6\xdd\xe4"
+			  "\xeb\xf2\xf9\x00\x07\x0e\x15\x1c"
+			  "\x23\x2a\x31\x38\x3f\x46\x4d\x54"
+			  "\x5b\x62\x69\x70\x77\x7e\x85\x8c"
+			  "\x93\x9a\xa1\xa8\xaf\xb6\xbd\xc4"
+			  "\xcb\xd2\xd9\xe0\xe7\xee\xf5\xfc"
+			  "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30\x37\x3e\x45\x4c"
+			  "\x53\x5a\x61\x68\x6f\x76\x7d\x84"
+			  "\x8b\x92\x99\xa0\xa7\xae\xb5\xbc"
+			  "\xc3\xca\xd1\xd8\xdf\xe6\xed\xf4"
+			  "\xfb\x02\x09\x10\x17\x1e\x25\x2c"
+			  "\x33\x3a\x41\x48\x4f\x56\x5d\x64"
+			  "\x6b\x72\x79\x80\x87\x8e\x95\x9c"
+			  "\xa3\xaa\xb1\xb8\xbf\xc6\xcd\xd4"
+			  "\xdb\xe2\xe9\xf0\xf7\xfe\x05\x0c"
+			  "\x13\x1a\x21\x28\x2f\x36\x3d\x44"
+			  "\x4b\x52\x59\x60\x67\x6e\x75\x7c"
+			  "\x83\x8a\x91\x98\x9f\xa6\xad\xb4"
+			  "\xbb\xc2\xc9\xd0\xd7\xde\xe5\xec"
+			  "\xf3\xfa\x01\x08\x0f\x16\x1d\x24"
+			  "\x2b\x32\x39\x40\x47\x4e\x55\x5c"
+			  "\x63\x6a\x71\x78\x7f\x86\x8d\x94"
+			  "\x9b\xa2\xa9\xb0\xb7\xbe\xc5\xcc"
+			  "\xd3\xda\xe1\xe8\xef\xf6\xfd\x04"
+			  "\x0b\x12\x19\x20\x27\x2e\x35\x3c"
+			  "\x43\x4a\x51\x58\x5f\x66\x6d\x74"
+			  "\x7b\x82\x89\x90\x97\x9e\xa5\xac"
+			  "\xb3\xba\xc1\xc8\xcf\xd6\xdd\xe4"
+			  "\xeb\xf2\xf9\x00\x07\x0e\x15\x1c"
+			  "\x23\x2a\x31\x38\x3f\x46\x4d\x54"
+			  "\x5b\x62\x69\x70\x77\x7e\x85\x8c"
+			  "\x93\x9a\xa1\xa8\xaf\xb6\xbd\xc4"
+			  "\xcb\xd2\xd9\xe0\xe7\xee\xf5\xfc"
+			  "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b\x42\x49\x50\x57\x5e\x65\x6c"
+			  "\x73\x7a\x81\x88\x8f\x96\x9d\xa4"
+			  "\xab\xb2\xb9\xc0\xc7\xce\xd5\xdc"
+			  "\xe3\xea\xf1\xf8\xff\x06\x0d\x14"
+			  "\x1b\x22\x29\x30\x37\x3e\x45\x4c"
+			  "\x53\x5a\x61\x68\x6f\x76\x7d\x84"
+			  "\x8b\x92\x99\xa0\xa7\xae\xb5\xbc"
+			  "\xc3\xca\xd1\xd8\xdf\xe6\xed\xf4"
+			  "\xfb\x02\x09\x10\x17\x1e\x25\x2c"
+			  "\x33\x3a\x41\x48\x4f\x56\x5d\x64"
+			  "\x6b\x72\x79\x80\x87\x8e\x95\x9c"
+			  "\xa3\xaa\xb1\xb8\xbf\xc6\xcd\xd4"
+			  "\xdb\xe2\xe9\xf0\xf7\xfe\x05\x0c"
+			  "\x13\x1a\x21\x28\x2f\x36\x3d\x44"
+			  "\x4b\x52\x59\x60\x67\x6e\x75\x7c"
+			  "\x83\x8a\x91\x98\x9f\xa6\xad\xb4"
+			  "\xbb\xc2\xc9\xd0\xd7\xde\xe5\xec"
+			  "\xf3\xfa\x01\x08\x0f\x16\x1d\x24"
+			  "\x2b\x32\x39\x40\x47\x4e\x55\x5c"
+			  "\x63\x6a\x71\x78\x7f\x86\x8d\x94"
+			  "\x9b\xa2\xa9\xb0\xb7\xbe\xc5\xcc"
+			  "\xd3\xda\xe1\xe8\xef\xf6\xfd\x04"
+			  "\x0b\x12\x19\x20\x27\x2e\x35\x3c"
+			  "\x43\x4a\x51\x58\x5f\x66\x6d\x74"
+			  "\x7b\x82\x89\x90\x97\x9e\xa5\xac"
+			  "\xb3\xba\xc1\xc8\xcf\xd6\xdd\xe4"
+			  "\xeb\xf2\xf9\x00\x07\x0e\x15\x1c"
+			  "\x23\x2a\x31\x38\x3f\x46\x4d\x54"
+			  "\x5b\x62\x69\x70\x77\x7e\x85\x8c"
+			  "\x93\x9a\xa1\xa8\xaf\xb6\xbd\xc4"
+			  "\xcb\xd2\xd9\xe0\xe7\xee\xf5\xfc"
+			  "\x03\x0a\x11\x18\x1f\x26\x2d\x34"
+			  "\x3b",
+		.ilen	= 777,
+		.result	= "\x7b\x5e\x54\x53\x77\x75\xd7\x60"
+			  "\x53\xc6\xdd\x81\x34\x43\x30\xcd"
+			  "\x35\xd5\x7a\x7f\x83\x77\x60\xdd"
+			  "\xca\x21\x39\xf7\xa6\x82\x03\x2d"
+			  "\xd6\xca\x11\x33\x93\x3c\x5a\x20"
+			  "\x64\x62\x6d\x62\xb2\x6a\xad\x5b"
+			  "\x37\xf6\x82\xb5\xd2\xc4\x34\x1f"
+			  "\xb1\x90\xd8\xe3\xf2\xc6\xdf\x1b"
+			  "\xed\x21\xd4\x9f\x3f\x28\x3a\x0f"
+			  "\xaf\x0d\x32\x7c\x33\x19\xbb\x0f"
+			  "\x71\xee\xa6\x6a\x54\xbb\x8f\xc9"
+			  "\x47\xcf\xc7\xb4\x9d\xda\x51\x05"
+			  "\x39\xb4\x0c\xb9\x70\x45\xdf\x80"
+			  "\xbc\x4c\xf9\x9c\x9c\x80\x40\xbd"
+			  "\xa9\x47\x3d\xcd\xc7\x89\x5c\x0a"
+			  "\xb4\x58\x4f\x9e\x07\x3c\x86\x17"
+			  "\xfc\x0a\xff\x00\xa0\x91\xf5\x1d"
+			  "\xce\xea\x9a\x71\xcf\xe5\x60\x69"
+			  "\x02\xbe\x11\x75\x2e\x02\xcb\x2e"
+			  "\x4a\x14\x9b\x1c\x4f\x41\x59\x76"
+			  "\x1f\x39\xd3\xef\x91\x71\xaa\x5a"
+			  "\x11\xbd\xb9\x9e\xd8\xc8\x32\x02"
+			  "\xee\xf8\xde\xea\x5c\x82\x20\x79"
+			  "\xf2\xd8\x4f\x8e\xb5\xbd\xc9\x09"
+			  "\xed\x3f\x83\x08\x9c\xc7\x54\x92"
+			  "\x85\xdd\x48\xee\x31\x89\x78\x37"
+			  "\xd2\x85\x88\x95\x21\xd7\xf3\xaf"
+			  "\x00\x0e\x05\x5a\xb9\x1e\xeb\xfe"
+			  "\x5a\xf5\xee\x03\xac\xa5\xd3\x7d"
+			  "\x09\x60\xf0\xf1\x50\xf3\x7a\xe2"
+			  "\xe7\xe3\xb2\x71\xb2\x02\x20\xde"
+			  "\xa3\x03\x37\x3a\xaa\x4b\x0d\x7e"
+			  "\xed\x64\x41\xb2\x5c\x49\xb5\xbb"
+			  "\xee\xe1\xc1\xcc\x44\x1f\xea\xa0"
+			  "\xdf\x5e\xac\x15\xac\x57\xb1\xb3"
+			  "\x14\xcc\x97\x95\xce\xdc\xe1\x2e"
+			  "\x22\x11\x27\x92\x09\xed\xf5\x0f"
+			  "\x79\x29\x3a\xca\xe3\x8c\x6b\xec"
+			  "\x07\x60\x2b\x53\xd0\x9c\x52\xb0"
+			  "\x67\x7d\xcf\x9c\x10\xd7\xe8\xd5"
+			  "\x75\x82\x18\xdf\x2d\x89\x58\x54"
+			  "\x59\xe9\x33\x3f\x0c\x9a\x4f\xf4"
+			  "\x33\x2c\xb0\x6f\x77\xcd\xf8\x38"
+			  "\x95\x1d\xa3\x90\x8f\xe5\xa2\x74"
+			  "\x61\x2d\xff\x02\x56\xd1\x29\xd1"
+			  "\xfa\xbb\x6e\xa1\xed\x2a\x6f\xf6"
+			  "\xc3\xd7\xbb\xbf\xd7\xbb\xfe\x8d"
+			  "\x26\xbd\x71\xa8\xd4\xc9\x00\x18"
+			  "\x12\xc9\xc7\x74\x63\x55\x6e\xaa"
+			  "\x6f\x0e\xd0\x65\x24\x43\x37\x16"
+			  "\x3a\xc1\xf8\x5b\x7f\x2b\x77\x7a"
+			  "\xf5\x38\xc1\x66\xce\xd4\x78\xca"
+			  "\x50\xf9\x96\x36\xc6\xe0\xa8\x9c"
+			  "\x2b\x55\xc1\x0f\x84\xd7\x09\x0f"
+			  "\x56\x4e\xaf\x2a\x1a\x73\x83\xcc"
+			  "\x8a\x51\x02\x35\x55\x68\x80\x40"
+			  "\xa5\xfc\xf8\x03\xde\x37\xa3\xa7"
+			  "\xb0\xca\x06\x65\xab\xa7\x07\x61"
+			  "\xd9\x96\x84\x1c\xe7\x44\xd8\x43"
+			  "\x8b\x52\x85\x84\x72\x58\x73\x30"
+			  "\x3b\x90\x1d\x00\xe5\x40\xbf\xdb"
+			  "\x50\x0d\x97\x6f\x1d\x9e\x3e\xd8"
+			  "\xd6\x6b\x05\xaf\x6f\x03\x81\xea"
+			  "\x9b\x06\xda\x16\x08\x41\x5e\x30"
+			  "\x79\x1b\x71\xd4\xa7\x98\x70\x33"
+			  "\x38\x0f\x8a\x6b\xc6\x3e\xf9\x80"
+			  "\x0e\x59\x10\x6d\xbc\x09\xc1\xc5"
+			  "\x84\xcd\x1d\x3b\x81\x24\x17\xad"
+			  "\x35\x94\x51\x30\x33\x2f\x1c\xfb"
+			  "\x17\x5f\xf1\xfe\x1e\x60\xb4\xd1"
+			  "\xa5\x59\xc3\xc5\xee\x68\xaf\xe6"
+			  "\xbd\x23\xda\xa0\xb3\x77\x57\x91"
+			  "\x67\xcd\x92\x44\x0b\x6a\x5d\x5b"
+			  "\xa5\x11\x5c\xe3\xc8\xce\xe3\x19"
+			  "\x90\x6d\x2a\xee\x4f\x4e\x19\xe3"
+			  "\x68\xbf\xfa\x4e\xbc\xa5\x02\x6c"
+			  "\xf8\xa3\x56\xca\xe8\x53\xe3\x5a"
+			  "\xb6\x36\x06\x40\x35\x50\x26\xa9"
+			  "\xa7\xfa\xa9\xe9\x6f\x62\x06\x32"
+			  "\x00\xe2\x33\xb0\x0f\x51\xf3\xf1"
+			  "\x79\x00\xe8\xc4\x44\x25\xc3\x9d"
+			  "\x4e\x30\xd7\x28\x9b\xb9\x16\x35"
+			  "\xa9\x5e\x5e\x77\x4c\x01\x5b\x3c"
+			  "\x3c\x25\x93\xd7\x26\x0d\x4b\xc4"
+			  "\x94\xc4\x31\x81\x4b\x06\x8b\x0a"
+			  "\x5a\xee\x1b\x5b\xa3\xd4\x24\x91"
+			  "\x5a\xc1\xb1\x9c\x28\x04\xc5\x07"
+			  "\xac\x7c\x9c\x9a\x95\x8c\xe0\xe3"
+			  "\x42\x6f\x42\x76\x0f\x74\xb5\x7f"
+			  "\xf6\xd6\x64\xf4\xbd\xfc\xae\x6c"
+			  "\x57\x77\x61\x24\x04\x56\x79\x54"
+			  "\xa2\x47\x93\x31\xc6\x9e\xeb\xb8"
+			  "\xa7\xec\xba\xb0\x95\xda\xb4\x07"
+			  "\xf5\x64\x0f\xfd\x63\x3d\x5b\x7d"
+			  "\x35\x92\xa1\xa7\xf4\x6e\x79\x35"
+			  "\x73\x8d\xec\x6c\x43\xa0\x3c\xb6"
+			  "\xd5\xd0\xe6\x7b\xfd\x25\x38\x55"
+			  "\x15",
+		.rlen	= 777,
+	},
+};
+
 /*
  * CTS (Cipher Text Stealing) mode tests
  */
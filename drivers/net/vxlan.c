@@ -26,6 +26,8 @@
 #include <linux/if_ether.h>
 #include <linux/if_vlan.h>
 #include <linux/hash.h>
+#include <linux/jhash.h>
+#include <linux/vmalloc.h>
 #include <linux/ethtool.h>
 #include <net/arp.h>
 #include <net/ndisc.h>
@@ -53,8 +55,14 @@
 #define PORT_HASH_SIZE  (1<<PORT_HASH_BITS)
 #define VNI_HASH_BITS	10
 #define VNI_HASH_SIZE	(1<<VNI_HASH_BITS)
-#define FDB_HASH_BITS	8
-#define FDB_HASH_SIZE	(1<<FDB_HASH_BITS)
+#define FDB_HASH_MIN_BITS 8
+#define FDB_HASH_MIN_SIZE (1<<FDB_HASH_MIN_BITS)
+#define FDB_HASH_MAX_BITS 20
+#define FDB_HASH_MAX_SIZE (1<<FDB_HASH_MAX_BITS)
+#define FDB_LOCK_BITS	6	/* must not exceed FDB_HASH_MIN_BITS */
+#define FDB_LOCK_SIZE	(1<<FDB_LOCK_BITS)
+#define FDB_LEARN_RATE	10000	/* learning events per second */
+#define FDB_LEARN_BURST	256	/* and at most this many queued */
 #define FDB_AGE_DEFAULT 300 /* 5 min */
 #define FDB_AGE_INTERVAL (10 * HZ)	/* rescan interval */
 
@@ -110,7 +118,7 @@ struct vxlan_rdst {
 
 /* Forwarding table entry */
 struct vxlan_fdb {
-	struct hlist_node hlist;	/* linked list of entries */
+	struct hlist_node hlist[2];	/* one per table version */
 	struct rcu_head	  rcu;
 	unsigned long	  updated;	/* jiffies */
 	unsigned long	  used;
@@ -120,6 +128,22 @@ struct vxlan_fdb {
 	u8		  eth_addr[ETH_ALEN];
 };
 
+/* Forwarding table, replaced as a whole when it is resized */
+struct vxlan_fdb_table {
+	struct rcu_head	  rcu;
+	unsigned int	  size;		/* number of buckets, power of 2 */
+	u32		  seed;
+	int		  node_ver;	/* which vxlan_fdb.hlist links us */
+	struct hlist_head buckets[0];
+};
+
+/* Address learned on receive, waiting for vxlan_learn_work() */
+struct vxlan_learn_event {
+	struct list_head  list;
+	union vxlan_addr  remote_ip;
+	u8		  eth_addr[ETH_ALEN];
+};
+
 /* Pseudo network device */
 struct vxlan_dev {
 	struct hlist_node hlist;	/* vni hash table */
@@ -141,11 +165,27 @@ struct vxlan_dev {
 
 	unsigned long	  age_interval;
 	struct timer_list age_timer;
-	spinlock_t	  hash_lock;
-	unsigned int	  addrcnt;
+	atomic_t	  addrcnt;
 	unsigned int	  addrmax;
 
-	struct hlist_head fdb_head[FDB_HASH_SIZE];
+	/* Entries are updated under the lock of their bucket with the
+	 * table lock held for reading; resizing takes it for writing.
+	 */
+	rwlock_t	  table_lock;
+	spinlock_t	  bucket_lock[FDB_LOCK_SIZE];
+	struct vxlan_fdb_table __rcu *fdb_table;
+	struct vxlan_fdb_table *fdb_new;	/* being filled by a resize */
+	unsigned int	  fdb_migrated;	/* fdb_table buckets now in fdb_new */
+	struct work_struct fdb_resize;
+	unsigned long	  fdb_resizes;
+
+	spinlock_t	  learn_lock;	/* protects the learn_* fields */
+	struct list_head  learn_list;
+	unsigned int	  learn_len;
+	unsigned int	  learn_tokens;
+	unsigned long	  learn_stamp;
+	unsigned long	  learn_dropped;
+	struct work_struct learn_work;
 };
 
 #define VXLAN_F_LEARN	0x01
@@ -445,24 +485,47 @@ static void vxlan_fdb_miss(struct vxlan_dev *vxlan, const u8 eth_addr[ETH_ALEN])
 }
 
 /* Hash Ethernet address */
-static u32 eth_hash(const unsigned char *addr)
+static u32 eth_hash(const struct vxlan_fdb_table *t, const unsigned char *addr)
 {
-	u64 value = get_unaligned((u64 *)addr);
+	return jhash_2words(get_unaligned((u32 *)addr),
+			    get_unaligned((u16 *)(addr + 4)), t->seed);
+}
 
-	/* only want 6 bytes */
-#ifdef __BIG_ENDIAN
-	value >>= 16;
-#else
-	value <<= 16;
-#endif
-	return hash_64(value, FDB_HASH_BITS);
+/* Hash chain to use given hash value */
+static inline struct hlist_head *vxlan_fdb_head(struct vxlan_fdb_table *t,
+						u32 hash)
+{
+	return &t->buckets[hash & (t->size - 1)];
 }
 
-/* Hash chain to use given mac address */
-static inline struct hlist_head *vxlan_fdb_head(struct vxlan_dev *vxlan,
-						const u8 *mac)
+static inline struct vxlan_fdb_table *vxlan_fdb_table(struct vxlan_dev *vxlan)
 {
-	return &vxlan->fdb_head[eth_hash(mac)];
+	return rcu_dereference_check(vxlan->fdb_table,
+				     rcu_read_lock_bh_held() ||
+				     lockdep_is_held(&vxlan->table_lock));
+}
+
+/* Take the locks needed to update the entry for @mac.  There are never
+ * more bucket locks than buckets, so a bucket is always covered by a
+ * single lock whatever the current table size.
+ */
+static spinlock_t *vxlan_fdb_lock_bh(struct vxlan_dev *vxlan, const u8 *mac)
+{
+	struct vxlan_fdb_table *t;
+	spinlock_t *lock;
+
+	read_lock_bh(&vxlan->table_lock);
+	t = vxlan_fdb_table(vxlan);
+	lock = &vxlan->bucket_lock[eth_hash(t, mac) & (FDB_LOCK_SIZE - 1)];
+	spin_lock(lock);
+
+	return lock;
+}
+
+static void vxlan_fdb_unlock_bh(struct vxlan_dev *vxlan, spinlock_t *lock)
+{
+	spin_unlock(lock);
+	read_unlock_bh(&vxlan->table_lock);
 }
 
 /* Look up Ethernet address in forwarding table */
@@ -470,10 +533,11 @@ static struct vxlan_fdb *__vxlan_find_mac(struct vxlan_dev *vxlan,
 					const u8 *mac)
 
 {
-	struct hlist_head *head = vxlan_fdb_head(vxlan, mac);
+	struct vxlan_fdb_table *t = vxlan_fdb_table(vxlan);
+	struct hlist_head *head = vxlan_fdb_head(t, eth_hash(t, mac));
 	struct vxlan_fdb *f;
 
-	hlist_for_each_entry_rcu(f, head, hlist) {
+	hlist_for_each_entry_rcu(f, head, hlist[t->node_ver]) {
 		if (ether_addr_equal(mac, f->eth_addr))
 			return f;
 	}
@@ -493,7 +557,193 @@ static struct vxlan_fdb *vxlan_find_mac(struct vxlan_dev *vxlan,
 	return f;
 }
 
-/* caller should hold vxlan->hash_lock */
+static struct vxlan_fdb_table *vxlan_fdb_table_alloc(unsigned int size,
+						     u32 seed)
+{
+	struct vxlan_fdb_table *t;
+	size_t sz = sizeof(*t) + size * sizeof(struct hlist_head);
+
+	if (sz <= PAGE_SIZE)
+		t = kzalloc(sz, GFP_KERNEL);
+	else
+		t = vzalloc(sz);
+	if (!t)
+		return NULL;
+
+	t->size = size;
+	t->seed = seed;
+	return t;
+}
+
+static void vxlan_fdb_table_free(struct vxlan_fdb_table *t)
+{
+	if (is_vmalloc_addr(t))
+		vfree(t);
+	else
+		kfree(t);
+}
+
+static void vxlan_fdb_table_free_rcu(struct rcu_head *head)
+{
+	vxlan_fdb_table_free(container_of(head, struct vxlan_fdb_table, rcu));
+}
+
+/* vxlan_xmit() walks the table under rcu_read_lock_bh(), the dump and
+ * the ethtool stats under rcu_read_lock(): wait for both flavours.
+ */
+static void vxlan_fdb_table_free_rcu_bh(struct rcu_head *head)
+{
+	call_rcu(head, vxlan_fdb_table_free_rcu);
+}
+
+static void vxlan_fdb_table_destroy(struct vxlan_dev *vxlan)
+{
+	struct vxlan_fdb_table *t = rtnl_dereference(vxlan->fdb_table);
+
+	if (!t)
+		return;
+
+	RCU_INIT_POINTER(vxlan->fdb_table, NULL);
+	call_rcu_bh(&t->rcu, vxlan_fdb_table_free_rcu_bh);
+}
+
+/* Aim for one entry per bucket, and shrink once the table is mostly empty */
+static void vxlan_fdb_check_size(struct vxlan_dev *vxlan,
+				 const struct vxlan_fdb_table *t)
+{
+	unsigned int count = atomic_read(&vxlan->addrcnt);
+
+	if ((count > t->size && t->size < FDB_HASH_MAX_SIZE) ||
+	    (count < t->size / 4 && t->size > FDB_HASH_MIN_SIZE))
+		queue_work(vxlan_wq, &vxlan->fdb_resize);
+}
+
+/* A resize moves this many buckets per write_lock_bh() section */
+#define FDB_RESIZE_CHUNK	256
+
+/* Is @hash in a bucket of the current table that a resize has already
+ * linked into vxlan->fdb_new?  Called with the table lock held.
+ */
+static bool vxlan_fdb_migrated(struct vxlan_dev *vxlan,
+			       const struct vxlan_fdb_table *t, u32 hash)
+{
+	return vxlan->fdb_new &&
+	       (hash & (t->size - 1)) < vxlan->fdb_migrated;
+}
+
+/* Link @f into the forwarding table, and into the table being filled
+ * by a resize if its bucket was moved already.  Both tables use the same
+ * seed, so both buckets are covered by the bucket lock held by the caller.
+ */
+static void vxlan_fdb_link(struct vxlan_dev *vxlan, struct vxlan_fdb *f)
+{
+	struct vxlan_fdb_table *t = vxlan_fdb_table(vxlan);
+	struct vxlan_fdb_table *new = vxlan->fdb_new;
+	u32 hash = eth_hash(t, f->eth_addr);
+
+	hlist_add_head_rcu(&f->hlist[t->node_ver], vxlan_fdb_head(t, hash));
+	if (vxlan_fdb_migrated(vxlan, t, hash))
+		hlist_add_head_rcu(&f->hlist[new->node_ver],
+				   vxlan_fdb_head(new, hash));
+}
+
+static void vxlan_fdb_unlink(struct vxlan_dev *vxlan, struct vxlan_fdb *f)
+{
+	struct vxlan_fdb_table *t = vxlan_fdb_table(vxlan);
+	struct vxlan_fdb_table *new = vxlan->fdb_new;
+
+	hlist_del_rcu(&f->hlist[t->node_ver]);
+	if (vxlan_fdb_migrated(vxlan, t, eth_hash(t, f->eth_addr)))
+		hlist_del_rcu(&f->hlist[new->node_ver]);
+}
+
+/* Link the entries of buckets [@start, @end) of @old into @new through
+ * their other hash node, so that lookups in @old are not disturbed until
+ * @new is published.
+ */
+static void vxlan_fdb_table_copy(struct vxlan_fdb_table *old,
+				 struct vxlan_fdb_table *new,
+				 unsigned int start, unsigned int end)
+{
+	struct vxlan_fdb *f;
+	unsigned int h;
+
+	for (h = start; h < end; ++h) {
+		hlist_for_each_entry(f, &old->buckets[h], hlist[old->node_ver])
+			hlist_add_head_rcu(&f->hlist[new->node_ver],
+					   vxlan_fdb_head(new,
+							  eth_hash(new, f->eth_addr)));
+	}
+}
+
+static void vxlan_fdb_resize(struct work_struct *work)
+{
+	struct vxlan_dev *vxlan = container_of(work, struct vxlan_dev,
+					       fdb_resize);
+	struct vxlan_fdb_table *old, *new;
+	unsigned int size, h;
+	u32 seed;
+
+	size = roundup_pow_of_two(atomic_read(&vxlan->addrcnt) ? : 1);
+	size = clamp_t(unsigned int, size, FDB_HASH_MIN_SIZE, FDB_HASH_MAX_SIZE);
+
+	/* we are the only one replacing the table */
+	rcu_read_lock();
+	old = rcu_dereference(vxlan->fdb_table);
+	if (old && old->size == size)
+		old = NULL;
+	if (old)
+		seed = old->seed;
+	rcu_read_unlock();
+	if (!old)
+		return;
+
+	new = vxlan_fdb_table_alloc(size, seed);
+	if (!new)
+		return;
+
+	write_lock_bh(&vxlan->table_lock);
+	old = vxlan_fdb_table(vxlan);
+	new->node_ver = !old->node_ver;
+	vxlan->fdb_new = new;
+	vxlan->fdb_migrated = 0;
+	write_unlock_bh(&vxlan->table_lock);
+
+	/* Move the entries a chunk at a time, so that softirqs are not held
+	 * off for the whole table.  Meanwhile updates of moved buckets are
+	 * applied to both tables by vxlan_fdb_link()/vxlan_fdb_unlink().
+	 */
+	for (h = 0; h < old->size; h += FDB_RESIZE_CHUNK) {
+		unsigned int end = min_t(unsigned int, h + FDB_RESIZE_CHUNK,
+					 old->size);
+
+		write_lock_bh(&vxlan->table_lock);
+		vxlan_fdb_table_copy(old, new, h, end);
+		vxlan->fdb_migrated = end;
+		write_unlock_bh(&vxlan->table_lock);
+		cond_resched();
+	}
+
+	write_lock_bh(&vxlan->table_lock);
+	rcu_assign_pointer(vxlan->fdb_table, new);
+	vxlan->fdb_new = NULL;
+	vxlan->fdb_resizes++;
+	write_unlock_bh(&vxlan->table_lock);
+
+	netdev_dbg(vxlan->dev, "fdb resized from %u to %u buckets\n",
+		   old->size, new->size);
+
+	/* The next resize relinks the hash nodes old is made of, so no
+	 * reader may be left walking it by then.  vxlan_xmit() runs under
+	 * rcu_read_lock_bh(), which synchronize_rcu() alone does not wait
+	 * for with PREEMPT_RCU.
+	 */
+	synchronize_rcu();
+	synchronize_rcu_bh();
+	vxlan_fdb_table_free(old);
+}
+
+/* caller should hold the bucket lock of f */
 static struct vxlan_rdst *vxlan_fdb_find_rdst(struct vxlan_fdb *f,
 					      union vxlan_addr *ip, __be16 port,
 					      __u32 vni, __u32 ifindex)
@@ -588,7 +838,7 @@ static void vxlan_notify_del_rx_port(struct sock *sk)
 	rcu_read_unlock();
 }
 
-/* Add new entry to forwarding table -- assumes lock held */
+/* Add new entry to forwarding table -- assumes bucket lock held */
 static int vxlan_fdb_create(struct vxlan_dev *vxlan,
 			    const u8 *mac, union vxlan_addr *ip,
 			    __u16 state, __u16 flags,
@@ -596,6 +846,7 @@ static int vxlan_fdb_create(struct vxlan_dev *vxlan,
 			    __u8 ndm_flags)
 {
 	struct vxlan_fdb *f;
+	unsigned int count;
 	int notify = 0;
 
 	f = __vxlan_find_mac(vxlan, mac);
@@ -641,18 +892,24 @@ static int vxlan_fdb_create(struct vxlan_dev *vxlan,
 		if (!(flags & NLM_F_CREATE))
 			return -ENOENT;
 
-		if (vxlan->addrmax && vxlan->addrcnt >= vxlan->addrmax)
-			return -ENOSPC;
-
 		/* Disallow replace to add a multicast entry */
 		if ((flags & NLM_F_REPLACE) &&
 		    (is_multicast_ether_addr(mac) || is_zero_ether_addr(mac)))
 			return -EOPNOTSUPP;
 
+		/* other buckets may be adding entries concurrently */
+		count = atomic_inc_return(&vxlan->addrcnt);
+		if (vxlan->addrmax && count > vxlan->addrmax) {
+			atomic_dec(&vxlan->addrcnt);
+			return -ENOSPC;
+		}
+
 		netdev_dbg(vxlan->dev, "add %pM -> %pIS\n", mac, ip);
 		f = kmalloc(sizeof(*f), GFP_ATOMIC);
-		if (!f)
+		if (!f) {
+			atomic_dec(&vxlan->addrcnt);
 			return -ENOMEM;
+		}
 
 		notify = 1;
 		f->state = state;
@@ -663,9 +920,8 @@ static int vxlan_fdb_create(struct vxlan_dev *vxlan,
 
 		vxlan_fdb_append(f, ip, port, vni, ifindex);
 
-		++vxlan->addrcnt;
-		hlist_add_head_rcu(&f->hlist,
-				   vxlan_fdb_head(vxlan, mac));
+		vxlan_fdb_link(vxlan, f);
+		vxlan_fdb_check_size(vxlan, vxlan_fdb_table(vxlan));
 	}
 
 	if (notify)
@@ -684,16 +940,20 @@ static void vxlan_fdb_free(struct rcu_head *head)
 	kfree(f);
 }
 
+/* caller should hold the bucket lock of f */
 static void vxlan_fdb_destroy(struct vxlan_dev *vxlan, struct vxlan_fdb *f)
 {
+	struct vxlan_fdb_table *t = vxlan_fdb_table(vxlan);
+
 	netdev_dbg(vxlan->dev,
 		    "delete %pM\n", f->eth_addr);
 
-	--vxlan->addrcnt;
+	atomic_dec(&vxlan->addrcnt);
 	vxlan_fdb_notify(vxlan, f, RTM_DELNEIGH);
 
-	hlist_del_rcu(&f->hlist);
+	vxlan_fdb_unlink(vxlan, f);
 	call_rcu(&f->rcu, vxlan_fdb_free);
+	vxlan_fdb_check_size(vxlan, t);
 }
 
 static int vxlan_fdb_parse(struct nlattr *tb[], struct vxlan_dev *vxlan,
@@ -762,6 +1022,7 @@ static int vxlan_fdb_add(struct ndmsg *ndm, struct nlattr *tb[],
 	union vxlan_addr ip;
 	__be16 port;
 	u32 vni, ifindex;
+	spinlock_t *lock;
 	int err;
 
 	if (!(ndm->ndm_state & (NUD_PERMANENT|NUD_REACHABLE))) {
@@ -777,10 +1038,10 @@ static int vxlan_fdb_add(struct ndmsg *ndm, struct nlattr *tb[],
 	if (err)
 		return err;
 
-	spin_lock_bh(&vxlan->hash_lock);
+	lock = vxlan_fdb_lock_bh(vxlan, addr);
 	err = vxlan_fdb_create(vxlan, addr, &ip, ndm->ndm_state, flags,
 			       port, vni, ifindex, ndm->ndm_flags);
-	spin_unlock_bh(&vxlan->hash_lock);
+	vxlan_fdb_unlock_bh(vxlan, lock);
 
 	return err;
 }
@@ -796,6 +1057,7 @@ static int vxlan_fdb_delete(struct ndmsg *ndm, struct nlattr *tb[],
 	union vxlan_addr ip;
 	__be16 port;
 	u32 vni, ifindex;
+	spinlock_t *lock;
 	int err;
 
 	err = vxlan_fdb_parse(tb, vxlan, &ip, &port, &vni, &ifindex);
@@ -804,7 +1066,7 @@ static int vxlan_fdb_delete(struct ndmsg *ndm, struct nlattr *tb[],
 
 	err = -ENOENT;
 
-	spin_lock_bh(&vxlan->hash_lock);
+	lock = vxlan_fdb_lock_bh(vxlan, addr);
 	f = vxlan_find_mac(vxlan, addr);
 	if (!f)
 		goto out;
@@ -829,7 +1091,7 @@ static int vxlan_fdb_delete(struct ndmsg *ndm, struct nlattr *tb[],
 	vxlan_fdb_destroy(vxlan, f);
 
 out:
-	spin_unlock_bh(&vxlan->hash_lock);
+	vxlan_fdb_unlock_bh(vxlan, lock);
 
 	return err;
 }
@@ -839,13 +1101,17 @@ static int vxlan_fdb_dump(struct sk_buff *skb, struct netlink_callback *cb,
 			  struct net_device *dev, int idx)
 {
 	struct vxlan_dev *vxlan = netdev_priv(dev);
+	struct vxlan_fdb_table *t;
 	unsigned int h;
 
-	for (h = 0; h < FDB_HASH_SIZE; ++h) {
+	rcu_read_lock();
+	t = rcu_dereference(vxlan->fdb_table);
+	for (h = 0; h < t->size; ++h) {
 		struct vxlan_fdb *f;
 		int err;
 
-		hlist_for_each_entry_rcu(f, &vxlan->fdb_head[h], hlist) {
+		hlist_for_each_entry_rcu(f, &t->buckets[h],
+					 hlist[t->node_ver]) {
 			struct vxlan_rdst *rd;
 
 			if (idx < cb->args[0])
@@ -865,11 +1131,127 @@ skip:
 		}
 	}
 out:
+	rcu_read_unlock();
 	return idx;
 }
 
+/* Update the forwarding table with an address learned on receive */
+static void vxlan_learn(struct vxlan_dev *vxlan,
+			union vxlan_addr *src_ip, const u8 *src_mac)
+{
+	struct vxlan_fdb *f;
+	spinlock_t *lock;
+
+	lock = vxlan_fdb_lock_bh(vxlan, src_mac);
+
+	/* close off race between vxlan_flush and incoming packets */
+	if (!netif_running(vxlan->dev))
+		goto out;
+
+	f = __vxlan_find_mac(vxlan, src_mac);
+	if (f) {
+		struct vxlan_rdst *rdst = first_remote_rtnl(f);
+
+		/* raced with another learning event, or made static */
+		if (vxlan_addr_equal(&rdst->remote_ip, src_ip) ||
+		    (f->state & NUD_NOARP))
+			goto out;
+
+		if (net_ratelimit())
+			netdev_info(vxlan->dev,
+				    "%pM migrated from %pIS to %pIS\n",
+				    src_mac, &rdst->remote_ip, src_ip);
+
+		rdst->remote_ip = *src_ip;
+		f->updated = jiffies;
+		vxlan_fdb_notify(vxlan, f, RTM_NEWNEIGH);
+	} else {
+		/* learned new entry */
+		vxlan_fdb_create(vxlan, src_mac, src_ip,
+				 NUD_REACHABLE,
+				 NLM_F_EXCL|NLM_F_CREATE,
+				 vxlan->dst_port,
+				 vxlan->default_dst.remote_vni,
+				 0, NTF_SELF);
+	}
+out:
+	vxlan_fdb_unlock_bh(vxlan, lock);
+}
+
+static void vxlan_learn_work(struct work_struct *work)
+{
+	struct vxlan_dev *vxlan = container_of(work, struct vxlan_dev,
+					       learn_work);
+	struct vxlan_learn_event *l, *n;
+	LIST_HEAD(list);
+
+	spin_lock_bh(&vxlan->learn_lock);
+	list_splice_init(&vxlan->learn_list, &list);
+	vxlan->learn_len = 0;
+	spin_unlock_bh(&vxlan->learn_lock);
+
+	list_for_each_entry_safe(l, n, &list, list) {
+		vxlan_learn(vxlan, &l->remote_ip, l->eth_addr);
+		kfree(l);
+	}
+}
+
+static void vxlan_learn_purge(struct vxlan_dev *vxlan)
+{
+	struct vxlan_learn_event *l, *n;
+
+	cancel_work_sync(&vxlan->learn_work);
+
+	spin_lock_bh(&vxlan->learn_lock);
+	list_for_each_entry_safe(l, n, &vxlan->learn_list, list)
+		kfree(l);
+	INIT_LIST_HEAD(&vxlan->learn_list);
+	vxlan->learn_len = 0;
+	spin_unlock_bh(&vxlan->learn_lock);
+}
+
+/* Queue a learning event for vxlan_learn_work().  Events are rate limited
+ * by a token bucket so that a flood of new source addresses cannot keep
+ * the table busy; what does not fit is dropped and counted.
+ */
+static void vxlan_learn_queue(struct vxlan_dev *vxlan,
+			      union vxlan_addr *src_ip, const u8 *src_mac)
+{
+	struct vxlan_learn_event *l = NULL;
+	unsigned long now = jiffies;
+
+	spin_lock(&vxlan->learn_lock);
+
+	if (now != vxlan->learn_stamp) {
+		unsigned long ticks = min(now - vxlan->learn_stamp,
+					  (unsigned long)HZ);
+
+		vxlan->learn_tokens = min_t(unsigned long, FDB_LEARN_BURST,
+					    vxlan->learn_tokens +
+					    ticks * FDB_LEARN_RATE / HZ);
+		vxlan->learn_stamp = now;
+	}
+
+	if (vxlan->learn_tokens && vxlan->learn_len < FDB_LEARN_BURST)
+		l = kmalloc(sizeof(*l), GFP_ATOMIC);
+	if (!l) {
+		vxlan->learn_dropped++;
+		goto out;
+	}
+
+	vxlan->learn_tokens--;
+	l->remote_ip = *src_ip;
+	memcpy(l->eth_addr, src_mac, ETH_ALEN);
+	list_add_tail(&l->list, &vxlan->learn_list);
+	if (!vxlan->learn_len++)
+		queue_work(vxlan_wq, &vxlan->learn_work);
+out:
+	spin_unlock(&vxlan->learn_lock);
+}
+
 /* Watch incoming packets to learn mapping between Ethernet address
- * and Tunnel endpoint.
+ * and Tunnel endpoint.  The table itself is updated from a work item,
+ * only the checks that may drop the packet are done here.
  * Return true if packet is bogus and should be droppped.
  */
 static bool vxlan_snoop(struct net_device *dev,
@@ -888,30 +1270,10 @@ static bool vxlan_snoop(struct net_device *dev,
 		/* Don't migrate static entries, drop packets */
 		if (f->state & NUD_NOARP)
 			return true;
-
-		if (net_ratelimit())
-			netdev_info(dev,
-				    "%pM migrated from %pIS to %pIS\n",
-				    src_mac, &rdst->remote_ip, &src_ip);
-
-		rdst->remote_ip = *src_ip;
-		f->updated = jiffies;
-		vxlan_fdb_notify(vxlan, f, RTM_NEWNEIGH);
-	} else {
-		/* learned new entry */
-		spin_lock(&vxlan->hash_lock);
-
-		/* close off race between vxlan_flush and incoming packets */
-		if (netif_running(dev))
-			vxlan_fdb_create(vxlan, src_mac, src_ip,
-					 NUD_REACHABLE,
-					 NLM_F_EXCL|NLM_F_CREATE,
-					 vxlan->dst_port,
-					 vxlan->default_dst.remote_vni,
-					 0, NTF_SELF);
-		spin_unlock(&vxlan->hash_lock);
 	}
 
+	vxlan_learn_queue(vxlan, src_ip, src_mac);
+
 	return false;
 }
 
@@ -1834,17 +2196,22 @@ static void vxlan_cleanup(unsigned long arg)
 {
 	struct vxlan_dev *vxlan = (struct vxlan_dev *) arg;
 	unsigned long next_timer = jiffies + FDB_AGE_INTERVAL;
+	struct vxlan_fdb_table *t;
 	unsigned int h;
 
 	if (!netif_running(vxlan->dev))
 		return;
 
-	spin_lock_bh(&vxlan->hash_lock);
-	for (h = 0; h < FDB_HASH_SIZE; ++h) {
-		struct hlist_node *p, *n;
-		hlist_for_each_safe(p, n, &vxlan->fdb_head[h]) {
-			struct vxlan_fdb *f
-				= container_of(p, struct vxlan_fdb, hlist);
+	read_lock_bh(&vxlan->table_lock);
+	t = vxlan_fdb_table(vxlan);
+	for (h = 0; h < t->size; ++h) {
+		spinlock_t *lock = &vxlan->bucket_lock[h & (FDB_LOCK_SIZE - 1)];
+		struct hlist_node *n;
+		struct vxlan_fdb *f;
+
+		spin_lock(lock);
+		hlist_for_each_entry_safe(f, n, &t->buckets[h],
+					  hlist[t->node_ver]) {
 			unsigned long timeout;
 
 			if (f->state & NUD_PERMANENT)
@@ -1860,8 +2227,9 @@ static void vxlan_cleanup(unsigned long arg)
 			} else if (time_before(timeout, next_timer))
 				next_timer = timeout;
 		}
+		spin_unlock(lock);
 	}
-	spin_unlock_bh(&vxlan->hash_lock);
+	read_unlock_bh(&vxlan->table_lock);
 
 	mod_timer(&vxlan->age_timer, next_timer);
 }
@@ -1912,12 +2280,17 @@ static int vxlan_init(struct net_device *dev)
 static void vxlan_fdb_delete_default(struct vxlan_dev *vxlan)
 {
 	struct vxlan_fdb *f;
+	spinlock_t *lock;
+
+	/* already gone if vxlan_uninit ran on a failed registration */
+	if (!rtnl_dereference(vxlan->fdb_table))
+		return;
 
-	spin_lock_bh(&vxlan->hash_lock);
+	lock = vxlan_fdb_lock_bh(vxlan, all_zeros_mac);
 	f = __vxlan_find_mac(vxlan, all_zeros_mac);
 	if (f)
 		vxlan_fdb_destroy(vxlan, f);
-	spin_unlock_bh(&vxlan->hash_lock);
+	vxlan_fdb_unlock_bh(vxlan, lock);
 }
 
 static void vxlan_uninit(struct net_device *dev)
@@ -1925,7 +2298,11 @@ static void vxlan_uninit(struct net_device *dev)
 	struct vxlan_dev *vxlan = netdev_priv(dev);
 	struct vxlan_sock *vs = vxlan->vn_sock;
 
+	vxlan_learn_purge(vxlan);
+	/* deleting the last entry may queue another resize */
 	vxlan_fdb_delete_default(vxlan);
+	cancel_work_sync(&vxlan->fdb_resize);
+	vxlan_fdb_table_destroy(vxlan);
 
 	if (vs)
 		vxlan_sock_release(vs);
@@ -1959,20 +2336,26 @@ static int vxlan_open(struct net_device *dev)
 /* Purge the forwarding table */
 static void vxlan_flush(struct vxlan_dev *vxlan)
 {
+	struct vxlan_fdb_table *t;
 	unsigned int h;
 
-	spin_lock_bh(&vxlan->hash_lock);
-	for (h = 0; h < FDB_HASH_SIZE; ++h) {
-		struct hlist_node *p, *n;
-		hlist_for_each_safe(p, n, &vxlan->fdb_head[h]) {
-			struct vxlan_fdb *f
-				= container_of(p, struct vxlan_fdb, hlist);
+	read_lock_bh(&vxlan->table_lock);
+	t = vxlan_fdb_table(vxlan);
+	for (h = 0; h < t->size; ++h) {
+		spinlock_t *lock = &vxlan->bucket_lock[h & (FDB_LOCK_SIZE - 1)];
+		struct hlist_node *n;
+		struct vxlan_fdb *f;
+
+		spin_lock(lock);
+		hlist_for_each_entry_safe(f, n, &t->buckets[h],
+					  hlist[t->node_ver]) {
 			/* the all_zeros_mac entry is deleted at vxlan_uninit */
 			if (!is_zero_ether_addr(f->eth_addr))
 				vxlan_fdb_destroy(vxlan, f);
 		}
+		spin_unlock(lock);
 	}
-	spin_unlock_bh(&vxlan->hash_lock);
+	read_unlock_bh(&vxlan->table_lock);
 }
 
 /* Cleanup timer and forwarding table on shutdown */
@@ -1991,6 +2374,7 @@ static int vxlan_stop(struct net_device *dev)
 
 	del_timer_sync(&vxlan->age_timer);
 
+	vxlan_learn_purge(vxlan);
 	vxlan_flush(vxlan);
 
 	return 0;
@@ -2082,7 +2466,13 @@ static void vxlan_setup(struct net_device *dev)
 	dev->priv_flags |= IFF_LIVE_ADDR_CHANGE;
 
 	INIT_LIST_HEAD(&vxlan->next);
-	spin_lock_init(&vxlan->hash_lock);
+	rwlock_init(&vxlan->table_lock);
+	for (h = 0; h < FDB_LOCK_SIZE; ++h)
+		spin_lock_init(&vxlan->bucket_lock[h]);
+	INIT_WORK(&vxlan->fdb_resize, vxlan_fdb_resize);
+	spin_lock_init(&vxlan->learn_lock);
+	INIT_LIST_HEAD(&vxlan->learn_list);
+	INIT_WORK(&vxlan->learn_work, vxlan_learn_work);
 	INIT_WORK(&vxlan->igmp_join, vxlan_igmp_join);
 	INIT_WORK(&vxlan->igmp_leave, vxlan_igmp_leave);
 	INIT_WORK(&vxlan->sock_work, vxlan_sock_work);
@@ -2097,9 +2487,6 @@ static void vxlan_setup(struct net_device *dev)
 	vxlan->dst_port = htons(vxlan_port);
 
 	vxlan->dev = dev;
-
-	for (h = 0; h < FDB_HASH_SIZE; ++h)
-		INIT_HLIST_HEAD(&vxlan->fdb_head[h]);
 }
 
 static const struct nla_policy vxlan_policy[IFLA_VXLAN_MAX + 1] = {
@@ -2166,9 +2553,73 @@ static void vxlan_get_drvinfo(struct net_device *netdev,
 	strlcpy(drvinfo->driver, "vxlan", sizeof(drvinfo->driver));
 }
 
+static const char vxlan_gstrings_stats[][ETH_GSTRING_LEN] = {
+	"fdb_entries",
+	"fdb_buckets",
+	"fdb_used_buckets",
+	"fdb_max_chain",
+	"fdb_resizes",
+	"fdb_learn_dropped",
+};
+
+static void vxlan_get_strings(struct net_device *dev, u32 stringset, u8 *buf)
+{
+	switch (stringset) {
+	case ETH_SS_STATS:
+		memcpy(buf, vxlan_gstrings_stats, sizeof(vxlan_gstrings_stats));
+		break;
+	}
+}
+
+static int vxlan_get_sset_count(struct net_device *dev, int sset)
+{
+	switch (sset) {
+	case ETH_SS_STATS:
+		return ARRAY_SIZE(vxlan_gstrings_stats);
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+/* Chain lengths are only gathered here, by walking the whole table */
+static void vxlan_get_ethtool_stats(struct net_device *dev,
+				    struct ethtool_stats *stats, u64 *data)
+{
+	struct vxlan_dev *vxlan = netdev_priv(dev);
+	struct vxlan_fdb_table *t;
+	unsigned int h, used = 0, max_chain = 0;
+
+	rcu_read_lock();
+	t = rcu_dereference(vxlan->fdb_table);
+	for (h = 0; t && h < t->size; ++h) {
+		struct vxlan_fdb *f;
+		unsigned int len = 0;
+
+		hlist_for_each_entry_rcu(f, &t->buckets[h],
+					 hlist[t->node_ver])
+			++len;
+
+		if (len)
+			++used;
+		max_chain = max(max_chain, len);
+	}
+
+	data[0] = atomic_read(&vxlan->addrcnt);
+	data[1] = t ? t->size : 0;
+	data[2] = used;
+	data[3] = max_chain;
+	rcu_read_unlock();
+
+	data[4] = vxlan->fdb_resizes;
+	data[5] = vxlan->learn_dropped;
+}
+
 static const struct ethtool_ops vxlan_ethtool_ops = {
-	.get_drvinfo	= vxlan_get_drvinfo,
-	.get_link	= ethtool_op_get_link,
+	.get_drvinfo		= vxlan_get_drvinfo,
+	.get_link		= ethtool_op_get_link,
+	.get_strings		= vxlan_get_strings,
+	.get_sset_count		= vxlan_get_sset_count,
+	.get_ethtool_stats	= vxlan_get_ethtool_stats,
 };
 
 static void vxlan_del_work(struct work_struct *work)
@@ -2376,7 +2827,8 @@ static int vxlan_newlink(struct net *net, struct net_device *dev,
 	struct vxlan_net *vn = net_generic(net, vxlan_net_id);
 	struct vxlan_dev *vxlan = netdev_priv(dev);
 	struct vxlan_rdst *dst = &vxlan->default_dst;
-	__u32 vni;
+	struct vxlan_fdb_table *t;
+	__u32 vni, seed;
 	int err;
 	bool use_ipv6 = false;
 
@@ -2489,8 +2941,16 @@ static int vxlan_newlink(struct net *net, struct net_device *dev,
 
 	SET_ETHTOOL_OPS(dev, &vxlan_ethtool_ops);
 
+	get_random_bytes(&seed, sizeof(seed));
+	t = vxlan_fdb_table_alloc(FDB_HASH_MIN_SIZE, seed);
+	if (!t)
+		return -ENOMEM;
+	RCU_INIT_POINTER(vxlan->fdb_table, t);
+
 	/* create an fdb entry for a valid default destination */
 	if (!vxlan_addr_any(&vxlan->default_dst.remote_ip)) {
+		spinlock_t *lock = vxlan_fdb_lock_bh(vxlan, all_zeros_mac);
+
 		err = vxlan_fdb_create(vxlan, all_zeros_mac,
 				       &vxlan->default_dst.remote_ip,
 				       NUD_REACHABLE|NUD_PERMANENT,
@@ -2499,19 +2959,24 @@ static int vxlan_newlink(struct net *net, struct net_device *dev,
 				       vxlan->default_dst.remote_vni,
 				       vxlan->default_dst.remote_ifindex,
 				       NTF_SELF);
+		vxlan_fdb_unlock_bh(vxlan, lock);
 		if (err)
-			return err;
+			goto err_table;
 	}
 
 	err = register_netdevice(dev);
 	if (err) {
 		vxlan_fdb_delete_default(vxlan);
-		return err;
+		goto err_table;
 	}
 
 	list_add(&vxlan->next, &vn->vxlan_list);
 
 	return 0;
+
+err_table:
+	vxlan_fdb_table_destroy(vxlan);
+	return err;
 }
 
 static void vxlan_dellink(struct net_device *dev, struct list_head *head)
@@ -2697,6 +3162,8 @@ static void __exit vxlan_cleanup_module(void)
 	rtnl_link_unregister(&vxlan_link_ops);
 	destroy_workqueue(vxlan_wq);
 	unregister_pernet_device(&vxlan_net_ops);
+	/* table frees go through call_rcu_bh() first, then call_rcu() */
+	rcu_barrier_bh();
 	rcu_barrier();
 }
 module_exit(vxlan_cleanup_module);
@@ -2462,6 +2462,113 @@ static int key_search(struct extent_buffer *b, struct btrfs_key *key,
 	return 0;
 }
 
+/*
+ * optimistic version of btrfs_search_slot for plain readers.  Instead of
+ * read locking every node on the way down (and every reader in the fs
+ * fighting over the lock on the root), we only hold references on the
+ * nodes and check the lock sequence of each one after reading from it.
+ * Writers bump the sequence whenever they take or drop the write lock,
+ * and every change to a tree block (cow, split, merge, freeing) happens
+ * under that lock, so an unchanged sequence on the parent proves the
+ * child pointer we followed was still current when we grabbed the child.
+ *
+ * Only the leaf is read locked, the path looks just like the one the
+ * locking search leaves behind once unlock_up has run.
+ *
+ * Blocks that aren't cached and up to date, or any sign of a concurrent
+ * writer, make us return -EAGAIN with the path released, and the caller
+ * falls back to the locking search.
+ */
+static int search_slot_optimistic(struct btrfs_root *root,
+				  struct btrfs_key *key,
+				  struct btrfs_path *p)
+{
+	struct extent_buffer *b;
+	struct extent_buffer *tmp;
+	unsigned seq;
+	unsigned tmp_seq;
+	u32 nritems;
+	u64 blocknr;
+	u64 gen;
+	int level;
+	int expect_level = -1;
+	int slot;
+	int ret;
+
+	b = btrfs_root_node(root);
+	seq = btrfs_tree_read_seq(b);
+	if (b != ACCESS_ONCE(root->node))
+		goto fail;
+
+	while (1) {
+		level = btrfs_header_level(b);
+		nritems = btrfs_header_nritems(b);
+
+		/*
+		 * a writer may be halfway through changing b, don't let
+		 * garbage send the binary search off the end of the buffer
+		 */
+		if (level >= BTRFS_MAX_LEVEL ||
+		    (expect_level >= 0 && level != expect_level))
+			goto fail;
+		if (level == 0) {
+			if (nritems > BTRFS_LEAF_DATA_SIZE(root) /
+				      sizeof(struct btrfs_item))
+				goto fail;
+		} else if (nritems > BTRFS_NODEPTRS_PER_BLOCK(root)) {
+			goto fail;
+		}
+
+		ret = bin_search(b, key, level, &slot);
+		if (level == 0)
+			break;
+
+		if (ret && slot > 0)
+			slot -= 1;
+		blocknr = btrfs_node_blockptr(b, slot);
+		gen = btrfs_node_ptr_generation(b, slot);
+		if (btrfs_tree_read_seq_retry(b, seq))
+			goto fail;
+
+		tmp = btrfs_find_tree_block(root, blocknr,
+					    btrfs_level_size(root, level - 1));
+		if (!tmp)
+			goto fail;
+		if (btrfs_buffer_uptodate(tmp, gen, 1) <= 0) {
+			free_extent_buffer(tmp);
+			goto fail;
+		}
+		tmp_seq = btrfs_tree_read_seq(tmp);
+
+		/* b still pointed to tmp after we sampled tmp's sequence */
+		if (btrfs_tree_read_seq_retry(b, seq)) {
+			free_extent_buffer(tmp);
+			goto fail;
+		}
+
+		p->nodes[level] = b;
+		p->slots[level] = slot;
+		expect_level = level - 1;
+		b = tmp;
+		seq = tmp_seq;
+	}
+
+	btrfs_tree_read_lock(b);
+	if (btrfs_tree_read_seq_retry(b, seq)) {
+		btrfs_tree_read_unlock(b);
+		goto fail;
+	}
+	p->nodes[0] = b;
+	p->locks[0] = BTRFS_READ_LOCK;
+	p->slots[0] = slot;
+	return ret;
+
+fail:
+	free_extent_buffer(b);
+	btrfs_release_path(p);
+	return -EAGAIN;
+}
+
 /*
  * look for key in the tree.  path is filled in with nodes along the way
  * if key is found, we return zero and you can find the item in the leaf
@@ -2520,6 +2627,14 @@ int btrfs_search_slot(struct btrfs_trans_handle *trans, struct btrfs_root
 
 	min_write_lock_level = write_lock_level;
 
+	if (!cow && !ins_len && !lowest_level && !p->keep_locks &&
+	    !p->skip_locking && !p->search_commit_root &&
+	    !p->search_for_split) {
+		ret = search_slot_optimistic(root, key, p);
+		if (ret != -EAGAIN)
+			goto done;
+	}
+
 again:
 	prev_cmp = -1;
 	/*
@@ -2,6 +2,7 @@
 #define __EXTENTIO__
 
 #include <linux/rbtree.h>
+#include <linux/seqlock.h>
 
 /* bits for the extent state */
 #define EXTENT_DIRTY 1
@@ -150,6 +151,12 @@ struct extent_buffer {
 	/* protects write locks */
 	rwlock_t lock;
 
+	/*
+	 * bumped when a write lock is taken and again when it is dropped,
+	 * so lockless readers can tell if the buffer changed under them
+	 */
+	seqcount_t lock_seq;
+
 	/* readers use lock_wq while they wait for the write
 	 * lock holders to unlock
 	 */
@@ -48,6 +48,23 @@ static inline void btrfs_tree_unlock_rw(struct extent_buffer *eb, int rw)
 		BUG();
 }
 
+/*
+ * lockless readers sample the sequence of a buffer before looking at it
+ * and check it again afterwards.  If a writer held or took the lock in
+ * between, btrfs_tree_read_seq_retry() returns true and whatever was
+ * read must be thrown away.
+ */
+static inline unsigned btrfs_tree_read_seq(struct extent_buffer *eb)
+{
+	return raw_seqcount_begin(&eb->lock_seq);
+}
+
+static inline int btrfs_tree_read_seq_retry(struct extent_buffer *eb,
+					    unsigned seq)
+{
+	return read_seqcount_retry(&eb->lock_seq, seq);
+}
+
 static inline void btrfs_set_lock_blocking(struct extent_buffer *eb)
 {
 	btrfs_set_lock_blocking_rw(eb, BTRFS_WRITE_LOCK);
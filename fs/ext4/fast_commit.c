@@ -0,0 +1,756 @@
+/*
+ *  fs/ext4/fast_commit.c
+ *
+ * Fast commits for fsync.
+ *
+ * fsync normally has to commit the whole running transaction, which means
+ * writing every metadata block any task dirtied, plus a descriptor and a
+ * commit block, just to make one file durable.  For the common case of a
+ * regular file that only grew or had blocks allocated since the last full
+ * commit, a much smaller record is enough: the logical to physical block
+ * ranges allocated to the file, and its size and times.  Such a fast commit
+ * is written to a dedicated area at the end of the journal (see
+ * jbd2_fc_init()) with a single flush, and is replayed on top of the last
+ * full commit at mount time.
+ *
+ * Anything a fast commit cannot describe -- namespace operations, freeing
+ * blocks, attribute and xattr changes, resize -- marks the inode (or the
+ * whole file system) ineligible for the rest of the transaction, and fsync
+ * falls back to a full commit.  The next full commit makes all fast commits
+ * of the transaction obsolete.
+ */
+
+#include <linux/fs.h>
+#include <linux/crc32.h>
+#include <linux/quotaops.h>
+#include "ext4.h"
+#include "ext4_jbd2.h"
+#include "ext4_extents.h"
+#include "fast_commit.h"
+
+void ext4_fc_init_inode(struct inode *inode)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+
+	spin_lock_init(&ei->i_fc_lock);
+	ei->i_fc_tid = 0;
+	ei->i_fc_lblk_start = 0;
+	ei->i_fc_lblk_len = 0;
+	ei->i_fc_ineligible_tid = 0;
+}
+
+/*
+ * Return the transaction a change made without a handle ends up in, or a
+ * later one.  Callers make the change first, so erring late is safe.
+ */
+static tid_t ext4_fc_current_tid(journal_t *journal)
+{
+	tid_t tid;
+
+	read_lock(&journal->j_state_lock);
+	if (journal->j_running_transaction)
+		tid = journal->j_running_transaction->t_tid;
+	else
+		tid = journal->j_transaction_sequence;
+	read_unlock(&journal->j_state_lock);
+	return tid;
+}
+
+static tid_t ext4_fc_handle_tid(handle_t *handle, journal_t *journal)
+{
+	if (ext4_handle_valid(handle))
+		return handle->h_transaction->t_tid;
+	return ext4_fc_current_tid(journal);
+}
+
+/*
+ * Record that @inode was changed in a way fast commits cannot describe.
+ * With a valid @handle the change must be part of it; without one the
+ * change must have been made already.
+ */
+void ext4_fc_mark_ineligible(handle_t *handle, struct inode *inode)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	journal_t *journal = EXT4_SB(inode->i_sb)->s_journal;
+	tid_t tid;
+
+	if (!test_opt(inode->i_sb, FAST_COMMIT) || !journal)
+		return;
+
+	tid = ext4_fc_handle_tid(handle, journal);
+	spin_lock(&ei->i_fc_lock);
+	if (!ext4_test_inode_state(inode, EXT4_STATE_FC_INELIGIBLE) ||
+	    tid_gt(tid, ei->i_fc_ineligible_tid))
+		ei->i_fc_ineligible_tid = tid;
+	ext4_set_inode_state(inode, EXT4_STATE_FC_INELIGIBLE);
+	spin_unlock(&ei->i_fc_lock);
+}
+
+/*
+ * Like ext4_fc_mark_ineligible(), for changes affecting the whole file
+ * system such as resize.  The change must have been made already.
+ */
+void ext4_fc_mark_sb_ineligible(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	tid_t tid;
+
+	if (!test_opt(sb, FAST_COMMIT) || !sbi->s_journal)
+		return;
+
+	tid = ext4_fc_current_tid(sbi->s_journal);
+	spin_lock(&sbi->s_fc_lock);
+	if (!sbi->s_fc_ineligible || tid_gt(tid, sbi->s_fc_ineligible_tid))
+		sbi->s_fc_ineligible_tid = tid;
+	sbi->s_fc_ineligible = 1;
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+/*
+ * Record that logical blocks @lblk to @lblk + @len - 1 of @inode were
+ * allocated or converted to written under @handle.
+ */
+void ext4_fc_track_range(handle_t *handle, struct inode *inode,
+			 ext4_lblk_t lblk, ext4_lblk_t len)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	ext4_lblk_t end;
+	tid_t tid;
+
+	if (!test_opt(inode->i_sb, FAST_COMMIT) ||
+	    !ext4_handle_valid(handle) || !S_ISREG(inode->i_mode))
+		return;
+
+	tid = handle->h_transaction->t_tid;
+	spin_lock(&ei->i_fc_lock);
+	if (ei->i_fc_tid != tid || !ei->i_fc_lblk_len) {
+		ei->i_fc_tid = tid;
+		ei->i_fc_lblk_start = lblk;
+		ei->i_fc_lblk_len = len;
+	} else {
+		end = max(ei->i_fc_lblk_start + ei->i_fc_lblk_len, lblk + len);
+		ei->i_fc_lblk_start = min(ei->i_fc_lblk_start, lblk);
+		ei->i_fc_lblk_len = end - ei->i_fc_lblk_start;
+	}
+	spin_unlock(&ei->i_fc_lock);
+}
+
+static bool ext4_fc_eligible(struct inode *inode, tid_t commit_tid)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	struct ext4_sb_info *sbi = EXT4_SB(inode->i_sb);
+	bool ret = true;
+
+	/*
+	 * Pages of writably mapped files can be dirtied, and thus get blocks
+	 * allocated, while we record the block map; quota usage is not part
+	 * of the record.
+	 */
+	if (!S_ISREG(inode->i_mode) ||
+	    !ext4_test_inode_flag(inode, EXT4_INODE_EXTENTS) ||
+	    ext4_has_inline_data(inode) ||
+	    mapping_writably_mapped(inode->i_mapping) ||
+	    sb_any_quota_loaded(inode->i_sb))
+		return false;
+
+	spin_lock(&ei->i_fc_lock);
+	if (ext4_test_inode_state(inode, EXT4_STATE_FC_INELIGIBLE) &&
+	    tid_geq(ei->i_fc_ineligible_tid, commit_tid))
+		ret = false;
+	spin_unlock(&ei->i_fc_lock);
+
+	spin_lock(&sbi->s_fc_lock);
+	if (sbi->s_fc_ineligible &&
+	    tid_geq(sbi->s_fc_ineligible_tid, commit_tid))
+		ret = false;
+	spin_unlock(&sbi->s_fc_lock);
+
+	return ret;
+}
+
+struct ext4_fc_writer {
+	journal_t *journal;
+	struct buffer_head *bh;	/* block being filled */
+	int off;		/* fill offset in @bh */
+	unsigned long first;	/* area offset of the first block */
+	int nblks;		/* blocks submitted so far */
+	u32 crc;
+};
+
+static void ext4_fc_submit_bh(journal_t *journal, struct buffer_head *bh,
+			      int rw)
+{
+	if (!(journal->j_flags & JBD2_BARRIER))
+		rw &= ~(REQ_FUA | REQ_FLUSH);
+	lock_buffer(bh);
+	clear_buffer_dirty(bh);
+	set_buffer_uptodate(bh);
+	get_bh(bh);
+	bh->b_end_io = end_buffer_write_sync;
+	submit_bh(rw, bh);
+}
+
+/* Pad out the block being filled and send it to disk */
+static void ext4_fc_flush_block(struct ext4_fc_writer *w)
+{
+	int size = w->journal->j_blocksize;
+	struct ext4_fc_tl *tl;
+
+	if (w->off < size) {
+		tl = (struct ext4_fc_tl *)(w->bh->b_data + w->off);
+		tl->fc_tag = cpu_to_le16(EXT4_FC_TAG_PAD);
+		tl->fc_len = cpu_to_le16(size - w->off - sizeof(*tl));
+	}
+	w->crc = crc32_be(w->crc, w->bh->b_data, size);
+	ext4_fc_submit_bh(w->journal, w->bh, WRITE_SYNC);
+	w->bh = NULL;
+	w->nblks++;
+}
+
+/* Make room for a record with a @len bytes value and return the value */
+static void *ext4_fc_reserve(struct ext4_fc_writer *w, int tag, int len)
+{
+	struct ext4_fc_tl *tl;
+	int ret;
+
+	if (w->bh && w->off + sizeof(*tl) + len > w->journal->j_blocksize)
+		ext4_fc_flush_block(w);
+	if (!w->bh) {
+		ret = jbd2_fc_get_buf(w->journal, &w->bh);
+		if (ret)
+			return ERR_PTR(ret);
+		w->off = 0;
+	}
+
+	tl = (struct ext4_fc_tl *)(w->bh->b_data + w->off);
+	tl->fc_tag = cpu_to_le16(tag);
+	tl->fc_len = cpu_to_le16(len);
+	w->off += sizeof(*tl) + len;
+	return tl + 1;
+}
+
+/*
+ * Write the last block of the fast commit.  It goes out with a cache flush
+ * and FUA only once the other blocks are done, so that a tail on disk
+ * implies that the data and all records before it are too.
+ */
+static int ext4_fc_write_tail(struct ext4_fc_writer *w, tid_t tid)
+{
+	journal_t *journal = w->journal;
+	struct ext4_fc_tail *tail;
+	int ret;
+
+	tail = ext4_fc_reserve(w, EXT4_FC_TAG_TAIL, sizeof(*tail));
+	if (IS_ERR(tail))
+		return PTR_ERR(tail);
+	tail->fc_tid = cpu_to_le32(tid);
+	w->crc = crc32_be(w->crc, w->bh->b_data,
+			  (char *)&tail->fc_crc - w->bh->b_data);
+	tail->fc_crc = cpu_to_le32(w->crc);
+
+	ret = jbd2_fc_wait_bufs(journal, w->first, w->nblks);
+	if (ret)
+		return ret;
+	if (journal->j_fs_dev != journal->j_dev &&
+	    (journal->j_flags & JBD2_BARRIER)) {
+		ret = blkdev_issue_flush(journal->j_fs_dev, GFP_NOFS, NULL);
+		if (ret)
+			return ret;
+	}
+	ext4_fc_submit_bh(journal, w->bh, WRITE_FLUSH_FUA);
+	w->bh = NULL;
+	return jbd2_fc_wait_bufs(journal, w->first + w->nblks++, 1);
+}
+
+static int ext4_fc_write_inode(struct ext4_fc_writer *w, struct inode *inode,
+			       tid_t tid, ext4_lblk_t lblk, ext4_lblk_t len)
+{
+	struct ext4_fc_head *head;
+	struct ext4_fc_add_range *range;
+	struct ext4_fc_inode *fc_inode;
+	struct ext4_map_blocks map;
+	struct extent_status es;
+	loff_t size;
+	int ret;
+
+	head = ext4_fc_reserve(w, EXT4_FC_TAG_HEAD, sizeof(*head));
+	if (IS_ERR(head))
+		return PTR_ERR(head);
+	head->fc_magic = cpu_to_le32(EXT4_FC_MAGIC);
+	head->fc_tid = cpu_to_le32(tid);
+
+	while (len) {
+		map.m_lblk = lblk;
+		map.m_len = min_t(ext4_lblk_t, len, EXT_INIT_MAX_LEN);
+		ret = ext4_map_blocks(NULL, inode, &map, 0);
+		if (ret < 0)
+			return ret;
+		if (!ret) {
+			/* A hole: skip it whole if the lookup cached it */
+			ret = 1;
+			if (ext4_es_lookup_extent(inode, lblk, &es) &&
+			    ext4_es_is_hole(&es))
+				ret = min_t(ext4_lblk_t, len,
+					    es.es_lblk + es.es_len - lblk);
+			lblk += ret;
+			len -= ret;
+			continue;
+		}
+		/* Written data would become unwritten again on replay */
+		if (map.m_flags & EXT4_MAP_UNWRITTEN)
+			return -EAGAIN;
+
+		range = ext4_fc_reserve(w, EXT4_FC_TAG_ADD_RANGE,
+					sizeof(*range));
+		if (IS_ERR(range))
+			return PTR_ERR(range);
+		range->fc_ino = cpu_to_le32(inode->i_ino);
+		range->fc_lblk = cpu_to_le32(lblk);
+		range->fc_len = cpu_to_le32(ret);
+		range->fc_pblk_lo = cpu_to_le32(map.m_pblk & 0xffffffff);
+		range->fc_pblk_hi = cpu_to_le32(map.m_pblk >> 32);
+		lblk += ret;
+		len -= ret;
+	}
+
+	fc_inode = ext4_fc_reserve(w, EXT4_FC_TAG_INODE, sizeof(*fc_inode));
+	if (IS_ERR(fc_inode))
+		return PTR_ERR(fc_inode);
+	size = EXT4_I(inode)->i_disksize;
+	fc_inode->fc_ino = cpu_to_le32(inode->i_ino);
+	fc_inode->fc_size_lo = cpu_to_le32(size & 0xffffffff);
+	fc_inode->fc_size_hi = cpu_to_le32(size >> 32);
+	fc_inode->fc_mtime = cpu_to_le32(inode->i_mtime.tv_sec);
+	fc_inode->fc_mtime_nsec = cpu_to_le32(inode->i_mtime.tv_nsec);
+	fc_inode->fc_ctime = cpu_to_le32(inode->i_ctime.tv_sec);
+	fc_inode->fc_ctime_nsec = cpu_to_le32(inode->i_ctime.tv_nsec);
+
+	return ext4_fc_write_tail(w, tid);
+}
+
+/**
+ * ext4_fc_commit() - make an inode durable with a fast commit
+ * @inode: inode to commit
+ * @commit_tid: transaction holding the inode's changes
+ *
+ * Returns 0 once a fast commit covering @inode is on disk, a negative error
+ * if writing back the data failed, or 1 if a full commit of @commit_tid is
+ * needed instead.
+ */
+int ext4_fc_commit(struct inode *inode, tid_t commit_tid)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	journal_t *journal = EXT4_SB(inode->i_sb)->s_journal;
+	struct ext4_fc_writer w;
+	ext4_lblk_t lblk = 0, len = 0;
+	int ret;
+
+	if (!ext4_fc_eligible(inode, commit_tid))
+		return 1;
+
+	/*
+	 * With i_mutex held and no writable mappings nothing can dirty pages
+	 * behind our back, so once the data is written back no more blocks
+	 * get allocated, and every block recorded below holds its data.
+	 */
+	mutex_lock(&inode->i_mutex);
+	ret = filemap_write_and_wait(inode->i_mapping);
+	if (ret)
+		goto out;
+	ret = 1;
+	if (!ext4_fc_eligible(inode, commit_tid))
+		goto out;
+	if (jbd2_fc_begin_commit(journal, commit_tid))
+		goto out;
+
+	spin_lock(&ei->i_fc_lock);
+	if (ei->i_fc_tid == commit_tid) {
+		lblk = ei->i_fc_lblk_start;
+		len = ei->i_fc_lblk_len;
+	}
+	spin_unlock(&ei->i_fc_lock);
+
+	memset(&w, 0, sizeof(w));
+	w.journal = journal;
+	w.first = journal->j_fc_off;
+	w.crc = ~0;
+	if (ext4_fc_write_inode(&w, inode, commit_tid, lblk, len)) {
+		jbd2_fc_end_commit_fallback(journal, commit_tid);
+		goto out;
+	}
+	jbd2_fc_end_commit(journal);
+	ret = 0;
+out:
+	mutex_unlock(&inode->i_mutex);
+	return ret;
+}
+
+/**
+ * ext4_fc_init() - set up fast commits at mount time
+ * @sb: super block
+ *
+ * Reserves the fast commit area in a journal which has none yet.
+ */
+int ext4_fc_init(struct super_block *sb)
+{
+	journal_t *journal = EXT4_SB(sb)->s_journal;
+
+	if (!test_opt(sb, FAST_COMMIT))
+		return 0;
+	/* Setting up the fast commit area rewrites the journal superblock */
+	if ((sb->s_flags & MS_RDONLY) &&
+	    !JBD2_HAS_INCOMPAT_FEATURE(journal,
+				       JBD2_FEATURE_INCOMPAT_FAST_COMMIT))
+		return -EROFS;
+	return jbd2_fc_init(journal, EXT4_NUM_FC_BLKS);
+}
+
+/*
+ * Replay
+ */
+
+enum {
+	EXT4_FC_SCAN,		/* find the complete fast commits */
+	EXT4_FC_REPLAY_MARK,	/* mark their blocks in use */
+	EXT4_FC_REPLAY_APPLY,	/* apply their records */
+};
+
+static bool ext4_fc_len_ok(int tag, int len)
+{
+	switch (tag) {
+	case EXT4_FC_TAG_HEAD:
+		return len >= sizeof(struct ext4_fc_head);
+	case EXT4_FC_TAG_ADD_RANGE:
+		return len >= sizeof(struct ext4_fc_add_range);
+	case EXT4_FC_TAG_INODE:
+		return len >= sizeof(struct ext4_fc_inode);
+	case EXT4_FC_TAG_TAIL:
+		return len >= sizeof(struct ext4_fc_tail);
+	case EXT4_FC_TAG_PAD:
+		return true;
+	}
+	return false;
+}
+
+static struct inode *ext4_fc_iget(struct super_block *sb, unsigned long ino)
+{
+	struct inode *inode;
+
+	inode = ext4_iget(sb, ino);
+	if (IS_ERR(inode))
+		return inode;
+	if (!S_ISREG(inode->i_mode) ||
+	    !ext4_test_inode_flag(inode, EXT4_INODE_EXTENTS) ||
+	    ext4_has_inline_data(inode)) {
+		iput(inode);
+		return ERR_PTR(-EINVAL);
+	}
+	return inode;
+}
+
+static int ext4_fc_mark_range(struct super_block *sb,
+			      struct ext4_fc_add_range *range)
+{
+	ext4_fsblk_t pblk = le32_to_cpu(range->fc_pblk_lo) |
+			    ((ext4_fsblk_t)le32_to_cpu(range->fc_pblk_hi) << 32);
+	unsigned long len = le32_to_cpu(range->fc_len);
+	ext4_group_t group;
+	ext4_grpblk_t off;
+	handle_t *handle;
+	unsigned long n;
+	int ret = 0;
+
+	while (len) {
+		ext4_get_group_no_and_offset(sb, pblk, &group, &off);
+		n = min_t(unsigned long, len, EXT4_BLOCKS_PER_GROUP(sb) - off);
+		handle = ext4_journal_start_sb(sb, EXT4_HT_MISC, 2);
+		if (IS_ERR(handle))
+			return PTR_ERR(handle);
+		ret = ext4_mb_mark_bb(sb, handle, pblk, n);
+		ext4_journal_stop(handle);
+		if (ret)
+			break;
+		pblk += n;
+		len -= n;
+	}
+	return ret;
+}
+
+/* Map a hole of @inode to the blocks recorded for it */
+static int ext4_fc_insert_range(struct inode *inode, ext4_lblk_t lblk,
+				ext4_lblk_t len, ext4_fsblk_t pblk)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	struct ext4_ext_path *path;
+	struct ext4_extent newex;
+	handle_t *handle;
+	int ret;
+
+	handle = ext4_journal_start(inode, EXT4_HT_MAP_BLOCKS,
+				    ext4_chunk_trans_blocks(inode, len));
+	if (IS_ERR(handle))
+		return PTR_ERR(handle);
+
+	down_write(&ei->i_data_sem);
+	path = ext4_ext_find_extent(inode, lblk, NULL, 0);
+	if (IS_ERR(path)) {
+		up_write(&ei->i_data_sem);
+		ret = PTR_ERR(path);
+		goto out;
+	}
+	newex.ee_block = cpu_to_le32(lblk);
+	newex.ee_len = cpu_to_le16(len);
+	ext4_ext_store_pblock(&newex, pblk);
+	ret = ext4_ext_insert_extent(handle, inode, path, &newex, 0);
+	ext4_ext_drop_refs(path);
+	kfree(path);
+	up_write(&ei->i_data_sem);
+	/* Forget the hole the lookups cached */
+	ext4_es_remove_extent(inode, lblk, len);
+	if (ret)
+		goto out;
+
+	dquot_alloc_block_nofail(inode, len);
+	ret = ext4_mark_inode_dirty(handle, inode);
+out:
+	ext4_journal_stop(handle);
+	return ret;
+}
+
+static int ext4_fc_replay_range(struct inode *inode,
+				struct ext4_fc_add_range *range)
+{
+	ext4_lblk_t lblk = le32_to_cpu(range->fc_lblk);
+	ext4_lblk_t len = le32_to_cpu(range->fc_len);
+	ext4_fsblk_t pblk = le32_to_cpu(range->fc_pblk_lo) |
+			    ((ext4_fsblk_t)le32_to_cpu(range->fc_pblk_hi) << 32);
+	struct ext4_map_blocks map;
+	ext4_lblk_t n, max;
+	int ret;
+
+	while (len) {
+		max = min_t(ext4_lblk_t, len, EXT_INIT_MAX_LEN);
+		map.m_lblk = lblk;
+		map.m_len = max;
+		ret = ext4_map_blocks(NULL, inode, &map, 0);
+		if (ret < 0)
+			return ret;
+		n = ret;
+
+		if (!n) {
+			/* Find how far the hole goes, up to one extent */
+			for (n = 1; n < max; n++) {
+				map.m_lblk = lblk + n;
+				map.m_len = 1;
+				ret = ext4_map_blocks(NULL, inode, &map, 0);
+				if (ret < 0)
+					return ret;
+				if (ret)
+					break;
+			}
+			ret = ext4_fc_insert_range(inode, lblk, n, pblk);
+			if (ret)
+				return ret;
+		} else if (map.m_pblk != pblk) {
+			ext4_warning(inode->i_sb, "fast commit replay: inode "
+				     "%lu block %u maps to %llu, not %llu",
+				     inode->i_ino, lblk, map.m_pblk, pblk);
+		} else if (map.m_flags & EXT4_MAP_UNWRITTEN) {
+			ret = ext4_convert_unwritten_extents(NULL, inode,
+				(loff_t)lblk << inode->i_blkbits,
+				(ssize_t)n << inode->i_blkbits);
+			if (ret)
+				return ret;
+		}
+
+		lblk += n;
+		pblk += n;
+		len -= n;
+	}
+	return 0;
+}
+
+static int ext4_fc_replay_inode(struct inode *inode,
+				struct ext4_fc_inode *fc_inode)
+{
+	loff_t size = le32_to_cpu(fc_inode->fc_size_lo) |
+		      ((loff_t)le32_to_cpu(fc_inode->fc_size_hi) << 32);
+	handle_t *handle;
+	int ret;
+
+	handle = ext4_journal_start(inode, EXT4_HT_INODE, 2);
+	if (IS_ERR(handle))
+		return PTR_ERR(handle);
+
+	if (size > i_size_read(inode))
+		i_size_write(inode, size);
+	ext4_update_i_disksize(inode, size);
+	inode->i_mtime.tv_sec = (signed)le32_to_cpu(fc_inode->fc_mtime);
+	inode->i_mtime.tv_nsec = le32_to_cpu(fc_inode->fc_mtime_nsec);
+	inode->i_ctime.tv_sec = (signed)le32_to_cpu(fc_inode->fc_ctime);
+	inode->i_ctime.tv_nsec = le32_to_cpu(fc_inode->fc_ctime_nsec);
+	ret = ext4_mark_inode_dirty(handle, inode);
+	ext4_journal_stop(handle);
+	return ret;
+}
+
+static int ext4_fc_replay_record(struct super_block *sb, int pass, int tag,
+				 void *val)
+{
+	struct ext4_fc_add_range *range = val;
+	struct ext4_fc_inode *fc_inode = val;
+	struct inode *inode;
+	unsigned long ino;
+	int ret;
+
+	if (tag == EXT4_FC_TAG_ADD_RANGE)
+		ino = le32_to_cpu(range->fc_ino);
+	else if (tag == EXT4_FC_TAG_INODE && pass == EXT4_FC_REPLAY_APPLY)
+		ino = le32_to_cpu(fc_inode->fc_ino);
+	else
+		return 0;
+
+	/* The inode may have been deleted by a full commit since */
+	inode = ext4_fc_iget(sb, ino);
+	if (IS_ERR(inode)) {
+		jbd_debug(1, "fast commit replay: skipping inode %lu (%ld)\n",
+			  ino, PTR_ERR(inode));
+		return 0;
+	}
+
+	mutex_lock(&inode->i_mutex);
+	if (pass == EXT4_FC_REPLAY_MARK)
+		ret = ext4_fc_mark_range(sb, range);
+	else if (tag == EXT4_FC_TAG_ADD_RANGE)
+		ret = ext4_fc_replay_range(inode, range);
+	else
+		ret = ext4_fc_replay_inode(inode, fc_inode);
+	mutex_unlock(&inode->i_mutex);
+	iput(inode);
+	return ret;
+}
+
+/*
+ * Walk the records of the fast commit area.  The scan pass stops at the
+ * first record which does not belong to a complete fast commit of the
+ * transaction to replay and returns in @nblks the number of blocks taken up
+ * by complete fast commits.  The replay passes walk those blocks only.
+ */
+static int ext4_fc_walk(struct super_block *sb, int pass, unsigned long *nblks)
+{
+	journal_t *journal = EXT4_SB(sb)->s_journal;
+	tid_t tid = journal->j_fc_replay_tid;
+	int size = journal->j_blocksize;
+	unsigned long off, end;
+	struct buffer_head *bh;
+	struct ext4_fc_tl *tl;
+	struct ext4_fc_head *head;
+	struct ext4_fc_tail *tail;
+	bool in_fc = false;
+	u32 crc = ~0;
+	int pos, tag, len, ret = 0;
+
+	end = pass == EXT4_FC_SCAN ? ULONG_MAX : *nblks;
+	if (pass == EXT4_FC_SCAN)
+		*nblks = 0;
+
+	for (off = 0; off < end; off++) {
+		ret = jbd2_fc_read_buf(journal, off, &bh);
+		if (ret) {
+			if (ret == -ENOSPC)
+				ret = 0;
+			break;
+		}
+
+		for (pos = 0; pos + (int)sizeof(*tl) <= size;
+		     pos += sizeof(*tl) + len) {
+			tl = (struct ext4_fc_tl *)(bh->b_data + pos);
+			tag = le16_to_cpu(tl->fc_tag);
+			len = le16_to_cpu(tl->fc_len);
+			if (pos + sizeof(*tl) + len > size ||
+			    !ext4_fc_len_ok(tag, len))
+				goto stop;
+			if (tag == EXT4_FC_TAG_PAD)
+				break;
+
+			if (!in_fc) {
+				head = (struct ext4_fc_head *)(tl + 1);
+				if (tag != EXT4_FC_TAG_HEAD || pos ||
+				    le32_to_cpu(head->fc_magic) != EXT4_FC_MAGIC ||
+				    le32_to_cpu(head->fc_tid) != tid)
+					goto stop;
+				in_fc = true;
+				crc = ~0;
+				continue;
+			}
+
+			if (tag == EXT4_FC_TAG_TAIL) {
+				tail = (struct ext4_fc_tail *)(tl + 1);
+				crc = crc32_be(crc, bh->b_data,
+					       (char *)&tail->fc_crc - bh->b_data);
+				if (le32_to_cpu(tail->fc_tid) != tid ||
+				    le32_to_cpu(tail->fc_crc) != crc)
+					goto stop;
+				in_fc = false;
+				if (pass == EXT4_FC_SCAN)
+					*nblks = off + 1;
+				break;
+			}
+			if (tag == EXT4_FC_TAG_HEAD)
+				goto stop;
+
+			if (pass != EXT4_FC_SCAN) {
+				ret = ext4_fc_replay_record(sb, pass, tag,
+							    tl + 1);
+				if (ret)
+					goto stop;
+			}
+		}
+
+		if (in_fc)
+			crc = crc32_be(crc, bh->b_data, size);
+		brelse(bh);
+	}
+	return ret;
+
+stop:
+	brelse(bh);
+	return ret;
+}
+
+/**
+ * ext4_fc_replay() - replay fast commits at mount time
+ * @sb: super block
+ *
+ * Applies the fast commits journal recovery found for the transaction that
+ * did not make it to the log.  Blocks recorded in any of them are marked in
+ * use first, so that extent tree blocks allocated while applying the
+ * records cannot take them.  Applying a fast commit twice is harmless, so a
+ * crash during replay is recovered from by replaying again.
+ */
+int ext4_fc_replay(struct super_block *sb)
+{
+	journal_t *journal = EXT4_SB(sb)->s_journal;
+	unsigned long nblks;
+	int ret;
+
+	if (!journal || !(journal->j_flags & JBD2_FC_REPLAY))
+		return 0;
+
+	ret = ext4_fc_walk(sb, EXT4_FC_SCAN, &nblks);
+	if (ret || !nblks)
+		goto out;
+
+	ext4_msg(sb, KERN_INFO, "replaying fast commits of transaction %u",
+		 journal->j_fc_replay_tid);
+	ret = ext4_fc_walk(sb, EXT4_FC_REPLAY_MARK, &nblks);
+	if (!ret)
+		ret = ext4_fc_walk(sb, EXT4_FC_REPLAY_APPLY, &nblks);
+	if (!ret)
+		ret = ext4_force_commit(sb);
+out:
+	if (ret)
+		return ret;
+	jbd2_fc_replay_done(journal);
+	return 0;
+}
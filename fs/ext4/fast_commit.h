@@ -0,0 +1,66 @@
+/*
+ *  fs/ext4/fast_commit.h
+ *
+ * On-disk format of ext4 fast commits.
+ */
+
+#ifndef _EXT4_FAST_COMMIT_H
+#define _EXT4_FAST_COMMIT_H
+
+/* Number of journal blocks set aside for fast commits */
+#define EXT4_NUM_FC_BLKS	256
+
+#define EXT4_FC_MAGIC		0xE4FC0001
+
+/*
+ * A fast commit is a stream of tag-length-value records in consecutive
+ * blocks of the fast commit area.  It starts with a HEAD record in a fresh
+ * block and ends with a TAIL record carrying a crc32 of every byte from the
+ * HEAD up to the crc itself.  Records never straddle blocks: the rest of a
+ * block which cannot hold the next record is covered by a PAD record.
+ * All records are multiples of four bytes long.
+ */
+#define EXT4_FC_TAG_HEAD	0x0001
+#define EXT4_FC_TAG_ADD_RANGE	0x0002
+#define EXT4_FC_TAG_INODE	0x0003
+#define EXT4_FC_TAG_PAD		0x0004
+#define EXT4_FC_TAG_TAIL	0x0005
+
+struct ext4_fc_tl {
+	__le16 fc_tag;
+	__le16 fc_len;		/* length of the value that follows */
+};
+
+/* Value of EXT4_FC_TAG_HEAD */
+struct ext4_fc_head {
+	__le32 fc_magic;
+	__le32 fc_tid;		/* transaction the fast commit belongs to */
+};
+
+/* Value of EXT4_FC_TAG_ADD_RANGE: logical blocks mapped to written blocks */
+struct ext4_fc_add_range {
+	__le32 fc_ino;
+	__le32 fc_lblk;
+	__le32 fc_len;
+	__le32 fc_pblk_lo;
+	__le32 fc_pblk_hi;
+};
+
+/* Value of EXT4_FC_TAG_INODE: size and times of an inode */
+struct ext4_fc_inode {
+	__le32 fc_ino;
+	__le32 fc_size_lo;
+	__le32 fc_size_hi;
+	__le32 fc_mtime;
+	__le32 fc_mtime_nsec;
+	__le32 fc_ctime;
+	__le32 fc_ctime_nsec;
+};
+
+/* Value of EXT4_FC_TAG_TAIL */
+struct ext4_fc_tail {
+	__le32 fc_tid;
+	__le32 fc_crc;
+};
+
+#endif	/* _EXT4_FAST_COMMIT_H */
@@ -686,6 +686,8 @@ found:
 
 has_zeroout:
 	up_write((&EXT4_I(inode)->i_data_sem));
+	if (retval > 0)
+		ext4_fc_track_range(handle, inode, map->m_lblk, map->m_len);
 	if (retval > 0 && map->m_flags & EXT4_MAP_MAPPED) {
 		int ret = check_block_validity(inode, map);
 		if (ret != 0)
@@ -3578,6 +3580,7 @@ int ext4_punch_hole(struct inode *inode, loff_t offset, loff_t length)
 		ext4_std_error(sb, ret);
 		goto out_dio;
 	}
+	ext4_fc_mark_ineligible(handle, inode);
 
 	ret = ext4_zero_partial_blocks(handle, inode, offset,
 				       length);
@@ -3725,6 +3728,7 @@ void ext4_truncate(struct inode *inode)
 		ext4_std_error(inode->i_sb, PTR_ERR(handle));
 		return;
 	}
+	ext4_fc_mark_ineligible(handle, inode);
 
 	if (inode->i_size & (inode->i_sb->s_blocksize - 1))
 		ext4_block_truncate_page(handle, mapping, inode->i_size);
@@ -4654,6 +4658,7 @@ int ext4_setattr(struct dentry *dentry, struct iattr *attr)
 		setattr_copy(inode, attr);
 		mark_inode_dirty(inode);
 	}
+	ext4_fc_mark_ineligible(NULL, inode);
 
 	/*
 	 * If the call to ext4_truncate failed to get a transaction handle at
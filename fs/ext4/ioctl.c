@@ -146,6 +146,8 @@ static long swap_inode_boot_loader(struct super_block *sb,
 		err = -EINVAL;
 		goto swap_boot_out;
 	}
+	ext4_fc_mark_ineligible(handle, inode);
+	ext4_fc_mark_ineligible(handle, inode_bl);
 
 	/* Protect extent tree against block allocations via delalloc */
 	ext4_double_down_write_data_sem(inode, inode_bl);
@@ -329,6 +331,7 @@ flags_err:
 		}
 
 flags_out:
+		ext4_fc_mark_ineligible(NULL, inode);
 		mutex_unlock(&inode->i_mutex);
 		mnt_drop_write_file(filp);
 		return err;
@@ -376,6 +379,7 @@ flags_out:
 		ext4_journal_stop(handle);
 
 unlock_out:
+		ext4_fc_mark_ineligible(NULL, inode);
 		mutex_unlock(&inode->i_mutex);
 setversion_out:
 		mnt_drop_write_file(filp);
@@ -414,6 +418,7 @@ setversion_out:
 		}
 		if (err == 0)
 			err = err2;
+		ext4_fc_mark_sb_ineligible(sb);
 		mnt_drop_write_file(filp);
 group_extend_out:
 		ext4_resize_end(sb);
@@ -457,6 +462,8 @@ group_extend_out:
 
 		err = ext4_move_extents(filp, donor.file, me.orig_start,
 					me.donor_start, me.len, &me.moved_len);
+		ext4_fc_mark_ineligible(NULL, inode);
+		ext4_fc_mark_ineligible(NULL, file_inode(donor.file));
 		mnt_drop_write_file(filp);
 
 		if (copy_to_user((struct move_extent __user *)arg,
@@ -501,6 +508,7 @@ mext_out:
 		}
 		if (err == 0)
 			err = err2;
+		ext4_fc_mark_sb_ineligible(sb);
 		mnt_drop_write_file(filp);
 		if (!err && ext4_has_group_desc_csum(sb) &&
 		    test_opt(sb, INIT_INODE_TABLE))
@@ -527,6 +535,7 @@ group_add_out:
 		 */
 		mutex_lock(&(inode->i_mutex));
 		err = ext4_ext_migrate(inode);
+		ext4_fc_mark_ineligible(NULL, inode);
 		mutex_unlock(&(inode->i_mutex));
 		mnt_drop_write_file(filp);
 		return err;
@@ -584,6 +593,7 @@ group_add_out:
 		}
 		if (err == 0)
 			err = err2;
+		ext4_fc_mark_sb_ineligible(sb);
 		mnt_drop_write_file(filp);
 		if (!err && (o_group > EXT4_SB(sb)->s_groups_count) &&
 		    ext4_has_group_desc_csum(sb) &&
@@ -4993,6 +4993,114 @@ error_return:
 	return err;
 }
 
+/**
+ * ext4_mb_mark_bb() -- mark blocks in use for fast commit replay
+ * @sb:		super block
+ * @handle:	handle to this transaction
+ * @block:	first block to mark
+ * @count:	number of blocks to mark
+ *
+ * Marks the blocks as in use in the block bitmap, the buddy and the free
+ * block counters.  Blocks which are in use already are skipped, so replaying
+ * the same fast commit twice does no harm.  The range may not cross a
+ * block group boundary, and bigalloc is not supported.
+ */
+int ext4_mb_mark_bb(struct super_block *sb, handle_t *handle,
+		    ext4_fsblk_t block, unsigned long count)
+{
+	struct buffer_head *bitmap_bh = NULL;
+	struct buffer_head *gdp_bh;
+	struct ext4_group_desc *gdp;
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_free_extent ex;
+	struct ext4_buddy e4b;
+	ext4_group_t group;
+	ext4_grpblk_t bit, end, i;
+	int err, ret, marked = 0;
+
+	ext4_get_group_no_and_offset(sb, block, &group, &bit);
+	if (group >= ext4_get_groups_count(sb) ||
+	    bit + count > EXT4_BLOCKS_PER_GROUP(sb))
+		return -EINVAL;
+
+	if (!ext4_data_block_valid(sbi, block, count)) {
+		ext4_error(sb, "Marking blocks %llu-%llu which overlap "
+			   "fs metadata", block, block + count - 1);
+		return -EIO;
+	}
+
+	bitmap_bh = ext4_read_block_bitmap(sb, group);
+	if (!bitmap_bh)
+		return -EIO;
+
+	err = -EIO;
+	gdp = ext4_get_group_desc(sb, group, &gdp_bh);
+	if (!gdp)
+		goto out;
+
+	err = ext4_journal_get_write_access(handle, bitmap_bh);
+	if (err)
+		goto out;
+	err = ext4_journal_get_write_access(handle, gdp_bh);
+	if (err)
+		goto out;
+
+	err = ext4_mb_load_buddy(sb, group, &e4b);
+	if (err)
+		goto out;
+
+	ext4_lock_group(sb, group);
+	end = bit + count;
+	for (i = bit; i < end; ) {
+		if (mb_test_bit(i, bitmap_bh->b_data) ||
+		    mb_test_bit(i, e4b.bd_bitmap)) {
+			i++;
+			continue;
+		}
+		ex.fe_logical = 0;
+		ex.fe_group = group;
+		ex.fe_start = i;
+		while (i < end && !mb_test_bit(i, bitmap_bh->b_data) &&
+		       !mb_test_bit(i, e4b.bd_bitmap))
+			i++;
+		ex.fe_len = i - ex.fe_start;
+		ext4_set_bits(bitmap_bh->b_data, ex.fe_start, ex.fe_len);
+		mb_mark_used(&e4b, &ex);
+		marked += ex.fe_len;
+	}
+	if (marked) {
+		if (gdp->bg_flags & cpu_to_le16(EXT4_BG_BLOCK_UNINIT)) {
+			gdp->bg_flags &= cpu_to_le16(~EXT4_BG_BLOCK_UNINIT);
+			ext4_free_group_clusters_set(sb, gdp,
+				ext4_free_clusters_after_init(sb, group, gdp));
+		}
+		ext4_free_group_clusters_set(sb, gdp,
+			ext4_free_group_clusters(sb, gdp) - marked);
+		ext4_block_bitmap_csum_set(sb, group, gdp, bitmap_bh);
+		ext4_group_desc_csum_set(sb, group, gdp);
+	}
+	ext4_unlock_group(sb, group);
+	ext4_mb_unload_buddy(&e4b);
+
+	if (!marked)
+		goto out;
+
+	percpu_counter_sub(&sbi->s_freeclusters_counter, marked);
+	if (sbi->s_log_groups_per_flex) {
+		ext4_group_t flex_group = ext4_flex_group(sbi, group);
+		atomic64_sub(marked,
+			     &sbi->s_flex_groups[flex_group].free_clusters);
+	}
+
+	err = ext4_handle_dirty_metadata(handle, NULL, bitmap_bh);
+	ret = ext4_handle_dirty_metadata(handle, NULL, gdp_bh);
+	if (!err)
+		err = ret;
+out:
+	brelse(bitmap_bh);
+	return err;
+}
+
 /**
  * ext4_trim_extent -- function to TRIM one single free extent in the group
  * @sb:		super block for the file system
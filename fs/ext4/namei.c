@@ -2793,6 +2793,7 @@ static int ext4_unlink(struct inode *dir, struct dentry *dentry)
 
 	if (IS_DIRSYNC(dir))
 		ext4_handle_sync(handle);
+	ext4_fc_mark_ineligible(handle, inode);
 
 	if (!inode->i_nlink) {
 		ext4_warning(inode->i_sb,
@@ -2947,6 +2948,7 @@ retry:
 
 	if (IS_DIRSYNC(dir))
 		ext4_handle_sync(handle);
+	ext4_fc_mark_ineligible(handle, inode);
 
 	inode->i_ctime = ext4_current_time(inode);
 	ext4_inc_count(handle, inode);
@@ -3062,6 +3064,9 @@ static int ext4_rename(struct inode *old_dir, struct dentry *old_dentry,
 
 	if (IS_DIRSYNC(old_dir) || IS_DIRSYNC(new_dir))
 		ext4_handle_sync(handle);
+	ext4_fc_mark_ineligible(handle, old_inode);
+	if (new_inode)
+		ext4_fc_mark_ineligible(handle, new_inode);
 
 	if (S_ISDIR(old_inode->i_mode)) {
 		if (new_inode) {
@@ -399,6 +399,28 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	if (JBD2_HAS_INCOMPAT_FEATURE(journal, JBD2_FEATURE_INCOMPAT_CSUM_V2))
 		csum_size = sizeof(struct jbd2_journal_block_tail);
 
+	/*
+	 * Wait for a fast commit in progress to finish and keep new ones out
+	 * until this transaction is on disk: the fast commit area gets reused
+	 * for the next transaction once we are done.
+	 */
+	if (JBD2_HAS_INCOMPAT_FEATURE(journal,
+				      JBD2_FEATURE_INCOMPAT_FAST_COMMIT)) {
+		write_lock(&journal->j_state_lock);
+		while (journal->j_flags & JBD2_FAST_COMMIT_ONGOING) {
+			DEFINE_WAIT(wait);
+
+			prepare_to_wait(&journal->j_fc_wait, &wait,
+					TASK_UNINTERRUPTIBLE);
+			write_unlock(&journal->j_state_lock);
+			schedule();
+			finish_wait(&journal->j_fc_wait, &wait);
+			write_lock(&journal->j_state_lock);
+		}
+		journal->j_flags |= JBD2_FULL_COMMIT_ONGOING;
+		write_unlock(&journal->j_state_lock);
+	}
+
 	/*
 	 * First job: lock down the current transaction and wait for
 	 * all outstanding updates to complete.
@@ -1108,6 +1130,8 @@ restart_loop:
 	J_ASSERT(commit_transaction == journal->j_committing_transaction);
 	journal->j_commit_sequence = commit_transaction->t_tid;
 	journal->j_committing_transaction = NULL;
+	journal->j_flags &= ~JBD2_FULL_COMMIT_ONGOING;
+	journal->j_fc_off = 0;
 	commit_time = ktime_to_ns(ktime_sub(ktime_get(), start_time));
 
 	/*
@@ -1159,4 +1183,5 @@ restart_loop:
 	spin_unlock(&journal->j_list_lock);
 	write_unlock(&journal->j_state_lock);
 	wake_up(&journal->j_wait_done_commit);
+	wake_up(&journal->j_fc_wait);
 }
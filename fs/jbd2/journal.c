@@ -89,6 +89,15 @@ EXPORT_SYMBOL(jbd2_log_wait_commit);
 EXPORT_SYMBOL(jbd2_log_start_commit);
 EXPORT_SYMBOL(jbd2_journal_start_commit);
 EXPORT_SYMBOL(jbd2_journal_force_commit_nested);
+EXPORT_SYMBOL(jbd2_fc_init);
+EXPORT_SYMBOL(jbd2_fc_begin_commit);
+EXPORT_SYMBOL(jbd2_fc_end_commit);
+EXPORT_SYMBOL(jbd2_fc_end_commit_fallback);
+EXPORT_SYMBOL(jbd2_fc_get_buf);
+EXPORT_SYMBOL(jbd2_fc_wait_bufs);
+EXPORT_SYMBOL(jbd2_fc_release_bufs);
+EXPORT_SYMBOL(jbd2_fc_read_buf);
+EXPORT_SYMBOL(jbd2_fc_replay_done);
 EXPORT_SYMBOL(jbd2_journal_wipe);
 EXPORT_SYMBOL(jbd2_journal_blocks_per_page);
 EXPORT_SYMBOL(jbd2_journal_invalidatepage);
@@ -1082,6 +1091,7 @@ static journal_t * journal_init_common (void)
 	init_waitqueue_head(&journal->j_wait_commit);
 	init_waitqueue_head(&journal->j_wait_updates);
 	init_waitqueue_head(&journal->j_wait_reserved);
+	init_waitqueue_head(&journal->j_fc_wait);
 	mutex_init(&journal->j_barrier);
 	mutex_init(&journal->j_checkpoint_mutex);
 	spin_lock_init(&journal->j_revoke_lock);
@@ -1280,7 +1290,7 @@ static int journal_reset(journal_t *journal)
 	unsigned long long first, last;
 
 	first = be32_to_cpu(sb->s_first);
-	last = be32_to_cpu(sb->s_maxlen);
+	last = journal->j_fc_first;
 	if (first + JBD2_MIN_JOURNAL_BLOCKS > last + 1) {
 		printk(KERN_ERR "JBD2: Journal too short (blocks %llu-%llu).\n",
 		       first, last);
@@ -1566,6 +1576,40 @@ out:
 	return err;
 }
 
+/*
+ * Set up the fast commit area, if the journal has one: it takes up the
+ * last s_num_fc_blks blocks of the journal, past the end of the log.
+ */
+static int jbd2_fc_setup(journal_t *journal)
+{
+	journal_superblock_t *sb = journal->j_superblock;
+	unsigned long maxlen = be32_to_cpu(sb->s_maxlen);
+	unsigned long nblks = 0;
+	struct buffer_head **wbuf = NULL;
+
+	if (JBD2_HAS_INCOMPAT_FEATURE(journal,
+				      JBD2_FEATURE_INCOMPAT_FAST_COMMIT)) {
+		nblks = be32_to_cpu(sb->s_num_fc_blks);
+		if (!nblks || be32_to_cpu(sb->s_first) +
+		    JBD2_MIN_JOURNAL_BLOCKS + nblks > maxlen + 1) {
+			printk(KERN_ERR "JBD2: Invalid fast commit area size "
+			       "%lu on %s\n", nblks, journal->j_devname);
+			return -EINVAL;
+		}
+		wbuf = kcalloc(nblks, sizeof(struct buffer_head *),
+			       GFP_KERNEL);
+		if (!wbuf)
+			return -ENOMEM;
+	}
+
+	kfree(journal->j_fc_wbuf);
+	journal->j_fc_wbuf = wbuf;
+	journal->j_fc_first = maxlen - nblks;
+	journal->j_fc_last = maxlen;
+	journal->j_fc_off = 0;
+	return 0;
+}
+
 /*
  * Load the on-disk journal superblock and read the key fields into the
  * journal_t.
@@ -1585,9 +1629,18 @@ static int load_superblock(journal_t *journal)
 	journal->j_tail_sequence = be32_to_cpu(sb->s_sequence);
 	journal->j_tail = be32_to_cpu(sb->s_start);
 	journal->j_first = be32_to_cpu(sb->s_first);
-	journal->j_last = be32_to_cpu(sb->s_maxlen);
 	journal->j_errno = be32_to_cpu(sb->s_errno);
 
+	err = jbd2_fc_setup(journal);
+	if (err)
+		return err;
+	journal->j_last = journal->j_fc_first;
+
+	if (sb->s_fc_replay) {
+		journal->j_flags |= JBD2_FC_REPLAY;
+		journal->j_fc_replay_tid = be32_to_cpu(sb->s_fc_replay_tid);
+	}
+
 	return 0;
 }
 
@@ -1658,6 +1711,297 @@ recovery_error:
 	return -EIO;
 }
 
+/**
+ * int jbd2_fc_init() - Set aside a fast commit area in the journal.
+ * @journal: Journal to act on.
+ * @nblks: Number of blocks to reserve for fast commits.
+ *
+ * Fast commits are written to the last @nblks blocks of the journal, past
+ * the end of the circular log.  The area can only be carved out of an empty
+ * log, so this must be called right after jbd2_journal_load() and before
+ * any handle is started.  A journal which already has a fast commit area
+ * keeps it as it is.
+ */
+int jbd2_fc_init(journal_t *journal, unsigned int nblks)
+{
+	journal_superblock_t *sb = journal->j_superblock;
+	int err;
+
+	if (JBD2_HAS_INCOMPAT_FEATURE(journal,
+				      JBD2_FEATURE_INCOMPAT_FAST_COMMIT))
+		return 0;
+	if (journal->j_format_version < 2)
+		return -EINVAL;
+	if (be32_to_cpu(sb->s_first) + JBD2_MIN_JOURNAL_BLOCKS + nblks >
+	    be32_to_cpu(sb->s_maxlen) + 1)
+		return -ENOSPC;
+
+	write_lock(&journal->j_state_lock);
+	if (journal->j_running_transaction ||
+	    journal->j_committing_transaction ||
+	    journal->j_checkpoint_transactions ||
+	    journal->j_head != journal->j_tail) {
+		write_unlock(&journal->j_state_lock);
+		return -EBUSY;
+	}
+	sb->s_feature_incompat |=
+		cpu_to_be32(JBD2_FEATURE_INCOMPAT_FAST_COMMIT);
+	sb->s_num_fc_blks = cpu_to_be32(nblks);
+	write_unlock(&journal->j_state_lock);
+
+	err = jbd2_fc_setup(journal);
+	if (err) {
+		sb->s_feature_incompat &=
+			~cpu_to_be32(JBD2_FEATURE_INCOMPAT_FAST_COMMIT);
+		sb->s_num_fc_blks = 0;
+		return err;
+	}
+
+	write_lock(&journal->j_state_lock);
+	journal->j_last = journal->j_fc_first;
+	journal->j_free = journal->j_last - journal->j_first;
+	write_unlock(&journal->j_state_lock);
+
+	jbd2_write_superblock(journal, WRITE_FUA);
+	return 0;
+}
+
+/**
+ * int jbd2_fc_begin_commit() - Start a fast commit.
+ * @journal: Journal to act on.
+ * @tid: Running transaction the fast commit belongs to.
+ *
+ * Waits for any full or fast commit in progress and then takes ownership of
+ * the fast commit area.  Returns -EALREADY if @tid got fully committed in
+ * the meantime, and -EINVAL if a fast commit cannot be used for @tid; the
+ * caller then has to fall back to a full commit.
+ */
+int jbd2_fc_begin_commit(journal_t *journal, tid_t tid)
+{
+	if (!JBD2_HAS_INCOMPAT_FEATURE(journal,
+				       JBD2_FEATURE_INCOMPAT_FAST_COMMIT))
+		return -EINVAL;
+
+	write_lock(&journal->j_state_lock);
+	while (!tid_geq(journal->j_commit_sequence, tid) &&
+	       (journal->j_flags & (JBD2_FULL_COMMIT_ONGOING |
+				    JBD2_FAST_COMMIT_ONGOING))) {
+		DEFINE_WAIT(wait);
+
+		prepare_to_wait(&journal->j_fc_wait, &wait,
+				TASK_UNINTERRUPTIBLE);
+		write_unlock(&journal->j_state_lock);
+		schedule();
+		finish_wait(&journal->j_fc_wait, &wait);
+		write_lock(&journal->j_state_lock);
+	}
+
+	if (tid_geq(journal->j_commit_sequence, tid)) {
+		write_unlock(&journal->j_state_lock);
+		return -EALREADY;
+	}
+
+	/*
+	 * Recovery only looks at fast commits if the log is not empty, so the
+	 * first commit after a flush has to be a full one.  Nothing may be
+	 * written to the area either while it still holds unreplayed fast
+	 * commits.
+	 */
+	if ((journal->j_flags & (JBD2_ABORT | JBD2_FLUSHED | JBD2_FC_REPLAY)) ||
+	    !journal->j_running_transaction ||
+	    journal->j_running_transaction->t_tid != tid) {
+		write_unlock(&journal->j_state_lock);
+		return -EINVAL;
+	}
+
+	journal->j_flags |= JBD2_FAST_COMMIT_ONGOING;
+	write_unlock(&journal->j_state_lock);
+	return 0;
+}
+
+/**
+ * void jbd2_fc_end_commit() - Finish a fast commit.
+ * @journal: Journal to act on.
+ *
+ * Releases the fast commit area taken by jbd2_fc_begin_commit().  All
+ * buffers handed out by jbd2_fc_get_buf() must have been waited upon.
+ */
+void jbd2_fc_end_commit(journal_t *journal)
+{
+	write_lock(&journal->j_state_lock);
+	journal->j_flags &= ~JBD2_FAST_COMMIT_ONGOING;
+	write_unlock(&journal->j_state_lock);
+	wake_up(&journal->j_fc_wait);
+}
+
+/**
+ * void jbd2_fc_end_commit_fallback() - Abandon a fast commit.
+ * @journal: Journal to act on.
+ * @tid: Transaction the fast commit belonged to.
+ *
+ * Drops the buffers of a fast commit which could not be completed and
+ * starts a full commit of @tid instead.  Later fast commits wait for that
+ * commit to finish, so nothing gets appended after the incomplete one.  The
+ * caller still has to wait for @tid to commit.
+ */
+void jbd2_fc_end_commit_fallback(journal_t *journal, tid_t tid)
+{
+	jbd2_fc_release_bufs(journal);
+
+	write_lock(&journal->j_state_lock);
+	journal->j_flags &= ~JBD2_FAST_COMMIT_ONGOING;
+	if (!tid_geq(journal->j_commit_sequence, tid)) {
+		journal->j_flags |= JBD2_FULL_COMMIT_ONGOING;
+		__jbd2_log_start_commit(journal, tid);
+	}
+	write_unlock(&journal->j_state_lock);
+	wake_up(&journal->j_fc_wait);
+}
+
+/**
+ * int jbd2_fc_get_buf() - Get the next block of the fast commit area.
+ * @journal: Journal to act on.
+ * @bh_out: Returns a zeroed, uptodate buffer for the block.
+ *
+ * Returns -ENOSPC once the area is full.  The buffer stays referenced by
+ * the journal until jbd2_fc_wait_bufs() or jbd2_fc_release_bufs().
+ */
+int jbd2_fc_get_buf(journal_t *journal, struct buffer_head **bh_out)
+{
+	unsigned long long pblock;
+	struct buffer_head *bh;
+	int ret;
+
+	if (journal->j_fc_first + journal->j_fc_off >= journal->j_fc_last)
+		return -ENOSPC;
+
+	ret = jbd2_journal_bmap(journal, journal->j_fc_first + journal->j_fc_off,
+				&pblock);
+	if (ret)
+		return ret;
+
+	bh = __getblk(journal->j_dev, pblock, journal->j_blocksize);
+	if (!bh)
+		return -ENOMEM;
+
+	lock_buffer(bh);
+	memset(bh->b_data, 0, journal->j_blocksize);
+	set_buffer_uptodate(bh);
+	unlock_buffer(bh);
+
+	journal->j_fc_wbuf[journal->j_fc_off++] = bh;
+	*bh_out = bh;
+	return 0;
+}
+
+/**
+ * int jbd2_fc_wait_bufs() - Wait for fast commit blocks to be written.
+ * @journal: Journal to act on.
+ * @off: Offset of the first block to wait for.
+ * @num_blks: Number of blocks to wait for.
+ *
+ * Waits for the writes of the blocks handed out by jbd2_fc_get_buf() at
+ * offsets @off to @off + @num_blks - 1 and drops the journal's references
+ * to them.  Returns -EIO if any of the writes failed.
+ */
+int jbd2_fc_wait_bufs(journal_t *journal, unsigned long off, int num_blks)
+{
+	struct buffer_head *bh;
+	unsigned long i;
+	int err = 0;
+
+	J_ASSERT(off + num_blks <= journal->j_fc_off);
+
+	for (i = off; i < off + num_blks; i++) {
+		bh = journal->j_fc_wbuf[i];
+		if (!bh)
+			continue;
+		wait_on_buffer(bh);
+		if (unlikely(!buffer_uptodate(bh)))
+			err = -EIO;
+		journal->j_fc_wbuf[i] = NULL;
+		put_bh(bh);
+	}
+	return err;
+}
+
+/**
+ * void jbd2_fc_release_bufs() - Drop all fast commit buffers.
+ * @journal: Journal to act on.
+ */
+void jbd2_fc_release_bufs(journal_t *journal)
+{
+	int i;
+
+	for (i = journal->j_fc_off - 1; i >= 0; i--) {
+		if (!journal->j_fc_wbuf[i])
+			continue;
+		brelse(journal->j_fc_wbuf[i]);
+		journal->j_fc_wbuf[i] = NULL;
+	}
+}
+
+/**
+ * int jbd2_fc_read_buf() - Read a block of the fast commit area.
+ * @journal: Journal to act on.
+ * @off: Offset of the block in the area.
+ * @bh_out: Returns the buffer, which the caller has to release.
+ *
+ * Returns -ENOSPC for offsets past the end of the area.
+ */
+int jbd2_fc_read_buf(journal_t *journal, unsigned long off,
+		     struct buffer_head **bh_out)
+{
+	unsigned long long pblock;
+	struct buffer_head *bh;
+	int ret;
+
+	if (journal->j_fc_first + off >= journal->j_fc_last)
+		return -ENOSPC;
+
+	ret = jbd2_journal_bmap(journal, journal->j_fc_first + off, &pblock);
+	if (ret)
+		return ret;
+
+	bh = __getblk(journal->j_dev, pblock, journal->j_blocksize);
+	if (!bh)
+		return -ENOMEM;
+
+	if (!buffer_uptodate(bh)) {
+		ll_rw_block(READ, 1, &bh);
+		wait_on_buffer(bh);
+		if (!buffer_uptodate(bh)) {
+			brelse(bh);
+			return -EIO;
+		}
+	}
+
+	*bh_out = bh;
+	return 0;
+}
+
+/**
+ * void jbd2_fc_replay_done() - Mark fast commits as replayed.
+ * @journal: Journal to act on.
+ *
+ * Called by the client fs once the changes recorded by the fast commits of
+ * j_fc_replay_tid are safely committed.  Fast commits may be written again
+ * afterwards.
+ */
+void jbd2_fc_replay_done(journal_t *journal)
+{
+	journal_superblock_t *sb = journal->j_superblock;
+
+	write_lock(&journal->j_state_lock);
+	journal->j_flags &= ~JBD2_FC_REPLAY;
+	write_unlock(&journal->j_state_lock);
+
+	if (!sb->s_fc_replay)
+		return;
+	sb->s_fc_replay = 0;
+	jbd2_write_superblock(journal, WRITE_FUA);
+}
+
 /**
  * void jbd2_journal_destroy() - Release a journal_t structure.
  * @journal: Journal to act on.
@@ -1713,6 +2057,7 @@ int jbd2_journal_destroy(journal_t *journal)
 	if (journal->j_chksum_driver)
 		crypto_free_shash(journal->j_chksum_driver);
 	kfree(journal->j_wbuf);
+	kfree(journal->j_fc_wbuf);
 	kfree(journal);
 
 	return err;
@@ -280,6 +280,21 @@ int jbd2_journal_recover(journal_t *journal)
 	jbd_debug(1, "JBD2: Replayed %d and revoked %d/%d blocks\n",
 		  info.nr_replays, info.nr_revoke_hits, info.nr_revokes);
 
+	/*
+	 * Fast commits belong to the first transaction that did not make it
+	 * to the log.  Remember to replay them; the mark is kept in the
+	 * superblock until the client fs says the replay is done, since the
+	 * log restart below makes the transaction ID unrecoverable.
+	 */
+	if (!err && JBD2_HAS_INCOMPAT_FEATURE(journal,
+					JBD2_FEATURE_INCOMPAT_FAST_COMMIT) &&
+	    !sb->s_fc_replay) {
+		sb->s_fc_replay = 1;
+		sb->s_fc_replay_tid = cpu_to_be32(info.end_transaction);
+		journal->j_fc_replay_tid = info.end_transaction;
+		journal->j_flags |= JBD2_FC_REPLAY;
+	}
+
 	/* Restart the log at the next transaction ID, thus invalidating
 	 * any existing commit records in the log. */
 	journal->j_transaction_sequence = ++info.end_transaction;
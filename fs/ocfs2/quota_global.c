@@ -300,12 +300,12 @@ int ocfs2_lock_global_qf(struct ocfs2_mem_dqinfo *oinfo, int ex)
 	status = ocfs2_inode_lock(oinfo->dqi_gqinode, &bh, ex);
 	if (status < 0)
 		return status;
-	spin_lock(&dq_data_lock);
+	spin_lock(&sb_dqopt(oinfo->dqi_gqinode->i_sb)->dq_data_lock);
 	if (!oinfo->dqi_gqi_count++)
 		oinfo->dqi_gqi_bh = bh;
 	else
 		WARN_ON(bh != oinfo->dqi_gqi_bh);
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&sb_dqopt(oinfo->dqi_gqinode->i_sb)->dq_data_lock);
 	if (ex) {
 		mutex_lock(&oinfo->dqi_gqinode->i_mutex);
 		down_write(&OCFS2_I(oinfo->dqi_gqinode)->ip_alloc_sem);
@@ -325,10 +325,10 @@ void ocfs2_unlock_global_qf(struct ocfs2_mem_dqinfo *oinfo, int ex)
 	}
 	ocfs2_inode_unlock(oinfo->dqi_gqinode, ex);
 	brelse(oinfo->dqi_gqi_bh);
-	spin_lock(&dq_data_lock);
+	spin_lock(&sb_dqopt(oinfo->dqi_gqinode->i_sb)->dq_data_lock);
 	if (!--oinfo->dqi_gqi_count)
 		oinfo->dqi_gqi_bh = NULL;
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&sb_dqopt(oinfo->dqi_gqinode->i_sb)->dq_data_lock);
 }
 
 /* Read information header from global quota file */
@@ -418,11 +418,11 @@ static int __ocfs2_global_write_info(struct super_block *sb, int type)
 	struct ocfs2_global_disk_dqinfo dinfo;
 	ssize_t size;
 
-	spin_lock(&dq_data_lock);
+	spin_lock(&sb_dqopt(sb)->dq_data_lock);
 	info->dqi_flags &= ~DQF_INFO_DIRTY;
 	dinfo.dqi_bgrace = cpu_to_le32(info->dqi_bgrace);
 	dinfo.dqi_igrace = cpu_to_le32(info->dqi_igrace);
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&sb_dqopt(sb)->dq_data_lock);
 	dinfo.dqi_syncms = cpu_to_le32(oinfo->dqi_syncms);
 	dinfo.dqi_blocks = cpu_to_le32(oinfo->dqi_gi.dqi_blocks);
 	dinfo.dqi_free_blk = cpu_to_le32(oinfo->dqi_gi.dqi_free_blk);
@@ -499,7 +499,7 @@ int __ocfs2_sync_dquot(struct dquot *dquot, int freeing)
 	/* Update space and inode usage. Get also other information from
 	 * global quota file so that we don't overwrite any changes there.
 	 * We are */
-	spin_lock(&dq_data_lock);
+	spin_lock(&dquot->dq_dqb_lock);
 	spacechange = dquot->dq_dqb.dqb_curspace -
 					OCFS2_DQUOT(dquot)->dq_origspace;
 	inodechange = dquot->dq_dqb.dqb_curinodes -
@@ -555,7 +555,7 @@ int __ocfs2_sync_dquot(struct dquot *dquot, int freeing)
 	__clear_bit(DQ_LASTSET_B + QIF_ITIME_B, &dquot->dq_flags);
 	OCFS2_DQUOT(dquot)->dq_origspace = dquot->dq_dqb.dqb_curspace;
 	OCFS2_DQUOT(dquot)->dq_originodes = dquot->dq_dqb.dqb_curinodes;
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&dquot->dq_dqb_lock);
 	err = ocfs2_qinfo_lock(info, freeing);
 	if (err < 0) {
 		mlog(ML_ERROR, "Failed to lock quota info, losing quota write"
@@ -839,10 +839,10 @@ static int ocfs2_mark_dquot_dirty(struct dquot *dquot)
 
 	/* In case user set some limits, sync dquot immediately to global
 	 * quota file so that information propagates quicker */
-	spin_lock(&dq_data_lock);
+	spin_lock(&dquot->dq_dqb_lock);
 	if (dquot->dq_flags & mask)
 		sync = 1;
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&dquot->dq_dqb_lock);
 	/* This is a slight hack but we can't afford getting global quota
 	 * lock if we already have a transaction started. */
 	if (!sync || journal_current_handle()) {
@@ -81,17 +81,25 @@
 #include <linux/uaccess.h>
 
 /*
- * There are three quota SMP locks. dq_list_lock protects all lists with quotas
- * and quota formats.
- * dq_data_lock protects data from dq_dqb and also mem_dqinfo structures and
- * also guards consistency of dquot->dq_dqb with inode->i_blocks, i_bytes.
- * i_blocks and i_bytes updates itself are guarded by i_lock acquired directly
- * in inode_add_bytes() and inode_sub_bytes(). dq_state_lock protects
- * modifications of quota state (on quotaon and quotaoff) and readers who care
- * about latest values take it as well.
+ * There are two global quota SMP locks. dq_list_lock protects all lists with
+ * quotas and quota formats. dq_state_lock protects modifications of quota
+ * state (on quotaon and quotaoff) and readers who care about latest values
+ * take it as well.
  *
- * The spinlock ordering is hence: dq_data_lock > dq_list_lock > i_lock,
- *   dq_list_lock > dq_state_lock
+ * Usage and limits of a dquot (dquot->dq_dqb) are protected by the dquot's
+ * own dq_dqb_lock, so charging space or inodes only ever contends with other
+ * charges against the same dquot. A charge against several dquots of an
+ * inode takes their locks one at a time and backs out the dquots already
+ * charged if a later one is over its limit. mem_dqinfo structures are
+ * protected by the per-superblock dq_data_lock in struct quota_info.
+ * Consistency of dquot->dq_dqb with inode->i_blocks, i_bytes is guarded by
+ * dqptr_sem: every change of both goes through this file with dqptr_sem held
+ * for reading and __dquot_transfer() holds it for writing. i_blocks and
+ * i_bytes updates itself are guarded by i_lock acquired directly in
+ * inode_add_bytes() and inode_sub_bytes().
+ *
+ * The spinlock ordering is hence: dq_list_lock > dq_state_lock. dq_dqb_lock
+ * and dq_data_lock are leaf locks; no two dq_dqb_locks are ever held at once.
  *
  * Note that some things (eg. sb pointer, type, id) doesn't change during
  * the life of the dquot structure and so needn't to be protected by a lock
@@ -112,7 +120,7 @@
  * it is being allocated) on the first dqget() and when it is being released on
  * the last dqput(). The allocation and release oparations are serialized by
  * the dq_lock and by checking the use count in dquot_release().  Write
- * operations on dquots don't hold dq_lock as they copy data under dq_data_lock
+ * operations on dquots don't hold dq_lock as they copy data under dq_dqb_lock
  * spinlock to internal buffers before writing.
  *
  * Lock ordering (including related VFS locks) is the following:
@@ -129,8 +137,6 @@
 
 static __cacheline_aligned_in_smp DEFINE_SPINLOCK(dq_list_lock);
 static __cacheline_aligned_in_smp DEFINE_SPINLOCK(dq_state_lock);
-__cacheline_aligned_in_smp DEFINE_SPINLOCK(dq_data_lock);
-EXPORT_SYMBOL(dq_data_lock);
 
 void __quota_error(struct super_block *sb, const char *func,
 		   const char *fmt, ...)
@@ -803,6 +809,7 @@ static struct dquot *get_empty_dquot(struct super_block *sb, int type)
 		return NULL;
 
 	mutex_init(&dquot->dq_lock);
+	spin_lock_init(&dquot->dq_dqb_lock);
 	INIT_LIST_HEAD(&dquot->dq_free);
 	INIT_LIST_HEAD(&dquot->dq_inuse);
 	INIT_HLIST_NODE(&dquot->dq_hash);
@@ -1252,7 +1259,7 @@ static int ignore_hardlimit(struct dquot *dquot)
 		!(info->dqi_flags & V1_DQF_RSQUASH));
 }
 
-/* needs dq_data_lock */
+/* needs dquot->dq_dqb_lock */
 static int check_idq(struct dquot *dquot, qsize_t inodes,
 		     struct dquot_warn *warn)
 {
@@ -1289,7 +1296,7 @@ static int check_idq(struct dquot *dquot, qsize_t inodes,
 	return 0;
 }
 
-/* needs dq_data_lock */
+/* needs dquot->dq_dqb_lock */
 static int check_bdq(struct dquot *dquot, qsize_t space, int prealloc,
 		     struct dquot_warn *warn)
 {
@@ -1340,6 +1347,46 @@ static int check_bdq(struct dquot *dquot, qsize_t space, int prealloc,
 	return 0;
 }
 
+/*
+ * Check inode limits of a dquot and charge it if they allow so. The check
+ * and the charge are done atomically under the dquot's dq_dqb_lock.
+ */
+static int dquot_add_inodes(struct dquot *dquot, qsize_t inodes,
+			    struct dquot_warn *warn)
+{
+	int ret;
+
+	spin_lock(&dquot->dq_dqb_lock);
+	ret = check_idq(dquot, inodes, warn);
+	if (!ret)
+		dquot_incr_inodes(dquot, inodes);
+	spin_unlock(&dquot->dq_dqb_lock);
+	return ret;
+}
+
+/*
+ * Check space limits of a dquot for @space of used and @rsv_space of
+ * reserved space and charge it if they allow so (or DQUOT_SPACE_NOFAIL is
+ * set). The check and the charge are done atomically under the dquot's
+ * dq_dqb_lock.
+ */
+static int dquot_add_space(struct dquot *dquot, qsize_t space,
+			   qsize_t rsv_space, int flags,
+			   struct dquot_warn *warn)
+{
+	int ret;
+
+	spin_lock(&dquot->dq_dqb_lock);
+	ret = check_bdq(dquot, space + rsv_space,
+			!(flags & DQUOT_SPACE_WARN), warn);
+	if (!ret || (flags & DQUOT_SPACE_NOFAIL)) {
+		dquot_incr_space(dquot, space);
+		dquot_resv_space(dquot, rsv_space);
+	}
+	spin_unlock(&dquot->dq_dqb_lock);
+	return ret;
+}
+
 static int info_idq_free(struct dquot *dquot, qsize_t inodes)
 {
 	qsize_t newinodes;
@@ -1440,9 +1487,11 @@ static void __dquot_initialize(struct inode *inode, int type)
 			 */
 			rsv = inode_get_rsv_space(inode);
 			if (unlikely(rsv)) {
-				spin_lock(&dq_data_lock);
-				dquot_resv_space(inode->i_dquot[cnt], rsv);
-				spin_unlock(&dq_data_lock);
+				struct dquot *dquot = inode->i_dquot[cnt];
+
+				spin_lock(&dquot->dq_dqb_lock);
+				dquot_resv_space(dquot, rsv);
+				spin_unlock(&dquot->dq_dqb_lock);
 			}
 		}
 	}
@@ -1607,27 +1656,33 @@ int __dquot_alloc_space(struct inode *inode, qsize_t number, int flags)
 		warn[cnt].w_type = QUOTA_NL_NOWARN;
 
 	down_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
-	spin_lock(&dq_data_lock);
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
 		if (!dquots[cnt])
 			continue;
-		ret = check_bdq(dquots[cnt], number,
-				!(flags & DQUOT_SPACE_WARN), &warn[cnt]);
+		if (reserve)
+			ret = dquot_add_space(dquots[cnt], 0, number, flags,
+					      &warn[cnt]);
+		else
+			ret = dquot_add_space(dquots[cnt], number, 0, flags,
+					      &warn[cnt]);
 		if (ret && !(flags & DQUOT_SPACE_NOFAIL)) {
-			spin_unlock(&dq_data_lock);
+			/* Back out changes we already did */
+			while (--cnt >= 0) {
+				struct dquot *dquot = dquots[cnt];
+
+				if (!dquot)
+					continue;
+				spin_lock(&dquot->dq_dqb_lock);
+				if (reserve)
+					dquot_free_reserved_space(dquot, number);
+				else
+					dquot_decr_space(dquot, number);
+				spin_unlock(&dquot->dq_dqb_lock);
+			}
 			goto out_flush_warn;
 		}
 	}
-	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
-		if (!dquots[cnt])
-			continue;
-		if (reserve)
-			dquot_resv_space(dquots[cnt], number);
-		else
-			dquot_incr_space(dquots[cnt], number);
-	}
 	inode_incr_space(inode, number, reserve);
-	spin_unlock(&dq_data_lock);
 
 	if (reserve)
 		goto out_flush_warn;
@@ -1656,23 +1711,25 @@ int dquot_alloc_inode(const struct inode *inode)
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++)
 		warn[cnt].w_type = QUOTA_NL_NOWARN;
 	down_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
-	spin_lock(&dq_data_lock);
-	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
-		if (!dquots[cnt])
-			continue;
-		ret = check_idq(dquots[cnt], 1, &warn[cnt]);
-		if (ret)
-			goto warn_put_all;
-	}
-
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
 		if (!dquots[cnt])
 			continue;
-		dquot_incr_inodes(dquots[cnt], 1);
+		ret = dquot_add_inodes(dquots[cnt], 1, &warn[cnt]);
+		if (ret) {
+			/* Back out changes we already did */
+			while (--cnt >= 0) {
+				struct dquot *dquot = dquots[cnt];
+
+				if (!dquot)
+					continue;
+				spin_lock(&dquot->dq_dqb_lock);
+				dquot_decr_inodes(dquot, 1);
+				spin_unlock(&dquot->dq_dqb_lock);
+			}
+			break;
+		}
 	}
 
-warn_put_all:
-	spin_unlock(&dq_data_lock);
 	if (ret == 0)
 		mark_all_dquot_dirty(dquots);
 	up_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
@@ -1694,16 +1751,18 @@ int dquot_claim_space_nodirty(struct inode *inode, qsize_t number)
 	}
 
 	down_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
-	spin_lock(&dq_data_lock);
 	/* Claim reserved quotas to allocated quotas */
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
-		if (inode->i_dquot[cnt])
-			dquot_claim_reserved_space(inode->i_dquot[cnt],
-							number);
+		struct dquot *dquot = inode->i_dquot[cnt];
+
+		if (dquot) {
+			spin_lock(&dquot->dq_dqb_lock);
+			dquot_claim_reserved_space(dquot, number);
+			spin_unlock(&dquot->dq_dqb_lock);
+		}
 	}
 	/* Update inode bytes */
 	inode_claim_rsv_space(inode, number);
-	spin_unlock(&dq_data_lock);
 	mark_all_dquot_dirty(inode->i_dquot);
 	up_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
 	return 0;
@@ -1723,16 +1782,18 @@ void dquot_reclaim_space_nodirty(struct inode *inode, qsize_t number)
 	}
 
 	down_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
-	spin_lock(&dq_data_lock);
 	/* Claim reserved quotas to allocated quotas */
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
-		if (inode->i_dquot[cnt])
-			dquot_reclaim_reserved_space(inode->i_dquot[cnt],
-						     number);
+		struct dquot *dquot = inode->i_dquot[cnt];
+
+		if (dquot) {
+			spin_lock(&dquot->dq_dqb_lock);
+			dquot_reclaim_reserved_space(dquot, number);
+			spin_unlock(&dquot->dq_dqb_lock);
+		}
 	}
 	/* Update inode bytes */
 	inode_reclaim_rsv_space(inode, number);
-	spin_unlock(&dq_data_lock);
 	mark_all_dquot_dirty(inode->i_dquot);
 	up_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
 	return;
@@ -1757,13 +1818,13 @@ void __dquot_free_space(struct inode *inode, qsize_t number, int flags)
 	}
 
 	down_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
-	spin_lock(&dq_data_lock);
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
 		int wtype;
 
 		warn[cnt].w_type = QUOTA_NL_NOWARN;
 		if (!dquots[cnt])
 			continue;
+		spin_lock(&dquots[cnt]->dq_dqb_lock);
 		wtype = info_bdq_free(dquots[cnt], number);
 		if (wtype != QUOTA_NL_NOWARN)
 			prepare_warning(&warn[cnt], dquots[cnt], wtype);
@@ -1771,9 +1832,9 @@ void __dquot_free_space(struct inode *inode, qsize_t number, int flags)
 			dquot_free_reserved_space(dquots[cnt], number);
 		else
 			dquot_decr_space(dquots[cnt], number);
+		spin_unlock(&dquots[cnt]->dq_dqb_lock);
 	}
 	inode_decr_space(inode, number, reserve);
-	spin_unlock(&dq_data_lock);
 
 	if (reserve)
 		goto out_unlock;
@@ -1799,19 +1860,19 @@ void dquot_free_inode(const struct inode *inode)
 		return;
 
 	down_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
-	spin_lock(&dq_data_lock);
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
 		int wtype;
 
 		warn[cnt].w_type = QUOTA_NL_NOWARN;
 		if (!dquots[cnt])
 			continue;
+		spin_lock(&dquots[cnt]->dq_dqb_lock);
 		wtype = info_idq_free(dquots[cnt], 1);
 		if (wtype != QUOTA_NL_NOWARN)
 			prepare_warning(&warn[cnt], dquots[cnt], wtype);
 		dquot_decr_inodes(dquots[cnt], 1);
+		spin_unlock(&dquots[cnt]->dq_dqb_lock);
 	}
-	spin_unlock(&dq_data_lock);
 	mark_all_dquot_dirty(dquots);
 	up_read(&sb_dqopt(inode->i_sb)->dqptr_sem);
 	flush_warnings(warn);
@@ -1854,11 +1915,11 @@ int __dquot_transfer(struct inode *inode, struct dquot **transfer_to)
 		up_write(&sb_dqopt(inode->i_sb)->dqptr_sem);
 		return 0;
 	}
-	spin_lock(&dq_data_lock);
+	/* dqptr_sem held for writing keeps the inode's usage stable */
 	cur_space = inode_get_bytes(inode);
 	rsv_space = inode_get_rsv_space(inode);
 	space = cur_space + rsv_space;
-	/* Build the transfer_from list and check the limits */
+	/* Build the transfer_from list, check the limits and charge */
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
 		/*
 		 * Skip changes for same uid or gid or for turned off quota-type.
@@ -1868,46 +1929,50 @@ int __dquot_transfer(struct inode *inode, struct dquot **transfer_to)
 		/* Avoid races with quotaoff() */
 		if (!sb_has_quota_active(inode->i_sb, cnt))
 			continue;
-		is_valid[cnt] = 1;
 		transfer_from[cnt] = inode->i_dquot[cnt];
-		ret = check_idq(transfer_to[cnt], 1, &warn_to[cnt]);
+		ret = dquot_add_inodes(transfer_to[cnt], 1, &warn_to[cnt]);
 		if (ret)
 			goto over_quota;
-		ret = check_bdq(transfer_to[cnt], space, 0, &warn_to[cnt]);
-		if (ret)
+		ret = dquot_add_space(transfer_to[cnt], cur_space, rsv_space,
+				      DQUOT_SPACE_WARN, &warn_to[cnt]);
+		if (ret) {
+			spin_lock(&transfer_to[cnt]->dq_dqb_lock);
+			dquot_decr_inodes(transfer_to[cnt], 1);
+			spin_unlock(&transfer_to[cnt]->dq_dqb_lock);
 			goto over_quota;
+		}
+		is_valid[cnt] = 1;
 	}
 
 	/*
-	 * Finally perform the needed transfer from transfer_from to transfer_to
+	 * Finally release the usage from transfer_from and switch the inode
+	 * over to transfer_to
 	 */
 	for (cnt = 0; cnt < MAXQUOTAS; cnt++) {
 		if (!is_valid[cnt])
 			continue;
 		/* Due to IO error we might not have transfer_from[] structure */
 		if (transfer_from[cnt]) {
+			struct dquot *dquot = transfer_from[cnt];
 			int wtype;
-			wtype = info_idq_free(transfer_from[cnt], 1);
+
+			spin_lock(&dquot->dq_dqb_lock);
+			wtype = info_idq_free(dquot, 1);
 			if (wtype != QUOTA_NL_NOWARN)
 				prepare_warning(&warn_from_inodes[cnt],
-						transfer_from[cnt], wtype);
-			wtype = info_bdq_free(transfer_from[cnt], space);
+						dquot, wtype);
+			wtype = info_bdq_free(dquot, space);
 			if (wtype != QUOTA_NL_NOWARN)
 				prepare_warning(&warn_from_space[cnt],
-						transfer_from[cnt], wtype);
-			dquot_decr_inodes(transfer_from[cnt], 1);
-			dquot_decr_space(transfer_from[cnt], cur_space);
-			dquot_free_reserved_space(transfer_from[cnt],
-						  rsv_space);
+						dquot, wtype);
+			dquot_decr_inodes(dquot, 1);
+			dquot_decr_space(dquot, cur_space);
+			dquot_free_reserved_space(dquot, rsv_space);
+			spin_unlock(&dquot->dq_dqb_lock);
 		}
 
-		dquot_incr_inodes(transfer_to[cnt], 1);
-		dquot_incr_space(transfer_to[cnt], cur_space);
-		dquot_resv_space(transfer_to[cnt], rsv_space);
-
 		inode->i_dquot[cnt] = transfer_to[cnt];
 	}
-	spin_unlock(&dq_data_lock);
 	up_write(&sb_dqopt(inode->i_sb)->dqptr_sem);
 
 	mark_all_dquot_dirty(transfer_from);
@@ -1921,7 +1986,18 @@ int __dquot_transfer(struct inode *inode, struct dquot **transfer_to)
 			transfer_to[cnt] = transfer_from[cnt];
 	return 0;
 over_quota:
-	spin_unlock(&dq_data_lock);
+	/* Back out changes we already did */
+	while (--cnt >= 0) {
+		struct dquot *dquot = transfer_to[cnt];
+
+		if (!is_valid[cnt])
+			continue;
+		spin_lock(&dquot->dq_dqb_lock);
+		dquot_decr_inodes(dquot, 1);
+		dquot_decr_space(dquot, cur_space);
+		dquot_free_reserved_space(dquot, rsv_space);
+		spin_unlock(&dquot->dq_dqb_lock);
+	}
 	up_write(&sb_dqopt(inode->i_sb)->dqptr_sem);
 	flush_warnings(warn_to);
 	return ret;
@@ -2407,7 +2483,7 @@ static void do_get_dqblk(struct dquot *dquot, struct fs_disk_quota *di)
 			FS_USER_QUOTA : FS_GROUP_QUOTA;
 	di->d_id = from_kqid_munged(current_user_ns(), dquot->dq_id);
 
-	spin_lock(&dq_data_lock);
+	spin_lock(&dquot->dq_dqb_lock);
 	di->d_blk_hardlimit = stoqb(dm->dqb_bhardlimit);
 	di->d_blk_softlimit = stoqb(dm->dqb_bsoftlimit);
 	di->d_ino_hardlimit = dm->dqb_ihardlimit;
@@ -2416,7 +2492,7 @@ static void do_get_dqblk(struct dquot *dquot, struct fs_disk_quota *di)
 	di->d_icount = dm->dqb_curinodes;
 	di->d_btimer = dm->dqb_btime;
 	di->d_itimer = dm->dqb_itime;
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&dquot->dq_dqb_lock);
 }
 
 int dquot_get_dqblk(struct super_block *sb, struct kqid qid,
@@ -2459,7 +2535,7 @@ static int do_set_dqblk(struct dquot *dquot, struct fs_disk_quota *di)
 	     (di->d_ino_hardlimit > dqi->dqi_maxilimit)))
 		return -ERANGE;
 
-	spin_lock(&dq_data_lock);
+	spin_lock(&dquot->dq_dqb_lock);
 	if (di->d_fieldmask & FS_DQ_BCOUNT) {
 		dm->dqb_curspace = di->d_bcount - dm->dqb_rsvspace;
 		check_blim = 1;
@@ -2525,7 +2601,7 @@ static int do_set_dqblk(struct dquot *dquot, struct fs_disk_quota *di)
 		clear_bit(DQ_FAKE_B, &dquot->dq_flags);
 	else
 		set_bit(DQ_FAKE_B, &dquot->dq_flags);
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&dquot->dq_dqb_lock);
 	mark_dquot_dirty(dquot);
 
 	return 0;
@@ -2560,12 +2636,12 @@ int dquot_get_dqinfo(struct super_block *sb, int type, struct if_dqinfo *ii)
 		return -ESRCH;
 	}
 	mi = sb_dqopt(sb)->info + type;
-	spin_lock(&dq_data_lock);
+	spin_lock(&sb_dqopt(sb)->dq_data_lock);
 	ii->dqi_bgrace = mi->dqi_bgrace;
 	ii->dqi_igrace = mi->dqi_igrace;
 	ii->dqi_flags = mi->dqi_flags & DQF_GETINFO_MASK;
 	ii->dqi_valid = IIF_ALL;
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&sb_dqopt(sb)->dq_data_lock);
 	mutex_unlock(&sb_dqopt(sb)->dqonoff_mutex);
 	return 0;
 }
@@ -2583,7 +2659,7 @@ int dquot_set_dqinfo(struct super_block *sb, int type, struct if_dqinfo *ii)
 		goto out;
 	}
 	mi = sb_dqopt(sb)->info + type;
-	spin_lock(&dq_data_lock);
+	spin_lock(&sb_dqopt(sb)->dq_data_lock);
 	if (ii->dqi_valid & IIF_BGRACE)
 		mi->dqi_bgrace = ii->dqi_bgrace;
 	if (ii->dqi_valid & IIF_IGRACE)
@@ -2591,7 +2667,7 @@ int dquot_set_dqinfo(struct super_block *sb, int type, struct if_dqinfo *ii)
 	if (ii->dqi_valid & IIF_FLAGS)
 		mi->dqi_flags = (mi->dqi_flags & ~DQF_SETINFO_MASK) |
 				(ii->dqi_flags & DQF_SETINFO_MASK);
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&sb_dqopt(sb)->dq_data_lock);
 	mark_info_dirty(sb, type);
 	/* Force write to disk */
 	sb->dq_op->write_info(sb, type);
@@ -153,12 +153,12 @@ static int v2_write_file_info(struct super_block *sb, int type)
 	struct qtree_mem_dqinfo *qinfo = info->dqi_priv;
 	ssize_t size;
 
-	spin_lock(&dq_data_lock);
+	spin_lock(&sb_dqopt(sb)->dq_data_lock);
 	info->dqi_flags &= ~DQF_INFO_DIRTY;
 	dinfo.dqi_bgrace = cpu_to_le32(info->dqi_bgrace);
 	dinfo.dqi_igrace = cpu_to_le32(info->dqi_igrace);
 	dinfo.dqi_flags = cpu_to_le32(info->dqi_flags & DQF_MASK);
-	spin_unlock(&dq_data_lock);
+	spin_unlock(&sb_dqopt(sb)->dq_data_lock);
 	dinfo.dqi_blocks = cpu_to_le32(qinfo->dqi_blocks);
 	dinfo.dqi_free_blk = cpu_to_le32(qinfo->dqi_free_blk);
 	dinfo.dqi_free_entry = cpu_to_le32(qinfo->dqi_free_entry);
@@ -212,3 +212,37 @@ read_failure:
 	kfree(bh);
 	return -EIO;
 }
+
+
+/*
+ * Start reading the device blocks holding a datablock without waiting for
+ * them, so that a later squashfs_read_data() of the block finds them in
+ * flight or already uptodate.  Used by readahead to get the I/O for a
+ * whole window of datablocks going before any of them is decompressed.
+ */
+void squashfs_prefetch_data(struct super_block *sb, u64 index, int length)
+{
+	struct squashfs_sb_info *msblk = sb->s_fs_info;
+	int offset = index & ((1 << msblk->devblksize_log2) - 1);
+	u64 cur_index = index >> msblk->devblksize_log2;
+	struct buffer_head *bh;
+	int bytes;
+
+	length = SQUASHFS_COMPRESSED_SIZE_BLOCK(length);
+	if (length <= 0 || (index + length) > msblk->bytes_used)
+		return;
+
+	/*
+	 * READ rather than READA: squashfs_read_data() won't resubmit a
+	 * buffer that is already locked for I/O, so a dropped READA would
+	 * turn into a read error there.
+	 */
+	for (bytes = -offset; bytes < length; cur_index++) {
+		bh = sb_getblk(sb, cur_index);
+		if (bh == NULL)
+			return;
+		ll_rw_block(READ, 1, &bh);
+		put_bh(bh);
+		bytes += msblk->devblksize;
+	}
+}
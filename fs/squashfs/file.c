@@ -497,7 +497,64 @@ out:
 	return 0;
 }
 
+#ifdef CONFIG_SQUASHFS_FILE_DIRECT
+/*
+ * Readahead.  Rather than leaving the window to readpage, which reads and
+ * decompresses one datablock at a time, start the I/O for every datablock
+ * in the window and decompress them in parallel directly into the page
+ * cache.  Sparse blocks, the tail end packed in a fragment, and blocks we
+ * can't get all the pages for are left to readpage.
+ */
+static int squashfs_readpages(struct file *file,
+	struct address_space *mapping, struct list_head *pages,
+	unsigned nr_pages)
+{
+	struct inode *inode = mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int shift = msblk->block_log - PAGE_CACHE_SHIFT;
+	int file_end = i_size_read(inode) >> msblk->block_log;
+	struct page *page;
+	LIST_HEAD(batch);
+	u64 block;
+	int index, bsize;
+
+	TRACE("Entered squashfs_readpages, %u pages, start block %llx\n",
+				nr_pages, squashfs_i(inode)->start);
+
+	while (!list_empty(pages)) {
+		page = list_entry(pages->prev, struct page, lru);
+		index = page->index >> shift;
+
+		if (index >= file_end && squashfs_i(inode)->fragment_block !=
+					SQUASHFS_INVALID_BLK)
+			break;
+
+		bsize = read_blocklist(inode, index, &block);
+		if (bsize > 0) {
+			squashfs_readahead_block(mapping, pages, index, block,
+							bsize, &batch);
+			continue;
+		}
+
+		/* Drop the pages of this block */
+		while (!list_empty(pages)) {
+			page = list_entry(pages->prev, struct page, lru);
+			if (page->index >> shift != index)
+				break;
+			list_del(&page->lru);
+			page_cache_release(page);
+		}
+	}
+
+	squashfs_readahead_start(inode->i_sb, &batch);
+	return 0;
+}
+#endif
+
 
 const struct address_space_operations squashfs_aops = {
-	.readpage = squashfs_readpage
+	.readpage = squashfs_readpage,
+#ifdef CONFIG_SQUASHFS_FILE_DIRECT
+	.readpages = squashfs_readpages,
+#endif
 };
@@ -13,6 +13,7 @@
 #include <linux/string.h>
 #include <linux/pagemap.h>
 #include <linux/mutex.h>
+#include <linux/workqueue.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -174,3 +175,160 @@ out:
 	squashfs_cache_put(buffer);
 	return res;
 }
+
+
+/*
+ * A datablock being read ahead.  All pages covered by the block are
+ * locked in the page cache, and we hold a reference on each of them,
+ * until the block has been decompressed into them.
+ */
+struct squashfs_readahead {
+	struct list_head	list;
+	struct work_struct	work;
+	struct super_block	*sb;
+	u64			block;
+	int			bsize;
+	int			pages;
+	struct page		*page[0];
+};
+
+static void squashfs_readahead_read(struct squashfs_readahead *ra)
+{
+	struct squashfs_page_actor *actor;
+	int i, bytes, res = -ENOMEM;
+	void *pageaddr;
+
+	actor = squashfs_page_actor_init_special(ra->page, ra->pages, 0);
+	if (actor) {
+		res = squashfs_read_data(ra->sb, ra->block, ra->bsize, NULL,
+								actor);
+		kfree(actor);
+	}
+
+	/* Last page may have trailing bytes not filled */
+	bytes = res % PAGE_CACHE_SIZE;
+	if (res >= 0 && bytes) {
+		pageaddr = kmap_atomic(ra->page[ra->pages - 1]);
+		memset(pageaddr + bytes, 0, PAGE_CACHE_SIZE - bytes);
+		kunmap_atomic(pageaddr);
+	}
+
+	/*
+	 * On failure just leave the pages !uptodate, readpage will try
+	 * again and report the error to whoever wants the data.
+	 */
+	for (i = 0; i < ra->pages; i++) {
+		flush_dcache_page(ra->page[i]);
+		if (res >= 0)
+			SetPageUptodate(ra->page[i]);
+		unlock_page(ra->page[i]);
+		page_cache_release(ra->page[i]);
+	}
+
+	kfree(ra);
+}
+
+static void squashfs_readahead_work(struct work_struct *work)
+{
+	squashfs_readahead_read(container_of(work, struct squashfs_readahead,
+								work));
+}
+
+/*
+ * Take the readahead pages covering datablock index off the tail of pages
+ * (readahead hands them to us in descending index order), put them in the
+ * page cache and grab whichever other pages the block covers.  If that
+ * works the block is queued on batch for squashfs_readahead_start(),
+ * otherwise the pages are left !uptodate for readpage to deal with.
+ */
+int squashfs_readahead_block(struct address_space *mapping,
+	struct list_head *pages, int index, u64 block, int bsize,
+	struct list_head *batch)
+{
+	struct inode *inode = mapping->host;
+	struct squashfs_sb_info *msblk = inode->i_sb->s_fs_info;
+	int file_end = (i_size_read(inode) - 1) >> PAGE_CACHE_SHIFT;
+	int shift = msblk->block_log - PAGE_CACHE_SHIFT;
+	int start_index = index << shift;
+	int end_index = start_index | ((1 << shift) - 1);
+	struct squashfs_readahead *ra;
+	struct page *page;
+	int i, n;
+
+	if (end_index > file_end)
+		end_index = file_end;
+
+	ra = kzalloc(sizeof(*ra) + sizeof(struct page *) *
+		(end_index - start_index + 1), GFP_KERNEL);
+
+	while (!list_empty(pages)) {
+		page = list_entry(pages->prev, struct page, lru);
+		if (page->index > end_index)
+			break;
+
+		list_del(&page->lru);
+		if (ra == NULL || add_to_page_cache_lru(page, mapping,
+						page->index, GFP_KERNEL)) {
+			page_cache_release(page);
+			continue;
+		}
+		ra->page[page->index - start_index] = page;
+	}
+
+	if (ra == NULL)
+		return -ENOMEM;
+
+	ra->pages = end_index - start_index + 1;
+	for (i = 0, n = start_index; i < ra->pages; i++, n++) {
+		if (ra->page[i])
+			continue;
+
+		ra->page[i] = grab_cache_page_nowait(mapping, n);
+		if (ra->page[i] == NULL || PageUptodate(ra->page[i]))
+			goto abort;
+	}
+
+	ra->sb = inode->i_sb;
+	ra->block = block;
+	ra->bsize = bsize;
+	INIT_WORK(&ra->work, squashfs_readahead_work);
+	list_add_tail(&ra->list, batch);
+	return 0;
+
+abort:
+	for (i = 0; i < ra->pages; i++) {
+		if (ra->page[i] == NULL)
+			continue;
+		unlock_page(ra->page[i]);
+		page_cache_release(ra->page[i]);
+	}
+	kfree(ra);
+	return -EAGAIN;
+}
+
+/*
+ * Get the I/O for every block in batch going, then decompress them in
+ * parallel.  The first block is decompressed here, the caller is about to
+ * wait for it anyway, the rest on the unbound workqueue so that they can
+ * run on other CPUs (each with its own decompressor stream when
+ * SQUASHFS_DECOMP_MULTI_PERCPU is configured).
+ */
+void squashfs_readahead_start(struct super_block *sb, struct list_head *batch)
+{
+	struct squashfs_readahead *ra, *first = NULL, *next;
+
+	list_for_each_entry(ra, batch, list)
+		squashfs_prefetch_data(sb, ra->block, ra->bsize);
+
+	list_for_each_entry_safe(ra, next, batch, list) {
+		list_del(&ra->list);
+		if (first == NULL)
+			first = ra;
+		else
+			queue_work(system_unbound_wq, &ra->work);
+	}
+
+	if (first)
+		squashfs_readahead_read(first);
+}
+
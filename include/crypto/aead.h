@@ -48,6 +48,19 @@ static inline int crypto_aead_givdecrypt(struct aead_givcrypt_request *req)
 	return crt->givdecrypt(req);
 };
 
+/* See crypto_aead_encrypt_batch() */
+static inline void crypto_aead_givencrypt_batch(
+	struct aead_givcrypt_request **reqs, unsigned int nreq)
+{
+	struct aead_tfm *crt;
+
+	if (!nreq)
+		return;
+
+	crt = crypto_aead_crt(aead_givcrypt_reqtfm(reqs[0]));
+	crt->givencrypt_batch(reqs, nreq);
+}
+
 static inline void aead_givcrypt_set_tfm(struct aead_givcrypt_request *req,
 					 struct crypto_aead *tfm)
 {
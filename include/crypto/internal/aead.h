@@ -78,5 +78,16 @@ static inline void aead_givcrypt_complete(struct aead_givcrypt_request *req,
 	aead_request_complete(&req->areq, err);
 }
 
+/*
+ * Whether a request for which ->encrypt() or ->decrypt() returned @err is
+ * still owned by the driver, which will then call its completion function.
+ */
+static inline bool aead_request_pending(struct aead_request *req, int err)
+{
+	return err == -EINPROGRESS ||
+	       (err == -EBUSY &&
+		(req->base.flags & CRYPTO_TFM_REQ_MAY_BACKLOG));
+}
+
 #endif	/* _CRYPTO_INTERNAL_AEAD_H */
 
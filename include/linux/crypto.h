@@ -221,6 +221,10 @@ struct aead_alg {
 	int (*decrypt)(struct aead_request *req);
 	int (*givencrypt)(struct aead_givcrypt_request *req);
 	int (*givdecrypt)(struct aead_givcrypt_request *req);
+	void (*encrypt_batch)(struct aead_request **reqs, unsigned int nreq);
+	void (*decrypt_batch)(struct aead_request **reqs, unsigned int nreq);
+	void (*givencrypt_batch)(struct aead_givcrypt_request **reqs,
+				 unsigned int nreq);
 
 	const char *geniv;
 
@@ -350,6 +354,10 @@ struct aead_tfm {
 	int (*decrypt)(struct aead_request *req);
 	int (*givencrypt)(struct aead_givcrypt_request *req);
 	int (*givdecrypt)(struct aead_givcrypt_request *req);
+	void (*encrypt_batch)(struct aead_request **reqs, unsigned int nreq);
+	void (*decrypt_batch)(struct aead_request **reqs, unsigned int nreq);
+	void (*givencrypt_batch)(struct aead_givcrypt_request **reqs,
+				 unsigned int nreq);
 
 	struct crypto_aead *base;
 
@@ -810,6 +818,29 @@ static inline int crypto_aead_decrypt(struct aead_request *req)
 	return crypto_aead_crt(crypto_aead_reqtfm(req))->decrypt(req);
 }
 
+/*
+ * Batched submission: all requests must belong to the same transform.  Unlike
+ * crypto_aead_encrypt(), every request is finished through its completion
+ * function, either before the call returns or later for asynchronous
+ * drivers, so the caller always learns the per-request result there.
+ * Drivers that save and restore SIMD state do so once per batch.
+ */
+static inline void crypto_aead_encrypt_batch(struct aead_request **reqs,
+					     unsigned int nreq)
+{
+	if (nreq)
+		crypto_aead_crt(crypto_aead_reqtfm(reqs[0]))->encrypt_batch(
+			reqs, nreq);
+}
+
+static inline void crypto_aead_decrypt_batch(struct aead_request **reqs,
+					     unsigned int nreq)
+{
+	if (nreq)
+		crypto_aead_crt(crypto_aead_reqtfm(reqs[0]))->decrypt_batch(
+			reqs, nreq);
+}
+
 static inline unsigned int crypto_aead_reqsize(struct crypto_aead *tfm)
 {
 	return crypto_aead_crt(tfm)->reqsize;
@@ -264,6 +264,7 @@ enum {
 	FTRACE_EVENT_FL_NO_SET_FILTER_BIT,
 	FTRACE_EVENT_FL_SOFT_MODE_BIT,
 	FTRACE_EVENT_FL_SOFT_DISABLED_BIT,
+	FTRACE_EVENT_FL_HIST_BIT,
 };
 
 /*
@@ -275,6 +276,7 @@ enum {
  *  SOFT_MODE     - The event is enabled/disabled by SOFT_DISABLED
  *  SOFT_DISABLED - When set, do not trace the event (even though its
  *                   tracepoint may be enabled)
+ *  HIST	  - The event has a histogram attached
  */
 enum {
 	FTRACE_EVENT_FL_ENABLED		= (1 << FTRACE_EVENT_FL_ENABLED_BIT),
@@ -283,6 +285,7 @@ enum {
 	FTRACE_EVENT_FL_NO_SET_FILTER	= (1 << FTRACE_EVENT_FL_NO_SET_FILTER_BIT),
 	FTRACE_EVENT_FL_SOFT_MODE	= (1 << FTRACE_EVENT_FL_SOFT_MODE_BIT),
 	FTRACE_EVENT_FL_SOFT_DISABLED	= (1 << FTRACE_EVENT_FL_SOFT_DISABLED_BIT),
+	FTRACE_EVENT_FL_HIST		= (1 << FTRACE_EVENT_FL_HIST_BIT),
 };
 
 struct ftrace_event_file {
@@ -292,6 +295,9 @@ struct ftrace_event_file {
 	struct dentry			*dir;
 	struct trace_array		*tr;
 	struct ftrace_subsystem_dir	*system;
+#ifdef CONFIG_EVENT_HIST
+	struct event_hist		*hist;
+#endif
 
 	/*
 	 * 32 bit flags:
@@ -312,6 +318,17 @@ struct ftrace_event_file {
 	atomic_t		sm_ref;	/* soft-mode reference counter */
 };
 
+/*
+ * A soft disabled event is not traced, but still has to be recorded for
+ * its histogram, if it has one.
+ */
+static inline bool ftrace_file_soft_disabled(struct ftrace_event_file *file)
+{
+	return (file->flags & (FTRACE_EVENT_FL_SOFT_DISABLED |
+			       FTRACE_EVENT_FL_HIST)) ==
+		FTRACE_EVENT_FL_SOFT_DISABLED;
+}
+
 #define __TRACE_EVENT_FLAGS(name, value)				\
 	static int __init trace_init_flags_##name(void)			\
 	{								\
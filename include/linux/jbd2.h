@@ -259,8 +259,11 @@ typedef struct journal_superblock_s
 
 /* 0x0050 */
 	__u8	s_checksum_type;	/* checksum type */
-	__u8	s_padding2[3];
-	__u32	s_padding[42];
+	__u8	s_fc_replay;		/* fast commits await replay */
+	__u8	s_padding2[2];
+	__be32	s_num_fc_blks;		/* Number of fast commit blocks */
+	__be32	s_fc_replay_tid;	/* Transaction of fast commits to replay */
+	__u32	s_padding[40];
 	__be32	s_checksum;		/* crc32c(superblock) */
 
 /* 0x0100 */
@@ -284,6 +287,7 @@ typedef struct journal_superblock_s
 #define JBD2_FEATURE_INCOMPAT_64BIT		0x00000002
 #define JBD2_FEATURE_INCOMPAT_ASYNC_COMMIT	0x00000004
 #define JBD2_FEATURE_INCOMPAT_CSUM_V2		0x00000008
+#define JBD2_FEATURE_INCOMPAT_FAST_COMMIT	0x00000020
 
 /* Features known to this kernel version: */
 #define JBD2_KNOWN_COMPAT_FEATURES	JBD2_FEATURE_COMPAT_CHECKSUM
@@ -291,7 +295,8 @@ typedef struct journal_superblock_s
 #define JBD2_KNOWN_INCOMPAT_FEATURES	(JBD2_FEATURE_INCOMPAT_REVOKE | \
 					JBD2_FEATURE_INCOMPAT_64BIT | \
 					JBD2_FEATURE_INCOMPAT_ASYNC_COMMIT | \
-					JBD2_FEATURE_INCOMPAT_CSUM_V2)
+					JBD2_FEATURE_INCOMPAT_CSUM_V2 | \
+					JBD2_FEATURE_INCOMPAT_FAST_COMMIT)
 
 #ifdef __KERNEL__
 
@@ -701,6 +706,13 @@ jbd2_time_diff(unsigned long start, unsigned long end)
  * @j_free: Journal free - how many free blocks are there in the journal?
  * @j_first: The block number of the first usable block
  * @j_last: The block number one beyond the last usable block
+ * @j_fc_first: The block number of the first fast commit block
+ * @j_fc_last: The block number one beyond the last fast commit block
+ * @j_fc_off: Number of fast commit blocks handed out since the last full
+ *  commit
+ * @j_fc_wbuf: Buffers of the fast commit blocks handed out
+ * @j_fc_wait: Wait queue for fast and full commits to exclude each other
+ * @j_fc_replay_tid: Transaction whose fast commits await replay
  * @j_dev: Device where we store the journal
  * @j_blocksize: blocksize for the location where we store the journal.
  * @j_blk_offset: starting block offset for into the device where we store the
@@ -845,6 +857,32 @@ struct journal_s
 	unsigned long		j_first;
 	unsigned long		j_last;
 
+	/*
+	 * Fast commit area: the block numbers of the first fast commit block
+	 * and one beyond the last one.  The area sits past j_last, outside of
+	 * the circular log.  [j_state_lock]
+	 */
+	unsigned long		j_fc_first;
+	unsigned long		j_fc_last;
+
+	/*
+	 * Number of fast commit blocks handed out for the running
+	 * transaction, and their buffers.  Only touched by the owner of
+	 * JBD2_FAST_COMMIT_ONGOING and by the commit code, which exclude
+	 * each other.
+	 */
+	unsigned long		j_fc_off;
+	struct buffer_head	**j_fc_wbuf;
+
+	/* Wait queue for fast and full commits to exclude each other */
+	wait_queue_head_t	j_fc_wait;
+
+	/*
+	 * Transaction whose fast commits were found on disk by recovery and
+	 * still have to be replayed by the client fs.  [j_state_lock]
+	 */
+	tid_t			j_fc_replay_tid;
+
 	/*
 	 * Device, blocksize and starting block offset for the location where we
 	 * store the journal.
@@ -996,6 +1034,11 @@ struct journal_s
 #define JBD2_ABORT_ON_SYNCDATA_ERR	0x040	/* Abort the journal on file
 						 * data write error in ordered
 						 * mode */
+#define JBD2_FAST_COMMIT_ONGOING	0x080	/* A fast commit is being
+						 * written */
+#define JBD2_FULL_COMMIT_ONGOING	0x100	/* A full commit is being
+						 * written */
+#define JBD2_FC_REPLAY	0x200	/* Fast commits await replay */
 
 /*
  * Function declarations for the journaling transaction and buffer
@@ -1156,6 +1199,16 @@ extern int	   jbd2_journal_clear_err  (journal_t *);
 extern int	   jbd2_journal_bmap(journal_t *, unsigned long, unsigned long long *);
 extern int	   jbd2_journal_force_commit(journal_t *);
 extern int	   jbd2_journal_force_commit_nested(journal_t *);
+extern int	   jbd2_fc_init(journal_t *, unsigned int);
+extern int	   jbd2_fc_begin_commit(journal_t *, tid_t);
+extern void	   jbd2_fc_end_commit(journal_t *);
+extern void	   jbd2_fc_end_commit_fallback(journal_t *, tid_t);
+extern int	   jbd2_fc_get_buf(journal_t *, struct buffer_head **);
+extern int	   jbd2_fc_wait_bufs(journal_t *, unsigned long, int);
+extern void	   jbd2_fc_release_bufs(journal_t *);
+extern int	   jbd2_fc_read_buf(journal_t *, unsigned long,
+				    struct buffer_head **);
+extern void	   jbd2_fc_replay_done(journal_t *);
 extern int	   jbd2_journal_file_inode(handle_t *handle, struct jbd2_inode *inode);
 extern int	   jbd2_journal_begin_ordered_truncate(journal_t *journal,
 				struct jbd2_inode *inode, loff_t new_size);
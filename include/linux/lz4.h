@@ -84,4 +84,32 @@ int lz4_decompress(const unsigned char *src, size_t *src_len,
  */
 int lz4_decompress_unknownoutputsize(const unsigned char *src, size_t src_len,
 		unsigned char *dest, size_t *dest_len);
+
+/*
+ * lz4_decompress_partial()
+ *	src     : source address of the compressed data
+ *	src_len : is the input size, therefore the compressed size
+ *	dest	: output buffer address of the decompressed data
+ *	dest_len: is the number of bytes wanted from the start of the
+ *			decompressed data, which is returned with the actual
+ *			number of bytes produced (less only if the data is
+ *			shorter)
+ *	return  : Success if return 0
+ *		  Error if return (< 0)
+ *	note :  Destination buffer must be already allocated with at least
+ *		dest_len bytes.  Decoding stops as soon as dest_len bytes are
+ *		available, e.g. to read a single page out of a larger block.
+ */
+int lz4_decompress_partial(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len);
+
+/*
+ * LZ4_DECOMPRESS_INPLACE_MARGIN()
+ * lz4_decompress_unknownoutputsize() and lz4_decompress_partial() can
+ * decompress in place: copy the compressed data to the end of a buffer
+ * holding the full decompressed size plus
+ * LZ4_DECOMPRESS_INPLACE_MARGIN(src_len) bytes and pass the start of that
+ * buffer as dest.
+ */
+#define LZ4_DECOMPRESS_INPLACE_MARGIN(src_len)	(((src_len) >> 8) + 32)
 #endif
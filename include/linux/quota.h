@@ -174,8 +174,6 @@ static inline struct kqid make_kqid_projid(kprojid_t projid)
 }
 
 
-extern spinlock_t dq_data_lock;
-
 /* Maximal numbers of writes for quota operation (insert/delete/update)
  * (over VFS all formats) */
 #define DQUOT_INIT_ALLOC max(V1_INIT_ALLOC, V2_INIT_ALLOC)
@@ -270,7 +268,7 @@ static inline void dqstats_dec(unsigned int type)
 #define DQ_ACTIVE_B	5	/* dquot is active (dquot_release not called) */
 #define DQ_LASTSET_B	6	/* Following 6 bits (see QIF_) are reserved\
 				 * for the mask of entries set via SETQUOTA\
-				 * quotactl. They are set under dq_data_lock\
+				 * quotactl. They are set under dq_dqb_lock\
 				 * and the quota format handling dquot can\
 				 * clear them when it sees fit. */
 
@@ -280,6 +278,7 @@ struct dquot {
 	struct list_head dq_free;	/* Free list element */
 	struct list_head dq_dirty;	/* List of dirty dquots */
 	struct mutex dq_lock;		/* dquot IO lock */
+	spinlock_t dq_dqb_lock;		/* Lock protecting dq_dqb changes */
 	atomic_t dq_count;		/* Use count */
 	wait_queue_head_t dq_wait_unused;	/* Wait queue for dquot to become unused */
 	struct super_block *dq_sb;	/* superblock this applies to */
@@ -390,6 +389,7 @@ struct quota_info {
 	struct mutex dqio_mutex;		/* lock device while I/O in progress */
 	struct mutex dqonoff_mutex;		/* Serialize quotaon & quotaoff */
 	struct rw_semaphore dqptr_sem;		/* serialize ops using quota_info struct, pointers from inode to dquots */
+	spinlock_t dq_data_lock;		/* protects mem_dqinfo of this device */
 	struct inode *files[MAXQUOTAS];		/* inodes of quotafiles */
 	struct mem_dqinfo info[MAXQUOTAS];	/* Information for each quota type */
 	const struct quota_format_ops *ops[MAXQUOTAS];	/* Operations for each type */
@@ -21,6 +21,8 @@ struct tcf_common {
 	struct gnet_stats_rate_est64	tcfc_rate_est;
 	spinlock_t			tcfc_lock;
 	struct rcu_head			tcfc_rcu;
+	struct gnet_stats_basic_cpu __percpu *cpu_bstats;
+	struct gnet_stats_queue __percpu *cpu_qstats;
 };
 #define tcf_next	common.tcfc_next
 #define tcf_index	common.tcfc_index
@@ -35,6 +37,43 @@ struct tcf_common {
 #define tcf_lock	common.tcfc_lock
 #define tcf_rcu		common.tcfc_rcu
 
+/* Actions created with per cpu statistics run without tcfc_lock and
+ * account through these helpers; the others must hold tcfc_lock.
+ */
+static inline void tcf_action_update_bstats(struct tcf_common *p,
+					    const struct sk_buff *skb)
+{
+	if (p->cpu_bstats)
+		bstats_cpu_update(this_cpu_ptr(p->cpu_bstats), skb);
+	else
+		bstats_update(&p->tcfc_bstats, skb);
+}
+
+static inline void tcf_action_inc_drop_qstats(struct tcf_common *p)
+{
+	if (p->cpu_qstats)
+		this_cpu_ptr(p->cpu_qstats)->drops++;
+	else
+		p->tcfc_qstats.drops++;
+}
+
+static inline void tcf_action_inc_overlimit_qstats(struct tcf_common *p)
+{
+	if (p->cpu_qstats)
+		this_cpu_ptr(p->cpu_qstats)->overlimits++;
+	else
+		p->tcfc_qstats.overlimits++;
+}
+
+/* Avoid dirtying a cache line shared by all cpus on every packet. */
+static inline void tcf_lastuse_update(struct tcf_t *tm)
+{
+	unsigned long now = jiffies;
+
+	if (tm->lastuse != now)
+		tm->lastuse = now;
+}
+
 struct tcf_hashinfo {
 	struct tcf_common	**htab;
 	unsigned int		hmask;
@@ -94,8 +133,9 @@ struct tcf_common *tcf_hash_check(u32 index, struct tc_action *a,
 				  int bind, struct tcf_hashinfo *hinfo);
 struct tcf_common *tcf_hash_create(u32 index, struct nlattr *est,
 				   struct tc_action *a, int size,
-				   int bind, u32 *idx_gen,
+				   int bind, bool cpustats, u32 *idx_gen,
 				   struct tcf_hashinfo *hinfo);
+void tcf_hash_cleanup(struct tcf_common *p, struct nlattr *est);
 void tcf_hash_insert(struct tcf_common *p, struct tcf_hashinfo *hinfo);
 
 int tcf_register_action(struct tc_action_ops *a);
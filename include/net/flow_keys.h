@@ -1,6 +1,8 @@
 #ifndef _NET_FLOW_KEYS_H
 #define _NET_FLOW_KEYS_H
 
+#include <linux/in6.h>
+
 struct flow_keys {
 	/* (src,dst) must be grouped, in the same way than in IP header */
 	__be32 src;
@@ -13,6 +15,19 @@ struct flow_keys {
 	u8 ip_proto;
 };
 
+/* Keys for users that match on header fields instead of hashing them.
+ * Like @basic they describe the innermost network header that was found.
+ */
+struct flow_keys_ext {
+	struct flow_keys basic;
+	__be16 n_proto;		/* protocol of that network header */
+	u16 vlan_id;		/* outermost VLAN tag found in the packet */
+	u32 mpls_label;		/* outermost MPLS label */
+	struct in6_addr ipv6_src;
+	struct in6_addr ipv6_dst;
+};
+
 bool skb_flow_dissect(const struct sk_buff *skb, struct flow_keys *flow);
+bool skb_flow_dissect_ext(const struct sk_buff *skb, struct flow_keys_ext *ext);
 __be32 skb_flow_get_ports(const struct sk_buff *skb, int thoff, u8 ip_proto);
 #endif
@@ -5,6 +5,15 @@
 #include <linux/socket.h>
 #include <linux/rtnetlink.h>
 #include <linux/pkt_sched.h>
+#include <linux/u64_stats_sync.h>
+
+/* Per cpu basic statistics, for users that update them without a lock
+ * and fold them when dumping.
+ */
+struct gnet_stats_basic_cpu {
+	struct gnet_stats_basic_packed	bstats;
+	struct u64_stats_sync		syncp;
+};
 
 struct gnet_dump {
 	spinlock_t *      lock;
@@ -36,6 +45,15 @@ int gnet_stats_copy_app(struct gnet_dump *d, void *st, int len);
 
 int gnet_stats_finish_copy(struct gnet_dump *d);
 
+void gnet_stats_add_basic_cpu(struct gnet_stats_basic_packed *bstats,
+			      struct gnet_stats_basic_cpu __percpu *cpu);
+void gnet_stats_add_queue_cpu(struct gnet_stats_queue *qstats,
+			      const struct gnet_stats_queue __percpu *cpu);
+
+int gen_new_estimator_cpu(struct gnet_stats_basic_packed *bstats,
+			  struct gnet_stats_basic_cpu __percpu *cpu_bstats,
+			  struct gnet_stats_rate_est64 *rate_est,
+			  spinlock_t *stats_lock, struct nlattr *opt);
 int gen_new_estimator(struct gnet_stats_basic_packed *bstats,
 		      struct gnet_stats_rate_est64 *rate_est,
 		      spinlock_t *stats_lock, struct nlattr *opt);
@@ -44,6 +62,10 @@ void gen_kill_estimator(struct gnet_stats_basic_packed *bstats,
 int gen_replace_estimator(struct gnet_stats_basic_packed *bstats,
 			  struct gnet_stats_rate_est64 *rate_est,
 			  spinlock_t *stats_lock, struct nlattr *opt);
+int gen_replace_estimator_cpu(struct gnet_stats_basic_packed *bstats,
+			      struct gnet_stats_basic_cpu __percpu *cpu_bstats,
+			      struct gnet_stats_rate_est64 *rate_est,
+			      spinlock_t *stats_lock, struct nlattr *opt);
 bool gen_estimator_active(const struct gnet_stats_basic_packed *bstats,
 			  const struct gnet_stats_rate_est64 *rate_est);
 #endif
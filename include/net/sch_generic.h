@@ -57,6 +57,14 @@ struct Qdisc {
 				      * Its true for MQ/MQPRIO slaves, or non
 				      * multiqueue device.
 				      */
+#define TCQ_F_NOLOCK		0x20 /* qdisc runs its filters without the
+				      * root lock, under RCU only.  Writers
+				      * still take sch_tree_lock(), which
+				      * waits for readers on unlock.
+				      */
+#define TCQ_F_CAN_NOLOCK	0x40 /* qdisc may set TCQ_F_NOLOCK while all
+				      * its filters are TCF_PROTO_OPS_NOLOCK
+				      */
 #define TCQ_F_WARN_NONWC	(1 << 16)
 	u32			limit;
 	const struct Qdisc_ops	*ops;
@@ -76,6 +84,8 @@ struct Qdisc {
 	struct netdev_queue	*dev_queue;
 
 	struct gnet_stats_rate_est64	rate_est;
+	/* counters of TCQ_F_NOLOCK qdiscs, bstats only holds their sum */
+	struct gnet_stats_basic_cpu __percpu *cpu_bstats;
 	struct Qdisc		*next_sched;
 	struct sk_buff		*gso_skb;
 	/*
@@ -207,9 +217,16 @@ struct tcf_proto_ops {
 	int			(*dump)(struct tcf_proto*, unsigned long,
 					struct sk_buff *skb, struct tcmsg*);
 
+	u32			flags;
 	struct module		*owner;
 };
 
+/* classify() is safe against concurrent changes under RCU alone: the
+ * classifier publishes new state with rcu_assign_pointer() and never
+ * modifies what readers may see in place.
+ */
+#define TCF_PROTO_OPS_NOLOCK	0x1
+
 struct tcf_proto {
 	/* Fast access part */
 	struct tcf_proto	*next;
@@ -302,11 +319,21 @@ static inline struct net_device *qdisc_dev(const struct Qdisc *qdisc)
 static inline void sch_tree_lock(const struct Qdisc *q)
 {
 	spin_lock_bh(qdisc_root_sleeping_lock(q));
+	/* Lockless readers must see objects set up before the lock was
+	 * taken once they are linked in below.
+	 */
+	if (qdisc_root_sleeping(q)->flags & TCQ_F_NOLOCK)
+		smp_wmb();
 }
 
 static inline void sch_tree_unlock(const struct Qdisc *q)
 {
 	spin_unlock_bh(qdisc_root_sleeping_lock(q));
+	/* Classifiers free what they unlinked right after dropping the
+	 * tree lock, wait for lockless readers that may still see it.
+	 */
+	if (qdisc_root_sleeping(q)->flags & TCQ_F_NOLOCK)
+		synchronize_net();
 }
 
 #define tcf_tree_lock(tp)	sch_tree_lock((tp)->q)
@@ -484,6 +511,14 @@ static inline void bstats_update(struct gnet_stats_basic_packed *bstats,
 	bstats->packets += skb_is_gso(skb) ? skb_shinfo(skb)->gso_segs : 1;
 }
 
+static inline void bstats_cpu_update(struct gnet_stats_basic_cpu *bstats,
+				     const struct sk_buff *skb)
+{
+	u64_stats_update_begin(&bstats->syncp);
+	bstats_update(&bstats->bstats, skb);
+	u64_stats_update_end(&bstats->syncp);
+}
+
 static inline void qdisc_bstats_update(struct Qdisc *sch,
 				       const struct sk_buff *skb)
 {
@@ -9,6 +9,7 @@ struct tcf_gact {
         u16			tcfg_ptype;
         u16			tcfg_pval;
         int			tcfg_paction;
+        atomic_t		packets;
 #endif
 };
 #define to_gact(pc) \
@@ -9,7 +9,7 @@ struct tcf_ipt {
 	struct tcf_common	common;
 	u32			tcfi_hook;
 	char			*tcfi_tname;
-	struct xt_entry_target	*tcfi_t;
+	struct xt_entry_target __rcu *tcfi_t;
 };
 #define to_ipt(pc) \
 	container_of(pc, struct tcf_ipt, common)
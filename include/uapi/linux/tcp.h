@@ -20,6 +20,7 @@
 #include <linux/types.h>
 #include <asm/byteorder.h>
 #include <linux/socket.h>
+#include <linux/sockios.h>
 
 struct tcphdr {
 	__be16	source;
@@ -188,6 +189,15 @@ struct tcp_info {
 	__u32	tcpi_total_retrans;
 };
 
+/* for SIOCTCPZCRECV ioctl, on a mapping obtained by mmap() on the socket */
+#define SIOCTCPZCRECV		(SIOCPROTOPRIVATE + 3)
+
+struct tcp_zerocopy_receive {
+	__u64	address;		/* in: page aligned address in the mapping */
+	__u32	length;			/* in: bytes to map, out: bytes mapped */
+	__u32	recv_skip_hint;		/* out: bytes to read() before next call */
+};
+
 /* for TCP_MD5SIG socket option */
 #define TCP_MD5SIG_MAXKEYLEN	80
 
@@ -245,6 +245,12 @@ int filter_check_discard(struct ftrace_event_file *file, void *rec,
 		return 1;
 	}
 
+	if (unlikely(file->flags & FTRACE_EVENT_FL_HIST) &&
+	    event_hist_update(file, rec, buffer)) {
+		ring_buffer_discard_commit(buffer, event);
+		return 1;
+	}
+
 	return 0;
 }
 EXPORT_SYMBOL_GPL(filter_check_discard);
@@ -1573,9 +1579,17 @@ trace_event_buffer_lock_reserve(struct ring_buffer **current_rb,
 			  int type, unsigned long len,
 			  unsigned long flags, int pc)
 {
+	struct ring_buffer_event *event = NULL;
+
 	*current_rb = ftrace_file->tr->trace_buffer.buffer;
-	return trace_buffer_lock_reserve(*current_rb,
-					 type, len, flags, pc);
+	if (!(ftrace_file->flags & FTRACE_EVENT_FL_SOFT_DISABLED))
+		event = trace_buffer_lock_reserve(*current_rb,
+						  type, len, flags, pc);
+	/* a histogram counts the event even if it is not traced */
+	if (!event && (ftrace_file->flags & FTRACE_EVENT_FL_HIST))
+		event = event_hist_reserve(current_rb, ftrace_file,
+					   type, len, flags, pc);
+	return event;
 }
 EXPORT_SYMBOL_GPL(trace_event_buffer_lock_reserve);
 
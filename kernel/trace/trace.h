@@ -942,6 +942,10 @@ struct event_filter {
 	struct filter_pred	*preds;
 	struct filter_pred	*root;
 	char			*filter_string;
+#ifdef CONFIG_EVENT_FILTER_BPF
+	struct sk_filter	*prog;		/* compiled filter, if any */
+	int			prog_len;	/* record bytes prog reads */
+#endif
 };
 
 struct event_subsystem {
@@ -1024,6 +1028,35 @@ extern int filter_assign_type(const char *type);
 struct ftrace_event_field *
 trace_find_event_field(struct ftrace_event_call *call, char *name);
 
+#ifdef CONFIG_EVENT_HIST
+extern bool event_hist_update(struct ftrace_event_file *file, void *rec,
+			      struct ring_buffer *buffer);
+extern struct ring_buffer_event *
+event_hist_reserve(struct ring_buffer **current_rb,
+		   struct ftrace_event_file *file,
+		   int type, unsigned long len,
+		   unsigned long flags, int pc);
+extern int apply_event_hist(struct ftrace_event_file *file, char *spec);
+extern int print_event_hist(struct ftrace_event_file *file,
+			    struct seq_file *m);
+extern void destroy_event_hist(struct ftrace_event_file *file);
+#else
+static inline bool
+event_hist_update(struct ftrace_event_file *file, void *rec,
+		  struct ring_buffer *buffer)
+{
+	return false;
+}
+static inline struct ring_buffer_event *
+event_hist_reserve(struct ring_buffer **current_rb,
+		   struct ftrace_event_file *file,
+		   int type, unsigned long len,
+		   unsigned long flags, int pc)
+{
+	return NULL;
+}
+#endif
+
 extern void trace_event_enable_cmd_record(bool enable);
 extern int event_trace_add_tracer(struct dentry *parent, struct trace_array *tr);
 extern int event_trace_del_tracer(struct trace_array *tr);
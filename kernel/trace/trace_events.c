@@ -426,6 +426,21 @@ static void *event_file_data(struct file *filp)
 	return ACCESS_ONCE(file_inode(filp)->i_private);
 }
 
+#ifdef CONFIG_EVENT_HIST
+/* Drop the histogram and the soft enable it holds, see event_hist_set() */
+static void event_hist_remove(struct ftrace_event_file *file)
+{
+	if (!file->hist)
+		return;
+
+	destroy_event_hist(file);
+	__ftrace_event_enable_disable(file, 0, 1);
+	module_put(file->event_call->mod);
+}
+#else
+static inline void event_hist_remove(struct ftrace_event_file *file) { }
+#endif
+
 static void remove_event_file_dir(struct ftrace_event_file *file)
 {
 	struct dentry *dir = file->dir;
@@ -444,6 +459,7 @@ static void remove_event_file_dir(struct ftrace_event_file *file)
 
 	list_del(&file->list);
 	remove_subsystem(file->system);
+	event_hist_remove(file);
 	kmem_cache_free(file_cachep, file);
 }
 
@@ -1053,6 +1069,95 @@ event_filter_write(struct file *filp, const char __user *ubuf, size_t cnt,
 	return cnt;
 }
 
+#ifdef CONFIG_EVENT_HIST
+/*
+ * A histogram keeps the event soft enabled, so that it is updated even
+ * while the event is not traced.  Must be called with event_mutex held.
+ */
+static int event_hist_set(struct ftrace_event_file *file, char *spec)
+{
+	struct ftrace_event_call *call = file->event_call;
+	int ret;
+
+	if (file->hist) {
+		ret = apply_event_hist(file, spec);
+		if (!ret && !file->hist) {
+			__ftrace_event_enable_disable(file, 0, 1);
+			module_put(call->mod);
+		}
+		return ret;
+	}
+
+	if (!try_module_get(call->mod))
+		return -ENODEV;
+
+	ret = apply_event_hist(file, spec);
+	if (!ret && file->hist) {
+		ret = __ftrace_event_enable_disable(file, 1, 1);
+		if (!ret)
+			return 0;
+		destroy_event_hist(file);
+	}
+	module_put(call->mod);
+	return ret;
+}
+
+static int event_hist_show(struct seq_file *m, void *v)
+{
+	struct ftrace_event_file *file;
+	int ret = -ENODEV;
+
+	mutex_lock(&event_mutex);
+	file = event_file_data(m->private);
+	if (file)
+		ret = print_event_hist(file, m);
+	mutex_unlock(&event_mutex);
+
+	return ret;
+}
+
+static int event_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, event_hist_show, file);
+}
+
+static ssize_t
+event_hist_write(struct file *filp, const char __user *ubuf, size_t cnt,
+		 loff_t *ppos)
+{
+	struct ftrace_event_file *file;
+	char *buf;
+	int err = -ENODEV;
+
+	if (cnt >= PAGE_SIZE)
+		return -EINVAL;
+
+	buf = (char *)__get_free_page(GFP_TEMPORARY);
+	if (!buf)
+		return -ENOMEM;
+
+	if (copy_from_user(buf, ubuf, cnt)) {
+		free_page((unsigned long) buf);
+		return -EFAULT;
+	}
+	buf[cnt] = '\0';
+
+	mutex_lock(&event_mutex);
+	file = event_file_data(filp);
+	if (file)
+		err = event_hist_set(file, buf);
+	mutex_unlock(&event_mutex);
+
+	free_page((unsigned long) buf);
+	if (err < 0)
+		return err;
+
+	*ppos += cnt;
+
+	return cnt;
+}
+#endif
+
 static LIST_HEAD(event_subsystems);
 
 static int subsystem_open(struct inode *inode, struct file *filp)
@@ -1297,6 +1402,16 @@ static const struct file_operations ftrace_event_filter_fops = {
 	.llseek = default_llseek,
 };
 
+#ifdef CONFIG_EVENT_HIST
+static const struct file_operations ftrace_event_hist_fops = {
+	.open = event_hist_open,
+	.read = seq_read,
+	.write = event_hist_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+#endif
+
 static const struct file_operations ftrace_subsystem_filter_fops = {
 	.open = subsystem_open,
 	.read = subsystem_filter_read,
@@ -1549,6 +1664,13 @@ event_create_dir(struct dentry *parent, struct ftrace_event_file *file)
 	trace_create_file("filter", 0644, file->dir, file,
 			  &ftrace_event_filter_fops);
 
+#ifdef CONFIG_EVENT_HIST
+	/* events recorded by call_filter_check_discard() never update it */
+	if (!(call->flags & TRACE_EVENT_FL_USE_CALL_FILTER))
+		trace_create_file("hist", 0644, file->dir, file,
+				  &ftrace_event_hist_fops);
+#endif
+
 	trace_create_file("format", 0444, file->dir, call,
 			  &ftrace_event_format_fops);
 
@@ -23,6 +23,8 @@
 #include <linux/mutex.h>
 #include <linux/perf_event.h>
 #include <linux/slab.h>
+#include <linux/filter.h>
+#include <linux/skbuff.h>
 
 #include "trace.h"
 #include "trace_output.h"
@@ -160,7 +162,7 @@ static int filter_pred_##type(struct filter_pred *pred, void *event)	\
 		match = (*addr >= val);					\
 		break;							\
 	case OP_BAND:							\
-		match = (*addr & val);					\
+		match = !!(*addr & val);				\
 		break;							\
 	default:							\
 		break;							\
@@ -535,6 +537,355 @@ static int filter_match_preds_cb(enum move_type move, struct filter_pred *pred,
 	return WALK_PRED_DEFAULT;
 }
 
+#ifdef CONFIG_EVENT_FILTER_BPF
+/*
+ * Filters that only test numeric fields are also translated into a
+ * classic BPF program which treats the event record as packet data, so
+ * the socket filter interpreter (or the BPF JIT when it is enabled) can
+ * run them instead of walking the predicate tree.  Anything else (string,
+ * glob and function field predicates) just keeps using the walker.
+ *
+ * Each node of the tree gets a label to jump to when it is true and one
+ * for when it is false.  The children of an AND continue with the right
+ * child when the left one is true, those of an OR when it is false, so
+ * short circuiting falls out of the jumps.
+ */
+#define FILTER_BPF_TRUE		0
+#define FILTER_BPF_FALSE	1
+#define FILTER_BPF_RIGHT(idx)	((idx) + 2)	/* start of a right child */
+#define FILTER_BPF_NEXT		-1		/* fall through */
+
+/* the largest leaf is an ordering test of a little endian 64-bit field */
+#define FILTER_BPF_LEAF_INSNS	32
+
+struct filter_bpf {
+	struct filter_pred	*preds;
+	struct sock_filter	*insns;
+	int			*jt;		/* label of each jump */
+	int			*jf;
+	int			*label;		/* insn index of each label */
+	int			*t;		/* per pred: label when true */
+	int			*f;		/* per pred: label when false */
+	int			len;
+	int			rec_len;	/* record bytes the program reads */
+};
+
+static void filter_bpf_emit(struct filter_bpf *b, u16 code, u32 k,
+			    int jt, int jf)
+{
+	struct sock_filter *insn = &b->insns[b->len];
+
+	insn->code = code;
+	insn->jt = 0;
+	insn->jf = 0;
+	insn->k = k;
+	b->jt[b->len] = jt;
+	b->jf[b->len] = jf;
+	b->len++;
+}
+
+static void filter_bpf_stmt(struct filter_bpf *b, u16 code, u32 k)
+{
+	filter_bpf_emit(b, code, k, FILTER_BPF_NEXT, FILTER_BPF_NEXT);
+}
+
+static u16 filter_bpf_size(int size)
+{
+	return size == 4 ? BPF_W : size == 2 ? BPF_H : BPF_B;
+}
+
+/* Load the field into A as it is laid out in memory (big endian) */
+static void filter_bpf_load_raw(struct filter_bpf *b, int off, int size)
+{
+	filter_bpf_stmt(b, BPF_LD | filter_bpf_size(size) | BPF_ABS, off);
+}
+
+/* Load the value of a field of up to 4 bytes into A */
+static void filter_bpf_load(struct filter_bpf *b, int off, int size)
+{
+#ifdef __BIG_ENDIAN
+	filter_bpf_load_raw(b, off, size);
+#else
+	int i;
+
+	/* absolute loads are big endian, put the bytes together by hand */
+	filter_bpf_stmt(b, BPF_LD | BPF_B | BPF_ABS, off + size - 1);
+	for (i = size - 2; i >= 0; i--) {
+		filter_bpf_stmt(b, BPF_ALU | BPF_LSH | BPF_K, 8);
+		filter_bpf_stmt(b, BPF_MISC | BPF_TAX, 0);
+		filter_bpf_stmt(b, BPF_LD | BPF_B | BPF_ABS, off + i);
+		filter_bpf_stmt(b, BPF_ALU | BPF_OR | BPF_X, 0);
+	}
+#endif
+}
+
+/* What a raw load of @size bytes holding @v returns */
+static u32 filter_bpf_raw_val(u64 v, int size)
+{
+	switch (size) {
+	case 1:
+		return (u8)v;
+	case 2:
+		return be16_to_cpu((__force __be16)(u16)v);
+	default:
+		return be32_to_cpu((__force __be32)(u32)v);
+	}
+}
+
+static void filter_bpf_cmp(struct filter_bpf *b, int op, u32 k, int t, int f)
+{
+	switch (op) {
+	case OP_LT:
+		filter_bpf_emit(b, BPF_JMP | BPF_JGE | BPF_K, k, f, t);
+		break;
+	case OP_LE:
+		filter_bpf_emit(b, BPF_JMP | BPF_JGT | BPF_K, k, f, t);
+		break;
+	case OP_GT:
+		filter_bpf_emit(b, BPF_JMP | BPF_JGT | BPF_K, k, t, f);
+		break;
+	case OP_GE:
+		filter_bpf_emit(b, BPF_JMP | BPF_JGE | BPF_K, k, t, f);
+		break;
+	}
+}
+
+static int filter_bpf_leaf(struct filter_bpf *b, struct filter_pred *pred,
+			   int t, int f)
+{
+	struct ftrace_event_field *field = pred->field;
+	int off = pred->offset;
+	int size, lo, hi;
+	u32 k, sign = 0;
+
+	if (!field || field->filter_type != FILTER_OTHER)
+		return -EINVAL;
+
+	size = field->size;
+	if (size != 1 && size != 2 && size != 4 && size != 8)
+		return -EINVAL;
+
+	b->rec_len = max(b->rec_len, off + size);
+
+	/* != is == with the result inverted */
+	if (pred->not)
+		swap(t, f);
+
+	switch (pred->op) {
+	case OP_EQ:
+	case OP_NE:
+	case OP_BAND:
+		/*
+		 * Bitwise tests don't care about the byte order, compare
+		 * against the constant as it would be laid out in memory.
+		 */
+		if (size == 8) {
+			u64 raw = be64_to_cpu((__force __be64)pred->val);
+
+			filter_bpf_load_raw(b, off, 4);
+			k = raw >> 32;
+			if (pred->op == OP_BAND)
+				filter_bpf_emit(b, BPF_JMP | BPF_JSET | BPF_K,
+						k, t, FILTER_BPF_NEXT);
+			else
+				filter_bpf_emit(b, BPF_JMP | BPF_JEQ | BPF_K,
+						k, FILTER_BPF_NEXT, f);
+			off += 4;
+			size = 4;
+			k = (u32)raw;
+		} else
+			k = filter_bpf_raw_val(pred->val, size);
+
+		filter_bpf_load_raw(b, off, size);
+		filter_bpf_emit(b, BPF_JMP | BPF_K |
+				(pred->op == OP_BAND ? BPF_JSET : BPF_JEQ),
+				k, t, f);
+		return 0;
+
+	case OP_LT:
+	case OP_LE:
+	case OP_GT:
+	case OP_GE:
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	/*
+	 * The BPF jumps compare unsigned, flipping the sign bit of both
+	 * sides maps signed ordering onto unsigned ordering.
+	 */
+	if (field->is_signed)
+		sign = 1U << (min(size, 4) * 8 - 1);
+
+	if (size == 8) {
+#ifdef __BIG_ENDIAN
+		hi = off;
+		lo = off + 4;
+#else
+		hi = off + 4;
+		lo = off;
+#endif
+		k = (u32)(pred->val >> 32) ^ sign;
+		filter_bpf_load(b, hi, 4);
+		if (sign)
+			filter_bpf_stmt(b, BPF_ALU | BPF_XOR | BPF_K, sign);
+		/* the high words decide unless they are equal */
+		if (pred->op == OP_GT || pred->op == OP_GE) {
+			filter_bpf_emit(b, BPF_JMP | BPF_JGT | BPF_K, k,
+					t, FILTER_BPF_NEXT);
+			filter_bpf_emit(b, BPF_JMP | BPF_JEQ | BPF_K, k,
+					FILTER_BPF_NEXT, f);
+		} else {
+			filter_bpf_emit(b, BPF_JMP | BPF_JGT | BPF_K, k,
+					f, FILTER_BPF_NEXT);
+			filter_bpf_emit(b, BPF_JMP | BPF_JEQ | BPF_K, k,
+					FILTER_BPF_NEXT, t);
+		}
+		filter_bpf_load(b, lo, 4);
+		filter_bpf_cmp(b, pred->op, (u32)pred->val, t, f);
+		return 0;
+	}
+
+	k = (u32)pred->val;
+	if (size < 4)
+		k &= (1U << (size * 8)) - 1;
+	k ^= sign;
+
+	filter_bpf_load(b, off, size);
+	if (sign)
+		filter_bpf_stmt(b, BPF_ALU | BPF_XOR | BPF_K, sign);
+	filter_bpf_cmp(b, pred->op, k, t, f);
+	return 0;
+}
+
+static int filter_bpf_cb(enum move_type move, struct filter_pred *pred,
+			 int *err, void *data)
+{
+	struct filter_bpf *b = data;
+	int idx = pred - b->preds;
+
+	switch (move) {
+	case MOVE_DOWN:
+		if (pred->left == FILTER_PRED_INVALID) {
+			*err = filter_bpf_leaf(b, pred, b->t[idx], b->f[idx]);
+			if (*err)
+				return WALK_PRED_ABORT;
+			return WALK_PRED_PARENT;
+		}
+		if (pred->op == OP_AND) {
+			b->t[pred->left] = FILTER_BPF_RIGHT(idx);
+			b->f[pred->left] = b->f[idx];
+		} else {
+			b->t[pred->left] = b->t[idx];
+			b->f[pred->left] = FILTER_BPF_RIGHT(idx);
+		}
+		b->t[pred->right] = b->t[idx];
+		b->f[pred->right] = b->f[idx];
+		break;
+	case MOVE_UP_FROM_LEFT:
+		b->label[FILTER_BPF_RIGHT(idx)] = b->len;
+		break;
+	case MOVE_UP_FROM_RIGHT:
+		break;
+	}
+
+	return WALK_PRED_DEFAULT;
+}
+
+static int filter_bpf_resolve(struct filter_bpf *b, int i, int l, u8 *off)
+{
+	int d = l == FILTER_BPF_NEXT ? 0 : b->label[l] - (i + 1);
+
+	if (d < 0 || d > 255)
+		return -ERANGE;
+	*off = d;
+	return 0;
+}
+
+/*
+ * Failing to compile is not an error, the filter is then simply run
+ * by walking the predicates.
+ */
+static void filter_compile_bpf(struct event_filter *filter,
+			       struct filter_pred *root)
+{
+	struct filter_bpf b = { .preds = filter->preds };
+	int n_preds = filter->n_preds;
+	int max_insns = n_preds * FILTER_BPF_LEAF_INSNS + 2;
+	struct sock_fprog fprog;
+	int i, err;
+
+	if (max_insns > BPF_MAXINSNS)
+		return;
+
+	b.insns = kcalloc(max_insns, sizeof(*b.insns), GFP_KERNEL);
+	b.jt = kcalloc(max_insns, sizeof(int), GFP_KERNEL);
+	b.jf = kcalloc(max_insns, sizeof(int), GFP_KERNEL);
+	b.label = kcalloc(FILTER_BPF_RIGHT(n_preds), sizeof(int), GFP_KERNEL);
+	b.t = kcalloc(n_preds, sizeof(int), GFP_KERNEL);
+	b.f = kcalloc(n_preds, sizeof(int), GFP_KERNEL);
+	if (!b.insns || !b.jt || !b.jf || !b.label || !b.t || !b.f)
+		goto out;
+
+	b.t[root - b.preds] = FILTER_BPF_TRUE;
+	b.f[root - b.preds] = FILTER_BPF_FALSE;
+	err = walk_pred_tree(b.preds, root, filter_bpf_cb, &b);
+	if (err)
+		goto out;
+
+	b.label[FILTER_BPF_TRUE] = b.len;
+	filter_bpf_stmt(&b, BPF_RET | BPF_K, 1);
+	b.label[FILTER_BPF_FALSE] = b.len;
+	filter_bpf_stmt(&b, BPF_RET | BPF_K, 0);
+
+	for (i = 0; i < b.len; i++) {
+		if (BPF_CLASS(b.insns[i].code) != BPF_JMP)
+			continue;
+		if (filter_bpf_resolve(&b, i, b.jt[i], &b.insns[i].jt) ||
+		    filter_bpf_resolve(&b, i, b.jf[i], &b.insns[i].jf))
+			goto out;
+	}
+
+	fprog.len = b.len;
+	fprog.filter = b.insns;
+	if (!sk_unattached_filter_create(&filter->prog, &fprog))
+		filter->prog_len = b.rec_len;
+out:
+	kfree(b.insns);
+	kfree(b.jt);
+	kfree(b.jf);
+	kfree(b.label);
+	kfree(b.t);
+	kfree(b.f);
+}
+
+static void filter_free_bpf(struct event_filter *filter)
+{
+	if (filter->prog) {
+		sk_unattached_filter_destroy(filter->prog);
+		filter->prog = NULL;
+	}
+}
+
+static int filter_run_bpf(struct event_filter *filter, void *rec)
+{
+	struct sk_buff skb;
+
+	/* absolute loads only look at the linear data */
+	skb.data = rec;
+	skb.len = filter->prog_len;
+	skb.data_len = 0;
+
+	return SK_RUN_FILTER(filter->prog, &skb) != 0;
+}
+#else
+static inline void filter_compile_bpf(struct event_filter *filter,
+				      struct filter_pred *root) { }
+static inline void filter_free_bpf(struct event_filter *filter) { }
+#endif /* CONFIG_EVENT_FILTER_BPF */
+
 /* return 1 if event matches, 0 otherwise (discard) */
 int filter_match_preds(struct event_filter *filter, void *rec)
 {
@@ -555,6 +906,11 @@ int filter_match_preds(struct event_filter *filter, void *rec)
 	if (!n_preds)
 		return 1;
 
+#ifdef CONFIG_EVENT_FILTER_BPF
+	if (filter->prog)
+		return filter_run_bpf(filter, rec);
+#endif
+
 	/*
 	 * n_preds, root and filter->preds are protect with preemption disabled.
 	 */
@@ -764,6 +1120,8 @@ static void __free_preds(struct event_filter *filter)
 {
 	int i;
 
+	filter_free_bpf(filter);
+
 	if (filter->preds) {
 		for (i = 0; i < filter->n_preds; i++)
 			kfree(filter->preds[i].ops);
@@ -1669,6 +2027,8 @@ static int replace_preds(struct ftrace_event_call *call,
 		/* We don't set root until we know it works */
 		barrier();
 		filter->root = root;
+
+		filter_compile_bpf(filter, root);
 	}
 
 	err = 0;
@@ -2332,6 +2692,13 @@ static struct test_filter_data_t {
 	DATA_REC(YES, 1, 1, 1, 1, 1, 1, 1, 1, "bdfh"),
 	DATA_REC(YES, 0, 1, 0, 1, 0, 1, 0, 1, ""),
 	DATA_REC(YES, 1, 0, 1, 0, 1, 0, 1, 0, "bdfh"),
+#undef FILTER
+#define FILTER "(a < 0 && b >= -2) || (c > 3 && d <= 4) || " \
+	       "e & 6 || f != 7"
+	DATA_REC(YES, -1, -2, 0, 0, 0, 0, 0, 0, "cdef"),
+	DATA_REC(YES, 1, 0, 4, 4, 0, 7, 0, 0, "ef"),
+	DATA_REC(NO,  0, -3, 3, 5, 1, 7, 0, 0, ""),
+	DATA_REC(YES, 0, 0, 0, 0, 2, 7, 0, 0, "f"),
 };
 
 #undef DATA_REC
@@ -2400,6 +2767,24 @@ static __init int ftrace_test_event_filter(void)
 		 * tests, but the rcu dereference will complain without it.
 		 */
 		preempt_disable();
+#ifdef CONFIG_EVENT_FILTER_BPF
+		/*
+		 * Check the compiled program first, then drop it so the
+		 * predicate walk below is tested as well.
+		 */
+		if (filter->prog) {
+			err = filter_match_preds(filter, &d->rec);
+			filter_free_bpf(filter);
+			if (err != d->match) {
+				preempt_enable();
+				__free_filter(filter);
+				printk(KERN_INFO
+				       "Failed to match filter '%s' with BPF, "
+				       "expected %d\n", d->filter, d->match);
+				break;
+			}
+		}
+#endif
 		if (*d->not_visited)
 			walk_pred_tree(filter->preds, filter->root,
 				       test_walk_pred_cb,
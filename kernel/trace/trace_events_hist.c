@@ -0,0 +1,525 @@
+/*
+ * trace_events_hist - in-kernel histograms of trace event fields
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * A histogram is attached to an event by writing a spec to the event's
+ * 'hist' file:
+ *
+ *   keys=<field>[.mod][,<field>[.mod]][:vals=<field>[,<field>...]]
+ *	[:sort=hitcount|key][:size=<entries>]
+ *
+ * Every event that passes the event filter then bumps the hit count of
+ * the entry for its key, and adds the 'vals' fields to the entry's sums.
+ * Key modifiers are 'hex' and 'sym' (only change how the key is shown)
+ * and 'log2' (bucket the key by power of two).  Reading the file prints
+ * the entries, writing "0" removes the histogram.
+ *
+ * The histogram keeps the event soft enabled, so it is updated whether
+ * or not the event is enabled for tracing.  Records that do not go into
+ * the trace buffer (the event is disabled, tracing is off or the buffer
+ * is full) are built in a scratch buffer and discarded after the update.
+ *
+ * Entries are preallocated and the table is updated without locks, so
+ * it can be used from any context the event fires in.  Events whose key
+ * does not fit anymore, or whose record could not be built, are only
+ * counted as dropped.
+ */
+
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/jhash.h>
+#include <linux/sort.h>
+#include <linux/seq_file.h>
+
+#include "trace.h"
+
+#define HIST_KEYS_MAX		2
+#define HIST_VALS_MAX		4
+#define HIST_SIZE_DEFAULT	2048
+#define HIST_SIZE_MAX		(1 << 17)
+
+enum {
+	HIST_FIELD_HEX		= 1,
+	HIST_FIELD_SYM		= 2,
+	HIST_FIELD_LOG2		= 4,
+};
+
+struct hist_field {
+	struct ftrace_event_field	*field;
+	unsigned int			flags;
+};
+
+struct hist_entry {
+	u64			key[HIST_KEYS_MAX];
+	atomic64_t		hitcount;
+	atomic64_t		sum[HIST_VALS_MAX];
+};
+
+/*
+ * A slot is claimed by setting its hash, and becomes visible once its
+ * entry pointer is set.  Slots are never released while the histogram
+ * exists.
+ */
+struct hist_slot {
+	u32			hash;
+	struct hist_entry	*entry;
+};
+
+struct event_hist {
+	struct hist_field	keys[HIST_KEYS_MAX];
+	struct hist_field	vals[HIST_VALS_MAX];
+	unsigned int		n_keys;
+	unsigned int		n_vals;
+	bool			sort_key;
+	unsigned int		size;		/* entries */
+	unsigned int		map_mask;	/* 2 * size slots */
+	struct hist_slot	*map;
+	struct hist_entry	*entries;
+	atomic_t		next_entry;
+	atomic64_t		drops;
+};
+
+/* Overwrite mode, records only live until their histogram is updated */
+static struct ring_buffer *hist_buffer;
+
+static u64 hist_field_value(struct ftrace_event_field *field, void *rec)
+{
+	void *addr = rec + field->offset;
+
+	switch (field->size) {
+	case 1:
+		return field->is_signed ? (s64)*(s8 *)addr : *(u8 *)addr;
+	case 2:
+		return field->is_signed ? (s64)*(s16 *)addr : *(u16 *)addr;
+	case 4:
+		return field->is_signed ? (s64)*(s32 *)addr : *(u32 *)addr;
+	default:
+		return *(u64 *)addr;
+	}
+}
+
+static struct hist_entry *hist_lookup(struct event_hist *hist, u64 *key)
+{
+	u32 hash = jhash2((u32 *)key, HIST_KEYS_MAX * 2, 0) ?: 1;
+	u32 idx = hash;
+	unsigned int i;
+
+	for (i = 0; i <= hist->map_mask; i++, idx++) {
+		struct hist_slot *slot = &hist->map[idx & hist->map_mask];
+		struct hist_entry *entry;
+		u32 h = ACCESS_ONCE(slot->hash);
+
+		if (!h) {
+			/* don't use up slots once there is nothing to put in */
+			if (atomic_read(&hist->next_entry) >= hist->size)
+				return NULL;
+
+			h = cmpxchg(&slot->hash, 0, hash);
+			if (!h) {
+				int n = atomic_inc_return(&hist->next_entry);
+
+				if (n > hist->size)
+					return NULL;
+				entry = &hist->entries[n - 1];
+				memcpy(entry->key, key, sizeof(entry->key));
+				smp_wmb();
+				slot->entry = entry;
+				return entry;
+			}
+		}
+
+		if (h != hash)
+			continue;
+
+		/* another CPU (or context) is still inserting this key */
+		entry = ACCESS_ONCE(slot->entry);
+		if (!entry)
+			return NULL;
+		smp_read_barrier_depends();
+		if (!memcmp(entry->key, key, sizeof(entry->key)))
+			return entry;
+	}
+
+	return NULL;
+}
+
+static void hist_update(struct event_hist *hist, void *rec)
+{
+	u64 key[HIST_KEYS_MAX] = { };
+	struct hist_entry *entry;
+	unsigned int i;
+
+	for (i = 0; i < hist->n_keys; i++) {
+		key[i] = hist_field_value(hist->keys[i].field, rec);
+		if (hist->keys[i].flags & HIST_FIELD_LOG2)
+			key[i] = fls64(key[i]);
+	}
+
+	entry = hist_lookup(hist, key);
+	if (!entry) {
+		atomic64_inc(&hist->drops);
+		return;
+	}
+
+	atomic64_inc(&entry->hitcount);
+	for (i = 0; i < hist->n_vals; i++)
+		atomic64_add(hist_field_value(hist->vals[i].field, rec),
+			     &entry->sum[i]);
+}
+
+/*
+ * Called for every event of @file that was not filtered out.  Returns
+ * true if @buffer is the scratch buffer, the record must then be
+ * discarded.
+ */
+bool event_hist_update(struct ftrace_event_file *file, void *rec,
+		       struct ring_buffer *buffer)
+{
+	struct event_hist *hist = rcu_dereference_sched(file->hist);
+
+	if (hist)
+		hist_update(hist, rec);
+
+	return buffer == hist_buffer;
+}
+
+/*
+ * Reserve the record of an event of @file in the scratch buffer, when it
+ * does not go into the trace buffer but the histogram still wants it.
+ */
+struct ring_buffer_event *
+event_hist_reserve(struct ring_buffer **current_rb,
+		   struct ftrace_event_file *file,
+		   int type, unsigned long len,
+		   unsigned long flags, int pc)
+{
+	struct event_hist *hist = rcu_dereference_sched(file->hist);
+	struct ring_buffer_event *event;
+
+	if (!hist)
+		return NULL;
+
+	*current_rb = hist_buffer;
+	event = trace_buffer_lock_reserve(hist_buffer, type, len, flags, pc);
+	if (!event)
+		atomic64_inc(&hist->drops);
+
+	return event;
+}
+
+static void free_event_hist(struct event_hist *hist)
+{
+	if (!hist)
+		return;
+
+	vfree(hist->map);
+	vfree(hist->entries);
+	kfree(hist);
+}
+
+static int parse_hist_field(struct ftrace_event_call *call, char *str,
+			    struct hist_field *hf, bool is_key)
+{
+	struct ftrace_event_field *field;
+	char *mod;
+
+	mod = strchr(str, '.');
+	if (mod) {
+		*mod++ = '\0';
+		if (!is_key)
+			return -EINVAL;
+		if (!strcmp(mod, "hex"))
+			hf->flags = HIST_FIELD_HEX;
+		else if (!strcmp(mod, "sym"))
+			hf->flags = HIST_FIELD_SYM;
+		else if (!strcmp(mod, "log2"))
+			hf->flags = HIST_FIELD_LOG2;
+		else
+			return -EINVAL;
+	}
+
+	field = trace_find_event_field(call, str);
+	if (!field || field->filter_type != FILTER_OTHER)
+		return -EINVAL;
+
+	switch (field->size) {
+	case 1:
+	case 2:
+	case 4:
+	case 8:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	hf->field = field;
+	return 0;
+}
+
+static int parse_hist_fields(struct ftrace_event_call *call, char *str,
+			     struct hist_field *fields, unsigned int *n,
+			     unsigned int max, bool is_key)
+{
+	char *tok;
+	int err;
+
+	while ((tok = strsep(&str, ",")) != NULL) {
+		if (*n == max)
+			return -EINVAL;
+		err = parse_hist_field(call, tok, &fields[*n], is_key);
+		if (err)
+			return err;
+		(*n)++;
+	}
+
+	return 0;
+}
+
+static int create_event_hist(struct ftrace_event_call *call, char *spec,
+			     struct event_hist **histp)
+{
+	struct event_hist *hist;
+	unsigned long size = HIST_SIZE_DEFAULT;
+	char *tok, *val;
+	int err;
+
+	hist = kzalloc(sizeof(*hist), GFP_KERNEL);
+	if (!hist)
+		return -ENOMEM;
+
+	while ((tok = strsep(&spec, ":")) != NULL) {
+		err = -EINVAL;
+		val = strchr(tok, '=');
+		if (!val)
+			goto fail;
+		*val++ = '\0';
+
+		if (!strcmp(tok, "keys"))
+			err = parse_hist_fields(call, val, hist->keys,
+						&hist->n_keys,
+						HIST_KEYS_MAX, true);
+		else if (!strcmp(tok, "vals"))
+			err = parse_hist_fields(call, val, hist->vals,
+						&hist->n_vals,
+						HIST_VALS_MAX, false);
+		else if (!strcmp(tok, "sort")) {
+			hist->sort_key = !strcmp(val, "key");
+			err = hist->sort_key || !strcmp(val, "hitcount") ?
+				0 : -EINVAL;
+		} else if (!strcmp(tok, "size"))
+			err = kstrtoul(val, 0, &size);
+		else
+			err = -EINVAL;
+		if (err)
+			goto fail;
+	}
+
+	err = -EINVAL;
+	if (!hist->n_keys || !size || size > HIST_SIZE_MAX)
+		goto fail;
+
+	hist->size = roundup_pow_of_two(size);
+	hist->map_mask = hist->size * 2 - 1;
+
+	err = -ENOMEM;
+	hist->map = vzalloc(sizeof(*hist->map) * hist->size * 2);
+	hist->entries = vzalloc(sizeof(*hist->entries) * hist->size);
+	if (!hist->map || !hist->entries)
+		goto fail;
+
+	*histp = hist;
+	return 0;
+fail:
+	free_event_hist(hist);
+	return err;
+}
+
+static void set_event_hist(struct ftrace_event_file *file,
+			   struct event_hist *hist)
+{
+	struct event_hist *old = file->hist;
+
+	if (hist) {
+		rcu_assign_pointer(file->hist, hist);
+		set_bit(FTRACE_EVENT_FL_HIST_BIT, &file->flags);
+	} else {
+		clear_bit(FTRACE_EVENT_FL_HIST_BIT, &file->flags);
+		rcu_assign_pointer(file->hist, NULL);
+	}
+
+	if (old) {
+		/* events run with preemption disabled */
+		synchronize_sched();
+		free_event_hist(old);
+	}
+}
+
+/* Must be called with event_mutex held */
+int apply_event_hist(struct ftrace_event_file *file, char *spec)
+{
+	struct event_hist *hist = NULL;
+	int err;
+
+	spec = strstrip(spec);
+	if (strcmp(spec, "0") != 0) {
+		if (!hist_buffer) {
+			hist_buffer = ring_buffer_alloc(PAGE_SIZE,
+							RB_FL_OVERWRITE);
+			if (!hist_buffer)
+				return -ENOMEM;
+		}
+		err = create_event_hist(file->event_call, spec, &hist);
+		if (err)
+			return err;
+	}
+
+	set_event_hist(file, hist);
+	return 0;
+}
+
+void destroy_event_hist(struct ftrace_event_file *file)
+{
+	set_event_hist(file, NULL);
+}
+
+static struct event_hist *sort_hist;
+
+static int cmp_hist_entry(const void *a, const void *b)
+{
+	const struct hist_entry *ea = *(const struct hist_entry **)a;
+	const struct hist_entry *eb = *(const struct hist_entry **)b;
+	unsigned int i;
+
+	if (!sort_hist->sort_key) {
+		u64 ha = atomic64_read(&ea->hitcount);
+		u64 hb = atomic64_read(&eb->hitcount);
+
+		if (ha != hb)
+			return ha < hb ? 1 : -1;
+	}
+
+	for (i = 0; i < sort_hist->n_keys; i++) {
+		u64 ka = ea->key[i], kb = eb->key[i];
+
+		if (ka == kb)
+			continue;
+		if (sort_hist->keys[i].field->is_signed &&
+		    !(sort_hist->keys[i].flags & HIST_FIELD_LOG2))
+			return (s64)ka < (s64)kb ? -1 : 1;
+		return ka < kb ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static void print_hist_key(struct seq_file *m, struct hist_field *hf, u64 key)
+{
+	struct ftrace_event_field *field = hf->field;
+
+	seq_printf(m, "%s: ", field->name);
+
+	if (hf->flags & HIST_FIELD_SYM)
+		seq_printf(m, "%-40pS", (void *)(unsigned long)key);
+	else if (hf->flags & HIST_FIELD_HEX)
+		seq_printf(m, "%16llx", key);
+	else if (hf->flags & HIST_FIELD_LOG2) {
+		if (!key)
+			seq_printf(m, "%21s", "0");
+		else
+			seq_printf(m, "%10llu-%-10llu", 1ULL << (key - 1),
+				   key == 64 ? ~0ULL : (1ULL << key) - 1);
+	} else if (field->is_signed)
+		seq_printf(m, "%20lld", (s64)key);
+	else
+		seq_printf(m, "%20llu", key);
+}
+
+static void print_hist_spec(struct seq_file *m, struct event_hist *hist)
+{
+	static const char * const mods[] = {
+		[HIST_FIELD_HEX] = ".hex",
+		[HIST_FIELD_SYM] = ".sym",
+		[HIST_FIELD_LOG2] = ".log2",
+	};
+	unsigned int i;
+
+	seq_puts(m, "# keys=");
+	for (i = 0; i < hist->n_keys; i++)
+		seq_printf(m, "%s%s%s", i ? "," : "",
+			   hist->keys[i].field->name,
+			   mods[hist->keys[i].flags] ?: "");
+	if (hist->n_vals)
+		seq_puts(m, ":vals=");
+	for (i = 0; i < hist->n_vals; i++)
+		seq_printf(m, "%s%s", i ? "," : "",
+			   hist->vals[i].field->name);
+	seq_printf(m, ":sort=%s:size=%u\n",
+		   hist->sort_key ? "key" : "hitcount", hist->size);
+}
+
+/* Must be called with event_mutex held */
+int print_event_hist(struct ftrace_event_file *file, struct seq_file *m)
+{
+	struct event_hist *hist = file->hist;
+	struct hist_entry **sorted;
+	unsigned int i, j, n = 0;
+	u64 hits = 0;
+
+	if (!hist) {
+		seq_puts(m, "none\n");
+		return 0;
+	}
+
+	sorted = vmalloc(sizeof(*sorted) * hist->size);
+	if (!sorted)
+		return -ENOMEM;
+
+	for (i = 0; i <= hist->map_mask; i++) {
+		struct hist_entry *entry = ACCESS_ONCE(hist->map[i].entry);
+
+		if (entry && n < hist->size)
+			sorted[n++] = entry;
+	}
+
+	/* sort() has no private data, event_mutex serializes readers */
+	sort_hist = hist;
+	sort(sorted, n, sizeof(*sorted), cmp_hist_entry, NULL);
+
+	print_hist_spec(m, hist);
+	seq_putc(m, '\n');
+
+	for (i = 0; i < n; i++) {
+		struct hist_entry *entry = sorted[i];
+		u64 count = atomic64_read(&entry->hitcount);
+
+		hits += count;
+		seq_puts(m, "{ ");
+		for (j = 0; j < hist->n_keys; j++) {
+			if (j)
+				seq_puts(m, ", ");
+			print_hist_key(m, &hist->keys[j], entry->key[j]);
+		}
+		seq_printf(m, " } hitcount: %10llu", count);
+		for (j = 0; j < hist->n_vals; j++)
+			seq_printf(m, "  %s: %10llu", hist->vals[j].field->name,
+				   (u64)atomic64_read(&entry->sum[j]));
+		seq_putc(m, '\n');
+	}
+
+	seq_printf(m, "\nTotals:\n    Hits: %llu\n    Entries: %u\n"
+		   "    Dropped: %llu\n", hits, n,
+		   (u64)atomic64_read(&hist->drops));
+
+	vfree(sorted);
+	return 0;
+}
@@ -47,240 +47,282 @@
 
 #include "lz4defs.h"
 
-static int lz4_uncompress(const char *source, char *dest, int osize)
+/*
+ * Matches ending closer than this to the end of the output buffer are
+ * finished byte by byte, everything before that uses the wide copies.
+ */
+#define MATCH_SAFEGUARD	(2 * COPYLENGTH)
+
+/*
+ * Copy a match of at least MINMATCH bytes from 'ref' to 'op'.  Offsets
+ * below 8 are first stepped apart through inc32table/dec64table; offsets
+ * 1, 2 and 4 then just repeat the first 8 bytes written.  May write up to
+ * 15 bytes past 'cpy'.
+ */
+static inline void lz4_copy_match(BYTE *op, const BYTE *ref,
+				  BYTE *const cpy, size_t offset)
+{
+	static const size_t inc32table[] = {0, 1, 2, 1, 0, 4, 4, 4};
+	static const int dec64table[] = {0, 0, 0, -1, -4, 1, 2, 3};
+
+	if (offset >= COPYLENGTH) {
+		LZ4_WILDCOPY16(ref, op, cpy);
+		return;
+	}
+
+	op[0] = ref[0];
+	op[1] = ref[1];
+	op[2] = ref[2];
+	op[3] = ref[3];
+	op += 4;
+	ref += inc32table[offset];
+	PUT4(ref, op);
+	op += 4;
+	ref -= dec64table[offset];
+	if (op >= cpy)
+		return;
+
+	if (op - ref == COPYLENGTH) {
+		const BYTE *const pattern = ref;
+
+		do {
+			ref = pattern;
+			LZ4_COPYPACKET(ref, op);
+		} while (op < cpy);
+		return;
+	}
+	LZ4_WILDCOPY(ref, op, cpy);
+}
+
+/*
+ * Common decoder.  With end_on_input clear the compressed size is unknown
+ * and 'osize' is the exact decompressed size; the input is trusted and the
+ * number of bytes read is returned.  Otherwise 'isize' bytes are decoded
+ * into a buffer of 'osize' bytes, all reads and writes are bounds checked
+ * and the number of bytes written is returned.  With 'partial' set,
+ * decoding stops once 'osize' bytes have been produced, even in the middle
+ * of a sequence.
+ */
+static __always_inline int lz4_decompress_generic(const char *source,
+		char *dest, int isize, int osize, int end_on_input, int partial)
 {
 	const BYTE *ip = (const BYTE *) source;
+	const BYTE *const iend = ip + isize;
 	const BYTE *ref;
 	BYTE *op = (BYTE *) dest;
-	BYTE * const oend = op + osize;
+	BYTE *const oend = op + osize;
 	BYTE *cpy;
-	unsigned token;
-	size_t length;
-	size_t dec32table[] = {0, 3, 2, 3, 0, 0, 0, 0};
-#if LZ4_ARCH64
-	size_t dec64table[] = {0, 0, 0, -1, 0, 1, 2, 3};
-#endif
+	/* room needed for the short literal + short match shortcut */
+	const BYTE *const shortiend = iend - (end_on_input ? 14 : 8) - 2;
+	const BYTE *const shortoend = oend - (end_on_input ? 14 : 8) - 18;
+
+	if (end_on_input) {
+		if (partial && osize == 0)
+			return 0;
+		if (unlikely(isize == 0))
+			return -1;
+		if (unlikely(osize == 0))
+			return (isize == 1 && *ip == 0) ? 0 : -1;
+	} else if (unlikely(osize == 0)) {
+		return (*ip == 0) ? 1 : -1;
+	}
 
 	while (1) {
+		unsigned token;
+		size_t length;
+		size_t offset;
 
-		/* get runlength */
 		token = *ip++;
 		length = (token >> ML_BITS);
+
+		/*
+		 * Most sequences are a short literal run followed by a short
+		 * match.  When there is enough room in both buffers, copy 16
+		 * literal bytes (8 if the input size is unknown) and 18 match
+		 * bytes blindly instead of computing the exact lengths.
+		 */
+		if ((end_on_input ? length != RUN_MASK : length <= 8) &&
+		    likely((end_on_input ? ip < shortiend : 1) &&
+			   op <= shortoend)) {
+			const BYTE *s = ip;
+			BYTE *d = op;
+
+			if (end_on_input)
+				LZ4_COPY16(s, d);
+			else
+				LZ4_COPYPACKET(s, d);
+			op += length;
+			ip += length;
+
+			length = token & ML_MASK;
+			offset = get_unaligned_le16(ip);
+			ip += 2;
+			ref = op - offset;
+
+			if (length != ML_MASK && offset >= COPYLENGTH &&
+			    ref >= (const BYTE *) dest) {
+				s = ref;
+				d = op;
+				LZ4_COPY16(s, d);
+				d[0] = s[0];
+				d[1] = s[1];
+				op += length + MINMATCH;
+				continue;
+			}
+			goto _copy_match;
+		}
+
+		/* get runlength */
 		if (length == RUN_MASK) {
-			size_t len;
+			unsigned s;
 
-			len = *ip++;
-			for (; len == 255; length += 255)
-				len = *ip++;
-			length += len;
+			if (end_on_input && unlikely(ip >= iend - RUN_MASK))
+				goto _output_error;
+			do {
+				s = *ip++;
+				length += s;
+			} while ((end_on_input ? ip < iend - RUN_MASK : 1) &&
+				 s == 255);
+			if (end_on_input && unlikely(op + length < op ||
+						    ip + length < ip))
+				goto _output_error;	/* overflow */
 		}
 
 		/* copy literals */
 		cpy = op + length;
-		if (unlikely(cpy > oend - COPYLENGTH)) {
+		if ((end_on_input && (cpy > oend - MFLIMIT ||
+			ip + length > iend - (2 + 1 + LASTLITERALS))) ||
+		    (!end_on_input && cpy > oend - COPYLENGTH)) {
 			/*
-			 * Error: not enough place for another match
-			 * (min 4) + 5 literals
+			 * Error: the literals must either end the input or
+			 * leave room for a match offset and another token.
+			 * lz4hc_compress() may start its last match closer
+			 * to the end than MFLIMIT.
 			 */
-			if (cpy != oend)
+			if (end_on_input && ip + length != iend &&
+			    ip + length > iend - (2 + 1))
 				goto _output_error;
-
-			memcpy(op, ip, length);
-			ip += length;
-			break; /* EOF */
+			if (partial) {
+				/* output full in the middle of the literals */
+				if (cpy > oend) {
+					cpy = oend;
+					length = oend - op;
+				}
+			} else if (end_on_input ? cpy > oend : cpy != oend) {
+				/*
+				 * Error: request to write beyond destination
+				 * buffer, or the trusted input does not fill
+				 * the output exactly
+				 */
+				goto _output_error;
+			}
+			/* the input may trail the output when run in place */
+			if (op + length > ip && op < ip + length) {
+				while (op < cpy)
+					*op++ = *ip++;
+			} else {
+				memcpy(op, ip, length);
+				ip += length;
+				op += length;
+			}
+			/* EOF, unless a match follows the literals */
+			if (!end_on_input || ip >= iend - 2 ||
+			    (partial && op == oend))
+				break;
+		} else {
+			if (end_on_input && cpy <= oend - 2 * COPYLENGTH &&
+			    ip + length <= iend - 2 * COPYLENGTH)
+				LZ4_WILDCOPY16(ip, op, cpy);
+			else
+				LZ4_WILDCOPY(ip, op, cpy);
+			ip -= (op - cpy);
+			op = cpy;
 		}
-		LZ4_WILDCOPY(ip, op, cpy);
-		ip -= (op - cpy);
-		op = cpy;
 
 		/* get offset */
-		LZ4_READ_LITTLEENDIAN_16(ref, cpy, ip);
+		offset = get_unaligned_le16(ip);
 		ip += 2;
+		ref = op - offset;
+		length = token & ML_MASK;
 
+_copy_match:
 		/* Error: offset create reference outside destination buffer */
-		if (unlikely(ref < (BYTE *const) dest))
+		if (unlikely(ref < (const BYTE *) dest))
 			goto _output_error;
 
 		/* get matchlength */
-		length = token & ML_MASK;
 		if (length == ML_MASK) {
-			for (; *ip == 255; length += 255)
-				ip++;
-			length += *ip++;
-		}
+			unsigned s;
 
-		/* copy repeated sequence */
-		if (unlikely((op - ref) < STEPSIZE)) {
-#if LZ4_ARCH64
-			size_t dec64 = dec64table[op - ref];
-#else
-			const int dec64 = 0;
-#endif
-			op[0] = ref[0];
-			op[1] = ref[1];
-			op[2] = ref[2];
-			op[3] = ref[3];
-			op += 4;
-			ref += 4;
-			ref -= dec32table[op-ref];
-			PUT4(ref, op);
-			op += STEPSIZE - 4;
-			ref -= dec64;
-		} else {
-			LZ4_COPYSTEP(ref, op);
+			do {
+				s = *ip++;
+				/* another length byte or the next token */
+				if (end_on_input && ip >= iend)
+					goto _output_error;
+				length += s;
+			} while (s == 255);
+			if (end_on_input && unlikely(op + length < op))
+				goto _output_error;	/* overflow */
 		}
-		cpy = op + length - (STEPSIZE - 4);
-		if (cpy > (oend - COPYLENGTH)) {
+		length += MINMATCH;
 
-			/* Error: request to write beyond destination buffer */
-			if (cpy > oend)
+		/* copy repeated sequence */
+		cpy = op + length;
+		if (unlikely(cpy > oend - MATCH_SAFEGUARD)) {
+			BYTE *const olimit = oend - MATCH_SAFEGUARD;
+
+			if (partial) {
+				if (cpy > oend)
+					cpy = oend;
+			} else if (cpy > oend) {
+				/*
+				 * Error: request to write beyond destination
+				 * buffer.  lz4hc_compress() may end a match
+				 * less than LASTLITERALS bytes before the end.
+				 */
 				goto _output_error;
-			LZ4_SECURECOPY(ref, op, (oend - COPYLENGTH));
+			}
+			if (op < olimit) {
+				lz4_copy_match(op, ref, olimit, offset);
+				op = olimit;
+				ref = op - offset;
+			}
 			while (op < cpy)
 				*op++ = *ref++;
-			op = cpy;
-			/*
-			 * Check EOF (should never happen, since last 5 bytes
-			 * are supposed to be literals)
-			 */
-			if (op == oend)
-				goto _output_error;
+			if (partial && op == oend)
+				break;
 			continue;
 		}
-		LZ4_SECURECOPY(ref, op, cpy);
+		lz4_copy_match(op, ref, cpy, offset);
 		op = cpy; /* correction */
 	}
 	/* end of decoding */
-	return (int) (((char *)ip) - source);
+	if (end_on_input)
+		return (int) (((char *) op) - dest);
+	return (int) (((char *) ip) - source);
 
-	/* write overflow error detected */
+	/* read or write overflow error detected */
 _output_error:
-	return (int) (-(((char *)ip) - source));
+	return (int) (-(((char *) ip) - source)) - 1;
+}
+
+static int lz4_uncompress(const char *source, char *dest, int osize)
+{
+	return lz4_decompress_generic(source, dest, 0, osize, 0, 0);
 }
 
 static int lz4_uncompress_unknownoutputsize(const char *source, char *dest,
 				int isize, size_t maxoutputsize)
 {
-	const BYTE *ip = (const BYTE *) source;
-	const BYTE *const iend = ip + isize;
-	const BYTE *ref;
-
-
-	BYTE *op = (BYTE *) dest;
-	BYTE * const oend = op + maxoutputsize;
-	BYTE *cpy;
-
-	size_t dec32table[] = {0, 3, 2, 3, 0, 0, 0, 0};
-#if LZ4_ARCH64
-	size_t dec64table[] = {0, 0, 0, -1, 0, 1, 2, 3};
-#endif
-
-	/* Main Loop */
-	while (ip < iend) {
-
-		unsigned token;
-		size_t length;
-
-		/* get runlength */
-		token = *ip++;
-		length = (token >> ML_BITS);
-		if (length == RUN_MASK) {
-			int s = 255;
-			while ((ip < iend) && (s == 255)) {
-				s = *ip++;
-				length += s;
-			}
-		}
-		/* copy literals */
-		cpy = op + length;
-		if ((cpy > oend - COPYLENGTH) ||
-			(ip + length > iend - COPYLENGTH)) {
-
-			if (cpy > oend)
-				goto _output_error;/* writes beyond buffer */
-
-			if (ip + length != iend)
-				goto _output_error;/*
-						    * Error: LZ4 format requires
-						    * to consume all input
-						    * at this stage
-						    */
-			memcpy(op, ip, length);
-			op += length;
-			break;/* Necessarily EOF, due to parsing restrictions */
-		}
-		LZ4_WILDCOPY(ip, op, cpy);
-		ip -= (op - cpy);
-		op = cpy;
-
-		/* get offset */
-		LZ4_READ_LITTLEENDIAN_16(ref, cpy, ip);
-		ip += 2;
-		if (ref < (BYTE * const) dest)
-			goto _output_error;
-			/*
-			 * Error : offset creates reference
-			 * outside of destination buffer
-			 */
-
-		/* get matchlength */
-		length = (token & ML_MASK);
-		if (length == ML_MASK) {
-			while (ip < iend) {
-				int s = *ip++;
-				length += s;
-				if (s == 255)
-					continue;
-				break;
-			}
-		}
-
-		/* copy repeated sequence */
-		if (unlikely((op - ref) < STEPSIZE)) {
-#if LZ4_ARCH64
-			size_t dec64 = dec64table[op - ref];
-#else
-			const int dec64 = 0;
-#endif
-				op[0] = ref[0];
-				op[1] = ref[1];
-				op[2] = ref[2];
-				op[3] = ref[3];
-				op += 4;
-				ref += 4;
-				ref -= dec32table[op - ref];
-				PUT4(ref, op);
-				op += STEPSIZE - 4;
-				ref -= dec64;
-		} else {
-			LZ4_COPYSTEP(ref, op);
-		}
-		cpy = op + length - (STEPSIZE-4);
-		if (cpy > oend - COPYLENGTH) {
-			if (cpy > oend)
-				goto _output_error; /* write outside of buf */
-
-			LZ4_SECURECOPY(ref, op, (oend - COPYLENGTH));
-			while (op < cpy)
-				*op++ = *ref++;
-			op = cpy;
-			/*
-			 * Check EOF (should never happen, since last 5 bytes
-			 * are supposed to be literals)
-			 */
-			if (op == oend)
-				goto _output_error;
-			continue;
-		}
-		LZ4_SECURECOPY(ref, op, cpy);
-		op = cpy; /* correction */
-	}
-	/* end of decoding */
-	return (int) (((char *) op) - dest);
+	return lz4_decompress_generic(source, dest, isize, maxoutputsize,
+				      1, 0);
+}
 
-	/* write overflow error detected */
-_output_error:
-	return (int) (-(((char *) ip) - source));
+static int lz4_uncompress_partial(const char *source, char *dest,
+				int isize, size_t targetoutputsize)
+{
+	return lz4_decompress_generic(source, dest, isize, targetoutputsize,
+				      1, 1);
 }
 
 int lz4_decompress(const unsigned char *src, size_t *src_len,
@@ -320,6 +362,22 @@ exit_0:
 }
 #ifndef STATIC
 EXPORT_SYMBOL(lz4_decompress_unknownoutputsize);
+#endif
+
+int lz4_decompress_partial(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len)
+{
+	int out_len;
+
+	out_len = lz4_uncompress_partial(src, dest, src_len, *dest_len);
+	if (out_len < 0)
+		return -1;
+	*dest_len = out_len;
+
+	return 0;
+}
+#ifndef STATIC
+EXPORT_SYMBOL(lz4_decompress_partial);
 
 MODULE_LICENSE("Dual BSD/GPL");
 MODULE_DESCRIPTION("LZ4 Decompressor");
@@ -154,3 +154,19 @@ typedef struct _U64_S { u64 v; } U64_S;
 		LZ4_WILDCOPY(s, d, e);	\
 		d = e;	\
 	} while (0)
+
+/*
+ * 16-byte variants for the decompressor fast paths.  These may write up
+ * to 15 bytes past 'e'; like LZ4_WILDCOPY, source and destination must be
+ * at least 8 bytes apart.
+ */
+#define LZ4_COPY16(s, d)		\
+	do {				\
+		LZ4_COPYPACKET(s, d);	\
+		LZ4_COPYPACKET(s, d);	\
+	} while (0)
+
+#define LZ4_WILDCOPY16(s, d, e)		\
+	do {				\
+		LZ4_COPY16(s, d);	\
+	} while (d < e)
@@ -0,0 +1,296 @@
+/*
+ * Contended lock microbenchmark, driven from user space.
+ *
+ * Writing "<lock> <threads> <msecs> [<hold> [<read_pct>]]" to
+ * <debugfs>/lock_bench/run starts @threads kthreads, spread over the
+ * online CPUs, that all hammer the same mutex, rwsem or spinlock for
+ * @msecs milliseconds.  Each iteration takes the lock, spins @hold times
+ * in the critical section and drops it again; for the rwsem @read_pct
+ * percent of the acquisitions are done for reading.  The write returns
+ * once the run is over and reading the file back gives the parameters
+ * of the last run followed by the number of acquisitions made by every
+ * thread, one per line.  "perf bench locking" is the intended user.
+ */
+
+#include <linux/cpumask.h>
+#include <linux/debugfs.h>
+#include <linux/delay.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/random.h>
+#include <linux/rwsem.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+
+#define LOCK_BENCH_MAX_THREADS	1024
+#define LOCK_BENCH_MAX_MSECS	(60 * MSEC_PER_SEC)
+
+enum lock_bench_type {
+	LOCK_BENCH_MUTEX,
+	LOCK_BENCH_RWSEM,
+	LOCK_BENCH_SPINLOCK,
+	LOCK_BENCH_NR,
+};
+
+static const char * const lock_bench_names[LOCK_BENCH_NR] = {
+	[LOCK_BENCH_MUTEX]	= "mutex",
+	[LOCK_BENCH_RWSEM]	= "rwsem",
+	[LOCK_BENCH_SPINLOCK]	= "spinlock",
+};
+
+struct lock_bench_thread {
+	struct task_struct	*task;
+	unsigned long		ops;
+	u32			seed;
+};
+
+/* The locks under test and the data they protect. */
+static DEFINE_MUTEX(bench_mutex);
+static DECLARE_RWSEM(bench_rwsem);
+static DEFINE_SPINLOCK(bench_spinlock);
+static unsigned long bench_shared ____cacheline_aligned_in_smp;
+
+/* Parameters of the current or last run, protected by lock_bench_run_lock. */
+static DEFINE_MUTEX(lock_bench_run_lock);
+static enum lock_bench_type bench_type;
+static unsigned int bench_nthreads;
+static unsigned int bench_msecs;
+static unsigned int bench_hold;
+static unsigned int bench_read_pct;
+static u64 bench_elapsed_ns;
+static struct lock_bench_thread *bench_threads;
+
+static bool bench_start, bench_stop;
+
+static struct dentry *lock_bench_dir;
+
+static inline void lock_bench_hold(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < bench_hold; i++)
+		cpu_relax();
+}
+
+static void lock_bench_one(struct lock_bench_thread *t)
+{
+	switch (bench_type) {
+	case LOCK_BENCH_MUTEX:
+		mutex_lock(&bench_mutex);
+		bench_shared++;
+		lock_bench_hold();
+		mutex_unlock(&bench_mutex);
+		break;
+	case LOCK_BENCH_RWSEM:
+		/* cheap LCG, all we want is a rough read/write mix */
+		t->seed = t->seed * 1664525 + 1013904223;
+		if ((t->seed >> 16) % 100 < bench_read_pct) {
+			down_read(&bench_rwsem);
+			(void)ACCESS_ONCE(bench_shared);
+			lock_bench_hold();
+			up_read(&bench_rwsem);
+		} else {
+			down_write(&bench_rwsem);
+			bench_shared++;
+			lock_bench_hold();
+			up_write(&bench_rwsem);
+		}
+		break;
+	case LOCK_BENCH_SPINLOCK:
+		spin_lock(&bench_spinlock);
+		bench_shared++;
+		lock_bench_hold();
+		spin_unlock(&bench_spinlock);
+		break;
+	default:
+		BUG();
+	}
+}
+
+static int lock_bench_thread(void *data)
+{
+	struct lock_bench_thread *t = data;
+
+	while (!ACCESS_ONCE(bench_start) && !kthread_should_stop())
+		cond_resched();
+
+	while (!ACCESS_ONCE(bench_stop)) {
+		lock_bench_one(t);
+		t->ops++;
+		cond_resched();
+	}
+
+	/* stay around until lock_bench_run() collects us */
+	set_current_state(TASK_INTERRUPTIBLE);
+	while (!kthread_should_stop()) {
+		schedule();
+		set_current_state(TASK_INTERRUPTIBLE);
+	}
+	__set_current_state(TASK_RUNNING);
+
+	return 0;
+}
+
+static int lock_bench_run(void)
+{
+	struct lock_bench_thread *threads;
+	unsigned int i, cpu = cpumask_first(cpu_online_mask);
+	ktime_t start;
+	int err = 0;
+
+	kfree(bench_threads);
+	bench_threads = NULL;
+
+	threads = kcalloc(bench_nthreads, sizeof(*threads), GFP_KERNEL);
+	if (!threads)
+		return -ENOMEM;
+
+	bench_start = false;
+	bench_stop = false;
+	bench_shared = 0;
+
+	for (i = 0; i < bench_nthreads; i++) {
+		struct task_struct *task;
+
+		threads[i].seed = prandom_u32();
+		task = kthread_create_on_node(lock_bench_thread, &threads[i],
+					      cpu_to_node(cpu), "lock_bench/%u",
+					      i);
+		if (IS_ERR(task)) {
+			err = PTR_ERR(task);
+			break;
+		}
+		kthread_bind(task, cpu);
+		threads[i].task = task;
+		wake_up_process(task);
+
+		cpu = cpumask_next(cpu, cpu_online_mask);
+		if (cpu >= nr_cpu_ids)
+			cpu = cpumask_first(cpu_online_mask);
+	}
+
+	if (!err) {
+		start = ktime_get();
+		ACCESS_ONCE(bench_start) = true;
+		msleep(bench_msecs);
+		ACCESS_ONCE(bench_stop) = true;
+		bench_elapsed_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	} else
+		ACCESS_ONCE(bench_stop) = true;
+
+	for (i = 0; i < bench_nthreads && threads[i].task; i++)
+		kthread_stop(threads[i].task);
+
+	if (err) {
+		kfree(threads);
+		return err;
+	}
+
+	bench_threads = threads;
+	return 0;
+}
+
+static int lock_bench_show(struct seq_file *m, void *v)
+{
+	unsigned int i;
+
+	mutex_lock(&lock_bench_run_lock);
+	if (!bench_threads)
+		goto out;
+
+	seq_printf(m, "%s %u %u %u %u %llu\n", lock_bench_names[bench_type],
+		   bench_nthreads, bench_msecs, bench_hold, bench_read_pct,
+		   bench_elapsed_ns);
+	for (i = 0; i < bench_nthreads; i++)
+		seq_printf(m, "%lu\n", bench_threads[i].ops);
+out:
+	mutex_unlock(&lock_bench_run_lock);
+	return 0;
+}
+
+static int lock_bench_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lock_bench_show, NULL);
+}
+
+static ssize_t lock_bench_write(struct file *file, const char __user *ubuf,
+				size_t count, loff_t *ppos)
+{
+	unsigned int nthreads, msecs, hold = 10, read_pct = 0;
+	char buf[64], name[16];
+	int type, ret;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	ret = sscanf(buf, "%15s %u %u %u %u", name, &nthreads, &msecs,
+		     &hold, &read_pct);
+	if (ret < 3)
+		return -EINVAL;
+
+	for (type = 0; type < LOCK_BENCH_NR; type++)
+		if (!strcmp(name, lock_bench_names[type]))
+			break;
+	if (type == LOCK_BENCH_NR)
+		return -EINVAL;
+
+	if (!nthreads || nthreads > LOCK_BENCH_MAX_THREADS ||
+	    !msecs || msecs > LOCK_BENCH_MAX_MSECS || read_pct > 100)
+		return -EINVAL;
+
+	mutex_lock(&lock_bench_run_lock);
+	bench_type = type;
+	bench_nthreads = nthreads;
+	bench_msecs = msecs;
+	bench_hold = hold;
+	bench_read_pct = read_pct;
+	ret = lock_bench_run();
+	mutex_unlock(&lock_bench_run_lock);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations lock_bench_fops = {
+	.owner		= THIS_MODULE,
+	.open		= lock_bench_open,
+	.read		= seq_read,
+	.write		= lock_bench_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init test_lock_bench_init(void)
+{
+	lock_bench_dir = debugfs_create_dir("lock_bench", NULL);
+	if (!lock_bench_dir)
+		return -ENOMEM;
+
+	if (!debugfs_create_file("run", 0600, lock_bench_dir, NULL,
+				 &lock_bench_fops)) {
+		debugfs_remove_recursive(lock_bench_dir);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void __exit test_lock_bench_exit(void)
+{
+	debugfs_remove_recursive(lock_bench_dir);
+	kfree(bench_threads);
+}
+
+module_init(test_lock_bench_init);
+module_exit(test_lock_bench_exit);
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Contended mutex, rwsem and spinlock benchmark");
@@ -0,0 +1,433 @@
+/*
+ * Test cases and benchmark for the LZ4 decompressor in lib/lz4.
+ *
+ * Buffers of several sizes and kinds are compressed with lz4_compress() and
+ * lz4hc_compress() and decoded through every decompressor entry point, including partial and
+ * in-place decoding, and through the previous word-at-a-time decoder kept
+ * below as a reference.  All results must match the original data byte for
+ * byte.  The decompression throughput of the reference and the current
+ * decoder is then reported for page sized blocks.
+ */
+#define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
+
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/lz4.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/vmalloc.h>
+
+#include <asm/unaligned.h>
+
+#include "lz4/lz4defs.h"
+
+#define TEST_LZ4_MAX_LEN	(64 * 1024)
+#define TEST_LZ4_BENCH_PAGES	256
+
+static unsigned int bench_loops = 100;
+module_param(bench_loops, uint, 0444);
+MODULE_PARM_DESC(bench_loops, "Passes over the benchmark pages (0 to skip)");
+
+enum {
+	CORPUS_ZERO,
+	CORPUS_TEXT,
+	CORPUS_RUNS,
+	CORPUS_RANDOM,
+	CORPUS_NR,
+};
+
+static const char * const corpus_names[CORPUS_NR] __initconst = {
+	"zero", "text", "runs", "random",
+};
+
+static const size_t test_lens[] __initconst = {
+	1, 15, 16, 31, 64, 255, 256, 1000, PAGE_SIZE - 1, PAGE_SIZE,
+	PAGE_SIZE + 1, 16384, 65535, TEST_LZ4_MAX_LEN,
+};
+
+static size_t bench_clen[TEST_LZ4_BENCH_PAGES] __initdata;
+
+typedef int (*test_lz4_comp_t)(const unsigned char *src, size_t src_len,
+			       unsigned char *dst, size_t *dst_len,
+			       void *wrkmem);
+
+static const struct {
+	const char *name;
+	test_lz4_comp_t comp;
+} compressors[] __initconst = {
+	{ "lz4_compress",	lz4_compress },
+	{ "lz4hc_compress",	lz4hc_compress },
+};
+
+/*
+ * Reference decoder: the bounds checked decoder lib/lz4 used before the
+ * wide-copy fast paths, kept unchanged to check against.
+ */
+static int __init lz4_ref_uncompress(const char *source, char *dest,
+				     int isize, size_t maxoutputsize)
+{
+	const BYTE *ip = (const BYTE *) source;
+	const BYTE *const iend = ip + isize;
+	const BYTE *ref;
+
+	BYTE *op = (BYTE *) dest;
+	BYTE * const oend = op + maxoutputsize;
+	BYTE *cpy;
+
+	size_t dec32table[] = {0, 3, 2, 3, 0, 0, 0, 0};
+#if LZ4_ARCH64
+	size_t dec64table[] = {0, 0, 0, -1, 0, 1, 2, 3};
+#endif
+
+	while (ip < iend) {
+		unsigned token;
+		size_t length;
+
+		/* get runlength */
+		token = *ip++;
+		length = (token >> ML_BITS);
+		if (length == RUN_MASK) {
+			int s = 255;
+			while ((ip < iend) && (s == 255)) {
+				s = *ip++;
+				length += s;
+			}
+		}
+		/* copy literals */
+		cpy = op + length;
+		if ((cpy > oend - COPYLENGTH) ||
+			(ip + length > iend - COPYLENGTH)) {
+			if (cpy > oend)
+				goto _output_error;
+			if (ip + length != iend)
+				goto _output_error;
+			memcpy(op, ip, length);
+			op += length;
+			break;
+		}
+		LZ4_WILDCOPY(ip, op, cpy);
+		ip -= (op - cpy);
+		op = cpy;
+
+		/* get offset */
+		LZ4_READ_LITTLEENDIAN_16(ref, cpy, ip);
+		ip += 2;
+		if (ref < (BYTE * const) dest)
+			goto _output_error;
+
+		/* get matchlength */
+		length = (token & ML_MASK);
+		if (length == ML_MASK) {
+			while (ip < iend) {
+				int s = *ip++;
+				length += s;
+				if (s == 255)
+					continue;
+				break;
+			}
+		}
+
+		/* copy repeated sequence */
+		if (unlikely((op - ref) < STEPSIZE)) {
+#if LZ4_ARCH64
+			size_t dec64 = dec64table[op - ref];
+#else
+			const int dec64 = 0;
+#endif
+			op[0] = ref[0];
+			op[1] = ref[1];
+			op[2] = ref[2];
+			op[3] = ref[3];
+			op += 4;
+			ref += 4;
+			ref -= dec32table[op - ref];
+			PUT4(ref, op);
+			op += STEPSIZE - 4;
+			ref -= dec64;
+		} else {
+			LZ4_COPYSTEP(ref, op);
+		}
+		cpy = op + length - (STEPSIZE-4);
+		if (cpy > oend - COPYLENGTH) {
+			if (cpy > oend)
+				goto _output_error;
+			LZ4_SECURECOPY(ref, op, (oend - COPYLENGTH));
+			while (op < cpy)
+				*op++ = *ref++;
+			op = cpy;
+			if (op == oend)
+				goto _output_error;
+			continue;
+		}
+		LZ4_SECURECOPY(ref, op, cpy);
+		op = cpy;
+	}
+	return (int) (((char *) op) - dest);
+
+_output_error:
+	return (int) (-(((char *) ip) - source)) - 1;
+}
+
+static void __init fill_corpus(u8 *buf, size_t len, int corpus,
+			       struct rnd_state *rnd)
+{
+	static const char * const words[] __initconst = {
+		"the ", "kernel ", "page ", "cache ", "zram ", "lz4 ", "\n",
+	};
+	size_t i = 0;
+
+	switch (corpus) {
+	case CORPUS_ZERO:
+		memset(buf, 0, len);
+		break;
+	case CORPUS_TEXT:
+		while (i < len) {
+			const char *w;
+
+			w = words[prandom_u32_state(rnd) % ARRAY_SIZE(words)];
+			while (*w && i < len)
+				buf[i++] = *w++;
+		}
+		break;
+	case CORPUS_RUNS:
+		/* short offset repeats hit the overlapping match copies */
+		while (i < len) {
+			size_t off = 1 + prandom_u32_state(rnd) % 16;
+			size_t n = prandom_u32_state(rnd) % 64;
+
+			if (i < off || !(prandom_u32_state(rnd) % 4)) {
+				buf[i++] = prandom_u32_state(rnd);
+				continue;
+			}
+			for (; n && i < len; n--, i++)
+				buf[i] = buf[i - off];
+		}
+		break;
+	default:
+		prandom_bytes_state(rnd, buf, len);
+		break;
+	}
+}
+
+static int __init test_lz4_check(const char *what, const char *name,
+				 size_t len, const u8 *out, size_t out_len,
+				 const u8 *expect, size_t expect_len, int ret)
+{
+	if (!ret && out_len == expect_len && !memcmp(out, expect, expect_len))
+		return 0;
+
+	pr_err("%s/%zu: %s mismatch (ret %d, %zu of %zu bytes)\n",
+	       name, len, what, ret, out_len, expect_len);
+	return 1;
+}
+
+static int __init test_lz4_one(const u8 *src, size_t len, u8 *comp, u8 *dst,
+			       u8 *ref, void *wrkmem, const char *name,
+			       unsigned int c, struct rnd_state *rnd)
+{
+	size_t clen, slen, dlen, target, margin;
+	int failed = 0;
+	int ret;
+
+	ret = compressors[c].comp(src, len, comp, &clen, wrkmem);
+	if (ret) {
+		pr_err("%s/%zu: %s failed\n", name, len, compressors[c].name);
+		return 1;
+	}
+
+	ret = lz4_ref_uncompress(comp, ref, clen, len);
+	failed += test_lz4_check("reference", name, len, ref, max(ret, 0),
+				 src, len, min(ret, 0));
+
+	slen = 0;
+	memset(dst, 0, len);
+	ret = lz4_decompress(comp, &slen, dst, len);
+	failed += test_lz4_check("lz4_decompress", name, len, dst, len,
+				 ref, len, ret ? ret : (slen != clen));
+
+	dlen = len;
+	memset(dst, 0, len);
+	ret = lz4_decompress_unknownoutputsize(comp, clen, dst, &dlen);
+	failed += test_lz4_check("lz4_decompress_unknownoutputsize", name,
+				 len, dst, dlen, ref, len, ret);
+
+	/* a destination one byte short must be rejected */
+	dlen = len - 1;
+	if (!lz4_decompress_unknownoutputsize(comp, clen, dst, &dlen)) {
+		pr_err("%s/%zu: short destination accepted\n", name, len);
+		failed++;
+	}
+
+	/* the first page, a random prefix and more than there is */
+	target = min_t(size_t, len, PAGE_SIZE);
+	dlen = target;
+	ret = lz4_decompress_partial(comp, clen, dst, &dlen);
+	failed += test_lz4_check("lz4_decompress_partial", name, len, dst,
+				 dlen, ref, target, ret);
+
+	target = prandom_u32_state(rnd) % (len + 1);
+	dlen = target;
+	ret = lz4_decompress_partial(comp, clen, dst, &dlen);
+	failed += test_lz4_check("lz4_decompress_partial", name, len, dst,
+				 dlen, ref, target, ret);
+
+	dlen = len + 1;
+	ret = lz4_decompress_partial(comp, clen, dst, &dlen);
+	failed += test_lz4_check("lz4_decompress_partial", name, len, dst,
+				 dlen, ref, len, ret);
+
+	/* in place, with the input at the end of the output buffer */
+	margin = LZ4_DECOMPRESS_INPLACE_MARGIN(clen);
+	memcpy(dst + len + margin - clen, comp, clen);
+	dlen = len;
+	ret = lz4_decompress_unknownoutputsize(dst + len + margin - clen, clen,
+					       dst, &dlen);
+	failed += test_lz4_check("in-place", name, len, dst, dlen, ref, len,
+				 ret);
+
+	return failed;
+}
+
+typedef int (*test_lz4_decomp_t)(const u8 *src, size_t src_len, u8 *dst);
+
+static int __init bench_ref(const u8 *src, size_t src_len, u8 *dst)
+{
+	return lz4_ref_uncompress(src, dst, src_len, PAGE_SIZE) < 0;
+}
+
+static int __init bench_fast(const u8 *src, size_t src_len, u8 *dst)
+{
+	return lz4_decompress(src, &src_len, dst, PAGE_SIZE);
+}
+
+static int __init bench_safe(const u8 *src, size_t src_len, u8 *dst)
+{
+	size_t dst_len = PAGE_SIZE;
+
+	return lz4_decompress_unknownoutputsize(src, src_len, dst, &dst_len);
+}
+
+static int __init test_lz4_bench_one(const char *name, const char *what,
+				     test_lz4_decomp_t decomp, const u8 *src,
+				     const u8 *comp, u8 *dst)
+{
+	u64 bytes = (u64)bench_loops * TEST_LZ4_BENCH_PAGES * PAGE_SIZE;
+	ktime_t start;
+	s64 ns;
+	unsigned int loop, i;
+
+	memset(dst, 0, TEST_LZ4_BENCH_PAGES * PAGE_SIZE);
+	start = ktime_get();
+	for (loop = 0; loop < bench_loops; loop++) {
+		const u8 *c = comp;
+
+		for (i = 0; i < TEST_LZ4_BENCH_PAGES; i++) {
+			if (decomp(c, bench_clen[i], dst + i * PAGE_SIZE)) {
+				pr_err("%s: %s failed on page %u\n",
+				       name, what, i);
+				return 1;
+			}
+			c += bench_clen[i];
+		}
+		cond_resched();
+	}
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	if (memcmp(dst, src, TEST_LZ4_BENCH_PAGES * PAGE_SIZE)) {
+		pr_err("%s: %s output mismatch\n", name, what);
+		return 1;
+	}
+
+	pr_info("%-6s %-10s %6llu MB/s\n", name, what,
+		div64_u64(bytes * 1000, max_t(s64, ns, 1)));
+	return 0;
+}
+
+static int __init test_lz4_bench(u8 *src, u8 *comp, u8 *dst, void *wrkmem,
+				 int corpus, struct rnd_state *rnd)
+{
+	const char *name = corpus_names[corpus];
+	size_t total = 0;
+	int failed = 0;
+	unsigned int i;
+
+	fill_corpus(src, TEST_LZ4_BENCH_PAGES * PAGE_SIZE, corpus, rnd);
+	for (i = 0; i < TEST_LZ4_BENCH_PAGES; i++) {
+		if (lz4_compress(src + i * PAGE_SIZE, PAGE_SIZE, comp + total,
+				 &bench_clen[i], wrkmem)) {
+			pr_err("%s: lz4_compress failed\n", name);
+			return 1;
+		}
+		total += bench_clen[i];
+	}
+
+	failed += test_lz4_bench_one(name, "reference", bench_ref,
+				     src, comp, dst);
+	failed += test_lz4_bench_one(name, "fast", bench_fast,
+				     src, comp, dst);
+	failed += test_lz4_bench_one(name, "safe", bench_safe,
+				     src, comp, dst);
+	return failed;
+}
+
+static int __init test_lz4_init(void)
+{
+	size_t bound = lz4_compressbound(TEST_LZ4_MAX_LEN);
+	size_t bench_len = TEST_LZ4_BENCH_PAGES * PAGE_SIZE;
+	size_t bench_bound;
+	struct rnd_state rnd;
+	u8 *src, *comp, *dst, *ref;
+	void *wrkmem;
+	int failed = 0;
+	int corpus;
+	unsigned int c, i;
+
+	bench_bound = TEST_LZ4_BENCH_PAGES * lz4_compressbound(PAGE_SIZE);
+	src = vmalloc(max_t(size_t, TEST_LZ4_MAX_LEN, bench_len));
+	comp = vmalloc(max(bound, bench_bound));
+	dst = vmalloc(max_t(size_t, TEST_LZ4_MAX_LEN +
+			    LZ4_DECOMPRESS_INPLACE_MARGIN(bound), bench_len));
+	ref = vmalloc(TEST_LZ4_MAX_LEN);
+	wrkmem = vmalloc(max(LZ4_MEM_COMPRESS, LZ4HC_MEM_COMPRESS));
+	if (!src || !comp || !dst || !ref || !wrkmem) {
+		failed = -ENOMEM;
+		goto out;
+	}
+
+	prandom_seed_state(&rnd, 3141592653589793238ULL);
+	for (corpus = 0; corpus < CORPUS_NR; corpus++) {
+		for (i = 0; i < ARRAY_SIZE(test_lens); i++) {
+			fill_corpus(src, test_lens[i], corpus, &rnd);
+			for (c = 0; c < ARRAY_SIZE(compressors); c++)
+				failed += test_lz4_one(src, test_lens[i], comp,
+						       dst, ref, wrkmem,
+						       corpus_names[corpus],
+						       c, &rnd);
+		}
+	}
+	pr_info("%d decompression checks failed\n", failed);
+
+	if (bench_loops && !failed) {
+		for (corpus = 0; corpus < CORPUS_NR; corpus++)
+			failed += test_lz4_bench(src, comp, dst, wrkmem,
+						 corpus, &rnd);
+	}
+
+out:
+	vfree(wrkmem);
+	vfree(ref);
+	vfree(dst);
+	vfree(comp);
+	vfree(src);
+	if (failed)
+		return failed < 0 ? failed : -EINVAL;
+	return -EAGAIN;  /* Fail will directly unload the module */
+}
+module_init(test_lz4_init);
+MODULE_LICENSE("Dual BSD/GPL");
+MODULE_DESCRIPTION("LZ4 decompressor tests and benchmark");
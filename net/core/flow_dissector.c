@@ -51,15 +51,26 @@ __be32 skb_flow_get_ports(const struct sk_buff *skb, int thoff, u8 ip_proto)
 }
 EXPORT_SYMBOL(skb_flow_get_ports);
 
-bool skb_flow_dissect(const struct sk_buff *skb, struct flow_keys *flow)
+/* MPLS label stack entry, RFC 3032 */
+#define MPLS_LS_LABEL_MASK	0xFFFFF000
+#define MPLS_LS_LABEL_SHIFT	12
+#define MPLS_LS_S_MASK		0x00000100
+
+static bool __skb_flow_dissect(const struct sk_buff *skb,
+			       struct flow_keys *flow,
+			       struct flow_keys_ext *ext)
 {
 	int nhoff = skb_network_offset(skb);
 	u8 ip_proto;
 	__be16 proto = skb->protocol;
+	bool vlan_seen = false;
 
 	memset(flow, 0, sizeof(*flow));
 
 again:
+	if (ext)
+		ext->n_proto = proto;
+
 	switch (proto) {
 	case __constant_htons(ETH_P_IP): {
 		const struct iphdr *iph;
@@ -75,6 +86,8 @@ ip:
 			ip_proto = 0;
 
 		iph_to_flow_copy_addrs(flow, iph);
+		if (ext)
+			ext->n_proto = htons(ETH_P_IP);
 		break;
 	}
 	case __constant_htons(ETH_P_IPV6): {
@@ -89,6 +102,11 @@ ipv6:
 		flow->src = (__force __be32)ipv6_addr_hash(&iph->saddr);
 		flow->dst = (__force __be32)ipv6_addr_hash(&iph->daddr);
 		nhoff += sizeof(struct ipv6hdr);
+		if (ext) {
+			ext->n_proto = htons(ETH_P_IPV6);
+			ext->ipv6_src = iph->saddr;
+			ext->ipv6_dst = iph->daddr;
+		}
 		break;
 	}
 	case __constant_htons(ETH_P_8021AD):
@@ -100,6 +118,9 @@ ipv6:
 		if (!vlan)
 			return false;
 
+		if (ext && !vlan_seen)
+			ext->vlan_id = ntohs(vlan->h_vlan_TCI) & VLAN_VID_MASK;
+		vlan_seen = true;
 		proto = vlan->h_vlan_encapsulated_proto;
 		nhoff += sizeof(*vlan);
 		goto again;
@@ -123,6 +144,36 @@ ipv6:
 			return false;
 		}
 	}
+	case __constant_htons(ETH_P_MPLS_UC):
+	case __constant_htons(ETH_P_MPLS_MC): {
+		const __be32 *lse;
+		__be32 _lse;
+		u32 entry;
+		bool top = true;
+
+		/* Nothing in the label stack can be hashed into the basic
+		 * keys, and we can't tell what is below it without the
+		 * control plane, so only the extended keys look at it.
+		 */
+		if (!ext)
+			return false;
+
+		do {
+			lse = skb_header_pointer(skb, nhoff, sizeof(_lse),
+						 &_lse);
+			if (!lse)
+				return false;
+			entry = ntohl(*lse);
+			if (top)
+				ext->mpls_label = (entry & MPLS_LS_LABEL_MASK) >>
+						  MPLS_LS_LABEL_SHIFT;
+			top = false;
+			nhoff += sizeof(*lse);
+		} while (!(entry & MPLS_LS_S_MASK));
+
+		flow->thoff = (u16) nhoff;
+		return true;
+	}
 	default:
 		return false;
 	}
@@ -181,8 +232,31 @@ ipv6:
 
 	return true;
 }
+
+bool skb_flow_dissect(const struct sk_buff *skb, struct flow_keys *flow)
+{
+	return __skb_flow_dissect(skb, flow, NULL);
+}
 EXPORT_SYMBOL(skb_flow_dissect);
 
+/**
+ * skb_flow_dissect_ext - dissect a packet into extended flow keys
+ * @skb: buffer to dissect
+ * @ext: keys to fill in
+ *
+ * Like skb_flow_dissect(), but also records the full IPv6 addresses,
+ * the outermost VLAN id and MPLS label and the protocol of the network
+ * header the keys refer to.  Dissection stops at the bottom of an MPLS
+ * label stack.  The fields found before a parsing failure are valid
+ * even if false is returned.
+ */
+bool skb_flow_dissect_ext(const struct sk_buff *skb, struct flow_keys_ext *ext)
+{
+	memset(ext, 0, sizeof(*ext));
+	return __skb_flow_dissect(skb, &ext->basic, ext);
+}
+EXPORT_SYMBOL(skb_flow_dissect_ext);
+
 static u32 hashrnd __read_mostly;
 static __always_inline void __flow_hash_secret_init(void)
 {
@@ -82,6 +82,7 @@ struct gen_estimator
 {
 	struct list_head	list;
 	struct gnet_stats_basic_packed	*bstats;
+	struct gnet_stats_basic_cpu __percpu *cpu_bstats;
 	struct gnet_stats_rate_est64	*rate_est;
 	spinlock_t		*stats_lock;
 	int			ewma_log;
@@ -108,6 +109,18 @@ static DEFINE_RWLOCK(est_lock);
 static struct rb_root est_root = RB_ROOT;
 static DEFINE_SPINLOCK(est_tree_lock);
 
+static void est_fetch_counters(struct gen_estimator *e,
+			       struct gnet_stats_basic_packed *b)
+{
+	if (e->cpu_bstats) {
+		memset(b, 0, sizeof(*b));
+		gnet_stats_add_basic_cpu(b, e->cpu_bstats);
+	} else {
+		b->bytes = e->bstats->bytes;
+		b->packets = e->bstats->packets;
+	}
+}
+
 static void est_timer(unsigned long arg)
 {
 	int idx = (int)arg;
@@ -115,6 +128,7 @@ static void est_timer(unsigned long arg)
 
 	rcu_read_lock();
 	list_for_each_entry_rcu(e, &elist[idx].list, list) {
+		struct gnet_stats_basic_packed b;
 		u64 nbytes;
 		u64 brate;
 		u32 npackets;
@@ -125,8 +139,9 @@ static void est_timer(unsigned long arg)
 		if (e->bstats == NULL)
 			goto skip;
 
-		nbytes = e->bstats->bytes;
-		npackets = e->bstats->packets;
+		est_fetch_counters(e, &b);
+		nbytes = b.bytes;
+		npackets = b.packets;
 		brate = (nbytes - e->last_bytes)<<(7 - idx);
 		e->last_bytes = nbytes;
 		e->avbps += (brate >> e->ewma_log) - (e->avbps >> e->ewma_log);
@@ -187,26 +202,26 @@ struct gen_estimator *gen_find_node(const struct gnet_stats_basic_packed *bstats
 }
 
 /**
- * gen_new_estimator - create a new rate estimator
- * @bstats: basic statistics
+ * gen_new_estimator_cpu - create a new rate estimator on per cpu statistics
+ * @bstats: basic statistics, identifies the estimator
+ * @cpu_bstats: per cpu basic statistics or NULL
  * @rate_est: rate estimator statistics
  * @stats_lock: statistics lock
  * @opt: rate estimator configuration TLV
  *
- * Creates a new rate estimator with &bstats as source and &rate_est
- * as destination. A new timer with the interval specified in the
- * configuration TLV is created. Upon each interval, the latest statistics
- * will be read from &bstats and the estimated rate will be stored in
- * &rate_est with the statistics lock grabed during this period.
+ * Like gen_new_estimator(), but if &cpu_bstats is not NULL the latest
+ * statistics are summed up from &cpu_bstats instead of read from &bstats.
+ * &bstats is still used to find the estimator again.
  *
  * Returns 0 on success or a negative error code.
- *
  */
-int gen_new_estimator(struct gnet_stats_basic_packed *bstats,
-		      struct gnet_stats_rate_est64 *rate_est,
-		      spinlock_t *stats_lock,
-		      struct nlattr *opt)
+int gen_new_estimator_cpu(struct gnet_stats_basic_packed *bstats,
+			  struct gnet_stats_basic_cpu __percpu *cpu_bstats,
+			  struct gnet_stats_rate_est64 *rate_est,
+			  spinlock_t *stats_lock,
+			  struct nlattr *opt)
 {
+	struct gnet_stats_basic_packed b;
 	struct gen_estimator *est;
 	struct gnet_estimator *parm = nla_data(opt);
 	int idx;
@@ -223,12 +238,14 @@ int gen_new_estimator(struct gnet_stats_basic_packed *bstats,
 
 	idx = parm->interval + 2;
 	est->bstats = bstats;
+	est->cpu_bstats = cpu_bstats;
 	est->rate_est = rate_est;
 	est->stats_lock = stats_lock;
 	est->ewma_log = parm->ewma_log;
-	est->last_bytes = bstats->bytes;
+	est_fetch_counters(est, &b);
+	est->last_bytes = b.bytes;
 	est->avbps = rate_est->bps<<5;
-	est->last_packets = bstats->packets;
+	est->last_packets = b.packets;
 	est->avpps = rate_est->pps<<10;
 
 	spin_lock_bh(&est_tree_lock);
@@ -246,6 +263,31 @@ int gen_new_estimator(struct gnet_stats_basic_packed *bstats,
 
 	return 0;
 }
+EXPORT_SYMBOL(gen_new_estimator_cpu);
+
+/**
+ * gen_new_estimator - create a new rate estimator
+ * @bstats: basic statistics
+ * @rate_est: rate estimator statistics
+ * @stats_lock: statistics lock
+ * @opt: rate estimator configuration TLV
+ *
+ * Creates a new rate estimator with &bstats as source and &rate_est
+ * as destination. A new timer with the interval specified in the
+ * configuration TLV is created. Upon each interval, the latest statistics
+ * will be read from &bstats and the estimated rate will be stored in
+ * &rate_est with the statistics lock grabed during this period.
+ *
+ * Returns 0 on success or a negative error code.
+ *
+ */
+int gen_new_estimator(struct gnet_stats_basic_packed *bstats,
+		      struct gnet_stats_rate_est64 *rate_est,
+		      spinlock_t *stats_lock,
+		      struct nlattr *opt)
+{
+	return gen_new_estimator_cpu(bstats, NULL, rate_est, stats_lock, opt);
+}
 EXPORT_SYMBOL(gen_new_estimator);
 
 /**
@@ -293,11 +335,35 @@ int gen_replace_estimator(struct gnet_stats_basic_packed *bstats,
 			  struct gnet_stats_rate_est64 *rate_est,
 			  spinlock_t *stats_lock, struct nlattr *opt)
 {
-	gen_kill_estimator(bstats, rate_est);
-	return gen_new_estimator(bstats, rate_est, stats_lock, opt);
+	return gen_replace_estimator_cpu(bstats, NULL, rate_est, stats_lock,
+					 opt);
 }
 EXPORT_SYMBOL(gen_replace_estimator);
 
+/**
+ * gen_replace_estimator_cpu - replace a rate estimator on per cpu statistics
+ * @bstats: basic statistics, identifies the estimator
+ * @cpu_bstats: per cpu basic statistics or NULL
+ * @rate_est: rate estimator statistics
+ * @stats_lock: statistics lock
+ * @opt: rate estimator configuration TLV
+ *
+ * Like gen_replace_estimator(), but the new estimator reads &cpu_bstats
+ * as gen_new_estimator_cpu() does.
+ *
+ * Returns 0 on success or a negative error code.
+ */
+int gen_replace_estimator_cpu(struct gnet_stats_basic_packed *bstats,
+			      struct gnet_stats_basic_cpu __percpu *cpu_bstats,
+			      struct gnet_stats_rate_est64 *rate_est,
+			      spinlock_t *stats_lock, struct nlattr *opt)
+{
+	gen_kill_estimator(bstats, rate_est);
+	return gen_new_estimator_cpu(bstats, cpu_bstats, rate_est,
+				     stats_lock, opt);
+}
+EXPORT_SYMBOL(gen_replace_estimator_cpu);
+
 /**
  * gen_estimator_active - test if estimator is currently in use
  * @bstats: basic statistics
@@ -17,6 +17,7 @@
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/interrupt.h>
+#include <linux/percpu.h>
 #include <linux/socket.h>
 #include <linux/rtnetlink.h>
 #include <linux/gen_stats.h>
@@ -200,6 +201,63 @@ gnet_stats_copy_queue(struct gnet_dump *d, struct gnet_stats_queue *q)
 }
 EXPORT_SYMBOL(gnet_stats_copy_queue);
 
+/**
+ * gnet_stats_add_basic_cpu - fold per cpu basic statistics
+ * @bstats: basic statistics to add to
+ * @cpu: per cpu basic statistics
+ *
+ * Adds the sum of the per cpu counters in &cpu to &bstats. Used by
+ * lockless users before copying &bstats or feeding a rate estimator.
+ */
+void
+gnet_stats_add_basic_cpu(struct gnet_stats_basic_packed *bstats,
+			 struct gnet_stats_basic_cpu __percpu *cpu)
+{
+	int i;
+
+	for_each_possible_cpu(i) {
+		struct gnet_stats_basic_cpu *bcpu = per_cpu_ptr(cpu, i);
+		unsigned int start;
+		u64 bytes;
+		u32 packets;
+
+		do {
+			start = u64_stats_fetch_begin_bh(&bcpu->syncp);
+			bytes = bcpu->bstats.bytes;
+			packets = bcpu->bstats.packets;
+		} while (u64_stats_fetch_retry_bh(&bcpu->syncp, start));
+
+		bstats->bytes += bytes;
+		bstats->packets += packets;
+	}
+}
+EXPORT_SYMBOL(gnet_stats_add_basic_cpu);
+
+/**
+ * gnet_stats_add_queue_cpu - fold per cpu queue statistics
+ * @qstats: queue statistics to add to
+ * @cpu: per cpu queue statistics
+ *
+ * Adds the sum of the per cpu counters in &cpu to &qstats.
+ */
+void
+gnet_stats_add_queue_cpu(struct gnet_stats_queue *qstats,
+			 const struct gnet_stats_queue __percpu *cpu)
+{
+	int i;
+
+	for_each_possible_cpu(i) {
+		const struct gnet_stats_queue *qcpu = per_cpu_ptr(cpu, i);
+
+		qstats->qlen += qcpu->qlen;
+		qstats->backlog += qcpu->backlog;
+		qstats->drops += qcpu->drops;
+		qstats->requeues += qcpu->requeues;
+		qstats->overlimits += qcpu->overlimits;
+	}
+}
+EXPORT_SYMBOL(gnet_stats_add_queue_cpu);
+
 /**
  * gnet_stats_copy_app - copy application specific statistics into statistics TLV
  * @d: dumping handle
@@ -7,10 +7,11 @@
  *	as published by the Free Software Foundation; either version
  *	2 of the License, or (at your option) any later version.
  *
- *	GRE GSO support
+ *	GRE GSO and GRO support
  */
 
 #include <linux/skbuff.h>
+#include <linux/netdevice.h>
 #include <net/protocol.h>
 #include <net/gre.h>
 
@@ -116,10 +117,143 @@ out:
 	return segs;
 }
 
+/* Compute the whole GRE header length including the optional fields.
+ * Only the key is accepted for aggregation: packets carrying a checksum
+ * would need it recomputed on completion, and a sequence number makes
+ * every packet distinct anyway.
+ */
+static int gre_gro_hlen(const struct gre_base_hdr *greh)
+{
+	if ((greh->flags & ~GRE_KEY) != 0)
+		return -1;
+
+	return GRE_HEADER_SECTION + ((greh->flags & GRE_KEY) ? 4 : 0);
+}
+
+static struct sk_buff **gre_gro_receive(struct sk_buff **head,
+					struct sk_buff *skb)
+{
+	struct sk_buff **pp = NULL;
+	struct sk_buff *p;
+	const struct gre_base_hdr *greh;
+	unsigned int hlen, grehlen;
+	unsigned int off;
+	struct packet_offload *ptype;
+	__be16 type;
+	__wsum csum;
+	int flush = 1;
+
+	/* Nested tunnels would recurse once per header, flush them instead */
+	if (NAPI_GRO_CB(skb)->encap_mark)
+		goto out;
+
+	NAPI_GRO_CB(skb)->encap_mark = 1;
+
+	off = skb_gro_offset(skb);
+	hlen = off + sizeof(*greh);
+	greh = skb_gro_header_fast(skb, off);
+	if (skb_gro_header_hard(skb, hlen)) {
+		greh = skb_gro_header_slow(skb, hlen, off);
+		if (unlikely(!greh))
+			goto out;
+	}
+
+	/* Version 0 only, no checksum, routing or sequence number */
+	if (gre_gro_hlen(greh) < 0)
+		goto out;
+
+	type = greh->protocol;
+
+	rcu_read_lock();
+	ptype = gro_find_receive_by_type(type);
+	if (ptype == NULL)
+		goto out_unlock;
+
+	grehlen = gre_gro_hlen(greh);
+	hlen = off + grehlen;
+	if (skb_gro_header_hard(skb, hlen)) {
+		greh = skb_gro_header_slow(skb, hlen, off);
+		if (unlikely(!greh))
+			goto out_unlock;
+	}
+
+	flush = 0;
+
+	for (p = *head; p; p = p->next) {
+		const struct gre_base_hdr *greh2;
+
+		if (!NAPI_GRO_CB(p)->same_flow)
+			continue;
+
+		/* The outer IP headers were compared already; packets of
+		 * the same flow also share the GRE flags, protocol and key.
+		 */
+		greh2 = (struct gre_base_hdr *)(p->data + off);
+
+		if (greh2->flags != greh->flags ||
+		    greh2->protocol != greh->protocol) {
+			NAPI_GRO_CB(p)->same_flow = 0;
+			continue;
+		}
+		if ((greh->flags & GRE_KEY) &&
+		    *(__be32 *)(greh2 + 1) != *(__be32 *)(greh + 1)) {
+			NAPI_GRO_CB(p)->same_flow = 0;
+			continue;
+		}
+	}
+
+	skb_gro_pull(skb, grehlen);
+
+	/* Unlike the IP header, the GRE header does not sum to zero, so
+	 * take it out of a CHECKSUM_COMPLETE sum for the inner protocol.
+	 */
+	csum = skb->csum;
+	skb_postpull_rcsum(skb, greh, grehlen);
+
+	pp = ptype->callbacks.gro_receive(head, skb);
+
+	skb->csum = csum;
+
+out_unlock:
+	rcu_read_unlock();
+out:
+	NAPI_GRO_CB(skb)->flush |= flush;
+
+	return pp;
+}
+
+static int gre_gro_complete(struct sk_buff *skb, int nhoff)
+{
+	struct gre_base_hdr *greh = (struct gre_base_hdr *)(skb->data + nhoff);
+	struct packet_offload *ptype;
+	unsigned int grehlen;
+	__be16 type;
+	int err = -ENOENT;
+
+	type = greh->protocol;
+	grehlen = gre_gro_hlen(greh);
+
+	skb->encapsulation = 1;
+	skb_shinfo(skb)->gso_type = SKB_GSO_GRE;
+
+	rcu_read_lock();
+	ptype = gro_find_complete_by_type(type);
+	if (ptype != NULL) {
+		skb_set_inner_mac_header(skb, nhoff + grehlen);
+		skb_set_inner_network_header(skb, nhoff + grehlen);
+		err = ptype->callbacks.gro_complete(skb, nhoff + grehlen);
+	}
+	rcu_read_unlock();
+
+	return err;
+}
+
 static const struct net_offload gre_offload = {
 	.callbacks = {
 		.gso_send_check = gre_gso_send_check,
 		.gso_segment = gre_gso_segment,
+		.gro_receive = gre_gro_receive,
+		.gro_complete = gre_gro_complete,
 	},
 };
 
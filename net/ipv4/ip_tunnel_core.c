@@ -90,6 +90,16 @@ int iptunnel_pull_header(struct sk_buff *skb, int hdr_len, __be16 inner_proto)
 
 	skb_pull_rcsum(skb, hdr_len);
 
+	/* A packet aggregated by GRE GRO continues as a plain inner
+	 * packet once the tunnel header is gone.
+	 */
+	if (skb_is_gso(skb) && (skb_shinfo(skb)->gso_type & SKB_GSO_GRE)) {
+		if (unlikely(skb_unclone(skb, GFP_ATOMIC)))
+			return -ENOMEM;
+		skb_shinfo(skb)->gso_type &= ~SKB_GSO_GRE;
+		skb->encapsulation = 0;
+	}
+
 	if (inner_proto == htons(ETH_P_TEB)) {
 		struct ethhdr *eh = (struct ethhdr *)skb->data;
 
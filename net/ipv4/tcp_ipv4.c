@@ -2760,6 +2760,7 @@ struct proto tcp_prot = {
 #ifdef CONFIG_COMPAT
 	.compat_setsockopt	= compat_tcp_setsockopt,
 	.compat_getsockopt	= compat_tcp_getsockopt,
+	.compat_ioctl		= compat_tcp_ioctl,
 #endif
 #ifdef CONFIG_MEMCG_KMEM
 	.init_cgroup		= tcp_init_cgroup,
@@ -419,6 +419,13 @@ struct sock *tcp_create_openreq_child(struct sock *sk, struct request_sock *req,
 		newtp->snd_cwnd = TCP_INIT_CWND;
 		newtp->snd_cwnd_cnt = 0;
 
+		newtp->delivered = 0;
+		newtp->lost = 0;
+		newtp->app_limited = ~0U;
+		newtp->rate_delivered = 0;
+		newtp->rate_interval_us = 0;
+		newtp->rate_app_limited = 0;
+
 		if (newicsk->icsk_ca_ops != &tcp_init_congestion_ops &&
 		    !try_module_get(newicsk->icsk_ca_ops->owner))
 			newicsk->icsk_ca_ops = &tcp_init_congestion_ops;
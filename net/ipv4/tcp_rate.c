@@ -0,0 +1,160 @@
+/*
+ * TCP delivery rate sampling.
+ *
+ * The code below estimates the rate at which the network delivered
+ * packets to the receiver: the number of data packets (S)ACKed over an
+ * interval of time, with a sample generated on every ACK.  Congestion
+ * control modules that implement cong_control() get the sample at the
+ * end of ACK processing.
+ *
+ * Every skb remembers, when it is sent, how many packets had been
+ * delivered so far (tp->delivered) and when that count was last updated
+ * (tp->delivered_mstamp).  When the skb is (S)ACKed, the delivery rate
+ * is the number of packets delivered since it was sent, over the longer
+ * of the send and ACK intervals:
+ *
+ *    send_rate = #pkts_delivered / (last_snd_time - first_snd_time)
+ *    ack_rate  = #pkts_delivered / (last_ack_time - first_ack_time)
+ *    bw = min(send_rate, ack_rate)
+ *
+ * The send interval protects against ACK compression, the ACK interval
+ * against stretched sending.  A sample taken while the sender had less
+ * data to send than cwnd allowed is marked application limited; it only
+ * shows a lower bound of the available bandwidth.
+ *
+ * Times are in microseconds of the monotonic clock, which also stamps
+ * sent skbs in tcp_transmit_skb().
+ */
+
+#include <linux/ktime.h>
+#include <net/tcp.h>
+
+static u64 tcp_skb_mstamp(const struct sk_buff *skb)
+{
+	return ktime_to_us(skb->tstamp);
+}
+
+/* Snapshot the current delivery information in the skb, to generate
+ * a rate sample later when the skb is (s)acked in tcp_rate_skb_delivered().
+ * Called from tcp_transmit_skb() after the skb was stamped.
+ */
+void tcp_rate_skb_sent(struct sock *sk, struct sk_buff *skb)
+{
+	struct tcp_sock *tp = tcp_sk(sk);
+
+	/* In general we need to start delivery rate samples from the
+	 * time we received the most recent ACK, to ensure we include
+	 * the full time the network needs to deliver all in-flight
+	 * packets.  If there are no packets in flight yet, then we
+	 * know that any ACKs after now indicate that the network was
+	 * able to deliver those packets completely in the sampling
+	 * interval between now and the next ACK.
+	 */
+	if (!tp->packets_out) {
+		tp->first_tx_mstamp  = tcp_skb_mstamp(skb);
+		tp->delivered_mstamp = tcp_skb_mstamp(skb);
+	}
+
+	TCP_SKB_CB(skb)->tx.first_tx_mstamp	= tp->first_tx_mstamp;
+	TCP_SKB_CB(skb)->tx.delivered_mstamp	= tp->delivered_mstamp;
+	TCP_SKB_CB(skb)->tx.delivered		= tp->delivered;
+	TCP_SKB_CB(skb)->tx.is_app_limited	= tp->app_limited ? 1 : 0;
+}
+
+/* When an skb is sacked or acked, we fill in the rate sample with the (prior)
+ * delivery information when the skb was last transmitted.
+ *
+ * If an ACK (s)acks multiple skbs (e.g., stretched-acks), this function is
+ * called multiple times. We favor the information from the most recently
+ * sent skb, i.e., the skb with the highest prior_delivered count.
+ */
+void tcp_rate_skb_delivered(struct sock *sk, struct sk_buff *skb,
+			    struct rate_sample *rs)
+{
+	struct tcp_sock *tp = tcp_sk(sk);
+	struct tcp_skb_cb *scb = TCP_SKB_CB(skb);
+
+	if (!scb->tx.delivered_mstamp)
+		return;
+
+	if (!rs->prior_delivered ||
+	    after(scb->tx.delivered, rs->prior_delivered)) {
+		rs->prior_delivered  = scb->tx.delivered;
+		rs->prior_mstamp     = scb->tx.delivered_mstamp;
+		rs->is_app_limited   = scb->tx.is_app_limited;
+		rs->is_retrans	     = scb->sacked & TCPCB_RETRANS;
+
+		/* Find the duration of the "send phase" of this window: */
+		rs->interval_us      = tcp_skb_mstamp(skb) -
+				       scb->tx.first_tx_mstamp;
+
+		/* Record send time of most recently ACKed packet: */
+		tp->first_tx_mstamp  = tcp_skb_mstamp(skb);
+	}
+	/* Mark off the skb delivered once it's sacked to avoid being
+	 * used again when it's cumulatively acked. For acked packets
+	 * we don't need to reset since it'll be freed soon.
+	 */
+	if (scb->sacked & TCPCB_SACKED_ACKED)
+		scb->tx.delivered_mstamp = 0;
+}
+
+/* Update the connection delivery information and generate a rate sample. */
+void tcp_rate_gen(struct sock *sk, u32 delivered, u32 lost,
+		  struct rate_sample *rs)
+{
+	struct tcp_sock *tp = tcp_sk(sk);
+	u32 snd_us, ack_us;
+
+	/* Clear app limited if bubble is acked and gone. */
+	if (tp->app_limited && after(tp->delivered, tp->app_limited))
+		tp->app_limited = 0;
+
+	if (delivered)
+		tp->delivered_mstamp = ktime_to_us(ktime_get());
+
+	rs->acked_sacked = delivered;	/* freshly ACKed or SACKed */
+	rs->losses = lost;		/* freshly marked lost */
+	/* Return an invalid sample if no timing information is available. */
+	if (!rs->prior_mstamp) {
+		rs->delivered = -1;
+		rs->interval_us = -1;
+		return;
+	}
+	rs->delivered   = tp->delivered - rs->prior_delivered;
+
+	/* Model sending data and receiving ACKs as separate pipeline phases
+	 * for a window. Usually the ACK phase is longer, but with ACK
+	 * compression the send phase can be longer. To be safe we use the
+	 * longer phase.
+	 */
+	snd_us = rs->interval_us;				/* send phase */
+	ack_us = tp->delivered_mstamp - rs->prior_mstamp;	/* ack phase */
+	rs->interval_us = max(snd_us, ack_us);
+
+	/* Record the last non-app-limited or the highest app-limited bw */
+	if (!rs->is_app_limited ||
+	    ((u64)rs->delivered * tp->rate_interval_us >=
+	     (u64)tp->rate_delivered * rs->interval_us)) {
+		tp->rate_delivered = rs->delivered;
+		tp->rate_interval_us = rs->interval_us;
+		tp->rate_app_limited = rs->is_app_limited;
+	}
+}
+
+/* If a gap is detected between sends, mark the socket application-limited. */
+void tcp_rate_check_app_limited(struct sock *sk)
+{
+	struct tcp_sock *tp = tcp_sk(sk);
+
+	if (/* We have less than one packet to send. */
+	    tp->write_seq - tp->snd_nxt < tp->mss_cache &&
+	    /* Nothing in sending host's qdisc queues or NIC tx queue. */
+	    sk_wmem_alloc_get(sk) < SKB_TRUESIZE(1) &&
+	    /* We are not limited by CWND. */
+	    tcp_packets_in_flight(tp) < tp->snd_cwnd &&
+	    /* All lost packets have been retransmitted. */
+	    tp->lost_out <= tp->retrans_out)
+		tp->app_limited =
+			(tp->delivered + tcp_packets_in_flight(tp)) ? : 1;
+}
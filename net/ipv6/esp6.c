@@ -252,7 +252,7 @@ static int esp6_output(struct xfrm_state *x, struct sk_buff *skb)
 			      XFRM_SKB_CB(skb)->seq.output.low);
 
 	ESP_SKB_CB(skb)->tmp = tmp;
-	err = crypto_aead_givencrypt(req);
+	err = xfrm_output_givencrypt(req);
 	if (err == -EINPROGRESS)
 		goto error;
 
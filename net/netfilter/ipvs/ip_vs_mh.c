@@ -0,0 +1,563 @@
+/*
+ * IPVS:        Maglev Hashing scheduling module
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU General Public License
+ *              as published by the Free Software Foundation; either version
+ *              2 of the License, or (at your option) any later version.
+ *
+ * Changes:
+ *
+ */
+
+/*
+ * The mh algorithm selects the server by looking up the hash of the
+ * source IP address (and optionally port) in a lookup table built with
+ * the Maglev consistent hashing scheme:
+ *
+ *       n <- lookup[hash(src_ip) % M];
+ *       if (n is dead) OR
+ *          (n is overloaded) or (n.weight <= 0) then
+ *                 return NULL;
+ *
+ *       return n;
+ *
+ * Every destination gets its own permutation of the M table slots,
+ * derived from two hashes of its address and port:
+ *
+ *       offset <- h1(dest) % M
+ *       skip   <- h2(dest) % (M - 1) + 1
+ *       permutation[j] <- (offset + j * skip) % M
+ *
+ * The table is filled by letting the destinations take turns, each one
+ * claiming the next slot of its permutation that is still free.  The
+ * number of turns per round is proportional to the weight.  As M is a
+ * prime, every permutation covers the whole table.
+ *
+ * When a destination is added or removed, most destinations keep most
+ * of their preferred slots, so only about 1/N of the flows move to a
+ * different server instead of nearly all of them with the modulo
+ * tiling of sh and dh.  The table only depends on the set of
+ * destinations (they are sorted by address before filling), so several
+ * directors configured alike send a flow to the same server without
+ * sharing connection state.
+ *
+ * The table is rebuilt on every configuration change and published with
+ * RCU; packet lookups are a single table access.
+ *
+ * Reference: Eisenbud et al., "Maglev: A Fast and Reliable Software
+ * Network Load Balancer", NSDI 2016.
+ *
+ */
+
+#define KMSG_COMPONENT "IPVS"
+#define pr_fmt(fmt) KMSG_COMPONENT ": " fmt
+
+#include <linux/ip.h>
+#include <linux/slab.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/skbuff.h>
+#include <linux/jhash.h>
+#include <linux/gcd.h>
+#include <linux/sort.h>
+
+#include <net/ip_vs.h>
+
+#include <net/tcp.h>
+#include <linux/udp.h>
+#include <linux/sctp.h>
+
+
+/*
+ *     for IPVS MH lookup table, the size must be a prime
+ */
+#ifndef CONFIG_IP_VS_MH_TAB_INDEX
+#define CONFIG_IP_VS_MH_TAB_INDEX	12
+#endif
+#if CONFIG_IP_VS_MH_TAB_INDEX <= 8
+#define IP_VS_MH_TAB_SIZE		251
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 9
+#define IP_VS_MH_TAB_SIZE		509
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 10
+#define IP_VS_MH_TAB_SIZE		1021
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 11
+#define IP_VS_MH_TAB_SIZE		2039
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 12
+#define IP_VS_MH_TAB_SIZE		4093
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 13
+#define IP_VS_MH_TAB_SIZE		8191
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 14
+#define IP_VS_MH_TAB_SIZE		16381
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 15
+#define IP_VS_MH_TAB_SIZE		32749
+#elif CONFIG_IP_VS_MH_TAB_INDEX == 16
+#define IP_VS_MH_TAB_SIZE		65521
+#else
+#define IP_VS_MH_TAB_SIZE		131071
+#endif
+
+/* Slot of the lookup table not assigned to any destination */
+#define IP_VS_MH_EMPTY			U16_MAX
+#define IP_VS_MH_MAX_DESTS		(IP_VS_MH_EMPTY - 1)
+
+/* Fixed seeds, so that all directors build the same table */
+#define IP_VS_MH_OFFSET_SEED		0x4d61676cU
+#define IP_VS_MH_SKIP_SEED		0x65764c42U
+#define IP_VS_MH_LOOKUP_SEED		0x49505653U
+
+/*
+ *      IPVS MH lookup table, replaced as a whole on every change
+ */
+struct ip_vs_mh_table {
+	struct rcu_head		rcu_head;
+	int			num_dests;
+	u16			lookup[IP_VS_MH_TAB_SIZE];
+	struct ip_vs_dest	*dests[0];	/* held real servers */
+};
+
+struct ip_vs_mh_state {
+	struct rcu_head			rcu_head;
+	struct ip_vs_mh_table __rcu	*table;
+};
+
+/* Per destination state while the table is being populated */
+struct ip_vs_mh_dest_setup {
+	struct ip_vs_dest	*dest;
+	unsigned int		slot;	/* next slot of its permutation */
+	unsigned int		skip;
+	unsigned int		weight;	/* turns per round */
+	unsigned int		turns;	/* turns left in this round */
+};
+
+/* Helper function to determine if server is unavailable */
+static inline bool is_unavailable(struct ip_vs_dest *dest)
+{
+	return atomic_read(&dest->weight) <= 0 ||
+	       dest->flags & IP_VS_DEST_F_OVERLOAD;
+}
+
+/*
+ *	Returns hash value of an address and port, independent of the
+ *	host byte order
+ */
+static inline u32
+ip_vs_mh_hashkey(int af, const union nf_inet_addr *addr,
+		 __be16 port, u32 seed)
+{
+#ifdef CONFIG_IP_VS_IPV6
+	if (af == AF_INET6) {
+		u32 key[5];
+		int i;
+
+		for (i = 0; i < 4; i++)
+			key[i] = ntohl(addr->ip6[i]);
+		key[4] = ntohs(port);
+		return jhash2(key, ARRAY_SIZE(key), seed);
+	}
+#endif
+	return jhash_2words(ntohl(addr->ip), ntohs(port), seed);
+}
+
+
+/*
+ *      Get ip_vs_dest associated with supplied parameters.
+ */
+static inline struct ip_vs_dest *
+ip_vs_mh_get(struct ip_vs_service *svc, struct ip_vs_mh_table *t,
+	     const union nf_inet_addr *addr, __be16 port)
+{
+	unsigned int hash = ip_vs_mh_hashkey(svc->af, addr, port,
+					     IP_VS_MH_LOOKUP_SEED) %
+			    IP_VS_MH_TAB_SIZE;
+	u16 i = t->lookup[hash];
+	struct ip_vs_dest *dest;
+
+	if (i == IP_VS_MH_EMPTY)
+		return NULL;
+	dest = t->dests[i];
+
+	return is_unavailable(dest) ? NULL : dest;
+}
+
+
+/* As ip_vs_mh_get, but with fallback if selected server is unavailable
+ *
+ * The fallback strategy walks the table from the original slot to find
+ * an available server.  Neighbouring slots belong to unrelated servers,
+ * so the flows of an unavailable server are spread over the others.
+ */
+static inline struct ip_vs_dest *
+ip_vs_mh_get_fallback(struct ip_vs_service *svc, struct ip_vs_mh_table *t,
+		      const union nf_inet_addr *addr, __be16 port)
+{
+	unsigned int offset, hash, ihash;
+	struct ip_vs_dest *dest;
+	u16 i;
+
+	/* first try the dest it's supposed to go to */
+	ihash = ip_vs_mh_hashkey(svc->af, addr, port, IP_VS_MH_LOOKUP_SEED) %
+		IP_VS_MH_TAB_SIZE;
+	i = t->lookup[ihash];
+	if (i == IP_VS_MH_EMPTY)
+		return NULL;
+	dest = t->dests[i];
+	if (!is_unavailable(dest))
+		return dest;
+
+	IP_VS_DBG_BUF(6, "MH: selected unavailable server %s:%d, reselecting",
+		      IP_VS_DBG_ADDR(svc->af, &dest->addr), ntohs(dest->port));
+
+	/* if the original dest is unavailable, loop around the table
+	 * starting from ihash to find a new dest
+	 */
+	for (offset = 1; offset < IP_VS_MH_TAB_SIZE; offset++) {
+		hash = (ihash + offset) % IP_VS_MH_TAB_SIZE;
+		dest = t->dests[t->lookup[hash]];
+		if (!is_unavailable(dest))
+			return dest;
+	}
+
+	return NULL;
+}
+
+
+static int ip_vs_mh_dest_cmp(const void *a, const void *b)
+{
+	const struct ip_vs_mh_dest_setup *da = a, *db = b;
+	u32 wa, wb;
+
+#ifdef CONFIG_IP_VS_IPV6
+	if (da->dest->af == AF_INET6) {
+		int i;
+
+		for (i = 0; i < 4; i++) {
+			wa = ntohl(da->dest->addr.ip6[i]);
+			wb = ntohl(db->dest->addr.ip6[i]);
+			if (wa != wb)
+				return wa < wb ? -1 : 1;
+		}
+		goto cmp_port;
+	}
+#endif
+	wa = ntohl(da->dest->addr.ip);
+	wb = ntohl(db->dest->addr.ip);
+	if (wa != wb)
+		return wa < wb ? -1 : 1;
+
+#ifdef CONFIG_IP_VS_IPV6
+cmp_port:
+#endif
+	return (int)ntohs(da->dest->port) - (int)ntohs(db->dest->port);
+}
+
+/*
+ *      Fill the lookup table from the permutations of the destinations
+ */
+static void ip_vs_mh_populate(struct ip_vs_mh_table *t,
+			      struct ip_vs_mh_dest_setup *ds, int n)
+{
+	unsigned int filled = 0;
+	u64 left = 0;
+	int i;
+
+	for (i = 0; i < IP_VS_MH_TAB_SIZE; i++)
+		t->lookup[i] = IP_VS_MH_EMPTY;
+	if (!n)
+		return;
+
+	while (filled < IP_VS_MH_TAB_SIZE) {
+		/* start a new round when every dest used its turns */
+		if (!left) {
+			for (i = 0; i < n; i++) {
+				ds[i].turns = ds[i].weight;
+				left += ds[i].turns;
+			}
+		}
+
+		/* one slot per dest and pass, so that heavy dests do not
+		 * take the whole table before the others get their turn
+		 */
+		for (i = 0; i < n && filled < IP_VS_MH_TAB_SIZE; i++) {
+			if (!ds[i].turns)
+				continue;
+			while (t->lookup[ds[i].slot] != IP_VS_MH_EMPTY) {
+				ds[i].slot += ds[i].skip;
+				if (ds[i].slot >= IP_VS_MH_TAB_SIZE)
+					ds[i].slot -= IP_VS_MH_TAB_SIZE;
+			}
+			t->lookup[ds[i].slot] = i;
+			ds[i].turns--;
+			left--;
+			filled++;
+		}
+	}
+}
+
+/*
+ *      Build a new table for the current destinations of the service.
+ */
+static struct ip_vs_mh_table *ip_vs_mh_build(struct ip_vs_service *svc)
+{
+	struct ip_vs_mh_dest_setup *ds;
+	struct ip_vs_mh_table *t;
+	struct ip_vs_dest *dest;
+	unsigned int g = 0;
+	int n = 0, i;
+
+	list_for_each_entry(dest, &svc->destinations, n_list) {
+		if (atomic_read(&dest->weight) > 0)
+			n++;
+	}
+	n = min(n, IP_VS_MH_MAX_DESTS);
+
+	t = kmalloc(sizeof(*t) + n * sizeof(struct ip_vs_dest *), GFP_KERNEL);
+	if (!t)
+		return NULL;
+	ds = kcalloc(n ? : 1, sizeof(*ds), GFP_KERNEL);
+	if (!ds) {
+		kfree(t);
+		return NULL;
+	}
+
+	i = 0;
+	list_for_each_entry(dest, &svc->destinations, n_list) {
+		int weight = atomic_read(&dest->weight);
+
+		/* quiesced servers do not get new flows */
+		if (weight <= 0)
+			continue;
+		if (i == n)
+			break;
+		ds[i].dest = dest;
+		ds[i].weight = weight;
+		g = gcd(g, weight);
+		i++;
+	}
+	/* weights may have dropped to zero meanwhile */
+	n = i;
+
+	/* the table must not depend on the order of configuration */
+	sort(ds, n, sizeof(*ds), ip_vs_mh_dest_cmp, NULL);
+
+	for (i = 0; i < n; i++) {
+		dest = ds[i].dest;
+		ds[i].slot = ip_vs_mh_hashkey(svc->af, &dest->addr, dest->port,
+					      IP_VS_MH_OFFSET_SEED) %
+			     IP_VS_MH_TAB_SIZE;
+		ds[i].skip = ip_vs_mh_hashkey(svc->af, &dest->addr, dest->port,
+					      IP_VS_MH_SKIP_SEED) %
+			     (IP_VS_MH_TAB_SIZE - 1) + 1;
+		ds[i].weight /= g;
+
+		ip_vs_dest_hold(dest);
+		t->dests[i] = dest;
+
+		IP_VS_DBG_BUF(6, "MH: dest %s:%d weight %d\n",
+			      IP_VS_DBG_ADDR(svc->af, &dest->addr),
+			      ntohs(dest->port), atomic_read(&dest->weight));
+	}
+	t->num_dests = n;
+
+	ip_vs_mh_populate(t, ds, n);
+	kfree(ds);
+
+	return t;
+}
+
+static void ip_vs_mh_table_free(struct rcu_head *head)
+{
+	struct ip_vs_mh_table *t;
+	int i;
+
+	t = container_of(head, struct ip_vs_mh_table, rcu_head);
+	for (i = 0; i < t->num_dests; i++)
+		ip_vs_dest_put(t->dests[i]);
+	kfree(t);
+}
+
+/*
+ *      Replace the table of the service with one built for its current
+ *      destinations.  The old one is released after a grace period.
+ */
+static int
+ip_vs_mh_reassign(struct ip_vs_mh_state *s, struct ip_vs_service *svc)
+{
+	struct ip_vs_mh_table *t, *old;
+
+	t = ip_vs_mh_build(svc);
+	if (!t)
+		return -ENOMEM;
+
+	old = rcu_dereference_protected(s->table, 1);
+	rcu_assign_pointer(s->table, t);
+	if (old)
+		call_rcu(&old->rcu_head, ip_vs_mh_table_free);
+
+	return 0;
+}
+
+
+static int ip_vs_mh_init_svc(struct ip_vs_service *svc)
+{
+	struct ip_vs_mh_state *s;
+	int ret;
+
+	/* allocate the MH state for this service */
+	s = kzalloc(sizeof(struct ip_vs_mh_state), GFP_KERNEL);
+	if (s == NULL)
+		return -ENOMEM;
+
+	/* build the lookup table with current dests */
+	ret = ip_vs_mh_reassign(s, svc);
+	if (ret < 0) {
+		kfree(s);
+		return ret;
+	}
+
+	svc->sched_data = s;
+	IP_VS_DBG(6, "MH lookup table (memory=%Zdbytes) allocated for "
+		  "current service\n",
+		  sizeof(u16) * IP_VS_MH_TAB_SIZE);
+
+	return 0;
+}
+
+
+static void ip_vs_mh_done_svc(struct ip_vs_service *svc)
+{
+	struct ip_vs_mh_state *s = svc->sched_data;
+	struct ip_vs_mh_table *t = rcu_dereference_protected(s->table, 1);
+
+	/* release the table and the dests it holds */
+	call_rcu(&t->rcu_head, ip_vs_mh_table_free);
+
+	kfree_rcu(s, rcu_head);
+	IP_VS_DBG(6, "MH lookup table (memory=%Zdbytes) released\n",
+		  sizeof(u16) * IP_VS_MH_TAB_SIZE);
+}
+
+
+static int ip_vs_mh_dest_changed(struct ip_vs_service *svc,
+				 struct ip_vs_dest *dest)
+{
+	struct ip_vs_mh_state *s = svc->sched_data;
+
+	/* rebuild the lookup table with the updated service; on failure
+	 * the previous table stays in use
+	 */
+	return ip_vs_mh_reassign(s, svc);
+}
+
+
+/* Helper function to get port number */
+static inline __be16
+ip_vs_mh_get_port(const struct sk_buff *skb, struct ip_vs_iphdr *iph)
+{
+	__be16 port;
+	struct tcphdr _tcph, *th;
+	struct udphdr _udph, *uh;
+	sctp_sctphdr_t _sctph, *sh;
+
+	switch (iph->protocol) {
+	case IPPROTO_TCP:
+		th = skb_header_pointer(skb, iph->len, sizeof(_tcph), &_tcph);
+		if (unlikely(th == NULL))
+			return 0;
+		port = th->source;
+		break;
+	case IPPROTO_UDP:
+		uh = skb_header_pointer(skb, iph->len, sizeof(_udph), &_udph);
+		if (unlikely(uh == NULL))
+			return 0;
+		port = uh->source;
+		break;
+	case IPPROTO_SCTP:
+		sh = skb_header_pointer(skb, iph->len, sizeof(_sctph), &_sctph);
+		if (unlikely(sh == NULL))
+			return 0;
+		port = sh->source;
+		break;
+	default:
+		port = 0;
+	}
+
+	return port;
+}
+
+
+/*
+ *      Maglev Hashing scheduling
+ */
+static struct ip_vs_dest *
+ip_vs_mh_schedule(struct ip_vs_service *svc, const struct sk_buff *skb,
+		  struct ip_vs_iphdr *iph)
+{
+	struct ip_vs_dest *dest;
+	struct ip_vs_mh_state *s;
+	struct ip_vs_mh_table *t;
+	__be16 port = 0;
+
+	IP_VS_DBG(6, "ip_vs_mh_schedule(): Scheduling...\n");
+
+	if (svc->flags & IP_VS_SVC_F_SCHED_MH_PORT)
+		port = ip_vs_mh_get_port(skb, iph);
+
+	s = (struct ip_vs_mh_state *) svc->sched_data;
+	t = rcu_dereference(s->table);
+
+	if (svc->flags & IP_VS_SVC_F_SCHED_MH_FALLBACK)
+		dest = ip_vs_mh_get_fallback(svc, t, &iph->saddr, port);
+	else
+		dest = ip_vs_mh_get(svc, t, &iph->saddr, port);
+
+	if (!dest) {
+		ip_vs_scheduler_err(svc, "no destination available");
+		return NULL;
+	}
+
+	IP_VS_DBG_BUF(6, "MH: source IP address %s --> server %s:%d\n",
+		      IP_VS_DBG_ADDR(svc->af, &iph->saddr),
+		      IP_VS_DBG_ADDR(svc->af, &dest->addr),
+		      ntohs(dest->port));
+
+	return dest;
+}
+
+
+/*
+ *      IPVS MH Scheduler structure
+ */
+static struct ip_vs_scheduler ip_vs_mh_scheduler =
+{
+	.name =			"mh",
+	.refcnt =		ATOMIC_INIT(0),
+	.module =		THIS_MODULE,
+	.n_list	 =		LIST_HEAD_INIT(ip_vs_mh_scheduler.n_list),
+	.init_service =		ip_vs_mh_init_svc,
+	.done_service =		ip_vs_mh_done_svc,
+	.add_dest =		ip_vs_mh_dest_changed,
+	.del_dest =		ip_vs_mh_dest_changed,
+	.upd_dest =		ip_vs_mh_dest_changed,
+	.schedule =		ip_vs_mh_schedule,
+};
+
+
+static int __init ip_vs_mh_init(void)
+{
+	return register_ip_vs_scheduler(&ip_vs_mh_scheduler);
+}
+
+
+static void __exit ip_vs_mh_cleanup(void)
+{
+	unregister_ip_vs_scheduler(&ip_vs_mh_scheduler);
+	/* wait for the tables still to be released by call_rcu() */
+	rcu_barrier();
+}
+
+
+module_init(ip_vs_mh_init);
+module_exit(ip_vs_mh_cleanup);
+MODULE_DESCRIPTION("Maglev hashing ipvs scheduler");
+MODULE_LICENSE("GPL");
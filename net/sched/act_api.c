@@ -21,12 +21,31 @@
 #include <linux/kmod.h>
 #include <linux/err.h>
 #include <linux/module.h>
+#include <linux/percpu.h>
 #include <net/net_namespace.h>
 #include <net/sock.h>
 #include <net/sch_generic.h>
 #include <net/act_api.h>
 #include <net/netlink.h>
 
+static void tcf_common_free_rcu(struct rcu_head *head)
+{
+	struct tcf_common *p = container_of(head, struct tcf_common, tcfc_rcu);
+
+	free_percpu(p->cpu_bstats);
+	free_percpu(p->cpu_qstats);
+	kfree(p);
+}
+
+/* Undo tcf_hash_create() for an action that was never inserted. */
+void tcf_hash_cleanup(struct tcf_common *p, struct nlattr *est)
+{
+	if (est)
+		gen_kill_estimator(&p->tcfc_bstats, &p->tcfc_rate_est);
+	call_rcu(&p->tcfc_rcu, tcf_common_free_rcu);
+}
+EXPORT_SYMBOL(tcf_hash_cleanup);
+
 void tcf_hash_destroy(struct tcf_common *p, struct tcf_hashinfo *hinfo)
 {
 	unsigned int h = tcf_hash(p->tcfc_index, hinfo->hmask);
@@ -41,9 +60,10 @@ void tcf_hash_destroy(struct tcf_common *p, struct tcf_hashinfo *hinfo)
 					   &p->tcfc_rate_est);
 			/*
 			 * gen_estimator est_timer() might access p->tcfc_lock
-			 * or bstats, wait a RCU grace period before freeing p
+			 * or bstats, and lockless actions may still run on
+			 * other cpus, wait a RCU grace period before freeing p
 			 */
-			kfree_rcu(p, tcfc_rcu);
+			call_rcu(&p->tcfc_rcu, tcf_common_free_rcu);
 			return;
 		}
 	}
@@ -224,9 +244,11 @@ EXPORT_SYMBOL(tcf_hash_check);
 
 struct tcf_common *tcf_hash_create(u32 index, struct nlattr *est,
 				   struct tc_action *a, int size, int bind,
-				   u32 *idx_gen, struct tcf_hashinfo *hinfo)
+				   bool cpustats, u32 *idx_gen,
+				   struct tcf_hashinfo *hinfo)
 {
 	struct tcf_common *p = kzalloc(size, GFP_KERNEL);
+	int err = -ENOMEM;
 
 	if (unlikely(!p))
 		return ERR_PTR(-ENOMEM);
@@ -234,21 +256,37 @@ struct tcf_common *tcf_hash_create(u32 index, struct nlattr *est,
 	if (bind)
 		p->tcfc_bindcnt = 1;
 
+	if (cpustats) {
+		int i;
+
+		p->cpu_bstats = alloc_percpu(struct gnet_stats_basic_cpu);
+		p->cpu_qstats = alloc_percpu(struct gnet_stats_queue);
+		if (!p->cpu_bstats || !p->cpu_qstats)
+			goto err_free;
+		for_each_possible_cpu(i)
+			u64_stats_init(&per_cpu_ptr(p->cpu_bstats, i)->syncp);
+	}
+
 	spin_lock_init(&p->tcfc_lock);
 	p->tcfc_index = index ? index : tcf_hash_new_index(idx_gen, hinfo);
 	p->tcfc_tm.install = jiffies;
 	p->tcfc_tm.lastuse = jiffies;
 	if (est) {
-		int err = gen_new_estimator(&p->tcfc_bstats, &p->tcfc_rate_est,
+		err = gen_new_estimator_cpu(&p->tcfc_bstats, p->cpu_bstats,
+					    &p->tcfc_rate_est,
 					    &p->tcfc_lock, est);
-		if (err) {
-			kfree(p);
-			return ERR_PTR(err);
-		}
+		if (err)
+			goto err_free;
 	}
 
 	a->priv = (void *) p;
 	return p;
+
+err_free:
+	free_percpu(p->cpu_bstats);
+	free_percpu(p->cpu_qstats);
+	kfree(p);
+	return ERR_PTR(err);
 }
 EXPORT_SYMBOL(tcf_hash_create);
 
@@ -615,6 +653,8 @@ int tcf_action_copy_stats(struct sk_buff *skb, struct tc_action *a,
 {
 	int err = 0;
 	struct gnet_dump d;
+	struct gnet_stats_basic_packed bstats;
+	struct gnet_stats_queue qstats;
 	struct tcf_act_hdr *h = a->priv;
 
 	if (h == NULL)
@@ -640,10 +680,17 @@ int tcf_action_copy_stats(struct sk_buff *skb, struct tc_action *a,
 		if (a->ops->get_stats(skb, a) < 0)
 			goto errout;
 
-	if (gnet_stats_copy_basic(&d, &h->tcf_bstats) < 0 ||
+	bstats = h->tcf_bstats;
+	qstats = h->tcf_qstats;
+	if (h->common.cpu_bstats)
+		gnet_stats_add_basic_cpu(&bstats, h->common.cpu_bstats);
+	if (h->common.cpu_qstats)
+		gnet_stats_add_queue_cpu(&qstats, h->common.cpu_qstats);
+
+	if (gnet_stats_copy_basic(&d, &bstats) < 0 ||
 	    gnet_stats_copy_rate_est(&d, &h->tcf_bstats,
 				     &h->tcf_rate_est) < 0 ||
-	    gnet_stats_copy_queue(&d, &h->tcf_qstats) < 0)
+	    gnet_stats_copy_queue(&d, &qstats) < 0)
 		goto errout;
 
 	if (gnet_stats_finish_copy(&d) < 0)
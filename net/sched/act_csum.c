@@ -74,7 +74,7 @@ static int tcf_csum_init(struct net *n, struct nlattr *nla, struct nlattr *est,
 	pc = tcf_hash_check(parm->index, a, bind, &csum_hash_info);
 	if (!pc) {
 		pc = tcf_hash_create(parm->index, est, a, sizeof(*p), bind,
-				     &csum_idx_gen, &csum_hash_info);
+				     true, &csum_idx_gen, &csum_hash_info);
 		if (IS_ERR(pc))
 			return PTR_ERR(pc);
 		ret = ACT_P_CREATED;
@@ -517,12 +517,10 @@ static int tcf_csum(struct sk_buff *skb,
 	int action;
 	u32 update_flags;
 
-	spin_lock(&p->tcf_lock);
-	p->tcf_tm.lastuse = jiffies;
-	bstats_update(&p->tcf_bstats, skb);
-	action = p->tcf_action;
-	update_flags = p->update_flags;
-	spin_unlock(&p->tcf_lock);
+	tcf_lastuse_update(&p->tcf_tm);
+	tcf_action_update_bstats(&p->common, skb);
+	action = ACCESS_ONCE(p->tcf_action);
+	update_flags = ACCESS_ONCE(p->update_flags);
 
 	if (unlikely(action == TC_ACT_SHOT))
 		goto drop;
@@ -541,9 +539,7 @@ static int tcf_csum(struct sk_buff *skb,
 	return action;
 
 drop:
-	spin_lock(&p->tcf_lock);
-	p->tcf_qstats.drops++;
-	spin_unlock(&p->tcf_lock);
+	tcf_action_inc_drop_qstats(&p->common);
 	return TC_ACT_SHOT;
 }
 
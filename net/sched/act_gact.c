@@ -37,16 +37,21 @@ static struct tcf_hashinfo gact_hash_info = {
 #ifdef CONFIG_GACT_PROB
 static int gact_net_rand(struct tcf_gact *gact)
 {
-	if (!gact->tcfg_pval || net_random() % gact->tcfg_pval)
-		return gact->tcf_action;
-	return gact->tcfg_paction;
+	u16 pval = ACCESS_ONCE(gact->tcfg_pval);
+
+	if (!pval || net_random() % pval)
+		return ACCESS_ONCE(gact->tcf_action);
+	return ACCESS_ONCE(gact->tcfg_paction);
 }
 
 static int gact_determ(struct tcf_gact *gact)
 {
-	if (!gact->tcfg_pval || gact->tcf_bstats.packets % gact->tcfg_pval)
-		return gact->tcf_action;
-	return gact->tcfg_paction;
+	u16 pval = ACCESS_ONCE(gact->tcfg_pval);
+
+	/* counts from 0, like tcf_bstats.packets used to */
+	if (!pval || (u32)(atomic_inc_return(&gact->packets) - 1) % pval)
+		return ACCESS_ONCE(gact->tcf_action);
+	return ACCESS_ONCE(gact->tcfg_paction);
 }
 
 typedef int (*g_rand)(struct tcf_gact *gact);
@@ -97,7 +102,8 @@ static int tcf_gact_init(struct net *net, struct nlattr *nla,
 	pc = tcf_hash_check(parm->index, a, bind, &gact_hash_info);
 	if (!pc) {
 		pc = tcf_hash_create(parm->index, est, a, sizeof(*gact),
-				     bind, &gact_idx_gen, &gact_hash_info);
+				     bind, true, &gact_idx_gen,
+				     &gact_hash_info);
 		if (IS_ERR(pc))
 			return PTR_ERR(pc);
 		ret = ACT_P_CREATED;
@@ -139,23 +145,26 @@ static int tcf_gact(struct sk_buff *skb, const struct tc_action *a,
 		    struct tcf_result *res)
 {
 	struct tcf_gact *gact = a->priv;
-	int action = TC_ACT_SHOT;
+	int action;
+#ifdef CONFIG_GACT_PROB
+	u16 ptype = ACCESS_ONCE(gact->tcfg_ptype);
+#endif
 
-	spin_lock(&gact->tcf_lock);
+	/* Runs without tcf_lock: tcf_gact_init() only ever updates single
+	 * words, a racing reader sees either the old or the new value.
+	 */
 #ifdef CONFIG_GACT_PROB
-	if (gact->tcfg_ptype)
-		action = gact_rand[gact->tcfg_ptype](gact);
+	if (ptype)
+		action = gact_rand[ptype](gact);
 	else
-		action = gact->tcf_action;
+		action = ACCESS_ONCE(gact->tcf_action);
 #else
-	action = gact->tcf_action;
+	action = ACCESS_ONCE(gact->tcf_action);
 #endif
-	gact->tcf_bstats.bytes += qdisc_pkt_len(skb);
-	gact->tcf_bstats.packets++;
+	tcf_action_update_bstats(&gact->common, skb);
 	if (action == TC_ACT_SHOT)
-		gact->tcf_qstats.drops++;
-	gact->tcf_tm.lastuse = jiffies;
-	spin_unlock(&gact->tcf_lock);
+		tcf_action_inc_drop_qstats(&gact->common);
+	tcf_lastuse_update(&gact->tcf_tm);
 
 	return action;
 }
@@ -85,9 +85,11 @@ static int tcf_ipt_release(struct tcf_ipt *ipt, int bind)
 			ipt->tcf_bindcnt--;
 		ipt->tcf_refcnt--;
 		if (ipt->tcf_bindcnt <= 0 && ipt->tcf_refcnt <= 0) {
-			ipt_destroy_target(ipt->tcfi_t);
+			struct xt_entry_target *t = rtnl_dereference(ipt->tcfi_t);
+
+			ipt_destroy_target(t);
 			kfree(ipt->tcfi_tname);
-			kfree(ipt->tcfi_t);
+			kfree(t);
 			tcf_hash_destroy(&ipt->common, &ipt_hash_info);
 			ret = ACT_P_DELETED;
 		}
@@ -108,8 +110,8 @@ static int tcf_ipt_init(struct net *net, struct nlattr *nla, struct nlattr *est,
 	struct nlattr *tb[TCA_IPT_MAX + 1];
 	struct tcf_ipt *ipt;
 	struct tcf_common *pc;
-	struct xt_entry_target *td, *t;
-	char *tname;
+	struct xt_entry_target *td, *t, *old_t = NULL;
+	char *tname, *old_tname = NULL;
 	int ret = 0, err;
 	u32 hook = 0;
 	u32 index = 0;
@@ -136,7 +138,7 @@ static int tcf_ipt_init(struct net *net, struct nlattr *nla, struct nlattr *est,
 	pc = tcf_hash_check(index, a, bind, &ipt_hash_info);
 	if (!pc) {
 		pc = tcf_hash_create(index, est, a, sizeof(*ipt), bind,
-				     &ipt_idx_gen, &ipt_hash_info);
+				     true, &ipt_idx_gen, &ipt_hash_info);
 		if (IS_ERR(pc))
 			return PTR_ERR(pc);
 		ret = ACT_P_CREATED;
@@ -170,16 +172,25 @@ static int tcf_ipt_init(struct net *net, struct nlattr *nla, struct nlattr *est,
 
 	spin_lock_bh(&ipt->tcf_lock);
 	if (ret != ACT_P_CREATED) {
-		ipt_destroy_target(ipt->tcfi_t);
-		kfree(ipt->tcfi_tname);
-		kfree(ipt->tcfi_t);
+		old_t = rtnl_dereference(ipt->tcfi_t);
+		old_tname = ipt->tcfi_tname;
 	}
 	ipt->tcfi_tname = tname;
-	ipt->tcfi_t     = t;
 	ipt->tcfi_hook  = hook;
+	rcu_assign_pointer(ipt->tcfi_t, t);
 	spin_unlock_bh(&ipt->tcf_lock);
-	if (ret == ACT_P_CREATED)
+	if (ret == ACT_P_CREATED) {
 		tcf_hash_insert(pc, &ipt_hash_info);
+	} else {
+		/* tcf_ipt() may still be running the old target; it runs
+		 * with BHs disabled on ingress and egress alike, which
+		 * synchronize_net() does not wait for under PREEMPT_RCU.
+		 */
+		synchronize_rcu_bh();
+		ipt_destroy_target(old_t);
+		kfree(old_tname);
+		kfree(old_t);
+	}
 	return ret;
 
 err3:
@@ -187,12 +198,8 @@ err3:
 err2:
 	kfree(tname);
 err1:
-	if (ret == ACT_P_CREATED) {
-		if (est)
-			gen_kill_estimator(&pc->tcfc_bstats,
-					   &pc->tcfc_rate_est);
-		kfree_rcu(pc, tcfc_rcu);
-	}
+	if (ret == ACT_P_CREATED)
+		tcf_hash_cleanup(pc, est);
 	return err;
 }
 
@@ -207,15 +214,20 @@ static int tcf_ipt(struct sk_buff *skb, const struct tc_action *a,
 {
 	int ret = 0, result = 0;
 	struct tcf_ipt *ipt = a->priv;
+	struct xt_entry_target *t;
 	struct xt_action_param par;
 
 	if (skb_unclone(skb, GFP_ATOMIC))
 		return TC_ACT_UNSPEC;
 
-	spin_lock(&ipt->tcf_lock);
-
-	ipt->tcf_tm.lastuse = jiffies;
-	bstats_update(&ipt->tcf_bstats, skb);
+	/*
+	 * No tcf_lock here: the target is RCU published by tcf_ipt_init()
+	 * and xtables targets are reentrant, as they run concurrently on
+	 * all cpus from the netfilter hooks anyway.
+	 */
+	tcf_lastuse_update(&ipt->tcf_tm);
+	tcf_action_update_bstats(&ipt->common, skb);
+	t = rcu_dereference_bh(ipt->tcfi_t);
 
 	/* yes, we have to worry about both in and out dev
 	 * worry later - danger - this API seems to have changed
@@ -223,9 +235,9 @@ static int tcf_ipt(struct sk_buff *skb, const struct tc_action *a,
 	 */
 	par.in       = skb->dev;
 	par.out      = NULL;
-	par.hooknum  = ipt->tcfi_hook;
-	par.target   = ipt->tcfi_t->u.kernel.target;
-	par.targinfo = ipt->tcfi_t->data;
+	par.hooknum  = ACCESS_ONCE(ipt->tcfi_hook);
+	par.target   = t->u.kernel.target;
+	par.targinfo = t->data;
 	ret = par.target->target(skb, &par);
 
 	switch (ret) {
@@ -234,7 +246,7 @@ static int tcf_ipt(struct sk_buff *skb, const struct tc_action *a,
 		break;
 	case NF_DROP:
 		result = TC_ACT_SHOT;
-		ipt->tcf_qstats.drops++;
+		tcf_action_inc_drop_qstats(&ipt->common);
 		break;
 	case XT_CONTINUE:
 		result = TC_ACT_PIPE;
@@ -245,7 +257,6 @@ static int tcf_ipt(struct sk_buff *skb, const struct tc_action *a,
 		result = TC_POLICE_OK;
 		break;
 	}
-	spin_unlock(&ipt->tcf_lock);
 	return result;
 
 }
@@ -254,6 +265,7 @@ static int tcf_ipt_dump(struct sk_buff *skb, struct tc_action *a, int bind, int
 {
 	unsigned char *b = skb_tail_pointer(skb);
 	struct tcf_ipt *ipt = a->priv;
+	struct xt_entry_target *target = rtnl_dereference(ipt->tcfi_t);
 	struct xt_entry_target *t;
 	struct tcf_t tm;
 	struct tc_cnt c;
@@ -263,15 +275,15 @@ static int tcf_ipt_dump(struct sk_buff *skb, struct tc_action *a, int bind, int
 	 * for foolproof you need to not assume this
 	 */
 
-	t = kmemdup(ipt->tcfi_t, ipt->tcfi_t->u.user.target_size, GFP_ATOMIC);
+	t = kmemdup(target, target->u.user.target_size, GFP_ATOMIC);
 	if (unlikely(!t))
 		goto nla_put_failure;
 
 	c.bindcnt = ipt->tcf_bindcnt - bind;
 	c.refcnt = ipt->tcf_refcnt - ref;
-	strcpy(t->u.user.name, ipt->tcfi_t->u.kernel.target->name);
+	strcpy(t->u.user.name, target->u.kernel.target->name);
 
-	if (nla_put(skb, TCA_IPT_TARG, ipt->tcfi_t->u.user.target_size, t) ||
+	if (nla_put(skb, TCA_IPT_TARG, target->u.user.target_size, t) ||
 	    nla_put_u32(skb, TCA_IPT_INDEX, ipt->tcf_index) ||
 	    nla_put_u32(skb, TCA_IPT_HOOK, ipt->tcfi_hook) ||
 	    nla_put(skb, TCA_IPT_CNT, sizeof(struct tc_cnt), &c) ||
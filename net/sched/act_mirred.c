@@ -48,9 +48,11 @@ static int tcf_mirred_release(struct tcf_mirred *m, int bind)
 			m->tcf_bindcnt--;
 		m->tcf_refcnt--;
 		if (!m->tcf_bindcnt && m->tcf_refcnt <= 0) {
+			struct net_device *dev = rtnl_dereference(m->tcfm_dev);
+
 			list_del(&m->tcfm_list);
-			if (m->tcfm_dev)
-				dev_put(m->tcfm_dev);
+			if (dev)
+				dev_put(dev);
 			tcf_hash_destroy(&m->common, &mirred_hash_info);
 			return 1;
 		}
@@ -114,7 +116,7 @@ static int tcf_mirred_init(struct net *net, struct nlattr *nla,
 		if (dev == NULL)
 			return -EINVAL;
 		pc = tcf_hash_create(parm->index, est, a, sizeof(*m), bind,
-				     &mirred_idx_gen, &mirred_hash_info);
+				     true, &mirred_idx_gen, &mirred_hash_info);
 		if (IS_ERR(pc))
 			return PTR_ERR(pc);
 		ret = ACT_P_CREATED;
@@ -130,12 +132,17 @@ static int tcf_mirred_init(struct net *net, struct nlattr *nla,
 	m->tcf_action = parm->action;
 	m->tcfm_eaction = parm->eaction;
 	if (dev != NULL) {
+		struct net_device *old = rtnl_dereference(m->tcfm_dev);
+
 		m->tcfm_ifindex = parm->ifindex;
-		if (ret != ACT_P_CREATED)
-			dev_put(m->tcfm_dev);
-		dev_hold(dev);
-		m->tcfm_dev = dev;
 		m->tcfm_ok_push = ok_push;
+		dev_hold(dev);
+		rcu_assign_pointer(m->tcfm_dev, dev);
+		/* readers may still use @old, but netdev unregistration
+		 * waits for a grace period before it is freed
+		 */
+		if (old)
+			dev_put(old);
 	}
 	spin_unlock_bh(&m->tcf_lock);
 	if (ret == ACT_P_CREATED) {
@@ -161,14 +168,20 @@ static int tcf_mirred(struct sk_buff *skb, const struct tc_action *a,
 	struct tcf_mirred *m = a->priv;
 	struct net_device *dev;
 	struct sk_buff *skb2;
+	int m_eaction, retval, err = 1;
 	u32 at;
-	int retval, err = 1;
-
-	spin_lock(&m->tcf_lock);
-	m->tcf_tm.lastuse = jiffies;
-	bstats_update(&m->tcf_bstats, skb);
 
-	dev = m->tcfm_dev;
+	/*
+	 * tcf_lock only serializes tcf_mirred_init(); we read the
+	 * parameters once.  We run with BHs disabled, from the receive
+	 * softirq on ingress and under rcu_read_lock_bh() on egress.
+	 */
+	tcf_lastuse_update(&m->tcf_tm);
+	tcf_action_update_bstats(&m->common, skb);
+
+	m_eaction = ACCESS_ONCE(m->tcfm_eaction);
+	retval = ACCESS_ONCE(m->tcf_action);
+	dev = rcu_dereference_bh(m->tcfm_dev);
 	if (!dev) {
 		printk_once(KERN_NOTICE "tc mirred: target device is gone\n");
 		goto out;
@@ -181,17 +194,17 @@ static int tcf_mirred(struct sk_buff *skb, const struct tc_action *a,
 	}
 
 	at = G_TC_AT(skb->tc_verd);
-	skb2 = skb_act_clone(skb, GFP_ATOMIC, m->tcf_action);
+	skb2 = skb_act_clone(skb, GFP_ATOMIC, retval);
 	if (skb2 == NULL)
 		goto out;
 
 	if (!(at & AT_EGRESS)) {
-		if (m->tcfm_ok_push)
+		if (ACCESS_ONCE(m->tcfm_ok_push))
 			skb_push(skb2, skb2->dev->hard_header_len);
 	}
 
 	/* mirror is always swallowed */
-	if (m->tcfm_eaction != TCA_EGRESS_MIRROR)
+	if (m_eaction != TCA_EGRESS_MIRROR)
 		skb2->tc_verd = SET_TC_FROM(skb2->tc_verd, at);
 
 	skb2->skb_iif = skb->dev->ifindex;
@@ -200,14 +213,10 @@ static int tcf_mirred(struct sk_buff *skb, const struct tc_action *a,
 
 out:
 	if (err) {
-		m->tcf_qstats.overlimits++;
-		if (m->tcfm_eaction != TCA_EGRESS_MIRROR)
+		tcf_action_inc_overlimit_qstats(&m->common);
+		if (m_eaction != TCA_EGRESS_MIRROR)
 			retval = TC_ACT_SHOT;
-		else
-			retval = m->tcf_action;
-	} else
-		retval = m->tcf_action;
-	spin_unlock(&m->tcf_lock);
+	}
 
 	return retval;
 }
@@ -248,9 +257,9 @@ static int mirred_device_event(struct notifier_block *unused,
 
 	if (event == NETDEV_UNREGISTER)
 		list_for_each_entry(m, &mirred_list, tcfm_list) {
-			if (m->tcfm_dev == dev) {
+			if (rcu_access_pointer(m->tcfm_dev) == dev) {
 				dev_put(dev);
-				m->tcfm_dev = NULL;
+				RCU_INIT_POINTER(m->tcfm_dev, NULL);
 			}
 		}
 
@@ -112,7 +112,7 @@ static int tcf_skbedit_init(struct net *net, struct nlattr *nla,
 	pc = tcf_hash_check(parm->index, a, bind, &skbedit_hash_info);
 	if (!pc) {
 		pc = tcf_hash_create(parm->index, est, a, sizeof(*d), bind,
-				     &skbedit_idx_gen, &skbedit_hash_info);
+				     false, &skbedit_idx_gen, &skbedit_hash_info);
 		if (IS_ERR(pc))
 			return PTR_ERR(pc);
 
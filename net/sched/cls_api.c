@@ -115,13 +115,46 @@ static inline u32 tcf_auto_prio(struct tcf_proto *tp)
 	return first;
 }
 
+/* Classifiers that modify their state in place rely on the root lock
+ * against the classify path.  Take a lockless qdisc back to the root
+ * lock before such a classifier is linked in, and let it run without
+ * the lock again once the last of them is gone.
+ */
+static void tcf_chain_nolock_drop(struct Qdisc *q, const struct tcf_proto *tp)
+{
+	struct Qdisc *root = qdisc_root_sleeping(q);
+
+	if (!(root->flags & TCQ_F_NOLOCK) ||
+	    (tp->ops->flags & TCF_PROTO_OPS_NOLOCK))
+		return;
+
+	root->flags &= ~TCQ_F_NOLOCK;
+	/* wait for the readers that did not take the lock */
+	synchronize_net();
+}
+
+static void tcf_chain_nolock_restore(struct Qdisc *q, struct tcf_proto *chain)
+{
+	struct Qdisc *root = qdisc_root_sleeping(q);
+	struct tcf_proto *tp;
+
+	if ((root->flags & (TCQ_F_CAN_NOLOCK | TCQ_F_NOLOCK)) !=
+	    TCQ_F_CAN_NOLOCK)
+		return;
+
+	for (tp = chain; tp; tp = tp->next)
+		if (!(tp->ops->flags & TCF_PROTO_OPS_NOLOCK))
+			return;
+
+	root->flags |= TCQ_F_NOLOCK;
+}
+
 /* Add/change/delete/get a filter node */
 
 static int tc_ctl_tfilter(struct sk_buff *skb, struct nlmsghdr *n)
 {
 	struct net *net = sock_net(skb->sk);
 	struct nlattr *tca[TCA_MAX + 1];
-	spinlock_t *root_lock;
 	struct tcmsg *t;
 	u32 protocol;
 	u32 prio;
@@ -212,8 +245,6 @@ replay:
 		}
 	}
 
-	root_lock = qdisc_root_sleeping_lock(q);
-
 	if (tp == NULL) {
 		/* Proto-tcf does not exist, create new one */
 
@@ -283,12 +314,13 @@ replay:
 
 	if (fh == 0) {
 		if (n->nlmsg_type == RTM_DELTFILTER && t->tcm_handle == 0) {
-			spin_lock_bh(root_lock);
+			tcf_tree_lock(tp);
 			*back = tp->next;
-			spin_unlock_bh(root_lock);
+			tcf_tree_unlock(tp);
 
 			tfilter_notify(net, skb, n, tp, fh, RTM_DELTFILTER);
 			tcf_destroy(tp);
+			tcf_chain_nolock_restore(q, *chain);
 			err = 0;
 			goto errout;
 		}
@@ -324,10 +356,11 @@ replay:
 	err = tp->ops->change(net, skb, tp, cl, t->tcm_handle, tca, &fh);
 	if (err == 0) {
 		if (tp_created) {
-			spin_lock_bh(root_lock);
+			tcf_chain_nolock_drop(q, tp);
+			tcf_tree_lock(tp);
 			tp->next = *back;
 			*back = tp;
-			spin_unlock_bh(root_lock);
+			tcf_tree_unlock(tp);
 		}
 		tfilter_notify(net, skb, n, tp, fh, RTM_NEWTFILTER);
 	} else {
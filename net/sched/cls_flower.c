@@ -0,0 +1,864 @@
+/*
+ * net/sched/cls_flower.c		Flow classifier
+ *
+ *		This program is free software; you can redistribute it and/or
+ *		modify it under the terms of the GNU General Public License
+ *		as published by the Free Software Foundation; either version
+ *		2 of the License, or (at your option) any later version.
+ *
+ * Every packet is dissected once into a struct fl_flow_key.  Filters are
+ * exact matches on that key under a mask; filters sharing a mask share a
+ * struct fl_flow_mask, and all of them live in one hash table keyed by
+ * the masked key, the way the openvswitch megaflow table works.  A lookup
+ * costs one hash probe per distinct mask, no matter how many filters
+ * there are.
+ */
+
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/rtnetlink.h>
+#include <linux/skbuff.h>
+#include <linux/jhash.h>
+#include <linux/random.h>
+#include <linux/rculist.h>
+#include <linux/flex_array.h>
+#include <linux/if_arp.h>
+#include <linux/if_ether.h>
+#include <linux/if_vlan.h>
+#include <linux/in6.h>
+#include <linux/in.h>
+
+#include <net/flow_keys.h>
+#include <net/netlink.h>
+#include <net/act_api.h>
+#include <net/pkt_cls.h>
+
+#define FL_MIN_BUCKETS		16
+
+struct fl_flow_key {
+	int	indev_ifindex;
+	struct {
+		u8	dst[ETH_ALEN];
+		u8	src[ETH_ALEN];
+	} eth;
+	u16	vlan_id;
+	__be16	n_proto;
+	u8	ip_proto;
+	u8	padding[3];
+	u32	mpls_label;
+	union {
+		struct {
+			__be32	src;
+			__be32	dst;
+		} ipv4;
+		struct {
+			struct in6_addr	src;
+			struct in6_addr	dst;
+		} ipv6;
+	};
+	__be16	tp_src;
+	__be16	tp_dst;
+} __aligned(BITS_PER_LONG / 8); /* Ensure that we can do comparisons as longs. */
+
+/* The part of the key a mask cares about, rounded to longs. */
+struct fl_flow_mask_range {
+	unsigned short	start;
+	unsigned short	end;
+};
+
+struct fl_flow_mask {
+	struct fl_flow_key		key;
+	struct fl_flow_mask_range	range;
+	struct list_head		list;
+	unsigned int			refcnt;
+};
+
+struct fl_table {
+	struct flex_array	*buckets;
+	unsigned int		n_buckets;
+	int			node_ver;
+	u32			hash_seed;
+};
+
+struct cls_fl_head {
+	struct fl_table __rcu	*table;
+	struct list_head	masks;
+	struct list_head	filters;
+	unsigned int		count;
+	u32			hgen;
+};
+
+struct cls_fl_filter {
+	struct hlist_node	ht_node[2];
+	struct fl_flow_mask	*mask;
+	struct fl_flow_key	mkey;
+	u32			hash;
+	u32			handle;
+	struct tcf_result	res;
+	struct tcf_exts		exts;
+	struct list_head	list;
+};
+
+static const struct tcf_ext_map fl_ext_map = {
+	.action = TCA_FLOWER_ACT,
+	.police = TCA_FLOWER_POLICE
+};
+
+static unsigned short fl_mask_range(const struct fl_flow_mask *mask)
+{
+	return mask->range.end - mask->range.start;
+}
+
+static void fl_mask_update_range(struct fl_flow_mask *mask)
+{
+	const u8 *bytes = (const u8 *) &mask->key;
+	size_t size = sizeof(mask->key);
+	size_t i, first = size, last = 0;
+
+	for (i = 0; i < size; i++) {
+		if (bytes[i]) {
+			if (first == size)
+				first = i;
+			last = i;
+		}
+	}
+	if (first == size) {
+		/* matches everything */
+		mask->range.start = 0;
+		mask->range.end = 0;
+		return;
+	}
+	mask->range.start = rounddown(first, sizeof(long));
+	mask->range.end = roundup(last + 1, sizeof(long));
+}
+
+static void *fl_key_get_start(struct fl_flow_key *key,
+			      const struct fl_flow_mask *mask)
+{
+	return (u8 *) key + mask->range.start;
+}
+
+static void fl_set_masked_key(struct fl_flow_key *mkey, struct fl_flow_key *key,
+			      struct fl_flow_mask *mask)
+{
+	const long *lkey = fl_key_get_start(key, mask);
+	const long *lmask = fl_key_get_start(&mask->key, mask);
+	long *lmkey = fl_key_get_start(mkey, mask);
+	int i;
+
+	for (i = 0; i < fl_mask_range(mask); i += sizeof(long))
+		*lmkey++ = *lkey++ & *lmask++;
+}
+
+static bool fl_cmp_masked_key(struct fl_flow_key *key1,
+			      struct fl_flow_key *key2,
+			      struct fl_flow_mask *mask)
+{
+	const long *l1 = fl_key_get_start(key1, mask);
+	const long *l2 = fl_key_get_start(key2, mask);
+	long diffs = 0;
+	int i;
+
+	for (i = 0; i < fl_mask_range(mask); i += sizeof(long))
+		diffs |= *l1++ ^ *l2++;
+
+	return diffs == 0;
+}
+
+static u32 fl_hash_masked_key(struct fl_flow_key *mkey,
+			      struct fl_flow_mask *mask)
+{
+	return jhash2(fl_key_get_start(mkey, mask),
+		      fl_mask_range(mask) / sizeof(u32), 0);
+}
+
+static struct hlist_head *fl_bucket(struct fl_table *t, u32 hash)
+{
+	hash = jhash_1word(hash, t->hash_seed);
+	return flex_array_get(t->buckets, hash & (t->n_buckets - 1));
+}
+
+static struct cls_fl_filter *fl_lookup(struct fl_table *t,
+				       struct fl_flow_key *mkey,
+				       struct fl_flow_mask *mask)
+{
+	u32 hash = fl_hash_masked_key(mkey, mask);
+	struct cls_fl_filter *f;
+
+	hlist_for_each_entry_rcu(f, fl_bucket(t, hash), ht_node[t->node_ver]) {
+		if (f->mask == mask && f->hash == hash &&
+		    fl_cmp_masked_key(&f->mkey, mkey, mask))
+			return f;
+	}
+	return NULL;
+}
+
+static void fl_dissect(struct sk_buff *skb, struct fl_flow_key *key)
+{
+	struct flow_keys_ext ext;
+
+	memset(key, 0, sizeof(*key));
+	key->indev_ifindex = skb->skb_iif;
+
+	if (skb->dev && skb->dev->type == ARPHRD_ETHER &&
+	    skb_mac_header_was_set(skb) &&
+	    skb_network_header(skb) - skb_mac_header(skb) >= ETH_HLEN) {
+		const struct ethhdr *eth = eth_hdr(skb);
+
+		memcpy(key->eth.dst, eth->h_dest, ETH_ALEN);
+		memcpy(key->eth.src, eth->h_source, ETH_ALEN);
+	}
+
+	/* whatever was parsed before a failure is still good to match on */
+	skb_flow_dissect_ext(skb, &ext);
+
+	key->n_proto = ext.n_proto;
+	key->vlan_id = vlan_tx_tag_present(skb) ? vlan_tx_tag_get_id(skb) :
+						  ext.vlan_id;
+	key->mpls_label = ext.mpls_label;
+	key->ip_proto = ext.basic.ip_proto;
+	if (key->n_proto == htons(ETH_P_IP)) {
+		key->ipv4.src = ext.basic.src;
+		key->ipv4.dst = ext.basic.dst;
+	} else if (key->n_proto == htons(ETH_P_IPV6)) {
+		key->ipv6.src = ext.ipv6_src;
+		key->ipv6.dst = ext.ipv6_dst;
+	}
+	key->tp_src = ext.basic.port16[0];
+	key->tp_dst = ext.basic.port16[1];
+}
+
+static int fl_classify(struct sk_buff *skb, const struct tcf_proto *tp,
+		       struct tcf_result *res)
+{
+	struct cls_fl_head *head = tp->root;
+	struct fl_table *t = rcu_dereference_bh(head->table);
+	struct fl_flow_key skb_key, skb_mkey;
+	struct fl_flow_mask *mask;
+	struct cls_fl_filter *f;
+	int r;
+
+	if (list_empty(&head->masks))
+		return -1;
+
+	fl_dissect(skb, &skb_key);
+
+	/* masks are tried in the order they were first used */
+	list_for_each_entry_rcu(mask, &head->masks, list) {
+		fl_set_masked_key(&skb_mkey, &skb_key, mask);
+		f = fl_lookup(t, &skb_mkey, mask);
+		if (!f)
+			continue;
+
+		*res = f->res;
+		r = tcf_exts_exec(skb, &f->exts, res);
+		if (r < 0)
+			continue;
+		return r;
+	}
+	return -1;
+}
+
+static struct fl_table *fl_table_alloc(unsigned int n_buckets)
+{
+	struct fl_table *t;
+	unsigned int i;
+
+	t = kmalloc(sizeof(*t), GFP_KERNEL);
+	if (!t)
+		return NULL;
+
+	t->buckets = flex_array_alloc(sizeof(struct hlist_head), n_buckets,
+				      GFP_KERNEL);
+	if (!t->buckets)
+		goto err_free;
+	if (flex_array_prealloc(t->buckets, 0, n_buckets, GFP_KERNEL))
+		goto err_free_buckets;
+	for (i = 0; i < n_buckets; i++)
+		INIT_HLIST_HEAD((struct hlist_head *)
+				flex_array_get(t->buckets, i));
+
+	t->n_buckets = n_buckets;
+	t->node_ver = 0;
+	get_random_bytes(&t->hash_seed, sizeof(t->hash_seed));
+	return t;
+
+err_free_buckets:
+	flex_array_free(t->buckets);
+err_free:
+	kfree(t);
+	return NULL;
+}
+
+static void fl_table_free(struct fl_table *t)
+{
+	flex_array_free(t->buckets);
+	kfree(t);
+}
+
+/* Link all filters of @old into @new through their other hash node, so
+ * that lookups in @old are not disturbed until @new is published.
+ */
+static void fl_table_copy(struct fl_table *old, struct fl_table *new)
+{
+	struct cls_fl_filter *f;
+	unsigned int i;
+
+	new->node_ver = !old->node_ver;
+	for (i = 0; i < old->n_buckets; i++) {
+		struct hlist_head *head = flex_array_get(old->buckets, i);
+
+		hlist_for_each_entry(f, head, ht_node[old->node_ver])
+			hlist_add_head_rcu(&f->ht_node[new->node_ver],
+					   fl_bucket(new, f->hash));
+	}
+}
+
+static struct fl_flow_mask *fl_mask_find(struct cls_fl_head *head,
+					 const struct fl_flow_mask *mask)
+{
+	struct fl_flow_mask *m;
+
+	list_for_each_entry(m, &head->masks, list) {
+		if (m->range.start == mask->range.start &&
+		    m->range.end == mask->range.end &&
+		    !memcmp(&m->key, &mask->key, sizeof(m->key)))
+			return m;
+	}
+	return NULL;
+}
+
+/* Called under tcf_tree_lock(); returns true if @mask must be freed. */
+static bool fl_mask_put(struct fl_flow_mask *mask)
+{
+	if (--mask->refcnt)
+		return false;
+	list_del_rcu(&mask->list);
+	return true;
+}
+
+static unsigned long fl_get(struct tcf_proto *tp, u32 handle)
+{
+	struct cls_fl_head *head = tp->root;
+	struct cls_fl_filter *f;
+
+	list_for_each_entry(f, &head->filters, list)
+		if (f->handle == handle)
+			return (unsigned long) f;
+	return 0;
+}
+
+static void fl_put(struct tcf_proto *tp, unsigned long f)
+{
+}
+
+static int fl_init(struct tcf_proto *tp)
+{
+	struct cls_fl_head *head;
+	struct fl_table *t;
+
+	head = kzalloc(sizeof(*head), GFP_KERNEL);
+	if (!head)
+		return -ENOBUFS;
+
+	t = fl_table_alloc(FL_MIN_BUCKETS);
+	if (!t) {
+		kfree(head);
+		return -ENOBUFS;
+	}
+
+	INIT_LIST_HEAD(&head->masks);
+	INIT_LIST_HEAD(&head->filters);
+	RCU_INIT_POINTER(head->table, t);
+	tp->root = head;
+	return 0;
+}
+
+static void fl_destroy_filter(struct tcf_proto *tp, struct cls_fl_filter *f)
+{
+	tcf_unbind_filter(tp, &f->res);
+	tcf_exts_destroy(tp, &f->exts);
+	kfree(f);
+}
+
+static void fl_destroy(struct tcf_proto *tp)
+{
+	struct cls_fl_head *head = tp->root;
+	struct cls_fl_filter *f, *next;
+	struct fl_flow_mask *mask, *mnext;
+
+	list_for_each_entry_safe(f, next, &head->filters, list) {
+		list_del(&f->list);
+		fl_destroy_filter(tp, f);
+	}
+	list_for_each_entry_safe(mask, mnext, &head->masks, list) {
+		list_del(&mask->list);
+		kfree(mask);
+	}
+	fl_table_free(rtnl_dereference(head->table));
+	kfree(head);
+}
+
+static int fl_delete(struct tcf_proto *tp, unsigned long arg)
+{
+	struct cls_fl_head *head = tp->root;
+	struct cls_fl_filter *f = (struct cls_fl_filter *) arg;
+	struct fl_table *t = rtnl_dereference(head->table);
+	struct fl_flow_mask *mask = f->mask;
+	bool free_mask;
+
+	tcf_tree_lock(tp);
+	hlist_del_rcu(&f->ht_node[t->node_ver]);
+	list_del(&f->list);
+	head->count--;
+	free_mask = fl_mask_put(mask);
+	tcf_tree_unlock(tp);
+
+	fl_destroy_filter(tp, f);
+	if (free_mask)
+		kfree(mask);
+	return 0;
+}
+
+/*
+ * Insert @f, which replaces @fold if that is not NULL.  The hash table
+ * is doubled once it holds more filters than buckets.
+ */
+static int fl_insert(struct tcf_proto *tp, struct cls_fl_head *head,
+		     struct cls_fl_filter *f, struct fl_flow_mask *tmpl,
+		     struct cls_fl_filter *fold)
+{
+	struct fl_table *t = rtnl_dereference(head->table);
+	struct fl_table *old_t = t, *new_t = NULL;
+	struct fl_flow_mask *mask, *old_mask = NULL;
+	struct cls_fl_filter *dup;
+	bool new_mask = false;
+
+	mask = fl_mask_find(head, tmpl);
+	if (mask) {
+		dup = fl_lookup(t, &f->mkey, mask);
+		if (dup && dup != fold)
+			return -EEXIST;
+	} else {
+		mask = kmemdup(tmpl, sizeof(*tmpl), GFP_KERNEL);
+		if (!mask)
+			return -ENOMEM;
+		mask->refcnt = 0;
+		new_mask = true;
+	}
+	f->mask = mask;
+	f->hash = fl_hash_masked_key(&f->mkey, mask);
+
+	if (!fold && head->count >= t->n_buckets) {
+		/* keep going with the old table if we can't grow */
+		new_t = fl_table_alloc(t->n_buckets * 2);
+		if (new_t)
+			fl_table_copy(t, new_t);
+	}
+
+	tcf_tree_lock(tp);
+	if (new_mask)
+		list_add_tail_rcu(&mask->list, &head->masks);
+	mask->refcnt++;
+	if (new_t) {
+		rcu_assign_pointer(head->table, new_t);
+		t = new_t;
+	}
+	hlist_add_head_rcu(&f->ht_node[t->node_ver], fl_bucket(t, f->hash));
+	if (fold) {
+		hlist_del_rcu(&fold->ht_node[t->node_ver]);
+		list_replace(&fold->list, &f->list);
+		if (fl_mask_put(fold->mask))
+			old_mask = fold->mask;
+	} else {
+		list_add_tail(&f->list, &head->filters);
+		head->count++;
+	}
+	tcf_tree_unlock(tp);
+
+	if (new_t)
+		fl_table_free(old_t);
+	kfree(old_mask);
+	return 0;
+}
+
+static const struct nla_policy fl_policy[TCA_FLOWER_MAX + 1] = {
+	[TCA_FLOWER_CLASSID]		= { .type = NLA_U32 },
+	[TCA_FLOWER_INDEV]		= { .type = NLA_STRING,
+					    .len = IFNAMSIZ },
+	[TCA_FLOWER_KEY_ETH_DST]	= { .len = ETH_ALEN },
+	[TCA_FLOWER_KEY_ETH_DST_MASK]	= { .len = ETH_ALEN },
+	[TCA_FLOWER_KEY_ETH_SRC]	= { .len = ETH_ALEN },
+	[TCA_FLOWER_KEY_ETH_SRC_MASK]	= { .len = ETH_ALEN },
+	[TCA_FLOWER_KEY_ETH_TYPE]	= { .type = NLA_U16 },
+	[TCA_FLOWER_KEY_IP_PROTO]	= { .type = NLA_U8 },
+	[TCA_FLOWER_KEY_IPV4_SRC]	= { .type = NLA_U32 },
+	[TCA_FLOWER_KEY_IPV4_SRC_MASK]	= { .type = NLA_U32 },
+	[TCA_FLOWER_KEY_IPV4_DST]	= { .type = NLA_U32 },
+	[TCA_FLOWER_KEY_IPV4_DST_MASK]	= { .type = NLA_U32 },
+	[TCA_FLOWER_KEY_IPV6_SRC]	= { .len = sizeof(struct in6_addr) },
+	[TCA_FLOWER_KEY_IPV6_SRC_MASK]	= { .len = sizeof(struct in6_addr) },
+	[TCA_FLOWER_KEY_IPV6_DST]	= { .len = sizeof(struct in6_addr) },
+	[TCA_FLOWER_KEY_IPV6_DST_MASK]	= { .len = sizeof(struct in6_addr) },
+	[TCA_FLOWER_KEY_L4_SRC]		= { .type = NLA_U16 },
+	[TCA_FLOWER_KEY_L4_SRC_MASK]	= { .type = NLA_U16 },
+	[TCA_FLOWER_KEY_L4_DST]		= { .type = NLA_U16 },
+	[TCA_FLOWER_KEY_L4_DST_MASK]	= { .type = NLA_U16 },
+	[TCA_FLOWER_KEY_VLAN_ID]	= { .type = NLA_U16 },
+	[TCA_FLOWER_KEY_MPLS_LABEL]	= { .type = NLA_U32 },
+};
+
+static void fl_set_key_val(struct nlattr **tb,
+			   void *val, int val_type,
+			   void *mask, int mask_type, int len)
+{
+	if (!tb[val_type])
+		return;
+	memcpy(val, nla_data(tb[val_type]), len);
+	if (mask_type == TCA_FLOWER_UNSPEC || !tb[mask_type])
+		memset(mask, 0xff, len);
+	else
+		memcpy(mask, nla_data(tb[mask_type]), len);
+}
+
+static int fl_set_key(struct net *net, struct nlattr **tb,
+		      struct fl_flow_key *key, struct fl_flow_key *mask)
+{
+	__be16 n_proto;
+
+	if (tb[TCA_FLOWER_INDEV]) {
+		struct net_device *dev;
+
+		dev = __dev_get_by_name(net, nla_data(tb[TCA_FLOWER_INDEV]));
+		if (!dev)
+			return -ENODEV;
+		key->indev_ifindex = dev->ifindex;
+		mask->indev_ifindex = 0xffffffff;
+	}
+
+	fl_set_key_val(tb, key->eth.dst, TCA_FLOWER_KEY_ETH_DST,
+		       mask->eth.dst, TCA_FLOWER_KEY_ETH_DST_MASK,
+		       sizeof(key->eth.dst));
+	fl_set_key_val(tb, key->eth.src, TCA_FLOWER_KEY_ETH_SRC,
+		       mask->eth.src, TCA_FLOWER_KEY_ETH_SRC_MASK,
+		       sizeof(key->eth.src));
+
+	if (tb[TCA_FLOWER_KEY_VLAN_ID]) {
+		u16 vid = nla_get_u16(tb[TCA_FLOWER_KEY_VLAN_ID]);
+
+		if (vid >= VLAN_N_VID)
+			return -EINVAL;
+		key->vlan_id = vid;
+		mask->vlan_id = VLAN_VID_MASK;
+	}
+
+	fl_set_key_val(tb, &key->n_proto, TCA_FLOWER_KEY_ETH_TYPE,
+		       &mask->n_proto, TCA_FLOWER_UNSPEC,
+		       sizeof(key->n_proto));
+	n_proto = mask->n_proto ? key->n_proto : 0;
+
+	/* the remaining keys only make sense for a given protocol */
+	if (tb[TCA_FLOWER_KEY_MPLS_LABEL]) {
+		u32 label = nla_get_u32(tb[TCA_FLOWER_KEY_MPLS_LABEL]);
+
+		if (n_proto != htons(ETH_P_MPLS_UC) &&
+		    n_proto != htons(ETH_P_MPLS_MC))
+			return -EINVAL;
+		if (label > 0xFFFFF)
+			return -EINVAL;
+		key->mpls_label = label;
+		mask->mpls_label = 0xFFFFF;
+	}
+
+	if (tb[TCA_FLOWER_KEY_IP_PROTO]) {
+		if (n_proto != htons(ETH_P_IP) && n_proto != htons(ETH_P_IPV6))
+			return -EINVAL;
+		fl_set_key_val(tb, &key->ip_proto, TCA_FLOWER_KEY_IP_PROTO,
+			       &mask->ip_proto, TCA_FLOWER_UNSPEC,
+			       sizeof(key->ip_proto));
+	}
+
+	if (tb[TCA_FLOWER_KEY_IPV4_SRC] || tb[TCA_FLOWER_KEY_IPV4_DST]) {
+		if (n_proto != htons(ETH_P_IP))
+			return -EINVAL;
+		fl_set_key_val(tb, &key->ipv4.src, TCA_FLOWER_KEY_IPV4_SRC,
+			       &mask->ipv4.src, TCA_FLOWER_KEY_IPV4_SRC_MASK,
+			       sizeof(key->ipv4.src));
+		fl_set_key_val(tb, &key->ipv4.dst, TCA_FLOWER_KEY_IPV4_DST,
+			       &mask->ipv4.dst, TCA_FLOWER_KEY_IPV4_DST_MASK,
+			       sizeof(key->ipv4.dst));
+	} else if (tb[TCA_FLOWER_KEY_IPV6_SRC] || tb[TCA_FLOWER_KEY_IPV6_DST]) {
+		if (n_proto != htons(ETH_P_IPV6))
+			return -EINVAL;
+		fl_set_key_val(tb, &key->ipv6.src, TCA_FLOWER_KEY_IPV6_SRC,
+			       &mask->ipv6.src, TCA_FLOWER_KEY_IPV6_SRC_MASK,
+			       sizeof(key->ipv6.src));
+		fl_set_key_val(tb, &key->ipv6.dst, TCA_FLOWER_KEY_IPV6_DST,
+			       &mask->ipv6.dst, TCA_FLOWER_KEY_IPV6_DST_MASK,
+			       sizeof(key->ipv6.dst));
+	}
+
+	if (tb[TCA_FLOWER_KEY_L4_SRC] || tb[TCA_FLOWER_KEY_L4_DST]) {
+		if (!mask->ip_proto || proto_ports_offset(key->ip_proto) < 0)
+			return -EINVAL;
+		fl_set_key_val(tb, &key->tp_src, TCA_FLOWER_KEY_L4_SRC,
+			       &mask->tp_src, TCA_FLOWER_KEY_L4_SRC_MASK,
+			       sizeof(key->tp_src));
+		fl_set_key_val(tb, &key->tp_dst, TCA_FLOWER_KEY_L4_DST,
+			       &mask->tp_dst, TCA_FLOWER_KEY_L4_DST_MASK,
+			       sizeof(key->tp_dst));
+	}
+
+	return 0;
+}
+
+static u32 fl_grab_new_handle(struct tcf_proto *tp, struct cls_fl_head *head)
+{
+	unsigned int i = 0x80000000;
+
+	do {
+		if (++head->hgen == 0x7FFFFFFF)
+			head->hgen = 1;
+	} while (--i > 0 && fl_get(tp, head->hgen));
+
+	if (unlikely(i == 0)) {
+		pr_err("Insufficient number of handles\n");
+		return 0;
+	}
+	return head->hgen;
+}
+
+static int fl_change(struct net *net, struct sk_buff *in_skb,
+		     struct tcf_proto *tp, unsigned long base,
+		     u32 handle, struct nlattr **tca,
+		     unsigned long *arg)
+{
+	struct cls_fl_head *head = tp->root;
+	struct cls_fl_filter *fold = (struct cls_fl_filter *) *arg;
+	struct cls_fl_filter *fnew;
+	struct nlattr *tb[TCA_FLOWER_MAX + 1];
+	struct fl_flow_mask mask = {};
+	struct tcf_exts e;
+	int err;
+
+	if (tca[TCA_OPTIONS] == NULL)
+		return -EINVAL;
+
+	err = nla_parse_nested(tb, TCA_FLOWER_MAX, tca[TCA_OPTIONS],
+			       fl_policy);
+	if (err < 0)
+		return err;
+
+	if (fold && handle && fold->handle != handle)
+		return -EINVAL;
+
+	fnew = kzalloc(sizeof(*fnew), GFP_KERNEL);
+	if (!fnew)
+		return -ENOBUFS;
+
+	err = fl_set_key(net, tb, &fnew->mkey, &mask.key);
+	if (err)
+		goto errout;
+
+	fl_mask_update_range(&mask);
+	fl_set_masked_key(&fnew->mkey, &fnew->mkey, &mask);
+
+	if (fold) {
+		handle = fold->handle;
+	} else if (!handle) {
+		err = -EINVAL;
+		handle = fl_grab_new_handle(tp, head);
+		if (!handle)
+			goto errout;
+	}
+	fnew->handle = handle;
+
+	err = tcf_exts_validate(net, tp, tb, tca[TCA_RATE], &e, &fl_ext_map);
+	if (err < 0)
+		goto errout;
+
+	if (tb[TCA_FLOWER_CLASSID]) {
+		fnew->res.classid = nla_get_u32(tb[TCA_FLOWER_CLASSID]);
+		tcf_bind_filter(tp, &fnew->res, base);
+	}
+	tcf_exts_change(tp, &fnew->exts, &e);
+
+	err = fl_insert(tp, head, fnew, &mask, fold);
+	if (err) {
+		fl_destroy_filter(tp, fnew);
+		return err;
+	}
+
+	*arg = (unsigned long) fnew;
+	if (fold)
+		fl_destroy_filter(tp, fold);
+	return 0;
+
+errout:
+	kfree(fnew);
+	return err;
+}
+
+static void fl_walk(struct tcf_proto *tp, struct tcf_walker *arg)
+{
+	struct cls_fl_head *head = tp->root;
+	struct cls_fl_filter *f;
+
+	list_for_each_entry(f, &head->filters, list) {
+		if (arg->count < arg->skip)
+			goto skip;
+		if (arg->fn(tp, (unsigned long) f, arg) < 0) {
+			arg->stop = 1;
+			break;
+		}
+skip:
+		arg->count++;
+	}
+}
+
+static int fl_dump_key_val(struct sk_buff *skb,
+			   void *val, int val_type,
+			   void *mask, int mask_type, int len)
+{
+	if (!memchr_inv(mask, 0, len))
+		return 0;
+	if (nla_put(skb, val_type, len, val))
+		return -1;
+	if (mask_type != TCA_FLOWER_UNSPEC &&
+	    nla_put(skb, mask_type, len, mask))
+		return -1;
+	return 0;
+}
+
+static int fl_dump_key(struct sk_buff *skb, struct net *net,
+		       struct fl_flow_key *key, struct fl_flow_key *mask)
+{
+	if (mask->indev_ifindex) {
+		struct net_device *dev;
+
+		dev = __dev_get_by_index(net, key->indev_ifindex);
+		if (dev && nla_put_string(skb, TCA_FLOWER_INDEV, dev->name))
+			return -1;
+	}
+
+	if (fl_dump_key_val(skb, key->eth.dst, TCA_FLOWER_KEY_ETH_DST,
+			    mask->eth.dst, TCA_FLOWER_KEY_ETH_DST_MASK,
+			    sizeof(key->eth.dst)) ||
+	    fl_dump_key_val(skb, key->eth.src, TCA_FLOWER_KEY_ETH_SRC,
+			    mask->eth.src, TCA_FLOWER_KEY_ETH_SRC_MASK,
+			    sizeof(key->eth.src)) ||
+	    fl_dump_key_val(skb, &key->vlan_id, TCA_FLOWER_KEY_VLAN_ID,
+			    &mask->vlan_id, TCA_FLOWER_UNSPEC,
+			    sizeof(key->vlan_id)) ||
+	    fl_dump_key_val(skb, &key->n_proto, TCA_FLOWER_KEY_ETH_TYPE,
+			    &mask->n_proto, TCA_FLOWER_UNSPEC,
+			    sizeof(key->n_proto)) ||
+	    fl_dump_key_val(skb, &key->mpls_label, TCA_FLOWER_KEY_MPLS_LABEL,
+			    &mask->mpls_label, TCA_FLOWER_UNSPEC,
+			    sizeof(key->mpls_label)) ||
+	    fl_dump_key_val(skb, &key->ip_proto, TCA_FLOWER_KEY_IP_PROTO,
+			    &mask->ip_proto, TCA_FLOWER_UNSPEC,
+			    sizeof(key->ip_proto)))
+		return -1;
+
+	if (mask->n_proto && key->n_proto == htons(ETH_P_IP) &&
+	    (fl_dump_key_val(skb, &key->ipv4.src, TCA_FLOWER_KEY_IPV4_SRC,
+			     &mask->ipv4.src, TCA_FLOWER_KEY_IPV4_SRC_MASK,
+			     sizeof(key->ipv4.src)) ||
+	     fl_dump_key_val(skb, &key->ipv4.dst, TCA_FLOWER_KEY_IPV4_DST,
+			     &mask->ipv4.dst, TCA_FLOWER_KEY_IPV4_DST_MASK,
+			     sizeof(key->ipv4.dst))))
+		return -1;
+
+	if (mask->n_proto && key->n_proto == htons(ETH_P_IPV6) &&
+	    (fl_dump_key_val(skb, &key->ipv6.src, TCA_FLOWER_KEY_IPV6_SRC,
+			     &mask->ipv6.src, TCA_FLOWER_KEY_IPV6_SRC_MASK,
+			     sizeof(key->ipv6.src)) ||
+	     fl_dump_key_val(skb, &key->ipv6.dst, TCA_FLOWER_KEY_IPV6_DST,
+			     &mask->ipv6.dst, TCA_FLOWER_KEY_IPV6_DST_MASK,
+			     sizeof(key->ipv6.dst))))
+		return -1;
+
+	if (fl_dump_key_val(skb, &key->tp_src, TCA_FLOWER_KEY_L4_SRC,
+			    &mask->tp_src, TCA_FLOWER_KEY_L4_SRC_MASK,
+			    sizeof(key->tp_src)) ||
+	    fl_dump_key_val(skb, &key->tp_dst, TCA_FLOWER_KEY_L4_DST,
+			    &mask->tp_dst, TCA_FLOWER_KEY_L4_DST_MASK,
+			    sizeof(key->tp_dst)))
+		return -1;
+
+	return 0;
+}
+
+static int fl_dump(struct tcf_proto *tp, unsigned long fh,
+		   struct sk_buff *skb, struct tcmsg *t)
+{
+	struct cls_fl_filter *f = (struct cls_fl_filter *) fh;
+	struct nlattr *nest;
+
+	if (f == NULL)
+		return skb->len;
+
+	t->tcm_handle = f->handle;
+
+	nest = nla_nest_start(skb, TCA_OPTIONS);
+	if (nest == NULL)
+		goto nla_put_failure;
+
+	if (f->res.classid &&
+	    nla_put_u32(skb, TCA_FLOWER_CLASSID, f->res.classid))
+		goto nla_put_failure;
+
+	if (fl_dump_key(skb, dev_net(qdisc_dev(tp->q)), &f->mkey,
+			&f->mask->key) < 0)
+		goto nla_put_failure;
+
+	if (tcf_exts_dump(skb, &f->exts, &fl_ext_map) < 0)
+		goto nla_put_failure;
+
+	nla_nest_end(skb, nest);
+
+	if (tcf_exts_dump_stats(skb, &f->exts, &fl_ext_map) < 0)
+		goto nla_put_failure;
+
+	return skb->len;
+
+nla_put_failure:
+	nla_nest_cancel(skb, nest);
+	return -1;
+}
+
+static struct tcf_proto_ops cls_fl_ops __read_mostly = {
+	.kind		=	"flower",
+	.classify	=	fl_classify,
+	.init		=	fl_init,
+	.destroy	=	fl_destroy,
+	.get		=	fl_get,
+	.put		=	fl_put,
+	.change		=	fl_change,
+	.delete		=	fl_delete,
+	.walk		=	fl_walk,
+	.dump		=	fl_dump,
+	.flags		=	TCF_PROTO_OPS_NOLOCK,
+	.owner		=	THIS_MODULE,
+};
+
+static int __init cls_fl_init(void)
+{
+	BUILD_BUG_ON(sizeof(struct fl_flow_key) % sizeof(long));
+
+	return register_tcf_proto_ops(&cls_fl_ops);
+}
+
+static void __exit cls_fl_exit(void)
+{
+	unregister_tcf_proto_ops(&cls_fl_ops);
+}
+
+module_init(cls_fl_init);
+module_exit(cls_fl_exit);
+
+MODULE_DESCRIPTION("Flower classifier");
+MODULE_LICENSE("GPL v2");
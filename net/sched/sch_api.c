@@ -959,8 +959,10 @@ qdisc_create(struct net_device *dev, struct netdev_queue *dev_queue,
 			else
 				root_lock = qdisc_lock(sch);
 
-			err = gen_new_estimator(&sch->bstats, &sch->rate_est,
-						root_lock, tca[TCA_RATE]);
+			err = gen_new_estimator_cpu(&sch->bstats,
+						    sch->cpu_bstats,
+						    &sch->rate_est,
+						    root_lock, tca[TCA_RATE]);
 			if (err)
 				goto err_out4;
 		}
@@ -1017,9 +1019,10 @@ static int qdisc_change(struct Qdisc *sch, struct nlattr **tca)
 		   because change can't be undone. */
 		if (sch->flags & TCQ_F_MQROOT)
 			goto out;
-		gen_replace_estimator(&sch->bstats, &sch->rate_est,
-					    qdisc_root_sleeping_lock(sch),
-					    tca[TCA_RATE]);
+		gen_replace_estimator_cpu(&sch->bstats, sch->cpu_bstats,
+					  &sch->rate_est,
+					  qdisc_root_sleeping_lock(sch),
+					  tca[TCA_RATE]);
 	}
 out:
 	return 0;
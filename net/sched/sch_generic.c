@@ -41,7 +41,9 @@ EXPORT_SYMBOL(default_qdisc_ops);
  *
  * The idea is the following:
  * - enqueue, dequeue are serialized via qdisc root lock
- * - ingress filtering is also serialized via qdisc root lock
+ * - ingress filtering is serialized via qdisc root lock, or runs under RCU
+ *   only while all its classifiers allow it; writers then wait in
+ *   sch_tree_unlock()
  * - updates to tree and tree walking are only done under the rtnl mutex.
  */
 
@@ -12,12 +12,17 @@
 #include <linux/list.h>
 #include <linux/skbuff.h>
 #include <linux/rtnetlink.h>
+#include <linux/percpu.h>
 #include <net/netlink.h>
 #include <net/pkt_sched.h>
 
 
+/* The ingress qdisc never queues, so it runs without the root lock
+ * (TCQ_F_NOLOCK) on all RX queues in parallel and counts per cpu.
+ */
 struct ingress_qdisc_data {
 	struct tcf_proto	*filter_list;
+	struct gnet_stats_queue __percpu *cpu_qstats;
 };
 
 /* ------------------------- Class/flow operations ------------------------- */
@@ -61,13 +66,13 @@ static int ingress_enqueue(struct sk_buff *skb, struct Qdisc *sch)
 	struct tcf_result res;
 	int result;
 
-	result = tc_classify(skb, p->filter_list, &res);
+	result = tc_classify(skb, ACCESS_ONCE(p->filter_list), &res);
 
-	qdisc_bstats_update(sch, skb);
+	bstats_cpu_update(this_cpu_ptr(sch->cpu_bstats), skb);
 	switch (result) {
 	case TC_ACT_SHOT:
 		result = TC_ACT_SHOT;
-		sch->qstats.drops++;
+		this_cpu_ptr(p->cpu_qstats)->drops++;
 		break;
 	case TC_ACT_STOLEN:
 	case TC_ACT_QUEUED:
@@ -86,11 +91,34 @@ static int ingress_enqueue(struct sk_buff *skb, struct Qdisc *sch)
 
 /* ------------------------------------------------------------- */
 
+static int ingress_init(struct Qdisc *sch, struct nlattr *opt)
+{
+	struct ingress_qdisc_data *p = qdisc_priv(sch);
+	int i;
+
+	sch->cpu_bstats = alloc_percpu(struct gnet_stats_basic_cpu);
+	p->cpu_qstats = alloc_percpu(struct gnet_stats_queue);
+	if (sch->cpu_bstats == NULL || p->cpu_qstats == NULL) {
+		free_percpu(sch->cpu_bstats);
+		sch->cpu_bstats = NULL;
+		free_percpu(p->cpu_qstats);
+		return -ENOMEM;
+	}
+
+	for_each_possible_cpu(i)
+		u64_stats_init(&per_cpu_ptr(sch->cpu_bstats, i)->syncp);
+
+	sch->flags |= TCQ_F_CAN_NOLOCK | TCQ_F_NOLOCK;
+	return 0;
+}
+
 static void ingress_destroy(struct Qdisc *sch)
 {
 	struct ingress_qdisc_data *p = qdisc_priv(sch);
 
 	tcf_destroy_chain(&p->filter_list);
+	free_percpu(sch->cpu_bstats);
+	free_percpu(p->cpu_qstats);
 }
 
 static int ingress_dump(struct Qdisc *sch, struct sk_buff *skb)
@@ -108,6 +136,20 @@ nla_put_failure:
 	return -1;
 }
 
+/* Fold the per cpu counters into the generic ones, which are copied
+ * to user space right after this.
+ */
+static int ingress_dump_stats(struct Qdisc *sch, struct gnet_dump *d)
+{
+	struct ingress_qdisc_data *p = qdisc_priv(sch);
+
+	memset(&sch->bstats, 0, sizeof(sch->bstats));
+	gnet_stats_add_basic_cpu(&sch->bstats, sch->cpu_bstats);
+	memset(&sch->qstats, 0, sizeof(sch->qstats));
+	gnet_stats_add_queue_cpu(&sch->qstats, p->cpu_qstats);
+	return 0;
+}
+
 static const struct Qdisc_class_ops ingress_class_ops = {
 	.leaf		=	ingress_leaf,
 	.get		=	ingress_get,
@@ -123,8 +165,10 @@ static struct Qdisc_ops ingress_qdisc_ops __read_mostly = {
 	.id		=	"ingress",
 	.priv_size	=	sizeof(struct ingress_qdisc_data),
 	.enqueue	=	ingress_enqueue,
+	.init		=	ingress_init,
 	.destroy	=	ingress_destroy,
 	.dump		=	ingress_dump,
+	.dump_stats	=	ingress_dump_stats,
 	.owner		=	THIS_MODULE,
 };
 
@@ -9,10 +9,12 @@
  * 2 of the License, or (at your option) any later version.
  */
 
+#include <crypto/aead.h>
 #include <linux/errno.h>
 #include <linux/module.h>
 #include <linux/netdevice.h>
 #include <linux/netfilter.h>
+#include <linux/percpu.h>
 #include <linux/skbuff.h>
 #include <linux/slab.h>
 #include <linux/spinlock.h>
@@ -21,6 +23,64 @@
 
 static int xfrm_output2(struct sk_buff *skb);
 
+/*
+ * While the segments of a GSO packet are sent, the AEAD requests of their
+ * ESP encapsulation are collected here and handed to the cipher in one
+ * call, so that SIMD drivers enter and leave the FPU once per batch.  The
+ * batch is per CPU and only active with bottom halves disabled.
+ */
+#define XFRM_CRYPTO_BATCH	16
+
+struct xfrm_crypto_batch {
+	bool active;
+	unsigned int n;
+	struct aead_givcrypt_request *reqs[XFRM_CRYPTO_BATCH];
+};
+
+static DEFINE_PER_CPU(struct xfrm_crypto_batch, xfrm_crypto_batch);
+
+static void xfrm_crypto_batch_flush(struct xfrm_crypto_batch *b)
+{
+	struct aead_givcrypt_request *reqs[XFRM_CRYPTO_BATCH];
+	unsigned int n;
+
+	/* the completions may queue requests for the next transform */
+	while ((n = b->n)) {
+		memcpy(reqs, b->reqs, n * sizeof(reqs[0]));
+		b->n = 0;
+		crypto_aead_givencrypt_batch(reqs, n);
+	}
+}
+
+/**
+ * xfrm_output_givencrypt - submit the AEAD request of an outgoing packet
+ * @req: request with its completion function set up
+ *
+ * Behaves like crypto_aead_givencrypt(), except that while a batch is
+ * active the request is only queued and -EINPROGRESS is returned; the
+ * completion function is then called when the batch is flushed.
+ */
+int xfrm_output_givencrypt(struct aead_givcrypt_request *req)
+{
+	struct xfrm_crypto_batch *b;
+
+	if (!in_softirq())
+		return crypto_aead_givencrypt(req);
+
+	b = &__get_cpu_var(xfrm_crypto_batch);
+	if (!b->active)
+		return crypto_aead_givencrypt(req);
+
+	if (b->n == XFRM_CRYPTO_BATCH ||
+	    (b->n && aead_givcrypt_reqtfm(b->reqs[0]) !=
+		     aead_givcrypt_reqtfm(req)))
+		xfrm_crypto_batch_flush(b);
+
+	b->reqs[b->n++] = req;
+	return -EINPROGRESS;
+}
+EXPORT_SYMBOL_GPL(xfrm_output_givencrypt);
+
 static int xfrm_skb_check_space(struct sk_buff *skb)
 {
 	struct dst_entry *dst = skb_dst(skb);
@@ -151,16 +211,23 @@ static int xfrm_output2(struct sk_buff *skb)
 
 static int xfrm_output_gso(struct sk_buff *skb)
 {
+	struct xfrm_crypto_batch *b;
 	struct sk_buff *segs;
+	bool nested;
+	int err = 0;
 
 	segs = skb_gso_segment(skb, 0);
 	kfree_skb(skb);
 	if (IS_ERR(segs))
 		return PTR_ERR(segs);
 
+	local_bh_disable();
+	b = &__get_cpu_var(xfrm_crypto_batch);
+	nested = b->active;
+	b->active = true;
+
 	do {
 		struct sk_buff *nskb = segs->next;
-		int err;
 
 		segs->next = NULL;
 		err = xfrm_output2(segs);
@@ -171,13 +238,19 @@ static int xfrm_output_gso(struct sk_buff *skb)
 				segs->next = NULL;
 				kfree_skb(segs);
 			}
-			return err;
+			break;
 		}
 
 		segs = nskb;
 	} while (segs);
 
-	return 0;
+	if (!nested) {
+		xfrm_crypto_batch_flush(b);
+		b->active = false;
+	}
+	local_bh_enable();
+
+	return err;
 }
 
 int xfrm_output(struct sk_buff *skb)
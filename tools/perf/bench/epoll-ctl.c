@@ -0,0 +1,307 @@
+/*
+ * epoll-ctl.c
+ *
+ * ctl: Measure epoll_ctl(2) throughput.  Every thread owns a set of
+ * eventfds and keeps adding, modifying and removing them from an epoll
+ * instance.  By default all threads share a single instance, so this
+ * stresses the instance mutex and the rbtree of watched files; with
+ * --multiq every thread uses its own instance.
+ */
+
+#include "../perf.h"
+#include "../util/util.h"
+#include "../util/stat.h"
+#include "../util/parse-options.h"
+#include "../builtin.h"
+#include "bench.h"
+
+#include <err.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+
+enum {
+	OP_EPOLL_ADD,
+	OP_EPOLL_MOD,
+	OP_EPOLL_DEL,
+	EPOLL_NR_OPS,
+};
+
+static const char * const op_names[EPOLL_NR_OPS] = {
+	[OP_EPOLL_ADD] = "ADD",
+	[OP_EPOLL_MOD] = "MOD",
+	[OP_EPOLL_DEL] = "DEL",
+};
+
+static unsigned int nthreads;
+static unsigned int nfds = 64;
+static unsigned int runtime = 10;
+static bool multiq, randomize, silent;
+
+static bool done;
+static int epollfd;
+static pthread_mutex_t thread_lock;
+static pthread_cond_t thread_parent, thread_worker;
+static unsigned int threads_starting;
+static struct stats all_stats[EPOLL_NR_OPS];
+
+struct worker {
+	int		tid;
+	int		epollfd;
+	int		*fdmap;
+	bool		*added;
+	unsigned int	seed;
+	pthread_t	thread;
+	unsigned long	ops[EPOLL_NR_OPS];
+};
+
+static const struct option options[] = {
+	OPT_UINTEGER('t', "threads", &nthreads, "Specify amount of threads (default: number of CPUs)"),
+	OPT_UINTEGER('r', "runtime", &runtime, "Specify runtime (in seconds)"),
+	OPT_UINTEGER('f', "nfds",    &nfds, "Specify amount of file descriptors per thread"),
+	OPT_BOOLEAN( 'm', "multiq",  &multiq, "Use an epoll instance per thread instead of a shared one"),
+	OPT_BOOLEAN( 'R', "randomize", &randomize, "Pick fds and operations at random instead of cycling"),
+	OPT_BOOLEAN( 's', "silent",  &silent, "Silent mode: do not display data/details"),
+	OPT_END()
+};
+
+static const char * const bench_epoll_ctl_usage[] = {
+	"perf bench epoll ctl <options>",
+	NULL
+};
+
+static void do_epoll_op(struct worker *w, int op, unsigned int i)
+{
+	struct epoll_event ev;
+	int ctl;
+
+	ev.events = EPOLLIN;
+	ev.data.fd = w->fdmap[i];
+
+	switch (op) {
+	case OP_EPOLL_ADD:
+		ctl = EPOLL_CTL_ADD;
+		break;
+	case OP_EPOLL_MOD:
+		ctl = EPOLL_CTL_MOD;
+		ev.events |= EPOLLOUT;
+		break;
+	default:
+		ctl = EPOLL_CTL_DEL;
+		break;
+	}
+
+	if (epoll_ctl(w->epollfd, ctl, w->fdmap[i], &ev) < 0)
+		err(EXIT_FAILURE, "epoll_ctl(%s)", op_names[op]);
+
+	w->added[i] = op != OP_EPOLL_DEL;
+	w->ops[op]++;
+}
+
+static void *workerfn(void *arg)
+{
+	struct worker *w = arg;
+	unsigned int i;
+	int op;
+
+	pthread_mutex_lock(&thread_lock);
+	threads_starting--;
+	if (!threads_starting)
+		pthread_cond_signal(&thread_parent);
+	pthread_cond_wait(&thread_worker, &thread_lock);
+	pthread_mutex_unlock(&thread_lock);
+
+	do {
+		if (randomize) {
+			i = rand_r(&w->seed) % nfds;
+			/* only pick operations that are valid for the fd */
+			if (!w->added[i])
+				op = OP_EPOLL_ADD;
+			else
+				op = OP_EPOLL_MOD + rand_r(&w->seed) % 2;
+			do_epoll_op(w, op, i);
+			continue;
+		}
+
+		for (op = 0; op < EPOLL_NR_OPS; op++)
+			for (i = 0; i < nfds; i++)
+				do_epoll_op(w, op, i);
+	} while (!done);
+
+	return NULL;
+}
+
+static void toggle_done(int sig __maybe_unused,
+			siginfo_t *info __maybe_unused,
+			void *uc __maybe_unused)
+{
+	/* inform all threads that we're done for the day */
+	done = true;
+}
+
+static void setup_fds(struct worker *w)
+{
+	unsigned int i;
+
+	w->fdmap = calloc(nfds, sizeof(*w->fdmap));
+	w->added = calloc(nfds, sizeof(*w->added));
+	if (!w->fdmap || !w->added)
+		err(EXIT_FAILURE, "calloc");
+
+	if (multiq) {
+		w->epollfd = epoll_create(nfds);
+		if (w->epollfd < 0)
+			err(EXIT_FAILURE, "epoll_create");
+	} else
+		w->epollfd = epollfd;
+
+	for (i = 0; i < nfds; i++) {
+		w->fdmap[i] = eventfd(0, EFD_NONBLOCK);
+		if (w->fdmap[i] < 0)
+			err(EXIT_FAILURE, "eventfd");
+	}
+}
+
+static void print_summary(void)
+{
+	double avg[EPOLL_NR_OPS], stddev[EPOLL_NR_OPS];
+	int op;
+
+	for (op = 0; op < EPOLL_NR_OPS; op++) {
+		avg[op] = avg_stats(&all_stats[op]);
+		stddev[op] = stddev_stats(&all_stats[op]);
+	}
+
+	if (bench_format == BENCH_FORMAT_SIMPLE) {
+		for (op = 0; op < EPOLL_NR_OPS; op++)
+			printf("%s%.0f %.2f", op ? " " : "", avg[op],
+			       rel_stddev_stats(stddev[op], avg[op]));
+		printf("\n");
+		return;
+	}
+
+	printf("%s", !silent ? "\n" : "");
+	for (op = 0; op < EPOLL_NR_OPS; op++)
+		printf("Averaged %ld %s operations/sec (+- %.2f%%)\n",
+		       (long)avg[op], op_names[op],
+		       rel_stddev_stats(stddev[op], avg[op]));
+}
+
+int bench_epoll_ctl(int argc, const char **argv,
+		    const char *prefix __maybe_unused)
+{
+	struct timeval start, end, runtime_tv;
+	struct sigaction act;
+	unsigned int i, j;
+	struct worker *worker = NULL;
+	int op, ret = 0;
+
+	argc = parse_options(argc, argv, options, bench_epoll_ctl_usage, 0);
+	if (argc) {
+		usage_with_options(bench_epoll_ctl_usage, options);
+		exit(EXIT_FAILURE);
+	}
+
+	sigfillset(&act.sa_mask);
+	act.sa_sigaction = toggle_done;
+	sigaction(SIGINT, &act, NULL);
+
+	if (!nthreads)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (!nfds)
+		nfds = 1;
+	if (!runtime)
+		runtime = 1;
+
+	worker = calloc(nthreads, sizeof(*worker));
+	if (!worker)
+		err(EXIT_FAILURE, "calloc");
+
+	if (!multiq) {
+		epollfd = epoll_create(nthreads * nfds);
+		if (epollfd < 0)
+			err(EXIT_FAILURE, "epoll_create");
+	}
+
+	if (bench_format == BENCH_FORMAT_DEFAULT)
+		printf("Run summary [PID %d]: %d threads doing epoll_ctl ops on %d fds each, "
+		       "%s epoll instance%s, for %d secs.\n\n",
+		       getpid(), nthreads, nfds,
+		       multiq ? "per-thread" : "one shared",
+		       multiq ? "s" : "", runtime);
+
+	for (op = 0; op < EPOLL_NR_OPS; op++)
+		init_stats(&all_stats[op]);
+	pthread_mutex_init(&thread_lock, NULL);
+	pthread_cond_init(&thread_parent, NULL);
+	pthread_cond_init(&thread_worker, NULL);
+
+	threads_starting = nthreads;
+	gettimeofday(&start, NULL);
+	for (i = 0; i < nthreads; i++) {
+		worker[i].tid = i;
+		worker[i].seed = getpid() + i;
+		setup_fds(&worker[i]);
+
+		ret = pthread_create(&worker[i].thread, NULL, workerfn,
+				     &worker[i]);
+		if (ret)
+			err(EXIT_FAILURE, "pthread_create");
+	}
+
+	pthread_mutex_lock(&thread_lock);
+	while (threads_starting)
+		pthread_cond_wait(&thread_parent, &thread_lock);
+	pthread_cond_broadcast(&thread_worker);
+	pthread_mutex_unlock(&thread_lock);
+
+	sleep(runtime);
+	toggle_done(0, NULL, NULL);
+
+	for (i = 0; i < nthreads; i++) {
+		ret = pthread_join(worker[i].thread, NULL);
+		if (ret)
+			err(EXIT_FAILURE, "pthread_join");
+	}
+
+	gettimeofday(&end, NULL);
+	timersub(&end, &start, &runtime_tv);
+
+	/* cleanup & report results */
+	pthread_cond_destroy(&thread_parent);
+	pthread_cond_destroy(&thread_worker);
+	pthread_mutex_destroy(&thread_lock);
+
+	for (i = 0; i < nthreads; i++) {
+		unsigned long t[EPOLL_NR_OPS];
+
+		for (op = 0; op < EPOLL_NR_OPS; op++) {
+			t[op] = worker[i].ops[op] / runtime_tv.tv_sec;
+			update_stats(&all_stats[op], t[op]);
+		}
+
+		if (!silent && bench_format == BENCH_FORMAT_DEFAULT)
+			printf("[thread %2d] fdmap: %p [ add: %ld ops/sec; "
+			       "mod: %ld ops/sec; del: %ld ops/sec ]\n",
+			       worker[i].tid, worker[i].fdmap,
+			       t[OP_EPOLL_ADD], t[OP_EPOLL_MOD], t[OP_EPOLL_DEL]);
+
+		for (j = 0; j < nfds; j++)
+			close(worker[i].fdmap[j]);
+		if (multiq)
+			close(worker[i].epollfd);
+		free(worker[i].fdmap);
+		free(worker[i].added);
+	}
+	if (!multiq)
+		close(epollfd);
+
+	print_summary();
+
+	free(worker);
+	return ret;
+}
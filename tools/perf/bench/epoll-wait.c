@@ -0,0 +1,282 @@
+/*
+ * epoll-wait.c
+ *
+ * wait: Measure epoll_wait(2) wakeup throughput.  A writer thread keeps
+ * signalling a set of eventfds while worker threads sit in epoll_wait()
+ * and consume the events.  By default all workers share one epoll
+ * instance, which stresses the ready list and wakeup path under
+ * contention; with --multiq every worker gets its own instance and only
+ * watches its own fds.
+ */
+
+#include "../perf.h"
+#include "../util/util.h"
+#include "../util/stat.h"
+#include "../util/parse-options.h"
+#include "../builtin.h"
+#include "bench.h"
+
+#include <err.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+
+static unsigned int nthreads;
+static unsigned int nfds = 64;
+static unsigned int runtime = 10;
+static bool multiq, edge, silent;
+
+static bool done;
+static int epollfd;
+static pthread_mutex_t thread_lock;
+static pthread_cond_t thread_parent, thread_worker;
+static unsigned int threads_starting;
+static struct stats throughput_stats;
+
+struct worker {
+	int		tid;
+	int		epollfd;	/* per-thread instance, or the shared one */
+	int		*fdmap;
+	pthread_t	thread;
+	unsigned long	ops;
+};
+
+static const struct option options[] = {
+	OPT_UINTEGER('t', "threads", &nthreads, "Specify amount of threads (default: number of CPUs)"),
+	OPT_UINTEGER('r', "runtime", &runtime, "Specify runtime (in seconds)"),
+	OPT_UINTEGER('f', "nfds",    &nfds, "Specify amount of file descriptors per thread"),
+	OPT_BOOLEAN( 'm', "multiq",  &multiq, "Use an epoll instance per thread instead of a shared one"),
+	OPT_BOOLEAN( 'E', "edge",    &edge, "Use edge-triggered instead of level-triggered events"),
+	OPT_BOOLEAN( 's', "silent",  &silent, "Silent mode: do not display data/details"),
+	OPT_END()
+};
+
+static const char * const bench_epoll_wait_usage[] = {
+	"perf bench epoll wait <options>",
+	NULL
+};
+
+static void *workerfn(void *arg)
+{
+	struct worker *w = arg;
+	struct epoll_event ev;
+	eventfd_t val;
+	int ret;
+
+	pthread_mutex_lock(&thread_lock);
+	threads_starting--;
+	if (!threads_starting)
+		pthread_cond_signal(&thread_parent);
+	pthread_cond_wait(&thread_worker, &thread_lock);
+	pthread_mutex_unlock(&thread_lock);
+
+	do {
+		/*
+		 * Use a short timeout so we notice @done even when the
+		 * writer has stopped and nothing is left to consume.
+		 */
+		ret = epoll_wait(w->epollfd, &ev, 1, 100);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			err(EXIT_FAILURE, "epoll_wait");
+		}
+		if (!ret)
+			continue;
+
+		/*
+		 * With a shared level-triggered instance several workers
+		 * can race for the same fd; only count the one that
+		 * actually consumed the event.
+		 */
+		if (!eventfd_read(ev.data.fd, &val))
+			w->ops++;
+	} while (!done);
+
+	return NULL;
+}
+
+static void *writerfn(void *arg)
+{
+	struct worker *worker = arg;
+	unsigned int i, j;
+
+	do {
+		for (i = 0; i < nthreads; i++)
+			for (j = 0; j < nfds; j++)
+				eventfd_write(worker[i].fdmap[j], 1);
+	} while (!done);
+
+	return NULL;
+}
+
+static void toggle_done(int sig __maybe_unused,
+			siginfo_t *info __maybe_unused,
+			void *uc __maybe_unused)
+{
+	/* inform all threads that we're done for the day */
+	done = true;
+}
+
+static void setup_fds(struct worker *w)
+{
+	struct epoll_event ev;
+	unsigned int i;
+
+	w->fdmap = calloc(nfds, sizeof(*w->fdmap));
+	if (!w->fdmap)
+		err(EXIT_FAILURE, "calloc");
+
+	if (multiq) {
+		w->epollfd = epoll_create(nfds);
+		if (w->epollfd < 0)
+			err(EXIT_FAILURE, "epoll_create");
+	} else
+		w->epollfd = epollfd;
+
+	for (i = 0; i < nfds; i++) {
+		w->fdmap[i] = eventfd(0, EFD_NONBLOCK);
+		if (w->fdmap[i] < 0)
+			err(EXIT_FAILURE, "eventfd");
+
+		ev.events = EPOLLIN;
+		if (edge)
+			ev.events |= EPOLLET;
+		ev.data.fd = w->fdmap[i];
+		if (epoll_ctl(w->epollfd, EPOLL_CTL_ADD, w->fdmap[i], &ev) < 0)
+			err(EXIT_FAILURE, "epoll_ctl");
+	}
+}
+
+static void print_summary(struct timeval *runtime_tv)
+{
+	double avg = avg_stats(&throughput_stats);
+	double stddev = stddev_stats(&throughput_stats);
+
+	if (bench_format == BENCH_FORMAT_SIMPLE) {
+		printf("%.0f %.2f\n", avg, rel_stddev_stats(stddev, avg));
+		return;
+	}
+
+	printf("%sAveraged %ld events/sec (+- %.2f%%), total secs = %d\n",
+	       !silent ? "\n" : "", (long)avg,
+	       rel_stddev_stats(stddev, avg), (int)runtime_tv->tv_sec);
+}
+
+int bench_epoll_wait(int argc, const char **argv,
+		     const char *prefix __maybe_unused)
+{
+	struct timeval start, end, runtime_tv;
+	struct sigaction act;
+	unsigned int i, j;
+	pthread_t writer;
+	struct worker *worker = NULL;
+	int ret = 0;
+
+	argc = parse_options(argc, argv, options, bench_epoll_wait_usage, 0);
+	if (argc) {
+		usage_with_options(bench_epoll_wait_usage, options);
+		exit(EXIT_FAILURE);
+	}
+
+	sigfillset(&act.sa_mask);
+	act.sa_sigaction = toggle_done;
+	sigaction(SIGINT, &act, NULL);
+
+	if (!nthreads)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (!nfds)
+		nfds = 1;
+	if (!runtime)
+		runtime = 1;
+
+	worker = calloc(nthreads, sizeof(*worker));
+	if (!worker)
+		err(EXIT_FAILURE, "calloc");
+
+	if (!multiq) {
+		epollfd = epoll_create(nthreads * nfds);
+		if (epollfd < 0)
+			err(EXIT_FAILURE, "epoll_create");
+	}
+
+	if (bench_format == BENCH_FORMAT_DEFAULT)
+		printf("Run summary [PID %d]: %d threads, %d %s-triggered fds each, "
+		       "%s epoll instance%s, for %d secs.\n\n",
+		       getpid(), nthreads, nfds, edge ? "edge" : "level",
+		       multiq ? "per-thread" : "one shared",
+		       multiq ? "s" : "", runtime);
+
+	init_stats(&throughput_stats);
+	pthread_mutex_init(&thread_lock, NULL);
+	pthread_cond_init(&thread_parent, NULL);
+	pthread_cond_init(&thread_worker, NULL);
+
+	threads_starting = nthreads;
+	for (i = 0; i < nthreads; i++) {
+		worker[i].tid = i;
+		setup_fds(&worker[i]);
+
+		ret = pthread_create(&worker[i].thread, NULL, workerfn,
+				     &worker[i]);
+		if (ret)
+			err(EXIT_FAILURE, "pthread_create");
+	}
+
+	pthread_mutex_lock(&thread_lock);
+	while (threads_starting)
+		pthread_cond_wait(&thread_parent, &thread_lock);
+	pthread_cond_broadcast(&thread_worker);
+	pthread_mutex_unlock(&thread_lock);
+
+	gettimeofday(&start, NULL);
+	ret = pthread_create(&writer, NULL, writerfn, worker);
+	if (ret)
+		err(EXIT_FAILURE, "pthread_create");
+
+	sleep(runtime);
+	toggle_done(0, NULL, NULL);
+
+	ret = pthread_join(writer, NULL);
+	if (ret)
+		err(EXIT_FAILURE, "pthread_join");
+	for (i = 0; i < nthreads; i++) {
+		ret = pthread_join(worker[i].thread, NULL);
+		if (ret)
+			err(EXIT_FAILURE, "pthread_join");
+	}
+
+	gettimeofday(&end, NULL);
+	timersub(&end, &start, &runtime_tv);
+
+	/* cleanup & report results */
+	pthread_cond_destroy(&thread_parent);
+	pthread_cond_destroy(&thread_worker);
+	pthread_mutex_destroy(&thread_lock);
+
+	for (i = 0; i < nthreads; i++) {
+		unsigned long t = worker[i].ops / runtime_tv.tv_sec;
+
+		update_stats(&throughput_stats, t);
+		if (!silent && bench_format == BENCH_FORMAT_DEFAULT)
+			printf("[thread %2d] fdmap: %p [ %ld events/sec ]\n",
+			       worker[i].tid, worker[i].fdmap, t);
+
+		for (j = 0; j < nfds; j++)
+			close(worker[i].fdmap[j]);
+		if (multiq)
+			close(worker[i].epollfd);
+		free(worker[i].fdmap);
+	}
+	if (!multiq)
+		close(epollfd);
+
+	print_summary(&runtime_tv);
+
+	free(worker);
+	return ret;
+}
@@ -0,0 +1,176 @@
+/*
+ * locking.c
+ *
+ * mutex, rwsem, spinlock: Contended kernel lock benchmarks.  The work is
+ * done by kthreads in the test-lock-bench module (CONFIG_TEST_LOCK_BENCH),
+ * which all hammer the same lock; we start a run through its debugfs
+ * file and report the per-thread acquisition rate.
+ */
+
+#include "../perf.h"
+#include "../util/util.h"
+#include "../util/stat.h"
+#include "../util/parse-options.h"
+#include "../builtin.h"
+#include "bench.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int nthreads;
+static unsigned int runtime = 5;
+static unsigned int hold = 10;
+static unsigned int read_pct;
+static bool silent;
+
+static const struct option options[] = {
+	OPT_UINTEGER('t', "threads", &nthreads, "Specify amount of kthreads (default: number of CPUs)"),
+	OPT_UINTEGER('r', "runtime", &runtime, "Specify runtime (in seconds)"),
+	OPT_UINTEGER('H', "hold",    &hold, "Specify amount of cpu_relax() spins inside the critical section"),
+	OPT_UINTEGER('R', "read",    &read_pct, "Specify percentage of read acquisitions (rwsem only)"),
+	OPT_BOOLEAN( 's', "silent",  &silent, "Silent mode: do not display data/details"),
+	OPT_END()
+};
+
+static const char * const bench_locking_usage[] = {
+	"perf bench locking <mutex|rwsem|spinlock> <options>",
+	NULL
+};
+
+/* -ENOENT means the benchmark is not available on this kernel */
+static int open_lock_bench(const char *mode, FILE **fp)
+{
+	const char *debugfs = debugfs_find_mountpoint();
+	char path[PATH_MAX];
+
+	if (!debugfs) {
+		fprintf(stderr, "debugfs is not mounted\n");
+		return -ENOENT;
+	}
+
+	snprintf(path, sizeof(path), "%s/lock_bench/run", debugfs);
+	*fp = fopen(path, mode);
+	if (!*fp) {
+		int ret = -errno;
+
+		if (ret == -ENOENT)
+			fprintf(stderr, "%s not found, is the test-lock-bench "
+				"module loaded?\n", path);
+		else
+			fprintf(stderr, "%s: %s\n", path, strerror(-ret));
+		return ret;
+	}
+	return 0;
+}
+
+static int bench_locking(const char *lock, int argc, const char **argv)
+{
+	struct stats throughput_stats;
+	unsigned long long elapsed_ns;
+	unsigned long ops, total = 0;
+	unsigned int i, n;
+	double secs, avg, stddev;
+	FILE *fp;
+	int ret;
+
+	argc = parse_options(argc, argv, options, bench_locking_usage, 0);
+	if (argc) {
+		usage_with_options(bench_locking_usage, options);
+		exit(EXIT_FAILURE);
+	}
+
+	if (!nthreads)
+		nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (!runtime)
+		runtime = 1;
+	if (read_pct > 100)
+		read_pct = 100;
+
+	/* don't abort 'perf bench all' where the module is missing */
+	ret = open_lock_bench("w", &fp);
+	if (ret == -ENOENT) {
+		fprintf(stderr, "Skipping the %s benchmark.\n", lock);
+		return 0;
+	}
+	if (ret)
+		return ret;
+
+	if (bench_format == BENCH_FORMAT_DEFAULT) {
+		printf("Run summary [PID %d]: %d kthreads contending on a %s for %d secs",
+		       getpid(), nthreads, lock, runtime);
+		if (!strcmp(lock, "rwsem"))
+			printf(", %d%% reads", read_pct);
+		printf(".\n\n");
+	}
+
+	/* the write blocks until the run is over */
+	ret = fprintf(fp, "%s %u %u %u %u\n", lock, nthreads, runtime * 1000,
+		      hold, read_pct);
+	if (fclose(fp) || ret < 0) {
+		fprintf(stderr, "starting the %s benchmark: %s\n", lock,
+			strerror(errno));
+		return -1;
+	}
+
+	ret = open_lock_bench("r", &fp);
+	if (ret)
+		return ret;
+	if (fscanf(fp, "%*s %u %*u %*u %*u %llu", &n, &elapsed_ns) != 2 ||
+	    n != nthreads)
+		goto bad_output;
+
+	secs = elapsed_ns / 1e9;
+	init_stats(&throughput_stats);
+	for (i = 0; i < n; i++) {
+		unsigned long t;
+
+		if (fscanf(fp, "%lu", &ops) != 1)
+			goto bad_output;
+
+		t = ops / secs;
+		total += t;
+		update_stats(&throughput_stats, t);
+		if (!silent && bench_format == BENCH_FORMAT_DEFAULT)
+			printf("[thread %2d] %ld ops/sec\n", i, t);
+	}
+	fclose(fp);
+
+	avg = avg_stats(&throughput_stats);
+	stddev = stddev_stats(&throughput_stats);
+
+	if (bench_format == BENCH_FORMAT_SIMPLE) {
+		printf("%lu %.0f %.2f\n", total, avg,
+		       rel_stddev_stats(stddev, avg));
+		return 0;
+	}
+
+	printf("%sTotal %lu ops/sec, averaged %ld ops/sec per thread (+- %.2f%%), "
+	       "total secs = %.2f\n", !silent ? "\n" : "", total, (long)avg,
+	       rel_stddev_stats(stddev, avg), secs);
+	return 0;
+
+bad_output:
+	fclose(fp);
+	fprintf(stderr, "unexpected lock_bench output\n");
+	return -1;
+}
+
+int bench_locking_mutex(int argc, const char **argv,
+			const char *prefix __maybe_unused)
+{
+	return bench_locking("mutex", argc, argv);
+}
+
+int bench_locking_rwsem(int argc, const char **argv,
+			const char *prefix __maybe_unused)
+{
+	return bench_locking("rwsem", argc, argv);
+}
+
+int bench_locking_spinlock(int argc, const char **argv,
+			   const char *prefix __maybe_unused)
+{
+	return bench_locking("spinlock", argc, argv);
+}
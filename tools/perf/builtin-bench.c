@@ -12,6 +12,9 @@
  *  sched ... scheduler and IPC performance
  *  mem   ... memory access performance
  *  numa  ... NUMA scheduling and MM performance
+ *  futex ... futex performance
+ *  epoll ... epoll performance
+ *  locking ... contended kernel lock performance
  */
 #include "perf.h"
 #include "util/util.h"
@@ -54,6 +57,29 @@ static struct bench mem_benchmarks[] = {
 	{ NULL,		NULL,						NULL			}
 };
 
+static struct bench futex_benchmarks[] = {
+	{ "hash",	"Benchmark for futex hash table",		bench_futex_hash	},
+	{ "wake",	"Benchmark for futex wake calls",		bench_futex_wake	},
+	{ "requeue",	"Benchmark for futex requeue calls",		bench_futex_requeue	},
+	{ "all",	"Test all futex benchmarks",			NULL			},
+	{ NULL,		NULL,						NULL			}
+};
+
+static struct bench epoll_benchmarks[] = {
+	{ "wait",	"Benchmark epoll concurrent epoll_waits",	bench_epoll_wait	},
+	{ "ctl",	"Benchmark epoll concurrent epoll_ctls",	bench_epoll_ctl		},
+	{ "all",	"Test all epoll benchmarks",			NULL			},
+	{ NULL,		NULL,						NULL			}
+};
+
+static struct bench locking_benchmarks[] = {
+	{ "mutex",	"Benchmark for contended mutexes",		bench_locking_mutex	},
+	{ "rwsem",	"Benchmark for contended rw-semaphores",	bench_locking_rwsem	},
+	{ "spinlock",	"Benchmark for contended spinlocks",		bench_locking_spinlock	},
+	{ "all",	"Test all locking benchmarks",			NULL			},
+	{ NULL,		NULL,						NULL			}
+};
+
 struct collection {
 	const char	*name;
 	const char	*summary;
@@ -66,6 +92,9 @@ static struct collection collections[] = {
 #ifdef HAVE_LIBNUMA_SUPPORT
 	{ "numa",	"NUMA scheduling and MM benchmarks",		numa_benchmarks		},
 #endif
+	{ "futex",	"Futex stressing benchmarks",			futex_benchmarks	},
+	{ "epoll",	"Epoll stressing benchmarks",			epoll_benchmarks	},
+	{ "locking",	"Kernel lock stressing benchmarks",		locking_benchmarks	},
 	{ "all",	"All benchmarks",				NULL			},
 	{ NULL,		NULL,						NULL			}
 };
@@ -0,0 +1,637 @@
+/*
+ * builtin-c2c.c
+ *
+ * Cache to cache contention analysis: groups memory access samples by
+ * the data cacheline they touched and reports the lines that bounce
+ * between CPUs (HITM - the load hit a line modified in another cache),
+ * together with the offsets and code locations accessing them.
+ */
+#include "builtin.h"
+#include "perf.h"
+
+#include "util/evlist.h"
+#include "util/evsel.h"
+#include "util/util.h"
+#include "util/cache.h"
+#include "util/symbol.h"
+#include "util/thread.h"
+#include "util/session.h"
+#include "util/tool.h"
+#include "util/debug.h"
+#include "util/data.h"
+
+#include "util/parse-options.h"
+
+#include <linux/rbtree.h>
+#include <linux/bitmap.h>
+
+struct c2c_stats {
+	u32	loads;
+	u32	stores;
+	u32	rmt_hitm;	/* load hit modified line in a remote cache */
+	u32	lcl_hitm;	/* ... in another core's cache on this node */
+	u32	lcl_dram;
+	u32	rmt_dram;
+	u32	st_l1hit;
+	u32	st_l1miss;
+	u32	locked;
+	u64	load_weight;	/* total load latency */
+};
+
+/* One instruction touching one offset of a cacheline */
+struct c2c_hit {
+	struct rb_node		node;
+	u64			offset;
+	u64			ip;
+	struct map		*map;
+	struct symbol		*sym;
+	struct c2c_stats	stats;
+	DECLARE_BITMAP(cpus, MAX_NR_CPUS);
+};
+
+struct c2c_line {
+	struct rb_node		node;
+	u64			addr;
+	pid_t			pid;		/* -1 for kernel addresses */
+	struct map		*map;		/* data map and symbol */
+	struct symbol		*sym;
+	struct c2c_stats	stats;
+	struct rb_root		hits;
+	unsigned int		nr_hits;
+	DECLARE_BITMAP(cpus, MAX_NR_CPUS);
+};
+
+typedef int (*c2c_sort_fn_t)(struct c2c_line *, struct c2c_line *);
+
+struct perf_c2c {
+	struct perf_tool	tool;
+	struct rb_root		lines;
+	unsigned int		nr_lines;
+	struct c2c_stats	stats;
+	u64			nr_samples;
+	u64			nr_unresolved;
+	u64			nr_no_cpu;	/* samples without a CPU */
+	c2c_sort_fn_t		sort;
+	u64			cl_size;
+	int			max_lines;
+	bool			all;
+};
+
+static const char	*sort_key = "hitm";
+static int		ldlat = 30;
+static bool		raw_ip;
+
+static void c2c_stats__add(struct c2c_stats *s, union perf_mem_data_src *src,
+			   u64 weight)
+{
+	u64 lvl = src->mem_lvl;
+	u64 snoop = src->mem_snoop;
+
+	if (src->mem_lock & PERF_MEM_LOCK_LOCKED)
+		s->locked++;
+
+	if (src->mem_op & PERF_MEM_OP_LOAD) {
+		s->loads++;
+		s->load_weight += weight;
+
+		if (snoop & PERF_MEM_SNOOP_HITM) {
+			if (lvl & (PERF_MEM_LVL_REM_CCE1 | PERF_MEM_LVL_REM_CCE2))
+				s->rmt_hitm++;
+			else if (lvl & PERF_MEM_LVL_L3)
+				s->lcl_hitm++;
+		}
+		if (lvl & PERF_MEM_LVL_LOC_RAM)
+			s->lcl_dram++;
+		if (lvl & (PERF_MEM_LVL_REM_RAM1 | PERF_MEM_LVL_REM_RAM2))
+			s->rmt_dram++;
+	} else if (src->mem_op & PERF_MEM_OP_STORE) {
+		s->stores++;
+
+		if (lvl & PERF_MEM_LVL_L1) {
+			if (lvl & PERF_MEM_LVL_HIT)
+				s->st_l1hit++;
+			else if (lvl & PERF_MEM_LVL_MISS)
+				s->st_l1miss++;
+		}
+	}
+}
+
+static u32 c2c_stats__hitm(struct c2c_stats *s)
+{
+	return s->rmt_hitm + s->lcl_hitm;
+}
+
+static struct c2c_line *c2c_line__findnew(struct perf_c2c *c2c, u64 addr,
+					  pid_t pid, bool *new)
+{
+	struct rb_node **p = &c2c->lines.rb_node;
+	struct rb_node *parent = NULL;
+	struct c2c_line *line;
+
+	*new = false;
+	while (*p) {
+		parent = *p;
+		line = rb_entry(parent, struct c2c_line, node);
+
+		if (addr < line->addr)
+			p = &(*p)->rb_left;
+		else if (addr > line->addr)
+			p = &(*p)->rb_right;
+		else if (pid < line->pid)
+			p = &(*p)->rb_left;
+		else if (pid > line->pid)
+			p = &(*p)->rb_right;
+		else
+			return line;
+	}
+
+	line = zalloc(sizeof(*line));
+	if (!line) {
+		pr_err("%s: zalloc failed\n", __func__);
+		return NULL;
+	}
+	line->addr = addr;
+	line->pid = pid;
+	line->hits = RB_ROOT;
+
+	rb_link_node(&line->node, parent, p);
+	rb_insert_color(&line->node, &c2c->lines);
+	c2c->nr_lines++;
+	*new = true;
+
+	return line;
+}
+
+static struct c2c_hit *c2c_hit__findnew(struct c2c_line *line, u64 offset,
+					u64 ip)
+{
+	struct rb_node **p = &line->hits.rb_node;
+	struct rb_node *parent = NULL;
+	struct c2c_hit *hit;
+
+	while (*p) {
+		parent = *p;
+		hit = rb_entry(parent, struct c2c_hit, node);
+
+		if (offset < hit->offset)
+			p = &(*p)->rb_left;
+		else if (offset > hit->offset)
+			p = &(*p)->rb_right;
+		else if (ip < hit->ip)
+			p = &(*p)->rb_left;
+		else if (ip > hit->ip)
+			p = &(*p)->rb_right;
+		else
+			return hit;
+	}
+
+	hit = zalloc(sizeof(*hit));
+	if (!hit) {
+		pr_err("%s: zalloc failed\n", __func__);
+		return NULL;
+	}
+	hit->offset = offset;
+	hit->ip = ip;
+
+	rb_link_node(&hit->node, parent, p);
+	rb_insert_color(&hit->node, &line->hits);
+	line->nr_hits++;
+
+	return hit;
+}
+
+static int process_sample_event(struct perf_tool *tool,
+				union perf_event *event,
+				struct perf_sample *sample,
+				struct perf_evsel *evsel,
+				struct machine *machine)
+{
+	struct perf_c2c *c2c = container_of(tool, struct perf_c2c, tool);
+	u8 cpumode = event->header.misc & PERF_RECORD_MISC_CPUMODE_MASK;
+	union perf_mem_data_src src = { .val = sample->data_src };
+	struct addr_location al;
+	struct c2c_line *line;
+	struct c2c_hit *hit;
+	u64 addr;
+	pid_t pid;
+	bool new;
+
+	if (!(evsel->attr.sample_type & PERF_SAMPLE_DATA_SRC) ||
+	    !(evsel->attr.sample_type & PERF_SAMPLE_ADDR))
+		return 0;
+
+	if (perf_event__preprocess_sample(event, machine, &al, sample) < 0) {
+		pr_debug("problem processing %d event, skipping it.\n",
+			 event->header.type);
+		return -1;
+	}
+
+	if (al.filtered)
+		return 0;
+
+	c2c->nr_samples++;
+	if (!sample->addr || !(src.mem_op & (PERF_MEM_OP_LOAD |
+					     PERF_MEM_OP_STORE))) {
+		c2c->nr_unresolved++;
+		return 0;
+	}
+
+	/*
+	 * User space addresses are only meaningful within a process, kernel
+	 * ones are shared by everybody.
+	 */
+	addr = sample->addr & ~(c2c->cl_size - 1);
+	pid = cpumode == PERF_RECORD_MISC_USER ? (pid_t)sample->pid : -1;
+
+	line = c2c_line__findnew(c2c, addr, pid, &new);
+	if (!line)
+		return -1;
+
+	if (new) {
+		struct mem_info *mi;
+
+		mi = machine__resolve_mem(machine, al.thread, sample, cpumode);
+		if (mi) {
+			line->map = mi->daddr.map;
+			line->sym = mi->daddr.sym;
+			free(mi);
+		}
+	}
+
+	hit = c2c_hit__findnew(line, sample->addr - addr, sample->ip);
+	if (!hit)
+		return -1;
+
+	if (!hit->map) {
+		hit->map = al.map;
+		hit->sym = al.sym;
+	}
+
+	c2c_stats__add(&c2c->stats, &src, sample->weight);
+	c2c_stats__add(&line->stats, &src, sample->weight);
+	c2c_stats__add(&hit->stats, &src, sample->weight);
+
+	if (!(evsel->attr.sample_type & PERF_SAMPLE_CPU) ||
+	    sample->cpu >= MAX_NR_CPUS) {
+		c2c->nr_no_cpu++;
+	} else {
+		set_bit(sample->cpu, line->cpus);
+		set_bit(sample->cpu, hit->cpus);
+	}
+
+	return 0;
+}
+
+static int hitm_cmp(struct c2c_line *l, struct c2c_line *r)
+{
+	u32 x = c2c_stats__hitm(&l->stats), y = c2c_stats__hitm(&r->stats);
+
+	if (x != y)
+		return x < y ? -1 : 1;
+	if (l->stats.rmt_hitm != r->stats.rmt_hitm)
+		return l->stats.rmt_hitm < r->stats.rmt_hitm ? -1 : 1;
+	if (l->stats.stores != r->stats.stores)
+		return l->stats.stores < r->stats.stores ? -1 : 1;
+	return 0;
+}
+
+static int rmt_cmp(struct c2c_line *l, struct c2c_line *r)
+{
+	if (l->stats.rmt_hitm != r->stats.rmt_hitm)
+		return l->stats.rmt_hitm < r->stats.rmt_hitm ? -1 : 1;
+	return hitm_cmp(l, r);
+}
+
+static int lcl_cmp(struct c2c_line *l, struct c2c_line *r)
+{
+	if (l->stats.lcl_hitm != r->stats.lcl_hitm)
+		return l->stats.lcl_hitm < r->stats.lcl_hitm ? -1 : 1;
+	return hitm_cmp(l, r);
+}
+
+static int stores_cmp(struct c2c_line *l, struct c2c_line *r)
+{
+	if (l->stats.stores != r->stats.stores)
+		return l->stats.stores < r->stats.stores ? -1 : 1;
+	return hitm_cmp(l, r);
+}
+
+static const struct {
+	const char	*name;
+	c2c_sort_fn_t	fn;
+} c2c_sorts[] = {
+	{ "hitm",	hitm_cmp },
+	{ "rmt",	rmt_cmp },
+	{ "lcl",	lcl_cmp },
+	{ "stores",	stores_cmp },
+};
+
+static c2c_sort_fn_t line_sort;
+
+static int line_qsort_cmp(const void *a, const void *b)
+{
+	/* biggest first */
+	return line_sort(*(struct c2c_line **)b, *(struct c2c_line **)a);
+}
+
+static void print_symbol(struct map *map, struct symbol *sym, u64 addr)
+{
+	if (sym && !raw_ip)
+		printf("%s", sym->name);
+	else
+		printf("%#" PRIx64, addr);
+	printf("  %s", map && map->dso ? map->dso->short_name : "[unknown]");
+}
+
+static double avg_latency(struct c2c_stats *s)
+{
+	return s->loads ? (double)s->load_weight / s->loads : 0;
+}
+
+/* The CPU count is meaningless if some samples did not record a CPU */
+static void print_cpus(struct perf_c2c *c2c, unsigned long *cpus)
+{
+	if (c2c->nr_no_cpu)
+		printf("%4s  ", "-");
+	else
+		printf("%4d  ", bitmap_weight(cpus, MAX_NR_CPUS));
+}
+
+static void print_line(struct perf_c2c *c2c, struct c2c_line *line, int idx)
+{
+	struct rb_node *nd;
+
+	printf("%4d  %#18" PRIx64 " %6d %6u %6u %6u %6u %6u %6u %6u %8.1f ",
+	       idx, line->addr, line->pid, c2c_stats__hitm(&line->stats),
+	       line->stats.rmt_hitm, line->stats.lcl_hitm,
+	       line->stats.loads, line->stats.stores,
+	       line->stats.st_l1hit, line->stats.st_l1miss,
+	       avg_latency(&line->stats));
+	print_cpus(c2c, line->cpus);
+	if (line->sym || line->map)
+		print_symbol(line->map, line->sym, line->addr);
+	printf("\n");
+
+	for (nd = rb_first(&line->hits); nd; nd = rb_next(nd)) {
+		struct c2c_hit *hit = rb_entry(nd, struct c2c_hit, node);
+
+		printf("      %#6" PRIx64 "  %#18" PRIx64 " %6u %6u %6u %6u %8.1f ",
+		       hit->offset, hit->ip, hit->stats.rmt_hitm,
+		       hit->stats.lcl_hitm, hit->stats.loads,
+		       hit->stats.stores, avg_latency(&hit->stats));
+		print_cpus(c2c, hit->cpus);
+		print_symbol(hit->map, hit->sym, hit->ip);
+		printf("\n");
+	}
+}
+
+static void print_summary(struct perf_c2c *c2c, unsigned int nr_hitm_lines)
+{
+	struct c2c_stats *s = &c2c->stats;
+
+	printf("# Shared data cache line summary\n");
+	printf("#\n");
+	printf("#   Samples                   : %10" PRIu64 "\n", c2c->nr_samples);
+	printf("#   Samples without address   : %10" PRIu64 "\n",
+	       c2c->nr_unresolved);
+	printf("#   Samples without CPU       : %10" PRIu64 "\n",
+	       c2c->nr_no_cpu);
+	printf("#   Loads                     : %10u\n", s->loads);
+	printf("#   Stores                    : %10u\n", s->stores);
+	printf("#   Load remote HITM          : %10u\n", s->rmt_hitm);
+	printf("#   Load local HITM           : %10u\n", s->lcl_hitm);
+	printf("#   Load local DRAM           : %10u\n", s->lcl_dram);
+	printf("#   Load remote DRAM          : %10u\n", s->rmt_dram);
+	printf("#   Store L1 hit / miss       : %10u / %u\n",
+	       s->st_l1hit, s->st_l1miss);
+	printf("#   Locked accesses           : %10u\n", s->locked);
+	printf("#   Cachelines                : %10u\n", c2c->nr_lines);
+	printf("#   Cachelines with HITM      : %10u\n", nr_hitm_lines);
+	printf("#\n");
+}
+
+static int c2c_print(struct perf_c2c *c2c)
+{
+	struct c2c_line **lines;
+	struct rb_node *nd;
+	unsigned int i, n = 0, nr_hitm = 0;
+
+	lines = calloc(c2c->nr_lines, sizeof(*lines));
+	if (c2c->nr_lines && !lines) {
+		pr_err("%s: calloc failed\n", __func__);
+		return -1;
+	}
+
+	for (nd = rb_first(&c2c->lines); nd; nd = rb_next(nd)) {
+		struct c2c_line *line = rb_entry(nd, struct c2c_line, node);
+
+		if (c2c_stats__hitm(&line->stats))
+			nr_hitm++;
+		else if (!c2c->all)
+			continue;
+		lines[n++] = line;
+	}
+
+	line_sort = c2c->sort;
+	qsort(lines, n, sizeof(*lines), line_qsort_cmp);
+
+	print_summary(c2c, nr_hitm);
+
+	printf("#  Num           Cacheline    Pid   HITM    Rmt    Lcl"
+	       "  Loads Stores  L1Hit L1Miss  Avg lat CPUs  Data symbol\n");
+	printf("#      Offset                  Ip    Rmt    Lcl  Loads"
+	       " Stores  Avg lat CPUs  Symbol\n");
+	printf("# ..........................................................."
+	       "......................................\n");
+
+	for (i = 0; i < n; i++) {
+		if (c2c->max_lines >= 0 && (int)i >= c2c->max_lines)
+			break;
+		print_line(c2c, lines[i], i);
+		printf("\n");
+	}
+
+	free(lines);
+	return 0;
+}
+
+static void c2c_delete(struct perf_c2c *c2c)
+{
+	struct rb_node *nd, *hn;
+
+	while ((nd = rb_first(&c2c->lines))) {
+		struct c2c_line *line = rb_entry(nd, struct c2c_line, node);
+
+		while ((hn = rb_first(&line->hits))) {
+			rb_erase(hn, &line->hits);
+			free(rb_entry(hn, struct c2c_hit, node));
+		}
+		rb_erase(nd, &c2c->lines);
+		free(line);
+	}
+}
+
+static int perf_c2c__report(struct perf_c2c *c2c)
+{
+	struct perf_data_file file = {
+		.path = input_name,
+		.mode = PERF_DATA_MODE_READ,
+	};
+	struct perf_session *session;
+	struct perf_evsel *evsel;
+	bool have_mem = false;
+	int err = -EINVAL;
+
+	session = perf_session__new(&file, false, &c2c->tool);
+	if (session == NULL)
+		return -ENOMEM;
+
+	list_for_each_entry(evsel, &session->evlist->entries, node) {
+		u64 type = evsel->attr.sample_type;
+
+		if ((type & PERF_SAMPLE_ADDR) && (type & PERF_SAMPLE_DATA_SRC))
+			have_mem = true;
+	}
+
+	if (!have_mem) {
+		pr_err("No memory access samples with data addresses found, "
+		       "use 'perf c2c record' to create them.\n");
+		goto out_delete;
+	}
+
+	if (symbol__init() < 0)
+		goto out_delete;
+
+	setup_pager();
+	err = perf_session__process_events(session, &c2c->tool);
+	if (err)
+		goto out_delete;
+
+	err = c2c_print(c2c);
+out_delete:
+	c2c_delete(c2c);
+	perf_session__delete(session);
+	return err;
+}
+
+static int __cmd_record(int argc, const char **argv)
+{
+	unsigned int rec_argc, i, j;
+	const char **rec_argv;
+	char event[64];
+	int ret;
+
+	rec_argc = argc + 8;
+	rec_argv = calloc(rec_argc + 1, sizeof(char *));
+	if (!rec_argv)
+		return -ENOMEM;
+
+	i = 0;
+	rec_argv[i++] = strdup("record");
+	rec_argv[i++] = strdup("-W");
+	rec_argv[i++] = strdup("-d");
+	/* -R samples the CPU even when not recording per cpu */
+	rec_argv[i++] = strdup("-R");
+	rec_argv[i++] = strdup("-e");
+	snprintf(event, sizeof(event), "cpu/mem-loads,ldlat=%d/pp", ldlat);
+	rec_argv[i++] = strdup(event);
+	rec_argv[i++] = strdup("-e");
+	rec_argv[i++] = strdup("cpu/mem-stores/pp");
+
+	for (j = 0; j < (unsigned int)argc; j++, i++)
+		rec_argv[i] = argv[j];
+
+	ret = cmd_record(i, rec_argv, NULL);
+	free(rec_argv);
+	return ret;
+}
+
+int cmd_c2c(int argc, const char **argv, const char *prefix __maybe_unused)
+{
+	struct perf_c2c c2c = {
+		.tool = {
+			.sample		= process_sample_event,
+			.mmap		= perf_event__process_mmap,
+			.mmap2		= perf_event__process_mmap2,
+			.comm		= perf_event__process_comm,
+			.exit		= perf_event__process_exit,
+			.fork		= perf_event__process_fork,
+			.lost		= perf_event__process_lost,
+			.build_id	= perf_event__process_build_id,
+			.ordered_samples = true,
+		},
+		.lines		= RB_ROOT,
+		.cl_size	= 64,
+		.max_lines	= 20,
+	};
+	const struct option c2c_options[] = {
+	OPT_STRING('i', "input", &input_name, "file", "input file name"),
+	OPT_END()
+	};
+	const struct option record_options[] = {
+	OPT_INTEGER('l', "ldlat", &ldlat,
+		    "minimum load latency in cycles (default 30)"),
+	OPT_END()
+	};
+	const struct option report_options[] = {
+	OPT_STRING('i', "input", &input_name, "file", "input file name"),
+	OPT_STRING('s', "sort", &sort_key, "key",
+		   "sort cachelines by: hitm (default), rmt, lcl, stores"),
+	OPT_INTEGER('n', "lines", &c2c.max_lines,
+		    "show at most n cachelines, -1 for all (default 20)"),
+	OPT_U64(0, "cacheline-size", &c2c.cl_size,
+		"cacheline size in bytes (default 64)"),
+	OPT_BOOLEAN('a', "all", &c2c.all,
+		    "also show cachelines without HITM"),
+	OPT_BOOLEAN(0, "raw-ip", &raw_ip, "show raw ip instead of symbol"),
+	OPT_END()
+	};
+	const char * const c2c_usage[] = {
+		"perf c2c [<options>] {record|report}",
+		NULL
+	};
+	const char * const record_usage[] = {
+		"perf c2c record [<options>] [-- <record options>] <command>",
+		NULL
+	};
+	const char * const report_usage[] = {
+		"perf c2c report [<options>]",
+		NULL
+	};
+	unsigned int i;
+
+	argc = parse_options(argc, argv, c2c_options, c2c_usage,
+			     PARSE_OPT_STOP_AT_NON_OPTION);
+	if (!argc)
+		usage_with_options(c2c_usage, c2c_options);
+
+	if (!strncmp(argv[0], "rec", 3)) {
+		/* anything after '--' is passed on to 'perf record' */
+		argc = parse_options(argc, argv, record_options, record_usage,
+				     PARSE_OPT_STOP_AT_NON_OPTION);
+		return __cmd_record(argc, argv);
+	}
+
+	if (strncmp(argv[0], "rep", 3))
+		usage_with_options(c2c_usage, c2c_options);
+
+	argc = parse_options(argc, argv, report_options, report_usage, 0);
+	if (argc)
+		usage_with_options(report_usage, report_options);
+
+	if (!c2c.cl_size || (c2c.cl_size & (c2c.cl_size - 1))) {
+		pr_err("cacheline size must be a power of two\n");
+		return -EINVAL;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(c2c_sorts); i++) {
+		if (!strcmp(sort_key, c2c_sorts[i].name))
+			c2c.sort = c2c_sorts[i].fn;
+	}
+	if (!c2c.sort) {
+		error("Unknown --sort key: '%s'", sort_key);
+		usage_with_options(report_usage, report_options);
+	}
+
+	return perf_c2c__report(&c2c);
+}